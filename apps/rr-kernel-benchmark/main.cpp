@@ -0,0 +1,202 @@
+// Micro benchmarks of the generated model functions.
+//
+// Loads each model once per code generator configuration, that is, each
+// combination of the LoadSBMLOptions::OPTIMIZE_* flags with the legacy JIT
+// and with MCJIT, and measures the cost per call of each generated function
+// (see rrllvm::KernelBenchmark). The results are printed as tab separated
+// rows of
+//
+// model, jit, optimizations, load seconds, function, ns per call, calls
+//
+// so the load options can be tuned per model class by measurement.
+
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "rrGetOptions.h"
+#include "rrLogger.h"
+#include "rrUtils.h"
+#include "llvm/KernelBenchmark.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+using namespace rr;
+using namespace std;
+using rrllvm::KernelBenchmark;
+using rrllvm::KernelTiming;
+
+static const unsigned optimizeFlags[] =
+{
+    LoadSBMLOptions::OPTIMIZE_GVN,
+    LoadSBMLOptions::OPTIMIZE_CFG_SIMPLIFICATION,
+    LoadSBMLOptions::OPTIMIZE_INSTRUCTION_COMBINING,
+    LoadSBMLOptions::OPTIMIZE_DEAD_INST_ELIMINATION,
+    LoadSBMLOptions::OPTIMIZE_DEAD_CODE_ELIMINATION,
+    LoadSBMLOptions::OPTIMIZE_INSTRUCTION_SIMPLIFIER
+};
+
+static const char* optimizeNames[] =
+{
+    "GVN",
+    "CFG_SIMPLIFICATION",
+    "INSTRUCTION_COMBINING",
+    "DEAD_INST_ELIMINATION",
+    "DEAD_CODE_ELIMINATION",
+    "INSTRUCTION_SIMPLIFIER"
+};
+
+static const unsigned numOptimizeFlags = sizeof(optimizeFlags) / sizeof(unsigned);
+
+static string optimizeString(unsigned flags)
+{
+    string result;
+    for (unsigned i = 0; i < numOptimizeFlags; ++i)
+    {
+        if (flags & optimizeFlags[i])
+        {
+            result += (result.empty() ? "" : "|");
+            result += optimizeNames[i];
+        }
+    }
+    return result.empty() ? "NONE" : result;
+}
+
+static void usage(const char* prg)
+{
+    cerr << "Usage: " << prg << " [options] sbml file ...\n\n"
+         << "  -a          run all combinations of the OPTIMIZE_* flags, by default\n"
+         << "              none, each flag on its own, and all flags are run\n"
+         << "  -j<jit>     legacy, mcjit or both. Default: both\n"
+         << "  -t<seconds> minimum time spent calling each function. Default: 0.02\n"
+         << "  -v<level>   log level, e.g. notice, information, debug\n";
+}
+
+int main(int argc, char** argv)
+{
+    bool allCombinations = false;
+    bool legacy = true;
+    bool mcjit = true;
+    double minSeconds = 0.02;
+
+    int c;
+    while ((c = GetOptions(argc, argv, "aj:t:v:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'a':
+            allCombinations = true;
+            break;
+        case 'j':
+            legacy = string(rrOptArg) != "mcjit";
+            mcjit = string(rrOptArg) != "legacy";
+            break;
+        case 't':
+            minSeconds = atof(rrOptArg);
+            break;
+        case 'v':
+            Logger::setLevel(Logger::stringToLevel(rrOptArg));
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (rrOptInd >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vector<unsigned> configs;
+    if (allCombinations)
+    {
+        for (unsigned i = 0; i < (1u << numOptimizeFlags); ++i)
+        {
+            unsigned flags = 0;
+            for (unsigned j = 0; j < numOptimizeFlags; ++j)
+            {
+                if (i & (1u << j))
+                {
+                    flags |= optimizeFlags[j];
+                }
+            }
+            configs.push_back(flags);
+        }
+    }
+    else
+    {
+        configs.push_back(0);
+        for (unsigned j = 0; j < numOptimizeFlags; ++j)
+        {
+            configs.push_back(optimizeFlags[j]);
+        }
+        configs.push_back(LoadSBMLOptions::OPTIMIZE);
+    }
+
+    vector<bool> jits;
+    if (legacy)
+    {
+        jits.push_back(false);
+    }
+    if (mcjit)
+    {
+        jits.push_back(true);
+    }
+
+    cout << "model\tjit\toptimize\tloadSeconds\tfunction\tnsPerCall\tcalls" << endl;
+
+    int failures = 0;
+
+    for (int m = rrOptInd; m < argc; ++m)
+    {
+        for (unsigned j = 0; j < jits.size(); ++j)
+        {
+            for (unsigned k = 0; k < configs.size(); ++k)
+            {
+                LoadSBMLOptions opt;
+                opt.modelGeneratorOpt &= ~(LoadSBMLOptions::OPTIMIZE
+                        | LoadSBMLOptions::USE_MCJIT | LoadSBMLOptions::READ_ONLY);
+                opt.modelGeneratorOpt |= LoadSBMLOptions::RECOMPILE | configs[k];
+                if (jits[j])
+                {
+                    opt.modelGeneratorOpt |= LoadSBMLOptions::USE_MCJIT;
+                }
+
+                const char* jit = jits[j] ? "mcjit" : "legacy";
+                string optimize = optimizeString(configs[k]);
+
+                try
+                {
+                    SBMLSolver solver;
+
+                    int64_t start = getMicroSeconds();
+                    solver.load(argv[m], &opt);
+                    double loadSeconds = (getMicroSeconds() - start) / 1.e6;
+
+                    vector<KernelTiming> timings =
+                            KernelBenchmark::run(solver.getModel(), minSeconds);
+
+                    for (unsigned t = 0; t < timings.size(); ++t)
+                    {
+                        cout << argv[m] << "\t" << jit << "\t" << optimize
+                                << "\t" << loadSeconds
+                                << "\t" << timings[t].name
+                                << "\t" << timings[t].nanoseconds
+                                << "\t" << timings[t].calls << endl;
+                    }
+                }
+                catch (std::exception& e)
+                {
+                    cerr << argv[m] << " " << jit << " " << optimize
+                            << " failed: " << e.what() << endl;
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,659 @@
+#pragma hdrstop
+#include "Benchmark.h"
+#include "Json.h"
+
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "TrajectoryFile.h"
+#include "Integrator.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+#include "rrUtils.h"
+#include "rrVersionInfo.h"
+
+#include <Poco/DirectoryIterator.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/TemporaryFile.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <math.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+using namespace rr;
+
+namespace rrbench
+{
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/**
+ * time differences below this are noise, and never regressions.
+ */
+static const double minimumTimeDelta = 1.e-3;
+
+static bool isNaN(double value)
+{
+    return value != value;
+}
+
+static const char* phaseNames[] =
+{
+        "load",
+        "sbmlProcessing",
+        "codegen",
+        "firstSimulate",
+        "simulate",
+        "steadyState",
+        "rhsThroughput",
+        "controlCoefficients",
+        "csvWrite",
+        "trajectoryWrite",
+        "trajectoryRead",
+        "csvBytes",
+        "trajectoryBytes"
+};
+
+const char* phaseName(int phase)
+{
+    return phaseNames[phase];
+}
+
+bool higherIsBetter(int phase)
+{
+    return phase == RHS_THROUGHPUT;
+}
+
+PhaseStatistics::PhaseStatistics() :
+        n(0), min(NaN), median(NaN), mean(NaN), stddev(NaN)
+{
+}
+
+PhaseStatistics PhaseStatistics::compute(std::vector<double> samples)
+{
+    samples.erase(std::remove_if(samples.begin(), samples.end(), isNaN),
+            samples.end());
+
+    PhaseStatistics stats;
+    stats.n = samples.size();
+
+    if (stats.n == 0)
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    stats.min = samples[0];
+    stats.median = stats.n % 2 ? samples[stats.n / 2] :
+            (samples[stats.n / 2 - 1] + samples[stats.n / 2]) / 2;
+
+    double sum = 0;
+    for (unsigned i = 0; i < stats.n; ++i)
+    {
+        sum += samples[i];
+    }
+    stats.mean = sum / stats.n;
+
+    double sq = 0;
+    for (unsigned i = 0; i < stats.n; ++i)
+    {
+        sq += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+    }
+    stats.stddev = stats.n > 1 ? sqrt(sq / (stats.n - 1)) : 0;
+
+    return stats;
+}
+
+static std::string relativeName(const std::string& root, const std::string& path)
+{
+    Poco::Path base(Poco::Path(root).absolute().makeDirectory());
+    std::string abs = Poco::Path(path).absolute().toString(Poco::Path::PATH_UNIX);
+    std::string prefix = base.toString(Poco::Path::PATH_UNIX);
+
+    if (abs.size() > 1 && abs[abs.size() - 1] == '/')
+    {
+        abs.erase(abs.size() - 1);
+    }
+
+    if (abs.compare(0, prefix.size(), prefix) == 0)
+    {
+        return abs.substr(prefix.size());
+    }
+    return abs;
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() &&
+            str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * a test suite case directory NAME with NAME-settings.txt, the sbml file
+ * of the highest level and version is used.
+ */
+static bool findTestSuiteCase(const std::string& root, const Poco::Path& dir,
+        BenchmarkCase& result)
+{
+    std::string name = dir.directory(dir.depth() - 1);
+    Poco::Path settings(dir, name + "-settings.txt");
+
+    if (!Poco::File(settings).exists())
+    {
+        return false;
+    }
+
+    std::string prefix = name + "-sbml-l";
+    std::string best;
+
+    for (Poco::DirectoryIterator i(dir), end; i != end; ++i)
+    {
+        std::string file = i.name();
+        if (file.compare(0, prefix.size(), prefix) == 0 && endsWith(file, ".xml")
+                && file > best)
+        {
+            best = file;
+        }
+    }
+
+    if (best.empty())
+    {
+        return false;
+    }
+
+    result.sbmlFile = Poco::Path(dir, best).toString();
+    result.settingsFile = settings.toString();
+    result.name = relativeName(root, dir.toString());
+    return true;
+}
+
+static bool compareNames(const BenchmarkCase& a, const BenchmarkCase& b)
+{
+    return a.name < b.name;
+}
+
+void findCases(const std::string& root, const std::string& path,
+        std::vector<BenchmarkCase>& cases)
+{
+    Poco::File file(path);
+
+    if (!file.exists())
+    {
+        throw std::invalid_argument("no such file or directory: " + path);
+    }
+
+    if (file.isFile())
+    {
+        BenchmarkCase c;
+        c.sbmlFile = path;
+        c.name = relativeName(root, path);
+        cases.push_back(c);
+        return;
+    }
+
+    std::vector<BenchmarkCase> found;
+
+    for (Poco::DirectoryIterator i(path), end; i != end; ++i)
+    {
+        BenchmarkCase c;
+
+        if (i->isDirectory())
+        {
+            Poco::Path dir(i.path());
+            dir.makeDirectory();
+
+            if (findTestSuiteCase(root, dir, c))
+            {
+                found.push_back(c);
+            }
+        }
+        else if (endsWith(i.name(), ".xml"))
+        {
+            c.sbmlFile = i.path().toString();
+            c.name = relativeName(root, c.sbmlFile);
+            found.push_back(c);
+        }
+    }
+
+    // directory iteration order is unspecified, keep runs comparable
+    std::sort(found.begin(), found.end(), compareNames);
+
+    cases.insert(cases.end(), found.begin(), found.end());
+}
+
+static double secondsSince(int64_t start)
+{
+    return (getMicroSeconds() - start) / 1.e6;
+}
+
+static double counter(const Dictionary* counters, const std::string& key)
+{
+    return counters->hasKey(key) ? counters->getItem(key).convert<double>() : NaN;
+}
+
+/**
+ * evaluate the rate function at the current state for about the given
+ * number of seconds.
+ */
+static double rhsThroughput(ExecutableModel* model, double seconds)
+{
+    int n = model->getStateVector(0);
+
+    if (n == 0)
+    {
+        return NaN;
+    }
+
+    std::vector<double> rates(n);
+    const double time = model->getTime();
+    const int64_t budget = seconds * 1.e6;
+    const int64_t start = getMicroSeconds();
+    int64_t elapsed = 0;
+    uint64_t evaluations = 0;
+
+    do
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            model->getStateVectorRate(time, 0, &rates[0]);
+        }
+        evaluations += 64;
+        elapsed = getMicroSeconds() - start;
+    }
+    while (elapsed < budget);
+
+    return evaluations / (elapsed / 1.e6);
+}
+
+/**
+ * write a simulation result as csv and as a trajectory file, and read the
+ * trajectory file back. The files are deleted when done.
+ */
+static void measureOutput(const ls::DoubleMatrix& result, double* values)
+{
+    Poco::TemporaryFile csvFile, trajectoryFile;
+
+    int64_t start = getMicroSeconds();
+    {
+        std::ofstream out(csvFile.path().c_str());
+        out << result;
+    }
+    values[CSV_WRITE] = secondsSince(start);
+    values[CSV_BYTES] = csvFile.getSize();
+
+    std::vector<std::string> columns = result.getColNames();
+    columns.resize(result.numCols());
+
+    start = getMicroSeconds();
+    {
+        TrajectoryWriter out(trajectoryFile.path(), columns);
+        out.write(result);
+        out.close();
+    }
+    values[TRAJECTORY_WRITE] = secondsSince(start);
+    values[TRAJECTORY_BYTES] = trajectoryFile.getSize();
+
+    start = getMicroSeconds();
+    {
+        TrajectoryReader in(trajectoryFile.path());
+        in.getMatrix();
+    }
+    values[TRAJECTORY_READ] = secondsSince(start);
+}
+
+/**
+ * raise increase to the growth of the current resident set size over base.
+ */
+static void sampleRSS(uint64_t base, uint64_t& increase)
+{
+    uint64_t rss = getCurrentRSS();
+
+    if (rss > base)
+    {
+        increase = std::max(increase, rss - base);
+    }
+}
+
+static void runOnce(const BenchmarkCase& c, const BenchmarkOptions& options,
+        double* values, uint64_t baseRSS, uint64_t& rssIncrease)
+{
+    SBMLSolver solver;
+
+    LoadSBMLOptions loadOptions;
+    loadOptions.modelGeneratorOpt |= LoadSBMLOptions::RECOMPILE;
+
+    int64_t start = getMicroSeconds();
+    solver.load(c.sbmlFile, &loadOptions);
+    values[LOAD] = secondsSince(start);
+    sampleRSS(baseRSS, rssIncrease);
+
+    const Dictionary* counters = solver.getPerformanceCounters();
+    values[SBML_PROCESSING] = counter(counters, "model.sbmlProcessingTime");
+    values[CODEGEN] = counter(counters, "model.codeGenerationTime");
+
+    SimulateOptions settings = c.settingsFile.empty() ? SimulateOptions() :
+            SimulateOptions(c.settingsFile);
+
+    if (options.stiff)
+    {
+        settings.integratorFlags |= Integrator::STIFF;
+    }
+
+    if (!options.integrator.empty())
+    {
+        settings.setItem("integrator", options.integrator);
+    }
+
+    solver.setSimulateOptions(settings);
+
+    start = getMicroSeconds();
+    solver.simulate(0);
+    values[FIRST_SIMULATE] = secondsSince(start);
+
+    solver.reset();
+
+    start = getMicroSeconds();
+    const ls::DoubleMatrix* result = solver.simulate(0);
+    values[SIMULATE] = secondsSince(start);
+
+    sampleRSS(baseRSS, rssIncrease);
+
+    measureOutput(*result, values);
+
+    values[RHS_THROUGHPUT] = rhsThroughput(solver.getModel(), options.rhsSeconds);
+
+    solver.reset();
+
+    try
+    {
+        start = getMicroSeconds();
+        solver.steadyState();
+        values[STEADY_STATE] = secondsSince(start);
+        sampleRSS(baseRSS, rssIncrease);
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_INFORMATION) << c.name << ": no steady state: " << e.what();
+        values[STEADY_STATE] = NaN;
+        values[CONTROL_COEFFICIENTS] = NaN;
+        return;
+    }
+
+    try
+    {
+        start = getMicroSeconds();
+        solver.getScaledConcentrationControlCoefficientMatrix();
+        values[CONTROL_COEFFICIENTS] = secondsSince(start);
+        sampleRSS(baseRSS, rssIncrease);
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_INFORMATION) << c.name << ": no control coefficients: " << e.what();
+        values[CONTROL_COEFFICIENTS] = NaN;
+    }
+}
+
+BenchmarkResult runCase(const BenchmarkCase& benchmarkCase,
+        const BenchmarkOptions& options)
+{
+    BenchmarkResult result;
+    result.benchmarkCase = benchmarkCase;
+
+    std::vector<double> samples[PHASE_COUNT];
+
+    const uint64_t baseRSS = getCurrentRSS();
+
+    try
+    {
+        for (unsigned i = 0; i < options.warmup + options.repeats; ++i)
+        {
+            double values[PHASE_COUNT];
+            runOnce(benchmarkCase, options, values, baseRSS,
+                    result.rssIncrease);
+
+            if (i >= options.warmup)
+            {
+                for (int p = 0; p < PHASE_COUNT; ++p)
+                {
+                    samples[p].push_back(values[p]);
+                }
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        result.error = e.what();
+    }
+
+    for (int p = 0; p < PHASE_COUNT; ++p)
+    {
+        result.phases[p] = PhaseStatistics::compute(samples[p]);
+    }
+
+    return result;
+}
+
+uint64_t getPeakRSS()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+    {
+        return info.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    // bytes on OSX
+    return usage.ru_maxrss;
+#else
+    // kilobytes on Linux
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+uint64_t getCurrentRSS()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+    {
+        return info.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+            (task_info_t)&info, &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // the second field of statm is the resident size in pages
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+    {
+        return 0;
+    }
+
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+
+    return n == 2 ? (uint64_t)resident * sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+static void writePhase(std::ostream& out, const PhaseStatistics& stats)
+{
+    if (stats.n == 0)
+    {
+        out << "null";
+        return;
+    }
+
+    out << "{\"n\": " << stats.n;
+    out << ", \"min\": ";
+    writeJsonNumber(out, stats.min);
+    out << ", \"median\": ";
+    writeJsonNumber(out, stats.median);
+    out << ", \"mean\": ";
+    writeJsonNumber(out, stats.mean);
+    out << ", \"stddev\": ";
+    writeJsonNumber(out, stats.stddev);
+    out << "}";
+}
+
+void writeResults(std::ostream& out, const BenchmarkOptions& options,
+        const std::vector<BenchmarkResult>& results)
+{
+    std::streamsize precision = out.precision(10);
+
+    out << "{\n";
+    out << "  \"version\": ";
+    writeJsonString(out, getVersionStr());
+    out << ",\n  \"repeats\": " << options.repeats;
+    out << ",\n  \"warmup\": " << options.warmup;
+    out << ",\n  \"stiff\": " << (options.stiff ? "true" : "false");
+    out << ",\n  \"integrator\": ";
+    writeJsonString(out, options.integrator.empty() ? "default" : options.integrator);
+    out << ",\n  \"peakRSS\": " << getPeakRSS();
+    out << ",\n  \"cases\": [";
+
+    for (unsigned i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& r = results[i];
+
+        out << (i ? ",\n" : "\n") << "    {\n      \"name\": ";
+        writeJsonString(out, r.benchmarkCase.name);
+        out << ",\n      \"sbml\": ";
+        writeJsonString(out, r.benchmarkCase.sbmlFile);
+
+        if (!r.error.empty())
+        {
+            out << ",\n      \"error\": ";
+            writeJsonString(out, r.error);
+        }
+
+        out << ",\n      \"rssIncrease\": " << r.rssIncrease;
+        out << ",\n      \"phases\": {";
+
+        for (int p = 0; p < PHASE_COUNT; ++p)
+        {
+            out << (p ? ",\n" : "\n") << "        \"" << phaseName(p) << "\": ";
+            writePhase(out, r.phases[p]);
+        }
+
+        out << "\n      }\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+
+    out.precision(precision);
+}
+
+int compareWithBaseline(std::ostream& report, const JsonValue& baseline,
+        const std::vector<BenchmarkResult>& results, double tolerance)
+{
+    std::map<std::string, const JsonValue*> baseCases;
+    const std::vector<JsonValue>& cases = baseline["cases"].array;
+
+    for (unsigned i = 0; i < cases.size(); ++i)
+    {
+        baseCases[cases[i]["name"].string] = &cases[i];
+    }
+
+    int regressions = 0;
+
+    for (unsigned i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& r = results[i];
+        const std::string& name = r.benchmarkCase.name;
+
+        std::map<std::string, const JsonValue*>::const_iterator b = baseCases.find(name);
+        if (b == baseCases.end())
+        {
+            report << "new      " << name << "\n";
+            continue;
+        }
+
+        const JsonValue& basePhases = (*b->second)["phases"];
+
+        for (int p = 0; p < PHASE_COUNT; ++p)
+        {
+            double base = basePhases[phaseName(p)]["median"].asNumber();
+            double current = r.phases[p].median;
+
+            if (isNaN(base))
+            {
+                continue;
+            }
+
+            if (isNaN(current))
+            {
+                report << "FAILED   " << name << " " << phaseName(p)
+                        << ": succeeded in the baseline\n";
+                ++regressions;
+                continue;
+            }
+
+            bool worse, better;
+            if (higherIsBetter(p))
+            {
+                worse = current * (1 + tolerance) < base;
+                better = current > base * (1 + tolerance);
+            }
+            else
+            {
+                bool significant = fabs(current - base) > minimumTimeDelta;
+                worse = significant && current > base * (1 + tolerance);
+                better = significant && current * (1 + tolerance) < base;
+            }
+
+            if (worse || better)
+            {
+                report << (worse ? "SLOWER   " : "faster   ") << name << " "
+                        << phaseName(p) << ": " << base << " -> " << current
+                        << " (" << std::showpos << std::fixed << std::setprecision(1)
+                        << 100 * (current - base) / base << "%)"
+                        << std::noshowpos << std::resetiosflags(std::ios::fixed)
+                        << std::setprecision(6) << "\n";
+            }
+
+            if (worse)
+            {
+                ++regressions;
+            }
+        }
+    }
+
+    return regressions;
+}
+
+} /* namespace rrbench */
@@ -0,0 +1,193 @@
+/*
+ * Benchmark.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_BENCHMARK_H_
+#define RR_BENCHMARK_H_
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rrbench
+{
+
+class JsonValue;
+
+/**
+ * A model to benchmark, either a plain sbml file simulated with the
+ * default simulate options, or an sbml test suite style case, a directory
+ * NAME holding NAME-settings.txt and NAME-sbml-lXvY.xml.
+ */
+struct BenchmarkCase
+{
+    /**
+     * the name results are matched by when comparing to a baseline,
+     * the path relative to the data root.
+     */
+    std::string name;
+
+    std::string sbmlFile;
+
+    /**
+     * empty for plain sbml files.
+     */
+    std::string settingsFile;
+};
+
+/**
+ * summary of the repeated measurements of one phase.
+ */
+struct PhaseStatistics
+{
+    PhaseStatistics();
+
+    unsigned n;
+    double min;
+    double median;
+    double mean;
+    double stddev;
+
+    /**
+     * compute the statistics of the samples, NaN samples are phases that
+     * failed, and are skipped.
+     */
+    static PhaseStatistics compute(std::vector<double> samples);
+};
+
+/**
+ * The measured phases, all times are wall clock seconds, and all sizes
+ * are bytes.
+ *
+ * load:           SBMLSolver::load, always recompiling.
+ * sbmlProcessing: the part of load spent processing the sbml.
+ * codegen:        the part of load spent generating and jitting code.
+ * firstSimulate:  the first simulate after load.
+ * simulate:       a second simulate after reset, warm caches.
+ * steadyState:    steadyState after reset.
+ * rhsThroughput:  model rate function evaluations per second.
+ * controlCoefficients: the scaled concentration control coefficients at
+ *                 the steady state, dominated by the structural matrix
+ *                 products for large models.
+ * csvWrite:       writing the simulate result as csv.
+ * trajectoryWrite: writing it as a trajectory file, see TrajectoryWriter.
+ * trajectoryRead: reading all the columns of that file back.
+ * csvBytes:       the size of the csv file.
+ * trajectoryBytes: the size of the trajectory file.
+ */
+enum Phase
+{
+    LOAD = 0,
+    SBML_PROCESSING,
+    CODEGEN,
+    FIRST_SIMULATE,
+    SIMULATE,
+    STEADY_STATE,
+    RHS_THROUGHPUT,
+    CONTROL_COEFFICIENTS,
+    CSV_WRITE,
+    TRAJECTORY_WRITE,
+    TRAJECTORY_READ,
+    CSV_BYTES,
+    TRAJECTORY_BYTES,
+    PHASE_COUNT
+};
+
+const char* phaseName(int phase);
+
+/**
+ * is a larger value of the phase better.
+ */
+bool higherIsBetter(int phase);
+
+struct BenchmarkResult
+{
+    BenchmarkResult() : rssIncrease(0) {}
+
+    BenchmarkCase benchmarkCase;
+
+    /**
+     * empty if the model could be loaded and simulated, phases that
+     * fail on their own, such as models without a steady state, are
+     * reported as having no samples.
+     */
+    std::string error;
+
+    PhaseStatistics phases[PHASE_COUNT];
+
+    /**
+     * the largest increase in bytes of the resident set size of the
+     * process over its size before this case, sampled after each phase
+     * while the model is loaded. The process peak is a high-water mark
+     * of all the cases run so far, so it can not be used per case.
+     */
+    uint64_t rssIncrease;
+};
+
+struct BenchmarkOptions
+{
+    BenchmarkOptions() : repeats(5), warmup(1), stiff(false),
+            rhsSeconds(0.05) {}
+
+    unsigned repeats;
+    unsigned warmup;
+    bool stiff;
+
+    /**
+     * the name of the integrator, empty for the one the settings select.
+     * Runs with different integrators are compared by using the results
+     * of one as the baseline of the other.
+     */
+    std::string integrator;
+
+    /**
+     * how long the rate function is evaluated to measure its throughput.
+     */
+    double rhsSeconds;
+};
+
+/**
+ * find the benchmark cases in a directory, the sbml files directly in it,
+ * and the test suite style cases in its sub directories. A path to a
+ * file is a single case.
+ *
+ * @param root the cases are named relative to root.
+ */
+void findCases(const std::string& root, const std::string& path,
+        std::vector<BenchmarkCase>& cases);
+
+/**
+ * run the warm up and the timed repeats of a case.
+ */
+BenchmarkResult runCase(const BenchmarkCase& benchmarkCase,
+        const BenchmarkOptions& options);
+
+/**
+ * the peak resident set size of this process in bytes, 0 if unknown.
+ */
+uint64_t getPeakRSS();
+
+/**
+ * the current resident set size of this process in bytes, 0 if unknown.
+ */
+uint64_t getCurrentRSS();
+
+void writeResults(std::ostream& out, const BenchmarkOptions& options,
+        const std::vector<BenchmarkResult>& results);
+
+/**
+ * compare the medians of the results with a baseline written by
+ * writeResults, and report the phases that are worse by more than
+ * tolerance (relative), ignoring time differences below one millisecond.
+ *
+ * @returns the number of regressions.
+ */
+int compareWithBaseline(std::ostream& report, const JsonValue& baseline,
+        const std::vector<BenchmarkResult>& results, double tolerance);
+
+} /* namespace rrbench */
+
+#endif /* RR_BENCHMARK_H_ */
@@ -0,0 +1,271 @@
+#pragma hdrstop
+#include "Json.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+namespace rrbench
+{
+
+namespace
+{
+
+class Parser
+{
+public:
+    Parser(const std::string& text) : text(text), pos(0) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != text.size())
+        {
+            error("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    const std::string& text;
+    size_t pos;
+
+    void error(const std::string& msg)
+    {
+        std::stringstream ss;
+        ss << "JSON syntax error at offset " << pos << ": " << msg;
+        throw std::runtime_error(ss.str());
+    }
+
+    void skipSpace()
+    {
+        while (pos < text.size() && isspace((unsigned char)text[pos]))
+        {
+            ++pos;
+        }
+    }
+
+    char peek()
+    {
+        skipSpace();
+        if (pos >= text.size())
+        {
+            error("unexpected end of input");
+        }
+        return text[pos];
+    }
+
+    void expect(char c)
+    {
+        if (peek() != c)
+        {
+            error(std::string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    bool consume(const char* word)
+    {
+        size_t n = strlen(word);
+        if (text.compare(pos, n, word) == 0)
+        {
+            pos += n;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue()
+    {
+        JsonValue value;
+        char c = peek();
+
+        if (c == '{')
+        {
+            value.type = JsonValue::OBJECT;
+            ++pos;
+            if (peek() == '}')
+            {
+                ++pos;
+                return value;
+            }
+            for (;;)
+            {
+                std::string key = parseString();
+                expect(':');
+                value.object[key] = parseValue();
+                if (peek() == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                expect('}');
+                return value;
+            }
+        }
+        else if (c == '[')
+        {
+            value.type = JsonValue::ARRAY;
+            ++pos;
+            if (peek() == ']')
+            {
+                ++pos;
+                return value;
+            }
+            for (;;)
+            {
+                value.array.push_back(parseValue());
+                if (peek() == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                expect(']');
+                return value;
+            }
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue::STRING;
+            value.string = parseString();
+        }
+        else if (consume("true"))
+        {
+            value.type = JsonValue::BOOL;
+            value.boolean = true;
+        }
+        else if (consume("false"))
+        {
+            value.type = JsonValue::BOOL;
+        }
+        else if (consume("null"))
+        {
+        }
+        else
+        {
+            const char* start = text.c_str() + pos;
+            char* end = 0;
+            value.type = JsonValue::NUMBER;
+            value.number = strtod(start, &end);
+            if (end == start)
+            {
+                error("invalid value");
+            }
+            pos += end - start;
+        }
+        return value;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string result;
+        while (pos < text.size() && text[pos] != '"')
+        {
+            char c = text[pos++];
+            if (c == '\\' && pos < text.size())
+            {
+                c = text[pos++];
+                switch (c)
+                {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'u':
+                    // benchmark names are ascii, keep the escape as is
+                    result += "\\u";
+                    break;
+                default: result += c; break;
+                }
+            }
+            else
+            {
+                result += c;
+            }
+        }
+        expect('"');
+        return result;
+    }
+};
+
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const
+{
+    static const JsonValue null;
+    std::map<std::string, JsonValue>::const_iterator i = object.find(key);
+    return i != object.end() ? i->second : null;
+}
+
+double JsonValue::asNumber() const
+{
+    return type == NUMBER ? number : std::numeric_limits<double>::quiet_NaN();
+}
+
+JsonValue JsonValue::parse(const std::string& text)
+{
+    return Parser(text).parseDocument();
+}
+
+JsonValue JsonValue::parseFile(const std::string& fileName)
+{
+    std::ifstream in(fileName.c_str());
+    if (!in)
+    {
+        throw std::runtime_error("could not open " + fileName);
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return parse(ss.str());
+}
+
+void writeJsonString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    {
+        switch (*i)
+        {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        case '\r': out << "\\r"; break;
+        default:
+            if ((unsigned char)*i < 0x20)
+            {
+                char buf[8];
+                sprintf(buf, "\\u%04x", (unsigned char)*i);
+                out << buf;
+            }
+            else
+            {
+                out << *i;
+            }
+        }
+    }
+    out << '"';
+}
+
+void writeJsonNumber(std::ostream& out, double value)
+{
+    if (value != value || fabs(value) == std::numeric_limits<double>::infinity())
+    {
+        out << "null";
+    }
+    else
+    {
+        out << value;
+    }
+}
+
+} /* namespace rrbench */
@@ -0,0 +1,73 @@
+/*
+ * Json.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ * Just enough JSON to write benchmark results and read them back as a
+ * baseline, Poco is built without its JSON library.
+ */
+
+#ifndef RR_BENCHMARK_JSON_H_
+#define RR_BENCHMARK_JSON_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rrbench
+{
+
+class JsonValue
+{
+public:
+    enum Type
+    {
+        NULL_TYPE, BOOL, NUMBER, STRING, ARRAY, OBJECT
+    };
+
+    JsonValue() : type(NULL_TYPE), boolean(false), number(0) {}
+
+    Type type;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    /**
+     * the member with the given key, or a null value if this is not an
+     * object or has no such member.
+     */
+    const JsonValue& operator[](const std::string& key) const;
+
+    bool isNull() const { return type == NULL_TYPE; }
+
+    /**
+     * the number, or NaN if this is not a number.
+     */
+    double asNumber() const;
+
+    /**
+     * parse a JSON document.
+     *
+     * @throws std::runtime_error with the offset of a syntax error.
+     */
+    static JsonValue parse(const std::string& text);
+
+    static JsonValue parseFile(const std::string& fileName);
+};
+
+/**
+ * write a quoted, escaped JSON string.
+ */
+void writeJsonString(std::ostream& out, const std::string& str);
+
+/**
+ * write a number, non finite numbers are written as null.
+ */
+void writeJsonNumber(std::ostream& out, double value);
+
+} /* namespace rrbench */
+
+#endif /* RR_BENCHMARK_JSON_H_ */
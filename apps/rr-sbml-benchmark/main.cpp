@@ -1,16 +1,28 @@
-// Roadrunner sbml test program which takes the same argument format as
-// COPASIs and does the same thing.
+// Roadrunner sbml benchmark program.
 //
-// basically all this program does is read the config from the sbml test
-// suite and dump out a csv of the results, nothing more.
-// the actuall RoadRunner sbml test suite does much more as it
-// also generates a formated report and compares results to
-// the sbml test suite.
+// Runs every model in the given directories (by default data/sosbench,
+// models and testing under the data root) a number of times, and reports
+// the load, sbml processing, code generation, first simulate, simulate and
+// steady state times, the model rate function throughput, the time and
+// size of writing the simulation result as csv and as a trajectory file,
+// the peak resident set size of the process and how much each case grew it
+// as JSON. The results can be compared against a stored baseline, the exit
+// status is then 2 if any phase regressed.
+//
+// When called with the same arguments as COPASIs sbml test suite program,
+// runs that one test case and dumps a csv of the results, like it always
+// did:
+//
+// ./rr-sbml-benchmark ~/src/sbml_test/cases/semantic 00221 ~/tmp/copasi 2 4
 
 // Copyright (C) 2013 Andy Somogyi
 // Indiana University, University of Washington
 
 #include "SBMLSolver.h"
+#include "Benchmark.h"
+#include "Json.h"
+#include "rrGetOptions.h"
+#include "rrLogger.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -18,16 +30,15 @@
 #include <sstream>
 #include <set>
 #include <stdlib.h>
+#include <ctype.h>
 #include <SBMLSolverOptions.h>
 
 using namespace rr;
 using namespace std;
 using ls::DoubleMatrix;
+using namespace rrbench;
 
-// copasi test suite called like
-// ./sbml-testsuite ~/src/sbml_test/cases/semantic 00221 ~/tmp/copasi 2 4
-
-int main(int argc, char** argv)
+static int runTestCase(int argc, char** argv)
 {
     std::string in_dir;
     std::string out_dir;
@@ -43,12 +54,6 @@ int main(int argc, char** argv)
     double relative_error = 0.0;
 
 
-    if (argc < 6)
-    {
-        std::cerr << "Usage: rr-sbml-benchmrk INPUT_DIRECTORY TESTNAME OUTPUTDIRECTORY SBMLLEVEL SBMLVERSION [steps override] [durration] [compiler] [-stiff]" << std::endl;
-        exit(1);
-    }
-
     in_dir = argv[1];
     test_name = argv[2];
     out_dir = argv[3];
@@ -136,6 +141,12 @@ int main(int argc, char** argv)
         if (string(argv[i]).find("stiff") != string::npos) {
             settings.integratorFlags |= Integrator::STIFF;
         }
+        if (string(argv[i]).find("rosenbrock") != string::npos) {
+            settings.integrator = Integrator::ROSENBROCK;
+        }
+        if (string(argv[i]).find("dopri5") != string::npos) {
+            settings.integrator = Integrator::DOPRI5;
+        }
     }
 
     std::cout << "running for " << settings.steps << ", duration " << settings.duration << std::endl;
@@ -177,3 +188,140 @@ int main(int argc, char** argv)
 
     return 0;
 }
+
+static void usage(const char* prg)
+{
+    cerr << "Usage: " << prg << " [options] [directory or sbml file ...]\n"
+         << "   or: " << prg << " INPUT_DIRECTORY TESTNAME OUTPUTDIRECTORY SBMLLEVEL SBMLVERSION [steps override] [durration] [compiler] [-stiff] [-rosenbrock] [-dopri5]\n\n"
+         << "  -d<path>     data root, cases are named relative to it, the default\n"
+         << "               cases are data/sosbench, models and testing. Default: .\n"
+         << "  -r<n>        timed repeats per case. Default: 5\n"
+         << "  -w<n>        untimed warm up runs per case. Default: 1\n"
+         << "  -o<file>     write the JSON results to file. Default: stdout\n"
+         << "  -b<file>     compare with the baseline JSON results in file\n"
+         << "  -t<fraction> relative tolerance for regressions. Default: 0.1\n"
+         << "  -s           use the stiff integrator\n"
+         << "  -i<name>     the integrator, e.g. cvode or rosenbrock. Default: the\n"
+         << "               one the case settings select\n"
+         << "  -v<level>    log level, e.g. notice, information, debug\n";
+}
+
+/**
+ * the COPASI style call, INPUT_DIRECTORY TESTNAME OUTPUTDIRECTORY LEVEL VERSION
+ */
+static bool isTestCaseCall(int argc, char** argv)
+{
+    return argc >= 6 && argv[1][0] != '-' && isdigit(argv[4][0])
+            && isdigit(argv[5][0]);
+}
+
+int main(int argc, char** argv)
+{
+    if (isTestCaseCall(argc, argv))
+    {
+        return runTestCase(argc, argv);
+    }
+
+    BenchmarkOptions options;
+    string root = ".";
+    string outputFile;
+    string baselineFile;
+    double tolerance = 0.1;
+
+    int c;
+    while ((c = GetOptions(argc, argv, "d:r:w:o:b:t:si:v:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'd': root = rrOptArg; break;
+        case 'r': options.repeats = strtol(rrOptArg, NULL, 10); break;
+        case 'w': options.warmup = strtol(rrOptArg, NULL, 10); break;
+        case 'o': outputFile = rrOptArg; break;
+        case 'b': baselineFile = rrOptArg; break;
+        case 't': tolerance = atof(rrOptArg); break;
+        case 's': options.stiff = true; break;
+        case 'i': options.integrator = rrOptArg; break;
+        case 'v': Logger::setLevel(Logger::stringToLevel(rrOptArg)); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.repeats < 1)
+    {
+        cerr << "at least one repeat is required" << endl;
+        return 1;
+    }
+
+    try
+    {
+        vector<BenchmarkCase> cases;
+
+        if (rrOptInd < argc)
+        {
+            for (int i = rrOptInd; i < argc; ++i)
+            {
+                findCases(root, argv[i], cases);
+            }
+        }
+        else
+        {
+            findCases(root, root + "/data/sosbench", cases);
+            findCases(root, root + "/models", cases);
+            findCases(root, root + "/testing", cases);
+        }
+
+        // read the baseline first, don't find out it is broken after
+        // the whole run.
+        JsonValue baseline;
+        if (!baselineFile.empty())
+        {
+            baseline = JsonValue::parseFile(baselineFile);
+        }
+
+        vector<BenchmarkResult> results;
+
+        for (unsigned i = 0; i < cases.size(); ++i)
+        {
+            cerr << "[" << i + 1 << "/" << cases.size() << "] "
+                    << cases[i].name << endl;
+
+            results.push_back(runCase(cases[i], options));
+
+            if (!results.back().error.empty())
+            {
+                cerr << "    failed: " << results.back().error << endl;
+            }
+        }
+
+        if (outputFile.empty())
+        {
+            writeResults(cout, options, results);
+        }
+        else
+        {
+            ofstream out(outputFile.c_str());
+            if (!out)
+            {
+                cerr << "could not open " << outputFile << endl;
+                return 1;
+            }
+            writeResults(out, options, results);
+        }
+
+        if (!baselineFile.empty())
+        {
+            int regressions = compareWithBaseline(cerr, baseline, results, tolerance);
+            cerr << regressions << " regressions compared to " << baselineFile << endl;
+            return regressions ? 2 : 0;
+        }
+    }
+    catch (std::exception& e)
+    {
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -34,7 +34,7 @@ string Usage(const string& prg)
     usage<<setfill('.');
     usage<<setw(25)<<"-v<debug level>"              <<" Debug levels: Error, Warning, Info, Debug. Default: Info\n";
     usage<<setw(25)<<"-m<FileName>"                 <<" SBML Model File Name (with path)\n";
-    usage<<setw(25)<<"-o<FileName>"                 <<" FileName for data output \n";
+    usage<<setw(25)<<"-o<FileName>"                 <<" FileName for data output. A .rrt file is written in the compressed binary trajectory format\n";
     usage<<setw(25)<<"-d<FilePath>"                 <<" Data output directory. If not given, data is output to current directory (implies -f is given)\n";
     usage<<setw(25)<<"-t<FilePath>"                 <<" Temporary data output directory. If not given, temp files are output to current directory\n";
     usage<<setw(25)<<"-p"                           <<" Pause before exiting.\n";
@@ -6,6 +6,7 @@
 #include "Args.h"
 #include "Integrator.h"
 #include "rrVersionInfo.h"
+#include "TrajectoryFile.h"
 
 #include <iostream>
 #include <fstream>
@@ -86,16 +87,33 @@ int main(int argc, char * argv[])
         	opt.integratorFlags |= Integrator::VARIABLE_STEP;
         }
 
-        ls::DoubleMatrix res = *rr.simulate();
-
-        if(args.OutputFileName.size() >  0)
+        if(toLower(getFileExtension(args.OutputFileName)) == "rrt")
         {
-        	ofstream os(args.OutputFileName.c_str());
-        	os << res;
+            // stream the rows into a compressed trajectory file
+            vector<string> columns;
+            const vector<SelectionRecord>& selections = rr.getSelections();
+            for(int i = 0; i < selections.size(); ++i)
+            {
+                columns.push_back(selections[i].to_string());
+            }
+
+            TrajectoryWriter out(args.OutputFileName, columns);
+            rr.simulate(0, &out);
+            out.close();
         }
         else
         {
-        	cout << res;
+            ls::DoubleMatrix res = *rr.simulate();
+
+            if(args.OutputFileName.size() >  0)
+            {
+            	ofstream os(args.OutputFileName.c_str());
+            	os << res;
+            }
+            else
+            {
+            	cout << res;
+            }
         }
     }
     catch(std::exception& ex)
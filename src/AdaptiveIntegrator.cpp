@@ -0,0 +1,632 @@
+/*
+ * AdaptiveIntegrator.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "AdaptiveIntegrator.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <math.h>
+
+using namespace std;
+
+namespace rr
+{
+
+static const int defaultMaxNumSteps = 10000;
+
+AdaptiveIntegrator::AdaptiveIntegrator(ExecutableModel *m,
+        const SimulateOptions *o) :
+        model(m),
+        stateVectorSize(0),
+        n(0),
+        told(0),
+        hold(0),
+        t(0),
+        rhsEvals(0),
+        numEvents(0),
+        h(0),
+        eventRoot(false),
+        pendingEvent(false),
+        steps(0),
+        errTestFails(0),
+        rootEvals(0)
+{
+    if (o)
+    {
+        opt = *o;
+    }
+
+    if (!model)
+    {
+        return;
+    }
+
+    stateVectorSize = model->getStateVector(NULL);
+    numEvents = model->getNumEvents();
+
+    // like cvode, models with only events get a place holder variable so
+    // the step size control and the root finding work.
+    n = stateVectorSize > 0 ? stateVectorSize : (numEvents > 0 ? 1 : 0);
+
+    y.resize(n);
+    yold.resize(n);
+    ynew.resize(n);
+    ytmp.resize(n);
+    f0.resize(n);
+
+    gold.resize(numEvents);
+    gnew.resize(numEvents);
+    gtmp.resize(numEvents);
+    eventStatus.resize(model->getEventTriggers(0, 0, 0));
+
+    if (stateVectorSize > 0)
+    {
+        model->getStateVector(&y[0]);
+    }
+    t = told = model->getTime();
+}
+
+AdaptiveIntegrator::~AdaptiveIntegrator()
+{
+}
+
+void AdaptiveIntegrator::setSimulateOptions(const SimulateOptions* options)
+{
+    if (options)
+    {
+        opt = *options;
+    }
+}
+
+void AdaptiveIntegrator::evalRate(double time, const double* state,
+        double* dydt)
+{
+    ++rhsEvals;
+    model->getStateVectorRate(time, state, dydt);
+
+    if (stateVectorSize == 0)
+    {
+        dydt[0] = 0;
+    }
+}
+
+double AdaptiveIntegrator::errorNorm(const double* error)
+{
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        double scale = opt.absolute + opt.relative
+                * max(fabs(y[i]), fabs(ynew[i]));
+        double e = error[i] / scale;
+        sum += e * e;
+    }
+
+    double norm = sqrt(sum / n);
+
+    // nan compares false, reject it as a failed step
+    return norm == norm ? norm : std::numeric_limits<double>::infinity();
+}
+
+void AdaptiveIntegrator::assignResultsToModel(double time,
+        const double* state)
+{
+    model->setTime(time);
+    if (stateVectorSize > 0)
+    {
+        model->setStateVector(state);
+    }
+}
+
+void AdaptiveIntegrator::interpolate(double time, double* result)
+{
+    if (hold == 0)
+    {
+        std::copy(y.begin(), y.end(), result);
+        return;
+    }
+
+    denseOutput((time - told) / hold, result);
+}
+
+double AdaptiveIntegrator::initialStepSize(double tout)
+{
+    if (opt.initialTimeStep > 0)
+    {
+        return opt.initialTimeStep;
+    }
+
+    double ynorm = 0, fnorm = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        double scale = opt.absolute + opt.relative * fabs(y[i]);
+        ynorm += (y[i] / scale) * (y[i] / scale);
+        fnorm += (f0[i] / scale) * (f0[i] / scale);
+    }
+    ynorm = sqrt(ynorm / n);
+    fnorm = sqrt(fnorm / n);
+
+    double h0 = (ynorm < 1.e-5 || fnorm < 1.e-5) ? 1.e-6 : 0.01 * ynorm / fnorm;
+
+    if (tout > t)
+    {
+        h0 = min(h0, tout - t);
+    }
+
+    return h0;
+}
+
+bool AdaptiveIntegrator::locateEventRoot()
+{
+    static const double eps = std::numeric_limits<double>::epsilon();
+
+    if (numEvents == 0)
+    {
+        return false;
+    }
+
+    ++rootEvals;
+    model->getEventRoots(t, &y[0], &gnew[0]);
+
+    bool changed = false;
+    for (int i = 0; i < numEvents && !changed; ++i)
+    {
+        changed = (gold[i] > 0) != (gnew[i] > 0);
+    }
+
+    if (!changed)
+    {
+        return false;
+    }
+
+    // the roots are only the signs of the triggers, so bisect, and end
+    // the step just after the earliest one, so the trigger has changed.
+    double tlo = told;
+    double thi = t;
+    const double ttol = 100. * eps * (fabs(t) + fabs(hold));
+
+    while (thi - tlo > ttol)
+    {
+        double tmid = 0.5 * (tlo + thi);
+
+        interpolate(tmid, &ytmp[0]);
+
+        ++rootEvals;
+        model->getEventRoots(tmid, &ytmp[0], &gtmp[0]);
+
+        changed = false;
+        for (int i = 0; i < numEvents && !changed; ++i)
+        {
+            changed = (gold[i] > 0) != (gtmp[i] > 0);
+        }
+
+        if (changed)
+        {
+            thi = tmid;
+        }
+        else
+        {
+            tlo = tmid;
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "Event detected at time " << thi;
+
+    if (thi < t)
+    {
+        // a pending event at the end of the step comes after the root
+        pendingEvent = false;
+    }
+
+    interpolate(thi, &y[0]);
+    t = thi;
+
+    return true;
+}
+
+void AdaptiveIntegrator::applyEvents()
+{
+    assignResultsToModel(t, &y[0]);
+
+    if (eventRoot)
+    {
+        model->applyEvents(t, &eventStatus[0], &y[0], &y[0]);
+    }
+    else
+    {
+        model->getEventTriggers(eventStatus.size(), 0, &eventStatus[0]);
+        model->applyEvents(t, &eventStatus[0], NULL, NULL);
+    }
+
+    model->setTime(t);
+    if (stateVectorSize > 0)
+    {
+        model->getStateVector(&y[0]);
+    }
+
+    eventRoot = false;
+    pendingEvent = false;
+
+    // the state jumped, start over with a new step size
+    told = t;
+    hold = 0;
+    h = 0;
+    resetHistory();
+
+    if (listener)
+    {
+        listener->onEvent(this, model, t);
+    }
+}
+
+double AdaptiveIntegrator::integrate(double t0, double hstep)
+{
+    static const double epsilon = std::numeric_limits<double>::epsilon();
+
+    if (!model)
+    {
+        return -1;
+    }
+
+    Log(Logger::LOG_DEBUG) << getName() << " integrate("
+            << t0 << ", " << hstep << ")";
+
+    const double tout = t0 + hstep;
+    const bool variableStep = opt.integratorFlags & VARIABLE_STEP;
+    const bool multiStep = opt.integratorFlags & MULTI_STEP;
+
+    if (n == 0)
+    {
+        model->getStateVectorRate(tout, 0, 0);
+        return tout;
+    }
+
+    const int maxSteps = opt.maximumNumSteps > 0 ? opt.maximumNumSteps
+            : defaultMaxNumSteps;
+    int stepCount = 0;
+
+    while (true)
+    {
+        // the event which ends the current step is applied once the
+        // output reaches it
+        if ((eventRoot || pendingEvent) && t <= tout)
+        {
+            applyEvents();
+
+            if (variableStep)
+            {
+                return t;
+            }
+            continue;
+        }
+
+        if (!variableStep && tout <= t)
+        {
+            if (tout < t)
+            {
+                interpolate(tout, &ytmp[0]);
+                assignResultsToModel(tout, &ytmp[0]);
+            }
+            else
+            {
+                assignResultsToModel(t, &y[0]);
+            }
+
+            try
+            {
+                model->testConstraints();
+            }
+            catch (const std::exception& e)
+            {
+                Log(Logger::LOG_WARNING) << "Constraint Violated at time = "
+                        << tout << ": " << e.what();
+            }
+
+            if (listener && !multiStep)
+            {
+                listener->onTimeStep(this, model, tout);
+            }
+
+            return tout;
+        }
+
+        if (++stepCount > maxSteps)
+        {
+            std::stringstream ss;
+            ss << getName() << " integrator exceeded the maximum number of "
+                    << maxSteps << " steps at time " << t;
+            throw IntegratorException(ss.str(), __FUNC__);
+        }
+
+        // steps may not pass the time of a delayed event
+        double limit = std::numeric_limits<double>::infinity();
+        if (model->getPendingEventSize() > 0)
+        {
+            limit = model->getNextPendingEventTime(false);
+            if (limit <= t)
+            {
+                pendingEvent = true;
+                continue;
+            }
+        }
+
+        assignResultsToModel(t, &y[0]);
+
+        if (numEvents > 0)
+        {
+            model->getEventTriggers(eventStatus.size(), 0, &eventStatus[0]);
+            ++rootEvals;
+            model->getEventRoots(t, &y[0], &gold[0]);
+        }
+
+        beginStep();
+
+        if (h <= 0)
+        {
+            h = initialStepSize(tout);
+        }
+
+        bool rejected = false;
+        bool last = false;
+
+        while (true)
+        {
+            if (opt.maximumTimeStep > 0)
+            {
+                h = min(h, opt.maximumTimeStep);
+            }
+
+            // stretch the step a little rather than leave a tiny one
+            last = t + 1.01 * h >= limit;
+            if (last)
+            {
+                h = limit - t;
+            }
+
+            if (!last && (h < 10. * epsilon * max(fabs(t), fabs(hstep))
+                    || (opt.minimumTimeStep > 0 && h < opt.minimumTimeStep)))
+            {
+                std::stringstream ss;
+                ss << getName() << " integrator step size " << h
+                        << " is too small at time " << t;
+                throw IntegratorException(ss.str(), __FUNC__);
+            }
+
+            double e = attemptStep(h);
+
+            if (e <= 1.)
+            {
+                double hnew = h / stepSizeFactor(h, e, true);
+                if (rejected)
+                {
+                    hnew = min(hnew, h);
+                }
+
+                told = t;
+                hold = h;
+                yold = y;
+                y = ynew;
+                t = last ? limit : t + h;
+
+                h = hnew;
+                acceptStep();
+                break;
+            }
+
+            ++errTestFails;
+            rejected = true;
+
+            Log(Logger::LOG_TRACE) << getName() << " step rejected at time "
+                    << t << ", step size " << h << ", error " << e;
+
+            if (e == std::numeric_limits<double>::infinity())
+            {
+                h *= 0.25;
+            }
+            else
+            {
+                h /= stepSizeFactor(h, e, false);
+            }
+        }
+
+        ++steps;
+
+        pendingEvent = last;
+        eventRoot = locateEventRoot();
+
+        if (variableStep)
+        {
+            assignResultsToModel(t, &y[0]);
+
+            if (eventRoot)
+            {
+                model->setTime(t - epsilon);
+            }
+
+            if (listener)
+            {
+                listener->onTimeStep(this, model, t);
+            }
+
+            return eventRoot ? t - epsilon : t;
+        }
+
+        if (listener && multiStep)
+        {
+            assignResultsToModel(t, &y[0]);
+            listener->onTimeStep(this, model, t);
+        }
+    }
+}
+
+void AdaptiveIntegrator::restart(double t0)
+{
+    if (!model)
+    {
+        return;
+    }
+
+    // apply any events that trigger before or at time 0, the same as
+    // cvode does.
+    if (t0 <= 0.0 && numEvents > 0)
+    {
+        if (stateVectorSize > 0)
+        {
+            model->getStateVector(&y[0]);
+        }
+
+        std::vector<unsigned char> initialEventStatus(eventStatus.size(), false);
+        model->getEventTriggers(initialEventStatus.size(), 0,
+                &initialEventStatus[0]);
+        model->applyEvents(0, &initialEventStatus[0], &y[0], &y[0]);
+    }
+
+    model->setTime(t0);
+
+    if (stateVectorSize > 0)
+    {
+        model->getStateVector(&y[0]);
+    }
+
+    t = told = t0;
+    hold = 0;
+    h = 0;
+    eventRoot = false;
+    pendingEvent = false;
+    resetHistory();
+}
+
+void AdaptiveIntegrator::setListener(IntegratorListenerPtr p)
+{
+    listener = p;
+}
+
+IntegratorListenerPtr AdaptiveIntegrator::getListener()
+{
+    return listener;
+}
+
+std::string AdaptiveIntegrator::toString() const
+{
+    return toRepr();
+}
+
+void AdaptiveIntegrator::getStatistics(BasicDictionary& dict) const
+{
+    dict.setItem("NumSteps", steps);
+    dict.setItem("NumRhsEvals", rhsEvals);
+    dict.setItem("NumErrTestFails", errTestFails);
+    dict.setItem("NumRootEvals", rootEvals);
+}
+
+void AdaptiveIntegrator::resetStatistics()
+{
+    steps = rhsEvals = errTestFails = rootEvals = 0;
+}
+
+static bool isStatisticsKey(const std::string& key)
+{
+    return key == "NumSteps" || key == "NumRhsEvals"
+            || key == "NumErrTestFails" || key == "NumRootEvals";
+}
+
+void AdaptiveIntegrator::setItem(const std::string& key,
+        const rr::Variant& value)
+{
+    if (key == "absolute")
+    {
+        opt.absolute = value.convert<double>();
+    }
+    else if (key == "relative")
+    {
+        opt.relative = value.convert<double>();
+    }
+    else if (key == "initialTimeStep")
+    {
+        opt.initialTimeStep = value.convert<double>();
+    }
+    else if (key == "minimumTimeStep")
+    {
+        opt.minimumTimeStep = value.convert<double>();
+    }
+    else if (key == "maximumTimeStep")
+    {
+        opt.maximumTimeStep = value.convert<double>();
+    }
+    else if (key == "maximumNumSteps")
+    {
+        opt.maximumNumSteps = value.convert<int>();
+    }
+    else
+    {
+        throw std::invalid_argument("invalid key: " + key);
+    }
+}
+
+Variant AdaptiveIntegrator::getItem(const std::string& key) const
+{
+    if (key == "absolute")
+    {
+        return opt.absolute;
+    }
+    else if (key == "relative")
+    {
+        return opt.relative;
+    }
+    else if (key == "initialTimeStep")
+    {
+        return opt.initialTimeStep;
+    }
+    else if (key == "minimumTimeStep")
+    {
+        return opt.minimumTimeStep;
+    }
+    else if (key == "maximumTimeStep")
+    {
+        return opt.maximumTimeStep;
+    }
+    else if (key == "maximumNumSteps")
+    {
+        return opt.maximumNumSteps;
+    }
+    else if (isStatisticsKey(key))
+    {
+        // read only performance counters
+        BasicDictionary stats;
+        getStatistics(stats);
+        return stats.getItem(key);
+    }
+    throw std::invalid_argument("invalid key: " + key);
+}
+
+bool AdaptiveIntegrator::hasKey(const std::string& key) const
+{
+    return key == "absolute" || key == "relative"
+            || key == "initialTimeStep" || key == "minimumTimeStep"
+            || key == "maximumTimeStep" || key == "maximumNumSteps"
+            || isStatisticsKey(key);
+}
+
+int AdaptiveIntegrator::deleteItem(const std::string& key)
+{
+    return -1;
+}
+
+std::vector<std::string> AdaptiveIntegrator::getKeys() const
+{
+    std::vector<std::string> keys;
+    keys.push_back("absolute");
+    keys.push_back("relative");
+    keys.push_back("initialTimeStep");
+    keys.push_back("minimumTimeStep");
+    keys.push_back("maximumTimeStep");
+    keys.push_back("maximumNumSteps");
+    return keys;
+}
+
+} /* namespace rr */
@@ -0,0 +1,248 @@
+/*
+ * AdaptiveIntegrator.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_ADAPTIVEINTEGRATOR_H_
+#define RR_ADAPTIVEINTEGRATOR_H_
+
+#include "Integrator.h"
+#include "SBMLSolverOptions.h"
+
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+/**
+ * Base class of the adaptive one step integrators with a dense output,
+ * which only differ in how a step is taken and interpolated.
+ *
+ * The integrator steps past the requested output time and interpolates the
+ * output with the dense output, the same as CVODE does, so the step size is
+ * not limited by the output grid. Events are located by bisection of the
+ * event roots (ExecutableModel::getEventRoots) on the dense output, and
+ * steps never pass the time of a pending delayed event.
+ *
+ * The absolute, relative, initialTimeStep, minimumTimeStep,
+ * maximumTimeStep and maximumNumSteps simulate options, and the
+ * VARIABLE_STEP and MULTI_STEP flags are supported.
+ */
+class AdaptiveIntegrator: public Integrator
+{
+public:
+
+    /**
+     * @param m: a borrowed reference to an existing ExecutableModel object.
+     * @param o: a reference to a SimulatOptions object where the configuration
+     * parameters will be read from.
+     */
+    AdaptiveIntegrator(ExecutableModel *m, const SimulateOptions *o);
+
+    virtual ~AdaptiveIntegrator();
+
+    /**
+     * implement Integrator interface
+     */
+public:
+
+    /**
+     * Set the configuration parameters the integrator uses.
+     */
+    virtual void setSimulateOptions(const SimulateOptions* options);
+
+    /**
+     * integrates the model from t0 to t0 + hstep, or by a single internal
+     * step if the VARIABLE_STEP flag is set.
+     */
+    virtual double integrate(double t0, double hstep);
+
+    /**
+     * copies the state vector out of the model, and discards the step size
+     * history.
+     */
+    virtual void restart(double t0);
+
+    /**
+     * the integrator can hold a single listener. If clients require multicast,
+     * they can create a multi-cast listener.
+     */
+    virtual void setListener(IntegratorListenerPtr);
+
+    /**
+     * get the integrator listener
+     */
+    virtual IntegratorListenerPtr getListener();
+
+    /**
+     * get a description of this object, compatable with python __str__
+     */
+    virtual std::string toString() const;
+
+    /**
+     * adds the read only items NumSteps, NumRhsEvals, NumErrTestFails and
+     * NumRootEvals.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    virtual void resetStatistics();
+
+    /**
+     * Implement Dictionary Interface, the tolerances and step limits are
+     * the keys of the simulate options of the same name, absolute,
+     * relative, initialTimeStep, minimumTimeStep, maximumTimeStep and
+     * maximumNumSteps, and are replaced by the next setSimulateOptions.
+     * The statistics are read only keys.
+     */
+public:
+
+    virtual void setItem(const std::string& key, const rr::Variant& value);
+
+    virtual Variant getItem(const std::string& key) const;
+
+    virtual bool hasKey(const std::string& key) const;
+
+    virtual int deleteItem(const std::string& key);
+
+    virtual std::vector<std::string> getKeys() const;
+
+protected:
+
+    /**
+     * prepare a step from (t, y), called once before the attempts at a
+     * step. f0 must hold the rates at (t, y) when it returns.
+     */
+    virtual void beginStep() = 0;
+
+    /**
+     * attempt a step of size h from (t, y), write the new state to ynew
+     * and return the scaled error norm, infinity if the step failed.
+     */
+    virtual double attemptStep(double h) = 0;
+
+    /**
+     * the factor the step size is divided by after an attempted step of
+     * size h with the error norm err, greater than 1 if accepted is false.
+     */
+    virtual double stepSizeFactor(double h, double err, bool accepted) = 0;
+
+    /**
+     * called after a step is accepted, yold holds the state at told and
+     * ynew and y the state at told + hold.
+     */
+    virtual void acceptStep() = 0;
+
+    /**
+     * the dense output of the last accepted step at told + s * hold.
+     */
+    virtual void denseOutput(double s, double* result) = 0;
+
+    /**
+     * the state changed discontinuously, at a restart or an event, and
+     * anything that is carried from step to step must be discarded.
+     */
+    virtual void resetHistory() = 0;
+
+    /**
+     * the rate function, zero for the place holder variable of models
+     * without variables.
+     */
+    void evalRate(double t, const double* y, double* dydt);
+
+    /**
+     * the root mean square norm of an error vector, relative to the
+     * tolerances at the start and the end of a step.
+     */
+    double errorNorm(const double* error);
+
+    ExecutableModel *model;
+
+    SimulateOptions opt;
+
+    /**
+     * the number of model state variables, the integrator state is one
+     * longer if the model has no variables but has events.
+     */
+    int stateVectorSize;
+    int n;
+
+    /**
+     * the current step, from told to t, the dense output is defined on
+     * [told, told + hold].
+     */
+    double told;
+    double hold;
+    double t;
+
+    std::vector<double> y;
+    std::vector<double> yold;
+    std::vector<double> ynew;
+    std::vector<double> f0;
+
+    int64_t rhsEvals;
+
+private:
+
+    /**
+     * the dense output of the last step at time t.
+     */
+    void interpolate(double t, double* result);
+
+    /**
+     * the initial step size.
+     */
+    double initialStepSize(double tout);
+
+    /**
+     * find the earliest event root in the last step, returns true if there
+     * is one, and truncates the step to it.
+     */
+    bool locateEventRoot();
+
+    /**
+     * apply the event that ends the current step, either a root or a
+     * pending delayed event, and restart the step size history.
+     */
+    void applyEvents();
+
+    /**
+     * copy a state into the model.
+     */
+    void assignResultsToModel(double t, const double* state);
+
+    IntegratorListenerPtr listener;
+
+    int numEvents;
+
+    /**
+     * the next step size.
+     */
+    double h;
+
+    /**
+     * set if the step ended at an event root, or at the time of a pending
+     * event, which is applied before stepping on.
+     */
+    bool eventRoot;
+    bool pendingEvent;
+
+    std::vector<double> ytmp;
+
+    /**
+     * event roots and triggers at the start and at the end of the step.
+     */
+    std::vector<double> gold;
+    std::vector<double> gnew;
+    std::vector<double> gtmp;
+    std::vector<unsigned char> eventStatus;
+
+    int64_t steps;
+    int64_t errTestFails;
+    int64_t rootEvals;
+};
+
+} /* namespace rr */
+
+#endif /* RR_ADAPTIVEINTEGRATOR_H_ */
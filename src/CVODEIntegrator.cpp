@@ -6,6 +6,7 @@
 #include "rrStringUtils.h"
 #include "rrException.h"
 #include "rrUtils.h"
+#include "Tracer.h"
 
 #include <cvode/cvode.h>
 #include <cvode/cvode_dense.h>
@@ -44,6 +45,30 @@ const int CVODEIntegrator::mDefaultMaxNumSteps = 10000;
 const int CVODEIntegrator::mDefaultMaxAdamsOrder = 12;
 const int CVODEIntegrator::mDefaultMaxBDFOrder = 5;
 
+/**
+ * the number of steps between stiffness checks, each check costs a few
+ * rate evaluations.
+ */
+static const int stiffnessCheckInterval = 20;
+
+/**
+ * the size of the stability regions of the Adams methods of order 1 to 12
+ * in h times the spectral radius of the Jacobian, as in LSODA.
+ */
+static const double adamsStability[] = {0.5, 0.575, 0.55, 0.45, 0.35, 0.25,
+        0.2, 0.15, 0.1, 0.075, 0.05, 0.025};
+
+/**
+ * the Adams steps are limited by stability rather than accuracy if they
+ * are this close to the stability region, and BDF steps with h times the
+ * spectral radius below the non stiff limit are stable with any Adams
+ * order used in practice. The gap between them keeps the integrator from
+ * switching back and forth.
+ */
+static const double stiffStabilityFraction = 0.7;
+static const double stiffStabilityMin = 0.1;
+static const double nonStiffStabilityLimit = 0.05;
+
 /**
  * Purpose
  * This function processes error and warning messages from CVODE and its
@@ -93,10 +118,16 @@ IntegratorListenerPtr CVODEIntegrator::getListener()
 CVODEIntegrator::CVODEIntegrator(ExecutableModel *aModel, const SimulateOptions* options)
 :
 mStateVector(NULL),
+mSampleVector(NULL),
 mCVODE_Memory(NULL),
 lastEventTime(0),
 mMaxAdamsOrder(mDefaultMaxAdamsOrder),
 mMaxBDFOrder(mDefaultMaxBDFOrder),
+stiffMethod(options->integratorFlags & STIFF),
+stiffnessDetection(false),
+denseOutputSampling(false),
+stiffnessCheckSteps(0),
+stiffnessCheckConvFails(0),
 mModel(aModel),
 stateVectorVariables(false),
 variableStepPendingEvent(false),
@@ -134,6 +165,7 @@ void CVODEIntegrator::setSimulateOptions(const SimulateOptions* o)
         // requires re-creating the CVode objects.
         Log(Logger::LOG_INFORMATION) << "re-creating CVode, interator stiffness has changed";
         options = *o;
+        stiffMethod = options.integratorFlags & STIFF;
         freeCVode();
         createCVode();
     }
@@ -184,6 +216,8 @@ void CVODEIntegrator::reInit(double t0)
         return;
     }
 
+    mStatistics += getCVODEStatistics();
+
     int result = CVodeReInit(mCVODE_Memory,  t0, mStateVector);
 
     if (result != CV_SUCCESS)
@@ -196,6 +230,8 @@ void CVODEIntegrator::reInit(double t0)
 
 double CVODEIntegrator::integrate(double timeStart, double hstep)
 {
+    RR_TRACE_SCOPE("CVODEIntegrator::integrate", "integrate");
+
     static const double epsilon = std::numeric_limits<double>::epsilon();
 
     Log(Logger::LOG_DEBUG) << "CVODEIntegrator::integrate("
@@ -209,10 +245,22 @@ double CVODEIntegrator::integrate(double timeStart, double hstep)
     double tout = timeStart + hstep;
     int strikes = 3;
 
-    const int itask = ((options.integratorFlags & MULTI_STEP)
+    int itask = ((options.integratorFlags & MULTI_STEP)
             || (options.integratorFlags & VARIABLE_STEP))
             ? CV_ONE_STEP : CV_NORMAL;
 
+    // with stiffness detection, single steps are taken up to the output
+    // time so the method can be switched between them.
+    const bool singleSteps = stiffnessDetection && itask == CV_NORMAL;
+    const int maxSteps = options.maximumNumSteps > 0
+            ? options.maximumNumSteps : mDefaultMaxNumSteps;
+    int steps = 0;
+
+    if (singleSteps)
+    {
+        itask = CV_ONE_STEP;
+    }
+
     // loop until machine epislon
     while (tout - timeEnd >= epsilon)
     {
@@ -235,9 +283,31 @@ double CVODEIntegrator::integrate(double timeStart, double hstep)
         // event status before time step
         mModel->getEventTriggers(eventStatus.size(), 0, &eventStatus[0]);
 
+        if (singleSteps)
+        {
+            CVodeSetStopTime(mCVODE_Memory, nextTargetEndTime);
+        }
+
         // time step
         int nResult = CVode(mCVODE_Memory, nextTargetEndTime,  mStateVector, &timeEnd, itask);
 
+        if (nResult == CV_SUCCESS || nResult == CV_TSTOP_RETURN)
+        {
+            detectStiffness(timeEnd);
+
+            if (singleSteps && nResult == CV_SUCCESS)
+            {
+                // an internal step short of the output time.
+                if (++steps >= maxSteps)
+                {
+                    handleCVODEError(CV_TOO_MUCH_WORK);
+                }
+                continue;
+            }
+
+            nResult = CV_SUCCESS;
+        }
+
         if (nResult == CV_ROOT_RETURN)
         {
             Log(Logger::LOG_DEBUG) << "Event detected at time " << timeEnd;
@@ -347,6 +417,163 @@ double CVODEIntegrator::integrate(double timeStart, double hstep)
     return timeEnd;
 }
 
+void CVODEIntegrator::sample(double t0, double hstep, int count,
+        IntegratorSampleListener& output)
+{
+    // a listener expects the same calls as integrate makes, and the
+    // multi and variable step modes return after each step.
+    if (!denseOutputSampling || listener || !haveVariables() || hstep <= 0
+            || (options.integratorFlags & (MULTI_STEP | VARIABLE_STEP)))
+    {
+        Integrator::sample(t0, hstep, count, output);
+        return;
+    }
+
+    RR_TRACE_SCOPE("CVODEIntegrator::sample", "integrate");
+
+    static const double epsilon = std::numeric_limits<double>::epsilon();
+
+    Log(Logger::LOG_DEBUG) << "CVODEIntegrator::sample(" << t0 << ", "
+            << hstep << ", " << count << ")";
+
+    const double tfinal = t0 + count * hstep;
+    const int maxSteps = options.maximumNumSteps > 0
+            ? options.maximumNumSteps : mDefaultMaxNumSteps;
+    const int numEvents = mModel->getNumEvents();
+
+    // the time of the cvode state vector, and if there is an event root
+    // there which is not applied yet.
+    double t = t0;
+    bool root = false;
+    bool stepped = false;
+    int strikes = 3;
+    int steps = 0;
+    int i = 1;
+
+    while (true)
+    {
+        const int first = i;
+        double tout = t0 + i * hstep;
+
+        // the output times before t, within the last step
+        while (i <= count && t - tout >= epsilon)
+        {
+            int err = CVodeGetDky(mCVODE_Memory, tout, 0, mSampleVector);
+            if (err != CV_SUCCESS)
+            {
+                handleCVODEError(err);
+            }
+
+            mModel->setTime(tout);
+            mModel->setStateVector(NV_DATA_S(mSampleVector));
+            output.onSample(i, tout);
+
+            tout = t0 + ++i * hstep;
+        }
+
+        // events at t are applied before the output at t, the same as
+        // integrate does.
+        if (root)
+        {
+            root = false;
+
+            bool tooCloseToStart = fabs(t - lastEventTime) > options.relative;
+
+            if(tooCloseToStart)
+            {
+                strikes =  3;
+            }
+            else
+            {
+                strikes--;
+            }
+
+            if (tooCloseToStart || strikes > 0)
+            {
+                lastEventTime = t;
+                applyEvents(t, eventStatus);
+            }
+        }
+        else if (mModel->getPendingEventSize() > 0)
+        {
+            mModel->setTime(t);
+            assignResultsToModel();
+            applyPendingEvents(t);
+        }
+
+        // an output time at t
+        while (i <= count && fabs(t - tout) < epsilon)
+        {
+            mModel->setTime(tout);
+            assignResultsToModel();
+            output.onSample(i, tout);
+
+            tout = t0 + ++i * hstep;
+        }
+
+        if (i > first)
+        {
+            steps = 0;
+
+            try
+            {
+                mModel->testConstraints();
+            }
+            catch (const std::exception& e)
+            {
+                Log(Logger::LOG_WARNING) << "Constraint Violated at time = " << t << ": " << e.what();
+            }
+        }
+
+        if (i > count)
+        {
+            break;
+        }
+
+        // after the outputs, switching methods discards the interpolant
+        if (stepped)
+        {
+            detectStiffness(t);
+        }
+
+        if (++steps > maxSteps)
+        {
+            handleCVODEError(CV_TOO_MUCH_WORK);
+        }
+
+        // steps may not pass a pending event or the last output time
+        double tstop = tfinal;
+        if (mModel->getPendingEventSize() > 0
+                && mModel->getNextPendingEventTime(false) < tstop)
+        {
+            tstop = mModel->getNextPendingEventTime(false);
+        }
+        CVodeSetStopTime(mCVODE_Memory, tstop);
+
+        // event status before time step
+        if (numEvents > 0)
+        {
+            mModel->setTime(t);
+            assignResultsToModel();
+            mModel->getEventTriggers(eventStatus.size(), 0, &eventStatus[0]);
+        }
+
+        int nResult = CVode(mCVODE_Memory, tstop, mStateVector, &t, CV_ONE_STEP);
+
+        if (nResult == CV_ROOT_RETURN)
+        {
+            Log(Logger::LOG_DEBUG) << "Event detected at time " << t;
+            root = true;
+        }
+        else if (nResult != CV_SUCCESS && nResult != CV_TSTOP_RETURN)
+        {
+            handleCVODEError(nResult);
+        }
+
+        stepped = !root;
+    }
+}
+
 bool CVODEIntegrator::haveVariables()
 {
     return stateVectorVariables;
@@ -367,9 +594,6 @@ void CVODEIntegrator::createCVode()
     int allocStateVectorSize = 0;
     int realStateVectorSize = mModel->getStateVector(0);
 
-    // cvode return code
-    int err;
-
     if(realStateVectorSize > 0)
     {
         stateVectorVariables = true;
@@ -388,6 +612,7 @@ void CVODEIntegrator::createCVode()
 
     // allocate and init the cvode arrays
     mStateVector = N_VNew_Serial(allocStateVectorSize);
+    mSampleVector = N_VNew_Serial(allocStateVectorSize);
     variableStepPostEventState = new double[allocStateVectorSize];
 
     for (int i = 0; i < allocStateVectorSize; i++)
@@ -395,7 +620,17 @@ void CVODEIntegrator::createCVode()
         SetVector(mStateVector, i, 0.);
     }
 
-    if (options.integratorFlags & STIFF)
+    initCVodeMemory(0.0);
+
+    mModel->resetEvents();
+}
+
+void CVODEIntegrator::initCVodeMemory(double t0)
+{
+    // cvode return code
+    int err;
+
+    if (stiffMethod)
     {
         Log(Logger::LOG_INFORMATION) << "using stiff integrator";
         mCVODE_Memory = (void*) CVodeCreate(CV_BDF, CV_NEWTON);
@@ -417,8 +652,6 @@ void CVODEIntegrator::createCVode()
     // for some sbml tests.
     CVodeSetMaxNumSteps(mCVODE_Memory, mDefaultMaxNumSteps);
 
-    double t0 = 0.0;
-
     if ((err = CVodeSetUserData(mCVODE_Memory, (void*) this)) != CV_SUCCESS)
     {
         handleCVODEError(err);
@@ -441,17 +674,17 @@ void CVODEIntegrator::createCVode()
 
     // only allocate this if we are using stiff solver.
     // otherwise, CVode will NOT free it if using standard solver.
-    if (options.integratorFlags & STIFF)
+    if (stiffMethod)
     {
-        if ((err = CVDense(mCVODE_Memory, allocStateVectorSize)) != CV_SUCCESS)
+        if ((err = CVDense(mCVODE_Memory, NV_LENGTH_S(mStateVector))) != CV_SUCCESS)
         {
             handleCVODEError(err);
         }
     }
 
-    setCVODETolerances();
+    CVodeSetMaxOrd(mCVODE_Memory, stiffMethod ? mMaxBDFOrder : mMaxAdamsOrder);
 
-    mModel->resetEvents();
+    setCVODETolerances();
 }
 
 
@@ -466,6 +699,8 @@ void CVODEIntegrator::testRootsAtInitialTime()
 
 void CVODEIntegrator::applyEvents(double timeEnd, vector<unsigned char> &previousEventStatus)
 {
+    RR_TRACE_SCOPE("CVODEIntegrator::applyEvents", "events");
+
     double *stateVector = mStateVector ? NV_DATA_S(mStateVector) : 0;
     mModel->applyEvents(timeEnd, &previousEventStatus[0], stateVector, stateVector);
 
@@ -486,6 +721,8 @@ void CVODEIntegrator::applyEvents(double timeEnd, vector<unsigned char> &previou
 
 void CVODEIntegrator::applyPendingEvents(double timeEnd)
 {
+    RR_TRACE_SCOPE("CVODEIntegrator::applyPendingEvents", "events");
+
     if(mModel) {
          // get current event triggered state
         mModel->getEventTriggers(eventStatus.size(), 0, &eventStatus[0]);
@@ -603,6 +840,7 @@ void CVODEIntegrator::freeCVode()
     // cvode does not check for null values.
     if(mCVODE_Memory)
     {
+        mStatistics += getCVODEStatistics();
         CVodeFree( &mCVODE_Memory);
     }
 
@@ -611,8 +849,174 @@ void CVODEIntegrator::freeCVode()
         N_VDestroy_Serial(mStateVector);
     }
 
+    if(mSampleVector)
+    {
+        N_VDestroy_Serial(mSampleVector);
+    }
+
     mCVODE_Memory = 0;
     mStateVector = 0;
+    mSampleVector = 0;
+}
+
+void CVODEIntegrator::detectStiffness(double t)
+{
+    if (!stiffnessDetection || !haveVariables())
+    {
+        return;
+    }
+
+    long steps = 0, convFails = 0;
+    CVodeGetNumSteps(mCVODE_Memory, &steps);
+    CVodeGetNumNonlinSolvConvFails(mCVODE_Memory, &convFails);
+
+    // cvode zeros its counters when it is re-initialized
+    if (steps < stiffnessCheckSteps)
+    {
+        stiffnessCheckSteps = steps;
+        stiffnessCheckConvFails = convFails;
+        return;
+    }
+
+    if (steps - stiffnessCheckSteps < stiffnessCheckInterval)
+    {
+        return;
+    }
+
+    long stepsSinceCheck = steps - stiffnessCheckSteps;
+    long convFailsSinceCheck = convFails - stiffnessCheckConvFails;
+    stiffnessCheckSteps = steps;
+    stiffnessCheckConvFails = convFails;
+
+    realtype h = 0;
+    int order = 1;
+    CVodeGetLastStep(mCVODE_Memory, &h);
+    CVodeGetLastOrder(mCVODE_Memory, &order);
+
+    double hrho = fabs(h) * estimateSpectralRadius(t);
+
+    Log(Logger::LOG_DEBUG) << "stiffness check at time " << t << ", h * rho: "
+            << hrho << ", order: " << order << ", convergence failures: " << convFailsSinceCheck
+            << " in " << stepsSinceCheck << " steps";
+
+    if (stiffMethod)
+    {
+        if (hrho < nonStiffStabilityLimit)
+        {
+            switchMethod(t);
+        }
+    }
+    else
+    {
+        // the functional iteration also fails to converge when the steps
+        // are too large for the stiff components.
+        double limit = adamsStability[max(1, min(order, 12)) - 1];
+        limit = max(stiffStabilityMin, stiffStabilityFraction * limit);
+
+        if (hrho > limit || 4 * convFailsSinceCheck > stepsSinceCheck)
+        {
+            switchMethod(t);
+        }
+    }
+}
+
+double CVODEIntegrator::estimateSpectralRadius(double t)
+{
+    static const double sqrtEpsilon =
+            sqrt(std::numeric_limits<double>::epsilon());
+    static const int maxIterations = 10;
+
+    const int n = NV_LENGTH_S(mStateVector);
+    const double *y = NV_DATA_S(mStateVector);
+
+    stiffnessWork.resize(4 * n);
+    double *f0 = &stiffnessWork[0], *v = &stiffnessWork[n],
+            *w = &stiffnessWork[2 * n], *ytmp = &stiffnessWork[3 * n];
+
+    mModel->getStateVectorRate(t, y, f0);
+
+    double ynorm = 0, vnorm = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        ynorm += y[i] * y[i];
+        vnorm += f0[i] * f0[i];
+    }
+    ynorm = sqrt(ynorm);
+    vnorm = sqrt(vnorm);
+
+    // start from the rates, they are mostly along the fast modes
+    for (int i = 0; i < n; ++i)
+    {
+        v[i] = vnorm > 0 ? f0[i] : 1.;
+    }
+    if (vnorm == 0)
+    {
+        vnorm = sqrt((double)n);
+    }
+
+    double delta = sqrtEpsilon * max(1., ynorm);
+    double rho = 0;
+
+    for (int k = 0; k < maxIterations; ++k)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            ytmp[i] = y[i] + delta * v[i] / vnorm;
+        }
+
+        mModel->getStateVectorRate(t, ytmp, w);
+
+        double wnorm = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            w[i] -= f0[i];
+            wnorm += w[i] * w[i];
+        }
+        wnorm = sqrt(wnorm);
+
+        double r = wnorm / delta;
+        bool converged = fabs(r - rho) <= 0.05 * r;
+        rho = r;
+
+        if (wnorm == 0 || converged)
+        {
+            break;
+        }
+
+        std::swap(v, w);
+        vnorm = wnorm;
+    }
+
+    return rho;
+}
+
+void CVODEIntegrator::switchMethod(double t)
+{
+    realtype h = 0;
+    CVodeGetCurrentStep(mCVODE_Memory, &h);
+
+    Log(Logger::LOG_INFORMATION) << "switching to the "
+            << (stiffMethod ? "non-stiff" : "stiff") << " integrator at time "
+            << t << ", step size " << h;
+
+    // the Adams and BDF histories are not compatible, only the state and
+    // the step size carry over.
+    mStatistics += getCVODEStatistics();
+    mStatistics.methodSwitches++;
+    CVodeFree(&mCVODE_Memory);
+    mCVODE_Memory = 0;
+
+    stiffMethod = !stiffMethod;
+    initCVodeMemory(t);
+    setSimulateOptions(0);
+
+    if (h > 0)
+    {
+        CVodeSetInitStep(mCVODE_Memory, h);
+    }
+
+    stiffnessCheckSteps = 0;
+    stiffnessCheckConvFails = 0;
 }
 
 const Dictionary* CVODEIntegrator::getIntegratorOptions()
@@ -633,6 +1037,8 @@ const Dictionary* CVODEIntegrator::getIntegratorOptions()
 
 double CVODEIntegrator::applyVariableStepPendingEvents()
 {
+    RR_TRACE_SCOPE("CVODEIntegrator::applyVariableStepPendingEvents", "events");
+
     if (variableStepTimeEndEvent) {
         // post event state allready calcuated.
         mModel->setStateVector(variableStepPostEventState);
@@ -681,7 +1087,7 @@ void CVODEIntegrator::setItem(const std::string& key, const rr::Variant& value)
     if (key == "BDFMaxOrder")
     {
         mMaxBDFOrder = value.convert<int>();
-        if (options.integratorFlags & STIFF)
+        if (stiffMethod)
         {
             CVodeSetMaxOrd(mCVODE_Memory, mMaxBDFOrder);
         }
@@ -690,15 +1096,43 @@ void CVODEIntegrator::setItem(const std::string& key, const rr::Variant& value)
     else if (key == "AdamsMaxOrder")
     {
         mMaxAdamsOrder = value.convert<int>();
-        if (!(options.integratorFlags & STIFF))
+        if (!stiffMethod)
         {
             CVodeSetMaxOrd(mCVODE_Memory, mMaxAdamsOrder);
         }
         return;
     }
+    else if (key == "DenseOutputSampling")
+    {
+        denseOutputSampling = value.convert<bool>();
+        return;
+    }
+    else if (key == "StiffnessDetection")
+    {
+        stiffnessDetection = value.convert<bool>();
+
+        // go back to the method selected by the stiff option
+        if (!stiffnessDetection && mCVODE_Memory
+                && stiffMethod != ((options.integratorFlags & STIFF) != 0))
+        {
+            switchMethod(mModel->getTime());
+        }
+        return;
+    }
     throw std::invalid_argument("invalid key: " + key);
 }
 
+/**
+ * the read only performance counter keys.
+ */
+static bool isStatisticsKey(const std::string& key)
+{
+    return key == "NumSteps" || key == "NumRhsEvals" || key == "NumJacEvals"
+            || key == "NumErrTestFails" || key == "NumNonlinSolvIters"
+            || key == "NumNonlinSolvConvFails" || key == "NumRootEvals"
+            || key == "NumMethodSwitches";
+}
+
 Variant CVODEIntegrator::getItem(const std::string& key) const
 {
     if (key == "BDFMaxOrder")
@@ -709,12 +1143,118 @@ Variant CVODEIntegrator::getItem(const std::string& key) const
     {
         return mMaxAdamsOrder;
     }
+    else if (key == "StiffnessDetection")
+    {
+        return stiffnessDetection;
+    }
+    else if (key == "DenseOutputSampling")
+    {
+        return denseOutputSampling;
+    }
+    else if (isStatisticsKey(key))
+    {
+        // read only performance counters
+        BasicDictionary stats;
+        getStatistics(stats);
+        return stats.getItem(key);
+    }
     throw std::invalid_argument("invalid key: " + key);
 }
 
 bool CVODEIntegrator::hasKey(const std::string& key) const
 {
-    return key == "BDFMaxOrder" || key == "AdamsMaxOrder";
+    return key == "BDFMaxOrder" || key == "AdamsMaxOrder"
+            || key == "StiffnessDetection" || key == "DenseOutputSampling"
+            || isStatisticsKey(key);
+}
+
+CVODEStatistics::CVODEStatistics() :
+    steps(0), rhsEvals(0), jacEvals(0), errTestFails(0),
+    nonlinSolvIters(0), nonlinSolvConvFails(0), rootEvals(0),
+    methodSwitches(0)
+{
+}
+
+CVODEStatistics& CVODEStatistics::operator+=(const CVODEStatistics& o)
+{
+    steps += o.steps;
+    rhsEvals += o.rhsEvals;
+    jacEvals += o.jacEvals;
+    errTestFails += o.errTestFails;
+    nonlinSolvIters += o.nonlinSolvIters;
+    nonlinSolvConvFails += o.nonlinSolvConvFails;
+    rootEvals += o.rootEvals;
+    methodSwitches += o.methodSwitches;
+    return *this;
+}
+
+CVODEStatistics& CVODEStatistics::operator-=(const CVODEStatistics& o)
+{
+    steps -= o.steps;
+    rhsEvals -= o.rhsEvals;
+    jacEvals -= o.jacEvals;
+    errTestFails -= o.errTestFails;
+    nonlinSolvIters -= o.nonlinSolvIters;
+    nonlinSolvConvFails -= o.nonlinSolvConvFails;
+    rootEvals -= o.rootEvals;
+    methodSwitches -= o.methodSwitches;
+    return *this;
+}
+
+/**
+ * read a cvode counter, zero if it is not available, e.g. there is no
+ * jacobian with the functional (non-stiff) iteration.
+ */
+static int64_t getCVODECounter(int (*getter)(void*, long int*), void* mem)
+{
+    long int value = 0;
+    return getter(mem, &value) == CV_SUCCESS ? value : 0;
+}
+
+CVODEStatistics CVODEIntegrator::getCVODEStatistics() const
+{
+    CVODEStatistics stats;
+
+    if (mCVODE_Memory)
+    {
+        stats.steps = getCVODECounter(CVodeGetNumSteps, mCVODE_Memory);
+        stats.rhsEvals = getCVODECounter(CVodeGetNumRhsEvals, mCVODE_Memory);
+        stats.jacEvals = getCVODECounter(CVDlsGetNumJacEvals, mCVODE_Memory);
+        stats.errTestFails = getCVODECounter(CVodeGetNumErrTestFails, mCVODE_Memory);
+        stats.nonlinSolvIters = getCVODECounter(CVodeGetNumNonlinSolvIters, mCVODE_Memory);
+        stats.nonlinSolvConvFails = getCVODECounter(CVodeGetNumNonlinSolvConvFails, mCVODE_Memory);
+        stats.rootEvals = getCVODECounter(CVodeGetNumGEvals, mCVODE_Memory);
+    }
+
+    return stats;
+}
+
+CVODEStatistics CVODEIntegrator::getTotalStatistics() const
+{
+    CVODEStatistics stats = mStatistics;
+    stats += getCVODEStatistics();
+    return stats;
+}
+
+void CVODEIntegrator::getStatistics(BasicDictionary& dict) const
+{
+    CVODEStatistics stats = getTotalStatistics();
+
+    dict.setItem("NumSteps", stats.steps);
+    dict.setItem("NumRhsEvals", stats.rhsEvals);
+    dict.setItem("NumJacEvals", stats.jacEvals);
+    dict.setItem("NumErrTestFails", stats.errTestFails);
+    dict.setItem("NumNonlinSolvIters", stats.nonlinSolvIters);
+    dict.setItem("NumNonlinSolvConvFails", stats.nonlinSolvConvFails);
+    dict.setItem("NumRootEvals", stats.rootEvals);
+    dict.setItem("NumMethodSwitches", stats.methodSwitches);
+}
+
+void CVODEIntegrator::resetStatistics()
+{
+    // the cvode counters can not be zeroed, so offset them
+    mStatistics = CVODEStatistics();
+    mStatistics -= getCVODEStatistics();
 }
 
 int CVODEIntegrator::deleteItem(const std::string& key)
@@ -727,6 +1267,8 @@ std::vector<std::string> CVODEIntegrator::getKeys() const
     std::vector<std::string> keys;
     keys.push_back("BDFMaxOrder");
     keys.push_back("AdamsMaxOrder");
+    keys.push_back("StiffnessDetection");
+    keys.push_back("DenseOutputSampling");
     return keys;
 }
 
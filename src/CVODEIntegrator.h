@@ -19,6 +19,31 @@ using std::string;
 class ExecutableModel;
 class SBMLSolver;
 
+/**
+ * @internal
+ * CVODE integrator counters.
+ */
+struct CVODEStatistics
+{
+    CVODEStatistics();
+
+    int64_t steps;
+    int64_t rhsEvals;
+    int64_t jacEvals;
+    int64_t errTestFails;
+    int64_t nonlinSolvIters;
+    int64_t nonlinSolvConvFails;
+    int64_t rootEvals;
+
+    /**
+     * switches between the Adams and BDF methods, not a cvode counter.
+     */
+    int64_t methodSwitches;
+
+    CVODEStatistics& operator+=(const CVODEStatistics& other);
+    CVODEStatistics& operator-=(const CVODEStatistics& other);
+};
+
 /**
  * @internal
  * The integrator implemented by CVODE.
@@ -32,6 +57,15 @@ public:
 
     double integrate(double t0, double tf);
 
+    /**
+     * if the DenseOutputSampling key is set, takes single cvode steps and
+     * fills all the output times within each step from the cvode
+     * interpolating polynomial, otherwise calls integrate for each output
+     * time.
+     */
+    virtual void sample(double t0, double hstep, int count,
+            IntegratorSampleListener& listener);
+
     /**
      * copies the state vector out of the model and into cvode vector,
      * re-initializes cvode.
@@ -67,6 +101,15 @@ public:
 
     virtual std::vector<std::string> getKeys() const;
 
+    /**
+     * adds the read only items NumSteps, NumRhsEvals, NumJacEvals,
+     * NumErrTestFails, NumNonlinSolvIters, NumNonlinSolvConvFails,
+     * NumRootEvals and NumMethodSwitches.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    virtual void resetStatistics();
+
     /**
      * get a description of this object, compatable with python __str__
      */
@@ -93,6 +136,11 @@ private:
 
     N_Vector mStateVector;
 
+    /**
+     * the interpolated state at an output time, used by sample.
+     */
+    N_Vector mSampleVector;
+
     /**
      * the CVODE object.
      */
@@ -181,14 +229,69 @@ private:
      */
     void createCVode();
 
+    /**
+     * create the cvode memory for the current method and initialize it
+     * with the state vector at time t0.
+     */
+    void initCVodeMemory(double t0);
+
     /**
      * free and nullify the cvode objects.
      */
     void freeCVode();
 
+    /**
+     * if stiffness detection is on, and enough steps were taken since the
+     * last check, decide if the current method is the right one, and
+     * switch if not.
+     */
+    void detectStiffness(double t);
+
+    /**
+     * estimate the spectral radius of the Jacobian at the current state
+     * by a few power iterations with finite differences of the rates.
+     */
+    double estimateSpectralRadius(double t);
+
+    /**
+     * re-create cvode with the other method at time t, keeping the state
+     * and the current step size.
+     */
+    void switchMethod(double t);
+
     int mMaxAdamsOrder;
     int mMaxBDFOrder;
 
+    /**
+     * the method in use, BDF with Newton iteration if true, Adams with
+     * functional iteration otherwise. Set by the STIFF flag, and changed
+     * by the stiffness detection.
+     */
+    bool stiffMethod;
+
+    /**
+     * switch between the Adams and BDF methods during integration, the
+     * same as LSODA does.
+     */
+    bool stiffnessDetection;
+
+    /**
+     * fill the output times of sample from the cvode dense output.
+     */
+    bool denseOutputSampling;
+
+    /**
+     * the cvode step and convergence failure counters at the last
+     * stiffness check.
+     */
+    long stiffnessCheckSteps;
+    long stiffnessCheckConvFails;
+
+    /**
+     * work space of the spectral radius estimate.
+     */
+    std::vector<double> stiffnessWork;
+
     /**
      * models may have no state vector variables, but in this case,
      * we still need a cvode state vector of len 1 for the integrator to
@@ -204,6 +307,22 @@ private:
      */
     SimulateOptions options;
 
+    /**
+     * cvode zeros its counters when it is re-initialized or re-created,
+     * the counts from before that are accumulated here.
+     */
+    CVODEStatistics mStatistics;
+
+    /**
+     * the counters of the current cvode object.
+     */
+    CVODEStatistics getCVODEStatistics() const;
+
+    /**
+     * the accumulated counters plus the current cvode counters.
+     */
+    CVODEStatistics getTotalStatistics() const;
+
     /**
      * cvode dydt callback
      */
@@ -0,0 +1,581 @@
+#pragma hdrstop
+#include "Continuation.h"
+#include "rrExecutableModel.h"
+#include "rrSteadyStateSolver.h"
+#include "rrLogger.h"
+#include "rrSelectionRecord.h"
+#include "rr-libstruct/lsLibla.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <complex>
+#include <list>
+#include <memory>
+#include <math.h>
+
+using namespace std;
+
+namespace rr
+{
+
+/**
+ * read an option from the dictionary if it is present.
+ */
+template <typename T>
+static void getOption(const Dictionary* dict, const char* key, T& value)
+{
+    if (dict && dict->hasKey(key))
+    {
+        value = dict->getItem(key).convert<T>();
+    }
+}
+
+static double normInf(const vector<double>& v)
+{
+    double result = 0;
+    for (unsigned i = 0; i < v.size(); ++i)
+    {
+        result = max(result, fabs(v[i]));
+    }
+    return result;
+}
+
+static bool isFinite(const vector<double>& v)
+{
+    for (unsigned i = 0; i < v.size(); ++i)
+    {
+        // false for both infinity and NaN
+        if (!(fabs(v[i]) < HUGE_VAL))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Solve the dense m x m system a x = b in place by Gaussian elimination with
+ * partial pivoting, a is row major and is destroyed, the solution is
+ * returned in b.
+ *
+ * The systems here are the size of the number of independent species, so
+ * it is not worth going through lapack for them.
+ *
+ * @returns false if the matrix is singular.
+ */
+static bool solveLinear(int m, vector<double>& a, vector<double>& b)
+{
+    for (int k = 0; k < m; ++k)
+    {
+        int pivot = k;
+        for (int i = k + 1; i < m; ++i)
+        {
+            if (fabs(a[i * m + k]) > fabs(a[pivot * m + k]))
+            {
+                pivot = i;
+            }
+        }
+
+        if (a[pivot * m + k] == 0.0)
+        {
+            return false;
+        }
+
+        if (pivot != k)
+        {
+            for (int j = 0; j < m; ++j)
+            {
+                swap(a[k * m + j], a[pivot * m + j]);
+            }
+            swap(b[k], b[pivot]);
+        }
+
+        for (int i = k + 1; i < m; ++i)
+        {
+            double factor = a[i * m + k] / a[k * m + k];
+            if (factor != 0.0)
+            {
+                for (int j = k; j < m; ++j)
+                {
+                    a[i * m + j] -= factor * a[k * m + j];
+                }
+                b[i] -= factor * b[k];
+            }
+        }
+    }
+
+    for (int i = m - 1; i >= 0; --i)
+    {
+        double sum = b[i];
+        for (int j = i + 1; j < m; ++j)
+        {
+            sum -= a[i * m + j] * b[j];
+        }
+        b[i] = sum / a[i * m + i];
+    }
+
+    return true;
+}
+
+/**
+ * a row of the branch table, the parameter value is stored last in the
+ * continuation vector but first in the table.
+ */
+static vector<double> branchRow(const vector<double>& y, double maxReal,
+        int type)
+{
+    vector<double> row;
+    row.reserve(y.size() + 2);
+    row.push_back(y.back());
+    row.insert(row.end(), y.begin(), y.end() - 1);
+    row.push_back(maxReal);
+    row.push_back(type);
+    return row;
+}
+
+Continuation::Continuation(ExecutableModel *model,
+        const std::string& parameterId, const Dictionary* options) :
+        model(model),
+        parameterIndex(-1),
+        parameterId(parameterId),
+        n(0),
+        initialStep(0.01),
+        minimumStep(1e-8),
+        maximumStep(0.5),
+        maximumPoints(1000),
+        maximumNewtonIterations(10),
+        tolerance(1e-9),
+        jacobianStep(1e-7),
+        numSteps(0),
+        numRejectedSteps(0)
+{
+    if (!model)
+    {
+        throw std::invalid_argument("Continuation requires a model");
+    }
+
+    parameterIndex = model->getGlobalParameterIndex(parameterId);
+
+    if (parameterIndex < 0)
+    {
+        throw std::invalid_argument("Continuation: \"" + parameterId
+                + "\" is not a global parameter");
+    }
+
+    n = model->getNumIndFloatingSpecies();
+
+    getOption(options, "initial_step", initialStep);
+    getOption(options, "minimum_step", minimumStep);
+    getOption(options, "maximum_step", maximumStep);
+    getOption(options, "maximum_points", maximumPoints);
+    getOption(options, "maximum_newton_iterations", maximumNewtonIterations);
+    getOption(options, "tolerance", tolerance);
+    getOption(options, "jacobian_step", jacobianStep);
+
+    if (!(minimumStep > 0 && initialStep >= minimumStep
+            && maximumStep >= initialStep))
+    {
+        throw std::invalid_argument("Continuation step sizes must satisfy "
+                "0 < minimum_step <= initial_step <= maximum_step");
+    }
+
+    if (maximumPoints < 1 || maximumNewtonIterations < 1 || tolerance <= 0
+            || jacobianStep <= 0)
+    {
+        throw std::invalid_argument("invalid Continuation options");
+    }
+}
+
+Continuation::~Continuation()
+{
+}
+
+int Continuation::getNumSteps() const
+{
+    return numSteps;
+}
+
+int Continuation::getNumRejectedSteps() const
+{
+    return numRejectedSteps;
+}
+
+void Continuation::evalRates(const std::vector<double>& y,
+        std::vector<double>& f)
+{
+    model->setGlobalParameterValues(1, &parameterIndex, &y[n]);
+
+    if (n)
+    {
+        model->setFloatingSpeciesAmounts(n, 0, &y[0]);
+        model->getFloatingSpeciesAmountRates(n, 0, &f[0]);
+    }
+}
+
+void Continuation::evalJacobian(const std::vector<double>& y,
+        std::vector<double>& f, std::vector<double>& jac)
+{
+    const int cols = n + 1;
+    vector<double> yh(y);
+    vector<double> fh(n);
+
+    f.resize(n);
+    jac.resize(n * cols);
+
+    evalRates(y, f);
+
+    // forward differences, one column per species and one for the parameter
+    for (int j = 0; j < cols; ++j)
+    {
+        double h = jacobianStep * max(fabs(y[j]), 1.0);
+        yh[j] = y[j] + h;
+        evalRates(yh, fh);
+        yh[j] = y[j];
+
+        for (int i = 0; i < n; ++i)
+        {
+            jac[i * cols + j] = (fh[i] - f[i]) / h;
+        }
+    }
+
+    // leave the model at y
+    evalRates(y, f);
+}
+
+bool Continuation::solveFixedParameter(std::vector<double>& y)
+{
+    const int cols = n + 1;
+    vector<double> f, jac;
+    vector<double> a(n * n);
+    vector<double> dx(n);
+
+    for (int iter = 0; iter < max(maximumNewtonIterations, 50); ++iter)
+    {
+        evalJacobian(y, f, jac);
+
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                a[i * n + j] = jac[i * cols + j];
+            }
+            dx[i] = -f[i];
+        }
+
+        if (!solveLinear(n, a, dx))
+        {
+            return false;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            y[i] += dx[i];
+        }
+
+        if (!isFinite(y))
+        {
+            return false;
+        }
+
+        if (normInf(dx) <= tolerance * (1.0 + normInf(y)))
+        {
+            evalRates(y, f);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Continuation::computeTangent(const std::vector<double>& y,
+        const std::vector<double>& prevTangent, std::vector<double>& tangent)
+{
+    const int cols = n + 1;
+    vector<double> f, jac;
+    evalJacobian(y, f, jac);
+
+    // [Fx Fp; prevTangent'] t = [0; 1], so the new tangent is in the
+    // null space of [Fx Fp] and has the same orientation as the previous one.
+    vector<double> a(cols * cols);
+    copy(jac.begin(), jac.end(), a.begin());
+    copy(prevTangent.begin(), prevTangent.end(), a.begin() + n * cols);
+
+    tangent.assign(cols, 0.0);
+    tangent[n] = 1.0;
+
+    if (!solveLinear(cols, a, tangent))
+    {
+        return false;
+    }
+
+    double norm = 0;
+    for (int i = 0; i < cols; ++i)
+    {
+        norm += tangent[i] * tangent[i];
+    }
+    norm = sqrt(norm);
+
+    if (!(norm > 0) || !isFinite(tangent))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < cols; ++i)
+    {
+        tangent[i] /= norm;
+    }
+    return true;
+}
+
+int Continuation::correct(const std::vector<double>& predictor,
+        const std::vector<double>& tangent, std::vector<double>& y)
+{
+    const int cols = n + 1;
+    vector<double> f, jac;
+    vector<double> a(cols * cols);
+    vector<double> dy(cols);
+
+    y = predictor;
+
+    for (int iter = 1; iter <= maximumNewtonIterations; ++iter)
+    {
+        evalJacobian(y, f, jac);
+
+        copy(jac.begin(), jac.end(), a.begin());
+        copy(tangent.begin(), tangent.end(), a.begin() + n * cols);
+
+        // the arclength constraint keeps the correction in the hyperplane
+        // orthogonal to the tangent through the predictor.
+        double arclength = 0;
+        for (int i = 0; i < cols; ++i)
+        {
+            arclength += tangent[i] * (y[i] - predictor[i]);
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            dy[i] = -f[i];
+        }
+        dy[n] = -arclength;
+
+        if (!solveLinear(cols, a, dy))
+        {
+            return -1;
+        }
+
+        for (int i = 0; i < cols; ++i)
+        {
+            y[i] += dy[i];
+        }
+
+        if (!isFinite(y))
+        {
+            return -1;
+        }
+
+        if (normInf(dy) <= tolerance * (1.0 + normInf(y)))
+        {
+            evalRates(y, f);
+            return iter;
+        }
+    }
+    return -1;
+}
+
+void Continuation::stability(const std::vector<double>& y, double& maxReal,
+        int& unstablePairs)
+{
+    maxReal = 0;
+    unstablePairs = 0;
+
+    if (n == 0)
+    {
+        return;
+    }
+
+    const int cols = n + 1;
+    vector<double> f, jac;
+    evalJacobian(y, f, jac);
+
+    ls::DoubleMatrix mat(n, n);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            mat(i, j) = jac[i * cols + j];
+        }
+    }
+
+    vector< complex<double> > eig = ls::getEigenValues(mat);
+
+    maxReal = -HUGE_VAL;
+    for (unsigned i = 0; i < eig.size(); ++i)
+    {
+        maxReal = max(maxReal, eig[i].real());
+
+        // each conjugate pair is only counted once
+        if (eig[i].real() > 0 && eig[i].imag() > 0)
+        {
+            ++unstablePairs;
+        }
+    }
+}
+
+ls::DoubleMatrix Continuation::run(double start, double end)
+{
+    const int cols = n + 1;
+    const double direction = end >= start ? 1.0 : -1.0;
+
+    numSteps = 0;
+    numRejectedSteps = 0;
+
+    vector<double> y(cols);
+    vector<double> f(n);
+
+    if (n)
+    {
+        model->getFloatingSpeciesAmounts(n, 0, &y[0]);
+    }
+    y[n] = start;
+    evalRates(y, f);
+
+    // the Newton iterates are written into the model, keep the starting
+    // point for the steady state solver
+    const vector<double> initial(y);
+
+    if (!solveFixedParameter(y))
+    {
+        Log(Logger::LOG_INFORMATION) << "Continuation: Newton iteration failed "
+                "to find the initial steady state, using the steady state solver";
+
+        y = initial;
+        evalRates(y, f);
+
+        std::auto_ptr<SteadyStateSolver> solver(
+                SteadyStateSolverFactory::New(0, model));
+
+        vector<double> amounts(y.begin(), y.begin() + n);
+        if (solver->solve(amounts) < 0)
+        {
+            throw std::runtime_error("Continuation: could not find the initial "
+                    "steady state at " + parameterId);
+        }
+
+        if (n)
+        {
+            model->getFloatingSpeciesAmounts(n, 0, &y[0]);
+        }
+    }
+
+    vector< vector<double> > rows;
+    vector<double> tangent(cols, 0.0);
+    vector<double> newTangent;
+    vector<double> predictor(cols);
+    vector<double> yNew;
+
+    tangent[n] = direction;
+    if (!computeTangent(y, tangent, newTangent))
+    {
+        throw std::runtime_error("Continuation: singular Jacobian at the "
+                "initial steady state");
+    }
+    tangent.swap(newTangent);
+
+    double maxReal = 0;
+    int unstablePairs = 0;
+    stability(y, maxReal, unstablePairs);
+
+    rows.push_back(branchRow(y, maxReal, REGULAR));
+
+    double ds = initialStep;
+
+    while ((int)rows.size() < maximumPoints)
+    {
+        for (int i = 0; i < cols; ++i)
+        {
+            predictor[i] = y[i] + ds * tangent[i];
+        }
+
+        int iterations = correct(predictor, tangent, yNew);
+
+        if (iterations < 0 || !computeTangent(yNew, tangent, newTangent))
+        {
+            ++numRejectedSteps;
+            ds *= 0.5;
+
+            if (ds < minimumStep)
+            {
+                Log(Logger::LOG_WARNING) << "Continuation stopped at " << parameterId
+                        << " = " << y[n] << ", step size below minimum_step";
+                break;
+            }
+            continue;
+        }
+
+        // stop when the branch leaves the requested parameter range
+        if ((yNew[n] - end) * direction > 0 || (yNew[n] - start) * direction < 0)
+        {
+            break;
+        }
+
+        int newPairs = 0;
+        stability(yNew, maxReal, newPairs);
+
+        PointType type = REGULAR;
+        if (newTangent[n] * tangent[n] < 0)
+        {
+            type = FOLD;
+        }
+        else if (newPairs != unstablePairs)
+        {
+            type = HOPF;
+        }
+
+        if (type != REGULAR)
+        {
+            Log(Logger::LOG_INFORMATION) << "Continuation: "
+                    << (type == FOLD ? "fold" : "Hopf point") << " near "
+                    << parameterId << " = " << yNew[n];
+        }
+
+        rows.push_back(branchRow(yNew, maxReal, type));
+
+        y.swap(yNew);
+        tangent.swap(newTangent);
+        unstablePairs = newPairs;
+        ++numSteps;
+
+        // adapt the step size to the corrector effort
+        if (iterations <= 3)
+        {
+            ds = min(ds * 1.5, maximumStep);
+        }
+        else if (iterations > maximumNewtonIterations / 2)
+        {
+            ds = max(ds * 0.5, minimumStep);
+        }
+    }
+
+    ls::DoubleMatrix result(rows.size(), cols + 2);
+
+    for (unsigned i = 0; i < rows.size(); ++i)
+    {
+        for (int j = 0; j < cols + 2; ++j)
+        {
+            result(i, j) = rows[i][j];
+        }
+    }
+
+    std::list<std::string> ids;
+    model->getIds(SelectionRecord::INDEPENDENT_FLOATING_AMOUNT, ids);
+
+    vector<string> names;
+    names.push_back(parameterId);
+    names.insert(names.end(), ids.begin(), ids.end());
+    names.push_back("max_real_eigenvalue");
+    names.push_back("point_type");
+    result.setColNames(names);
+
+    return result;
+}
+
+} /* namespace rr */
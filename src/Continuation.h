@@ -0,0 +1,169 @@
+/*
+ * Continuation.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_CONTINUATION_H_
+#define RR_CONTINUATION_H_
+
+#include "rrExporter.h"
+#include "Dictionary.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class ExecutableModel;
+
+/**
+ * Steady state continuation with respect to a single global parameter.
+ *
+ * Follows a branch of steady states of the independent floating species
+ * using pseudo-arclength continuation: a tangent predictor followed by a
+ * Newton corrector on the system augmented with the arclength constraint,
+ * with an adaptive step size. As the branch is parameterized by arclength,
+ * it can be followed around folds where a natural parameter sweep fails.
+ *
+ * Folds are detected by a sign change of the parameter component of the
+ * branch tangent, Hopf points by a change in the number of complex
+ * conjugate eigenvalue pairs of the reduced Jacobian with positive real part.
+ *
+ * The following options are recognized:
+ *
+ * initial_step: initial arclength step size, default 0.01.
+ *
+ * minimum_step: the continuation stops if the step size drops below this
+ * value, default 1e-8.
+ *
+ * maximum_step: largest arclength step, default 0.5.
+ *
+ * maximum_points: maximum number of points on the branch, default 1000.
+ *
+ * maximum_newton_iterations: maximum number of corrector iterations per
+ * step, default 10.
+ *
+ * tolerance: convergence tolerance of the Newton corrector, default 1e-9.
+ *
+ * jacobian_step: relative step size for the finite difference Jacobian,
+ * default 1e-7.
+ */
+class RR_DECLSPEC Continuation
+{
+public:
+
+    /**
+     * The kind of point stored in the point_type column of the branch table.
+     */
+    enum PointType
+    {
+        REGULAR = 0,
+        FOLD    = 1,
+        HOPF    = 2
+    };
+
+    /**
+     * Create a continuation for the given model and global parameter.
+     *
+     * The model is borrowed, and is modified while the branch is computed.
+     *
+     * @throws std::invalid_argument if the parameter does not exist.
+     */
+    Continuation(ExecutableModel *model, const std::string& parameterId,
+            const Dictionary* options = 0);
+
+    ~Continuation();
+
+    /**
+     * Compute the branch of steady states from parameter value start
+     * towards end.
+     *
+     * The first point is found by a Newton iteration from the current model
+     * state at parameter value start, falling back to the default steady state
+     * solver if that does not converge.
+     *
+     * @returns the branch table. The columns are the parameter value, the
+     * independent floating species amounts, the largest real part of the
+     * reduced Jacobian eigenvalues and the PointType of the point.
+     */
+    ls::DoubleMatrix run(double start, double end);
+
+    /**
+     * number of accepted continuation steps in the last run.
+     */
+    int getNumSteps() const;
+
+    /**
+     * number of rejected (step size reduced) steps in the last run.
+     */
+    int getNumRejectedSteps() const;
+
+private:
+
+    ExecutableModel *model;
+    int parameterIndex;
+    std::string parameterId;
+
+    /**
+     * number of independent floating species.
+     */
+    int n;
+
+    double initialStep;
+    double minimumStep;
+    double maximumStep;
+    int maximumPoints;
+    int maximumNewtonIterations;
+    double tolerance;
+    double jacobianStep;
+
+    int numSteps;
+    int numRejectedSteps;
+
+    /**
+     * set the state and parameter from y, where y has n + 1 elements, the
+     * last one being the parameter, and evaluate the independent species
+     * rates into f.
+     */
+    void evalRates(const std::vector<double>& y, std::vector<double>& f);
+
+    /**
+     * evaluate the rates at y and the n x (n + 1) finite difference Jacobian
+     * with respect to both the species and the parameter, stored row major.
+     */
+    void evalJacobian(const std::vector<double>& y, std::vector<double>& f,
+            std::vector<double>& jac);
+
+    /**
+     * Newton iteration at a fixed parameter value, used to find the first
+     * point of the branch.
+     */
+    bool solveFixedParameter(std::vector<double>& y);
+
+    /**
+     * compute the unit branch tangent at y, oriented along prevTangent.
+     */
+    bool computeTangent(const std::vector<double>& y,
+            const std::vector<double>& prevTangent, std::vector<double>& tangent);
+
+    /**
+     * Newton corrector on the arclength augmented system.
+     *
+     * @returns the number of iterations used, or -1 if it failed to converge.
+     */
+    int correct(const std::vector<double>& predictor,
+            const std::vector<double>& tangent, std::vector<double>& y);
+
+    /**
+     * the largest eigenvalue real part and the number of complex eigenvalue
+     * pairs with positive real part of the reduced Jacobian at y.
+     */
+    void stability(const std::vector<double>& y, double& maxReal,
+            int& unstablePairs);
+};
+
+} /* namespace rr */
+
+#endif /* RR_CONTINUATION_H_ */
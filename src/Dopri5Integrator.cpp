@@ -0,0 +1,248 @@
+/*
+ * Dopri5Integrator.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "Dopri5Integrator.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+
+#include <algorithm>
+#include <sstream>
+#include <math.h>
+
+using namespace std;
+
+namespace rr
+{
+
+/**
+ * the Dormand-Prince 5(4) coefficients, as in DOPRI5 of Hairer.
+ */
+static const double c2 = 1. / 5.;
+static const double c3 = 3. / 10.;
+static const double c4 = 4. / 5.;
+static const double c5 = 8. / 9.;
+
+static const double a21 = 1. / 5.;
+static const double a31 = 3. / 40.;
+static const double a32 = 9. / 40.;
+static const double a41 = 44. / 45.;
+static const double a42 = -56. / 15.;
+static const double a43 = 32. / 9.;
+static const double a51 = 19372. / 6561.;
+static const double a52 = -25360. / 2187.;
+static const double a53 = 64448. / 6561.;
+static const double a54 = -212. / 729.;
+static const double a61 = 9017. / 3168.;
+static const double a62 = -355. / 33.;
+static const double a63 = 46732. / 5247.;
+static const double a64 = 49. / 176.;
+static const double a65 = -5103. / 18656.;
+static const double a71 = 35. / 384.;
+static const double a73 = 500. / 1113.;
+static const double a74 = 125. / 192.;
+static const double a75 = -2187. / 6784.;
+static const double a76 = 11. / 84.;
+
+/**
+ * difference of the 5th and the embedded 4th order weights.
+ */
+static const double e1 = 71. / 57600.;
+static const double e3 = -71. / 16695.;
+static const double e4 = 71. / 1920.;
+static const double e5 = -17253. / 339200.;
+static const double e6 = 22. / 525.;
+static const double e7 = -1. / 40.;
+
+/**
+ * dense output weights.
+ */
+static const double d1 = -12715105075. / 11282082432.;
+static const double d3 = 87487479700. / 32700410799.;
+static const double d4 = -10690763975. / 1880347072.;
+static const double d5 = 701980252875. / 199316789632.;
+static const double d6 = -1453857185. / 822651844.;
+static const double d7 = 69997945. / 29380423.;
+
+/**
+ * step size control
+ */
+static const double safety = 0.9;
+static const double beta = 0.04;
+static const double expo = 0.2 - beta * 0.75;
+static const double maxIncrease = 10.0;
+static const double maxDecrease = 0.2;
+
+Dopri5Integrator::Dopri5Integrator(ExecutableModel *m,
+        const SimulateOptions *o) :
+        AdaptiveIntegrator(m, o),
+        fsal(false),
+        errprev(1.e-4)
+{
+    Log(Logger::LOG_INFORMATION) << "creating dopri5 integrator";
+
+    ytmp.resize(n);
+    err.resize(n);
+    k.resize(6 * n);
+    cont.resize(5 * n);
+}
+
+Dopri5Integrator::~Dopri5Integrator()
+{
+}
+
+void Dopri5Integrator::beginStep()
+{
+    if (!fsal)
+    {
+        evalRate(t, &y[0], &f0[0]);
+        fsal = true;
+    }
+}
+
+double Dopri5Integrator::attemptStep(double hstep)
+{
+    const double *k1 = &f0[0];
+    double *k2 = &k[0], *k3 = &k[n], *k4 = &k[2 * n], *k5 = &k[3 * n],
+            *k6 = &k[4 * n], *k7 = &k[5 * n];
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + hstep * a21 * k1[i];
+    }
+    evalRate(t + c2 * hstep, &ytmp[0], k2);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + hstep * (a31 * k1[i] + a32 * k2[i]);
+    }
+    evalRate(t + c3 * hstep, &ytmp[0], k3);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + hstep * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+    }
+    evalRate(t + c4 * hstep, &ytmp[0], k4);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + hstep * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i]
+                + a54 * k4[i]);
+    }
+    evalRate(t + c5 * hstep, &ytmp[0], k5);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + hstep * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i]
+                + a64 * k4[i] + a65 * k5[i]);
+    }
+    evalRate(t + hstep, &ytmp[0], k6);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ynew[i] = y[i] + hstep * (a71 * k1[i] + a73 * k3[i] + a74 * k4[i]
+                + a75 * k5[i] + a76 * k6[i]);
+    }
+    evalRate(t + hstep, &ynew[0], k7);
+
+    for (int i = 0; i < n; ++i)
+    {
+        err[i] = hstep * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i]
+                + e6 * k6[i] + e7 * k7[i]);
+    }
+
+    return errorNorm(&err[0]);
+}
+
+double Dopri5Integrator::stepSizeFactor(double h, double e, bool accepted)
+{
+    double fac = pow(e, expo);
+
+    if (!accepted)
+    {
+        return min(1. / maxDecrease, fac / safety);
+    }
+
+    fac = fac / pow(errprev, beta) / safety;
+    fac = max(1. / maxIncrease, min(1. / maxDecrease, fac));
+
+    errprev = max(e, 1.e-4);
+
+    return fac;
+}
+
+void Dopri5Integrator::acceptStep()
+{
+    const double *k1 = &f0[0], *k3 = &k[n], *k4 = &k[2 * n], *k5 = &k[3 * n],
+            *k6 = &k[4 * n], *k7 = &k[5 * n];
+    double *cont1 = &cont[0], *cont2 = &cont[n], *cont3 = &cont[2 * n],
+            *cont4 = &cont[3 * n], *cont5 = &cont[4 * n];
+
+    for (int i = 0; i < n; ++i)
+    {
+        double dy = ynew[i] - yold[i];
+        double bspl = hold * k1[i] - dy;
+
+        cont1[i] = yold[i];
+        cont2[i] = dy;
+        cont3[i] = bspl;
+        cont4[i] = dy - hold * k7[i] - bspl;
+        cont5[i] = hold * (d1 * k1[i] + d3 * k3[i] + d4 * k4[i] + d5 * k5[i]
+                + d6 * k6[i] + d7 * k7[i]);
+    }
+
+    // first same as last
+    std::copy(k7, k7 + n, f0.begin());
+}
+
+void Dopri5Integrator::denseOutput(double s, double* result)
+{
+    const double *cont1 = &cont[0], *cont2 = &cont[n], *cont3 = &cont[2 * n],
+            *cont4 = &cont[3 * n], *cont5 = &cont[4 * n];
+    double s1 = 1. - s;
+
+    for (int i = 0; i < n; ++i)
+    {
+        result[i] = cont1[i] + s * (cont2[i] + s1 * (cont3[i]
+                + s * (cont4[i] + s1 * cont5[i])));
+    }
+}
+
+void Dopri5Integrator::resetHistory()
+{
+    fsal = false;
+    errprev = 1.e-4;
+}
+
+std::string Dopri5Integrator::toRepr() const
+{
+    std::stringstream ss;
+    ss << "< roadrunner.Dopri5Integrator() { 'this' : "
+            << (void*)this << " }>";
+    return ss.str();
+}
+
+std::string Dopri5Integrator::getName() const
+{
+    return "dopri5";
+}
+
+const Dictionary* Dopri5Integrator::getIntegratorOptions()
+{
+    // static instance
+    static SimulateOptions opt;
+
+    // defaults could have changed, so re-load them.
+    opt = SimulateOptions();
+
+    opt.setItem("integrator", "dopri5");
+    opt.setItem("integrator.description", "Dormand-Prince 5(4) explicit "
+            "Runge-Kutta method with dense output, for non stiff models");
+    opt.setItem("integrator.hint", "non stiff models");
+
+    return &opt;
+}
+
+} /* namespace rr */
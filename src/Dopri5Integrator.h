@@ -0,0 +1,119 @@
+/*
+ * Dopri5Integrator.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_DOPRI5INTEGRATOR_H_
+#define RR_DOPRI5INTEGRATOR_H_
+
+#include "AdaptiveIntegrator.h"
+
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+/**
+ * An explicit Runge-Kutta integrator for non stiff models, the 5th order
+ * Dormand-Prince method with an embedded 4th order error estimate and the
+ * 4th order dense output of Hairer, Norsett and Wanner.
+ *
+ * The last stage of a step is the rate at the end of the step (first same
+ * as last), so an accepted step takes six rate evaluations, and output
+ * times and event roots are found on the dense output without extra rate
+ * evaluations. For small non stiff models this has a lower overhead than
+ * the CVODE Adams integrator.
+ */
+class Dopri5Integrator: public AdaptiveIntegrator
+{
+public:
+
+    /**
+     * Creates a new Dopri5Integrator.
+     *
+     * The IntegratorFactory is the ONLY object that creates integrators.
+     *
+     * @param m: a borrowed reference to an existing ExecutableModel object.
+     * @param o: a reference to a SimulatOptions object where the configuration
+     * parameters will be read from.
+     */
+    Dopri5Integrator(ExecutableModel *m, const SimulateOptions *o);
+
+    virtual ~Dopri5Integrator();
+
+    /**
+     * get a short descriptions of this object, compatable with python __repr__.
+     */
+    virtual std::string toRepr() const;
+
+    /**
+     * get the name of this integrator
+     */
+    virtual std::string getName() const;
+
+    /**
+     * list of keys that this integrator supports.
+     *
+     * This method is called by the IntegratorFactory to build a list of
+     * all the options that all the integrators support.
+     */
+    static const Dictionary* getIntegratorOptions();
+
+protected:
+
+    /**
+     * evaluates the rates at (t, y), unless they are the last stage of the
+     * previous step.
+     */
+    virtual void beginStep();
+
+    virtual double attemptStep(double h);
+
+    /**
+     * the PI controller of Gustafsson and Lund.
+     */
+    virtual double stepSizeFactor(double h, double err, bool accepted);
+
+    /**
+     * computes the dense output coefficients, and keeps the last stage as
+     * the first of the next step.
+     */
+    virtual void acceptStep();
+
+    virtual void denseOutput(double s, double* result);
+
+    virtual void resetHistory();
+
+private:
+
+    /**
+     * set if f0 holds the rates at (t, y) from the last stage of the
+     * previous step.
+     */
+    bool fsal;
+
+    /**
+     * the error norm of the last accepted step.
+     */
+    double errprev;
+
+    std::vector<double> ytmp;
+    std::vector<double> err;
+
+    /**
+     * the stages 2 to 7, k[(i - 2) * n ... (i - 1) * n), the first stage is
+     * f0.
+     */
+    std::vector<double> k;
+
+    /**
+     * dense output coefficients.
+     */
+    std::vector<double> cont;
+};
+
+} /* namespace rr */
+
+#endif /* RR_DOPRI5INTEGRATOR_H_ */
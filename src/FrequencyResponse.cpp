@@ -0,0 +1,621 @@
+/*
+ * FrequencyResponse.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "FrequencyResponse.h"
+#include "SBMLSolver.h"
+#include "rrExecutableModel.h"
+#include "rrConstants.h"
+#include "rrLogger.h"
+#include "Tracer.h"
+
+#include <Poco/Environment.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <algorithm>
+#include <complex>
+#include <list>
+#include <stdexcept>
+#include <math.h>
+
+extern "C" {
+#include <clapack/f2c.h>
+#include <clapack/clapack.h>
+}
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using std::string;
+using std::vector;
+using ls::Complex;
+using ls::DoubleMatrix;
+
+namespace rr
+{
+
+/**
+ * y = (10).^ [d1+(0:n-2)*(d2-d1)/(floor(n)-1), d2];
+ *
+ * d1 = starting value (10^d1)
+ * d2 = ending value (10^d2)
+ * n = number of values in the generated series
+ */
+static vector<double> logspace(double startW, double d2, int n)
+{
+    double d1 = 0;
+    vector<double> y(n);
+    for (int i = 0; i <= n - 2; i++)
+    {
+        y[i] = i*(d2 - d1);
+        y[i] = y[i]/(n - 1);
+        y[i] = d1 + y[i];
+        y[i] = pow(10, y[i]) * startW;
+    }
+    y[n - 1] = pow(10, d2)*startW;
+    return y;
+}
+
+static double phaseOf(const Complex& val)
+{
+    if ((std::real(val) == 0.0) && (std::imag(val) == 0.0))
+    {
+        return 0.0;
+    }
+    else
+    {
+        return atan2(std::imag(val), std::real(val));
+    }
+}
+
+/**
+ * the phase is reported in [0, 360) degrees.
+ */
+static double getAdjustment(const Complex& z)
+{
+    return std::imag(z) >= 0 ? 0 : 360;
+}
+
+/**
+ * The factorization shared by all frequencies, J = Q H Q', the
+ * parameter perturbations Q' Nr dv/dp, and the variable rows of L Q.
+ */
+struct HessenbergSystem
+{
+    int n;
+    int numParameters;
+    int numVariables;
+
+    /**
+     * row major, n x n, zero below the first sub diagonal.
+     */
+    vector<double> H;
+
+    /**
+     * row major, n x numParameters.
+     */
+    vector<double> B;
+
+    /**
+     * row major, numVariables x n.
+     */
+    vector<double> C;
+};
+
+/**
+ * solves the system of a range of frequencies.
+ */
+class FrequencyWorker : public Poco::Runnable
+{
+public:
+    FrequencyWorker(const HessenbergSystem& system,
+            const vector<double>& w, int begin, int end,
+            bool useDB, DoubleMatrix& gain, DoubleMatrix& phase) :
+        system(system), w(w), begin(begin), end(end), useDB(useDB),
+        gain(gain), phase(phase)
+    {
+    }
+
+    virtual void run()
+    {
+        try
+        {
+            const int n = system.n;
+            const int np = system.numParameters;
+
+            vector<Complex> A(n * n);
+            vector<Complex> Z(n * np);
+
+            for (int f = begin; f < end; ++f)
+            {
+                solve(w[f], A, Z);
+
+                for (int v = 0; v < system.numVariables; ++v)
+                {
+                    const double* c = &system.C[v * n];
+                    for (int p = 0; p < np; ++p)
+                    {
+                        Complex y(0, 0);
+                        for (int k = 0; k < n; ++k)
+                        {
+                            y += c[k] * Z[k * np + p];
+                        }
+
+                        double g = std::abs(y);
+                        gain(f, v * np + p) = useDB ? 20.0 * log10(g) : g;
+                        phase(f, v * np + p) = (180.0 / M_PI) * phaseOf(y)
+                                + getAdjustment(y);
+                    }
+                }
+            }
+        }
+        catch (std::exception& e)
+        {
+            error = e.what();
+        }
+    }
+
+    string error;
+
+private:
+    const HessenbergSystem& system;
+    const vector<double>& w;
+    int begin;
+    int end;
+    bool useDB;
+    DoubleMatrix& gain;
+    DoubleMatrix& phase;
+
+    /**
+     * Z = (iwI - H)^-1 B, Gaussian elimination with partial pivoting, a
+     * Hessenberg matrix only has one entry to eliminate per column, and
+     * pivoting only swaps adjacent rows, so it stays upper triangular
+     * after the elimination.
+     */
+    void solve(double omega, vector<Complex>& A, vector<Complex>& Z)
+    {
+        const int n = system.n;
+        const int np = system.numParameters;
+
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = std::max(0, i - 1); j < n; ++j)
+            {
+                A[i * n + j] = -system.H[i * n + j];
+            }
+            A[i * n + i] += Complex(0, omega);
+        }
+
+        for (int i = 0; i < n * np; ++i)
+        {
+            Z[i] = system.B[i];
+        }
+
+        for (int k = 0; k < n - 1; ++k)
+        {
+            Complex* rk = &A[k * n];
+            Complex* rk1 = &A[(k + 1) * n];
+
+            if (std::abs(rk1[k]) > std::abs(rk[k]))
+            {
+                std::swap_ranges(rk + k, rk + n, rk1 + k);
+                std::swap_ranges(Z.begin() + k * np, Z.begin() + (k + 1) * np,
+                        Z.begin() + (k + 1) * np);
+            }
+
+            if (rk[k] == Complex(0, 0))
+            {
+                throw std::runtime_error("singular Jacobian in frequency response");
+            }
+
+            Complex l = rk1[k] / rk[k];
+            for (int j = k + 1; j < n; ++j)
+            {
+                rk1[j] -= l * rk[j];
+            }
+            for (int p = 0; p < np; ++p)
+            {
+                Z[(k + 1) * np + p] -= l * Z[k * np + p];
+            }
+        }
+
+        for (int k = n - 1; k >= 0; --k)
+        {
+            const Complex* rk = &A[k * n];
+
+            if (rk[k] == Complex(0, 0))
+            {
+                throw std::runtime_error("singular Jacobian in frequency response");
+            }
+
+            for (int p = 0; p < np; ++p)
+            {
+                Complex s = Z[k * np + p];
+                for (int j = k + 1; j < n; ++j)
+                {
+                    s -= rk[j] * Z[j * np + p];
+                }
+                Z[k * np + p] = s / rk[k];
+            }
+        }
+    }
+};
+
+/**
+ * reduce J to upper Hessenberg form, and return H and the orthogonal Q,
+ * both row major.
+ */
+static void hessenberg(const DoubleMatrix& J, vector<double>& H,
+        vector<double>& Q)
+{
+    integer n = J.numRows();
+    integer ilo = 1, ihi = n, lda = n, info = 0;
+
+    // lapack is column major
+    vector<double> a(n * n);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            a[i + j * n] = J(i, j);
+        }
+    }
+
+    vector<double> tau(std::max<integer>(1, n - 1));
+
+    // workspace query
+    integer lwork = -1;
+    double size = 0;
+    dgehrd_(&n, &ilo, &ihi, &a[0], &lda, &tau[0], &size, &lwork, &info);
+    lwork = std::max<integer>(n, (integer)size);
+    vector<double> work(lwork);
+
+    dgehrd_(&n, &ilo, &ihi, &a[0], &lda, &tau[0], &work[0], &lwork, &info);
+
+    if (info != 0)
+    {
+        throw std::runtime_error("Hessenberg reduction of the Jacobian failed");
+    }
+
+    H.assign(n * n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = std::max(0, i - 1); j < n; ++j)
+        {
+            H[i * n + j] = a[i + j * n];
+        }
+    }
+
+    lwork = -1;
+    dorghr_(&n, &ilo, &ihi, &a[0], &lda, &tau[0], &size, &lwork, &info);
+    lwork = std::max<integer>(n, (integer)size);
+    work.resize(lwork);
+
+    dorghr_(&n, &ilo, &ihi, &a[0], &lda, &tau[0], &work[0], &lwork, &info);
+
+    if (info != 0)
+    {
+        throw std::runtime_error("Hessenberg reduction of the Jacobian failed");
+    }
+
+    Q.resize(n * n);
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            Q[i * n + j] = a[i + j * n];
+        }
+    }
+}
+
+static int indexOf(const vector<string>& ids, const string& id)
+{
+    vector<string>::const_iterator i = std::find(ids.begin(), ids.end(), id);
+    return i == ids.end() ? -1 : i - ids.begin();
+}
+
+FrequencyResponse::FrequencyResponse(SBMLSolver* solver,
+        const Dictionary* options) :
+    solver(solver),
+    useDB(false),
+    useHz(false),
+    steadyState(true),
+    threads(0)
+{
+    if (!solver || !solver->getModel())
+    {
+        throw std::logic_error(gEmptyModelMessage);
+    }
+
+    if (options)
+    {
+        if (options->hasKey("use_db"))
+        {
+            useDB = options->getItem("use_db").convert<bool>();
+        }
+
+        if (options->hasKey("use_hz"))
+        {
+            useHz = options->getItem("use_hz").convert<bool>();
+        }
+
+        if (options->hasKey("steady_state"))
+        {
+            steadyState = options->getItem("steady_state").convert<bool>();
+        }
+
+        if (options->hasKey("threads"))
+        {
+            threads = options->getItem("threads").convert<int>();
+        }
+    }
+}
+
+FrequencyResponse::~FrequencyResponse()
+{
+}
+
+void FrequencyResponse::addParameter(const std::string& id)
+{
+    parameters.push_back(id);
+}
+
+void FrequencyResponse::addVariable(const std::string& id)
+{
+    std::list<string> list;
+    solver->getModel()->getIds(SelectionRecord::FLOATING_AMOUNT, list);
+
+    if (std::find(list.begin(), list.end(), id) == list.end())
+    {
+        throw std::invalid_argument("'" + id + "' is not a floating species");
+    }
+
+    variables.push_back(id);
+}
+
+const std::vector<std::string>& FrequencyResponse::getParameters() const
+{
+    return parameters;
+}
+
+const std::vector<std::string>& FrequencyResponse::getVariables() const
+{
+    return variables;
+}
+
+void FrequencyResponse::run(double startFrequency, int numberOfDecades,
+        int numberOfPoints)
+{
+    RR_TRACE_SCOPE("FrequencyResponse::run", "mca");
+
+    if (numberOfPoints < 1)
+    {
+        throw std::invalid_argument("the number of points must be positive");
+    }
+
+    ExecutableModel* model = solver->getModel();
+    if (!model)
+    {
+        throw std::logic_error(gEmptyModelMessage);
+    }
+
+    std::list<string> list;
+
+    model->getIds(SelectionRecord::FLOATING_AMOUNT, list);
+    vector<string> species(list.begin(), list.end());
+    list.clear();
+
+    model->getIds(SelectionRecord::REACTION_RATE, list);
+    vector<string> reactions(list.begin(), list.end());
+    list.clear();
+
+    runVariables = variables.empty() ? species : variables;
+
+    if (parameters.empty())
+    {
+        model->getIds(SelectionRecord::GLOBAL_PARAMETER, list);
+        runParameters.assign(list.begin(), list.end());
+    }
+    else
+    {
+        runParameters = parameters;
+    }
+
+    if (steadyState && solver->steadyState() > 1E-2)
+    {
+        throw std::runtime_error("Unable to locate steady state during "
+                "frequency response computation");
+    }
+
+    const int numVariables = runVariables.size();
+    const int numParameters = runParameters.size();
+
+    HessenbergSystem system;
+    system.numVariables = numVariables;
+    system.numParameters = numParameters;
+
+    DoubleMatrix Nr = solver->getNrMatrix();
+    DoubleMatrix L = solver->getLinkMatrix();
+    const int n = system.n = Nr.numRows();
+
+    system.B.assign(n * numParameters, 0);
+    system.C.assign(numVariables * n, 0);
+
+    if (n > 0 && reactions.size() > 0)
+    {
+        DoubleMatrix uelast = solver->getUnscaledElasticityMatrix();
+        DoubleMatrix J = mult(mult(Nr, uelast), L);
+
+        vector<double> Q;
+        hessenberg(J, system.H, Q);
+
+        // B = Q' Nr dv/dp
+        DoubleMatrix dvdp(reactions.size(), std::max(1, numParameters));
+        for (unsigned r = 0; r < reactions.size(); ++r)
+        {
+            for (int p = 0; p < numParameters; ++p)
+            {
+                dvdp(r, p) = solver->getUnscaledParameterElasticity(
+                        reactions[r], runParameters[p]);
+            }
+        }
+
+        DoubleMatrix Nrdvdp = mult(Nr, dvdp);
+
+        for (int k = 0; k < n; ++k)
+        {
+            for (int p = 0; p < numParameters; ++p)
+            {
+                double s = 0;
+                for (int i = 0; i < n; ++i)
+                {
+                    s += Q[i * n + k] * Nrdvdp(i, p);
+                }
+                system.B[k * numParameters + p] = s;
+            }
+        }
+
+        // C = the variable rows of L Q
+        for (int v = 0; v < numVariables; ++v)
+        {
+            int row = indexOf(species, runVariables[v]);
+            if (row < 0)
+            {
+                throw std::invalid_argument("'" + runVariables[v]
+                        + "' is not a floating species");
+            }
+
+            for (int k = 0; k < n; ++k)
+            {
+                double s = 0;
+                for (int i = 0; i < n; ++i)
+                {
+                    s += L(row, i) * Q[i * n + k];
+                }
+                system.C[v * n + k] = s;
+            }
+        }
+    }
+    else
+    {
+        system.n = 0;
+    }
+
+    vector<double> w = logspace(startFrequency, numberOfDecades, numberOfPoints);
+
+    gain.resize(numberOfPoints, numVariables * numParameters);
+    phase.resize(numberOfPoints, numVariables * numParameters);
+
+    vector<string> names;
+    for (int v = 0; v < numVariables; ++v)
+    {
+        for (int p = 0; p < numParameters; ++p)
+        {
+            names.push_back(runVariables[v] + "/" + runParameters[p]);
+        }
+    }
+    gain.setColNames(names);
+    phase.setColNames(names);
+
+    int nThreads = threads > 0 ? threads : Poco::Environment::processorCount();
+    nThreads = std::max(1, std::min(nThreads, numberOfPoints));
+
+    vector<FrequencyWorker*> workers;
+    for (int i = 0; i < nThreads; ++i)
+    {
+        int begin = (long)numberOfPoints * i / nThreads;
+        int end = (long)numberOfPoints * (i + 1) / nThreads;
+        workers.push_back(new FrequencyWorker(system, w, begin, end, useDB,
+                gain, phase));
+    }
+
+    if (nThreads == 1)
+    {
+        workers[0]->run();
+    }
+    else
+    {
+        Poco::Thread* pool = new Poco::Thread[nThreads];
+        for (int i = 0; i < nThreads; ++i)
+        {
+            pool[i].start(*workers[i]);
+        }
+        for (int i = 0; i < nThreads; ++i)
+        {
+            pool[i].join();
+        }
+        delete[] pool;
+    }
+
+    string error;
+    for (int i = 0; i < nThreads; ++i)
+    {
+        if (error.empty())
+        {
+            error = workers[i]->error;
+        }
+        delete workers[i];
+    }
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+
+    frequencies.resize(numberOfPoints);
+    for (int i = 0; i < numberOfPoints; ++i)
+    {
+        // convert to Hz by dividing by 2Pi, or leave as rad/sec
+        frequencies[i] = useHz ? w[i] / (2. * M_PI) : w[i];
+    }
+
+    Log(Logger::LOG_DEBUG) << "frequency response of " << numVariables
+            << " variables to " << numParameters << " parameters at "
+            << numberOfPoints << " frequencies using " << nThreads
+            << " threads";
+}
+
+const std::vector<double>& FrequencyResponse::getFrequencies() const
+{
+    return frequencies;
+}
+
+const ls::DoubleMatrix& FrequencyResponse::getGain() const
+{
+    return gain;
+}
+
+const ls::DoubleMatrix& FrequencyResponse::getPhase() const
+{
+    return phase;
+}
+
+ls::DoubleMatrix FrequencyResponse::getResponse(const std::string& variable,
+        const std::string& parameter) const
+{
+    int v = indexOf(runVariables, variable);
+    int p = indexOf(runParameters, parameter);
+
+    if (v < 0 || p < 0)
+    {
+        throw std::invalid_argument("the frequency response of '" + variable
+                + "' to '" + parameter + "' was not computed");
+    }
+
+    int column = v * runParameters.size() + p;
+
+    DoubleMatrix result(frequencies.size(), 3);
+    for (unsigned i = 0; i < frequencies.size(); ++i)
+    {
+        result(i, 0) = frequencies[i];
+        result(i, 1) = gain(i, column);
+        result(i, 2) = phase(i, column);
+    }
+    return result;
+}
+
+} /* namespace rr */
@@ -0,0 +1,136 @@
+/*
+ * FrequencyResponse.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_FREQUENCYRESPONSE_H_
+#define RR_FREQUENCYRESPONSE_H_
+
+#include "rrExporter.h"
+#include "Dictionary.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class SBMLSolver;
+
+/**
+ * Frequency response of the floating species to sinusoidal perturbations
+ * of parameters, linearized around the steady state.
+ *
+ * The response of the species to a parameter p at the angular frequency w
+ * is
+ *
+ * L (iwI - J)^-1 Nr dv/dp,
+ *
+ * where J = Nr E L is the reduced Jacobian, E the unscaled elasticities, L
+ * the link matrix and Nr the reduced stoichiometry matrix. J is reduced
+ * once to upper Hessenberg form, J = Q H Q', so each frequency only needs
+ * the solution of the Hessenberg system (iwI - H) Z = Q' Nr dv/dp, which
+ * takes O(N^2) per parameter, instead of inverting a dense complex matrix.
+ * All parameters share the same factorization, and the frequencies are
+ * distributed over a number of worker threads.
+ *
+ * The following options are recognized:
+ *
+ * use_db: report the gain in decibel, default false.
+ *
+ * use_hz: report the frequencies in Hz instead of rad/s, default false.
+ *
+ * steady_state: compute the steady state of the solver before the
+ * linearization, default true. If false, the current state is used.
+ *
+ * threads: number of worker threads, default 0, the number of cpus.
+ */
+class RR_DECLSPEC FrequencyResponse
+{
+public:
+
+    /**
+     * The solver is borrowed, it is brought to its steady state, if
+     * the steady_state option is set, when run is called.
+     *
+     * @throws std::logic_error if no model is loaded.
+     */
+    FrequencyResponse(SBMLSolver* solver, const Dictionary* options = 0);
+
+    ~FrequencyResponse();
+
+    /**
+     * add a perturbed parameter. If none are added, all global parameters
+     * are used.
+     */
+    void addParameter(const std::string& id);
+
+    /**
+     * add a floating species whose response is computed. If none are
+     * added, all floating species are used.
+     */
+    void addVariable(const std::string& id);
+
+    const std::vector<std::string>& getParameters() const;
+
+    const std::vector<std::string>& getVariables() const;
+
+    /**
+     * compute the responses of all variables to all parameters at
+     * numberOfPoints logarithmically spaced angular frequencies, from
+     * startFrequency to startFrequency * 10^numberOfDecades.
+     *
+     * @throws std::runtime_error if no steady state is found, or the
+     * Jacobian is singular at one of the frequencies.
+     */
+    void run(double startFrequency, int numberOfDecades, int numberOfPoints);
+
+    /**
+     * the frequencies of the last run, in rad/s or Hz.
+     */
+    const std::vector<double>& getFrequencies() const;
+
+    /**
+     * the gains, one row per frequency and one column per variable and
+     * parameter pair, variable major, labeled "variable/parameter".
+     */
+    const ls::DoubleMatrix& getGain() const;
+
+    /**
+     * the phases in degrees, in the same layout as getGain.
+     */
+    const ls::DoubleMatrix& getPhase() const;
+
+    /**
+     * the response of a single pair, one row per frequency, with the
+     * frequency, the gain and the phase, the same as
+     * SBMLSolver::getFrequencyResponse returns.
+     */
+    ls::DoubleMatrix getResponse(const std::string& variable,
+            const std::string& parameter) const;
+
+private:
+    SBMLSolver* solver;
+    bool useDB;
+    bool useHz;
+    bool steadyState;
+    int threads;
+
+    std::vector<std::string> parameters;
+    std::vector<std::string> variables;
+
+    std::vector<double> frequencies;
+    ls::DoubleMatrix gain;
+    ls::DoubleMatrix phase;
+
+    /**
+     * the parameters and variables of the last run.
+     */
+    std::vector<std::string> runParameters;
+    std::vector<std::string> runVariables;
+};
+
+} /* namespace rr */
+
+#endif /* RR_FREQUENCYRESPONSE_H_ */
@@ -9,6 +9,7 @@
 #include "rrUtils.h"
 #include "rrLogger.h"
 #include "rrConfig.h"
+#include "StateSaving.h"
 
 #include <cstring>
 #include <assert.h>
@@ -16,6 +17,7 @@
 #include <exception>
 #include <ctime>
 #include <limits>
+#include <sstream>
 
 using namespace std;
 
@@ -50,7 +52,9 @@ GillespieIntegrator::GillespieIntegrator(ExecutableModel* m,
         stoichRows(0),
         stoichCols(0),
         stoichData(0),
-        seed(defaultSeed()) // default value for mersene twister
+        seed(defaultSeed()), // default value for mersene twister
+        reactionFirings(0),
+        propensityEvaluations(0)
 {
     if (o)
     {
@@ -164,6 +168,7 @@ double GillespieIntegrator::integrate(double t, double hstep)
 
         // get the 'propensity' -- reaction rates
         model->getReactionRates(nReactions, 0, reactionRates);
+        ++propensityEvaluations;
 
         // sum the propensity
         for (int k = 0; k < nReactions; k++)
@@ -208,6 +213,8 @@ double GillespieIntegrator::integrate(double t, double hstep)
 
         assert(reaction >= 0 && reaction < nReactions);
 
+        ++reactionFirings;
+
         // update chemical species
         // if rate is negative, means reaction goes in reverse, so
         // multiply by sign
@@ -247,6 +254,29 @@ IntegratorListenerPtr GillespieIntegrator::getListener()
     return IntegratorListenerPtr();
 }
 
+void GillespieIntegrator::saveState(std::ostream& out) const
+{
+    std::stringstream ss;
+    ss << engine;
+
+    saveBinary(out, (uint64_t)seed);
+    saveBinary(out, ss.str());
+}
+
+void GillespieIntegrator::loadState(std::istream& in)
+{
+    uint64_t s;
+    std::string str;
+
+    loadBinary(in, s);
+    loadBinary(in, str);
+
+    seed = (unsigned long)s;
+
+    std::stringstream ss(str);
+    ss >> engine;
+}
+
 double GillespieIntegrator::urand()
 {
     return (double) engine() / (double) engine.max();
@@ -305,6 +335,14 @@ Variant GillespieIntegrator::getItem(const std::string& key) const
         GillespieIntegrator *pthis = const_cast<GillespieIntegrator*>(this);
         return Variant(pthis->urand());
     }
+    else if(key == "NumReactionFirings")
+    {
+        return Variant(reactionFirings);
+    }
+    else if(key == "NumPropensityEvals")
+    {
+        return Variant(propensityEvaluations);
+    }
 
     std::string err = "invalid key: \"";
     err += key;
@@ -314,7 +352,8 @@ Variant GillespieIntegrator::getItem(const std::string& key) const
 
 bool GillespieIntegrator::hasKey(const std::string& key) const
 {
-    return key == "seed" || key == "rand";
+    return key == "seed" || key == "rand" || key == "NumReactionFirings"
+            || key == "NumPropensityEvals";
 }
 
 int GillespieIntegrator::deleteItem(const std::string& key)
@@ -330,6 +369,18 @@ std::vector<std::string> GillespieIntegrator::getKeys() const
     return result;
 }
 
+void GillespieIntegrator::getStatistics(BasicDictionary& stats) const
+{
+    stats.setItem("NumReactionFirings", reactionFirings);
+    stats.setItem("NumPropensityEvals", propensityEvaluations);
+}
+
+void GillespieIntegrator::resetStatistics()
+{
+    reactionFirings = 0;
+    propensityEvaluations = 0;
+}
+
 unsigned long GillespieIntegrator::getSeed() const
 {
     return seed;
@@ -53,6 +53,16 @@ public:
      */
     virtual IntegratorListenerPtr getListener();
 
+    /**
+     * save the seed and the random engine state.
+     */
+    virtual void saveState(std::ostream& out) const;
+
+    /**
+     * restore the seed and the random engine state.
+     */
+    virtual void loadState(std::istream& in);
+
     /**
      * implement dictionary interface
      */
@@ -66,6 +76,15 @@ public:
 
     virtual std::vector<std::string> getKeys() const;
 
+    /**
+     * adds the read only items NumReactionFirings, the number of reaction
+     * events simulated, and NumPropensityEvals, the number of reaction
+     * rate evaluations.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    virtual void resetStatistics();
+
     /**
      * get a description of this object, compatable with python __str__
      */
@@ -123,6 +142,9 @@ private:
 
     unsigned long seed;
 
+    int64_t reactionFirings;
+    int64_t propensityEvaluations;
+
     /**
      * set the seed into the random engine.
      */
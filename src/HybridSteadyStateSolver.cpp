@@ -0,0 +1,310 @@
+#pragma hdrstop
+#include "HybridSteadyStateSolver.h"
+#include "rrNLEQInterface.h"
+#include "Integrator.h"
+#include "SBMLSolverOptions.h"
+#include "rrException.h"
+#include "rrLogger.h"
+#include "Tracer.h"
+
+#include <memory>
+#include <sstream>
+#include <math.h>
+
+using namespace std;
+
+namespace rr
+{
+
+static const char* keys[] =
+{
+        "initialDuration",
+        "durationGrowth",
+        "maxAttempts",
+        "tolerance"
+};
+
+/**
+ * the number of rhs evaluations of a cvode integrator, zero for other
+ * integrators.
+ */
+static int64_t integratorRhsEvaluations(const Integrator* integrator)
+{
+    if (integrator->hasKey("NumRhsEvals"))
+    {
+        return integrator->getItem("NumRhsEvals").convert<int64_t>();
+    }
+    return 0;
+}
+
+HybridSteadyStateSolver::HybridSteadyStateSolver(ExecutableModel *model,
+        const Dictionary* options) :
+        model(model),
+        initialDuration(1.0),
+        durationGrowth(10.0),
+        maxAttempts(10),
+        tolerance(1.e-6),
+        timeIntegrated(0),
+        integrationRounds(0),
+        newtonAttempts(0),
+        rhsEvaluations(0)
+{
+    const SimulateOptions* simulateOptions =
+            dynamic_cast<const SimulateOptions*>(options);
+
+    if (simulateOptions && IntegratorFactory::getIntegratorType(
+            simulateOptions->integrator) != Integrator::STOCHASTIC)
+    {
+        integratorOptions = *simulateOptions;
+    }
+    else
+    {
+        integratorOptions.integrator = Integrator::CVODE;
+        integratorOptions.integratorFlags |= Integrator::STIFF;
+    }
+
+    if (options)
+    {
+        for (unsigned i = 0; i < sizeof(keys) / sizeof(char*); ++i)
+        {
+            if (options->hasKey(keys[i]))
+            {
+                setItem(keys[i], options->getItem(keys[i]));
+            }
+        }
+    }
+}
+
+HybridSteadyStateSolver::~HybridSteadyStateSolver()
+{
+}
+
+double HybridSteadyStateSolver::rateNorm()
+{
+    int n = model->getStateVector(0);
+    vector<double> rates(n);
+
+    if (n)
+    {
+        model->getStateVectorRate(model->getTime(), 0, &rates[0]);
+    }
+    ++rhsEvaluations;
+
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        sum += rates[i] * rates[i];
+    }
+    return sqrt(sum);
+}
+
+bool HybridSteadyStateSolver::tryNewton(const std::vector<double>& yin)
+{
+    RR_TRACE_SCOPE("HybridSteadyStateSolver::newton", "steadystate");
+
+    vector<double> saved(model->getStateVector(0));
+    if (saved.size())
+    {
+        model->getStateVector(&saved[0]);
+    }
+
+    ++newtonAttempts;
+
+    NLEQInterface nleq(model);
+    bool converged = false;
+
+    try
+    {
+        converged = nleq.solve(yin) < tolerance;
+    }
+    catch (NLEQException& e)
+    {
+        Log(Logger::LOG_DEBUG) << "Hybrid steady state, NLEQ attempt "
+                << newtonAttempts << " failed: " << e.Message();
+    }
+
+    rhsEvaluations += nleq.getNumberOfModelEvaluations()
+            + nleq.getNumberOfModelEvaluationsForJacobian();
+
+    // NLEQ leaves the model at its last trial point, check that
+    // the state it stopped at actually is a steady state.
+    converged = converged && rateNorm() < tolerance;
+
+    if (!converged && saved.size())
+    {
+        model->setStateVector(&saved[0]);
+    }
+
+    return converged;
+}
+
+double HybridSteadyStateSolver::solve(const std::vector<double>& yin)
+{
+    timeIntegrated = 0;
+    integrationRounds = 0;
+    newtonAttempts = 0;
+    rhsEvaluations = 0;
+
+    double norm = rateNorm();
+
+    if (norm < tolerance)
+    {
+        return norm;
+    }
+
+    if (tryNewton(yin))
+    {
+        return rateNorm();
+    }
+
+    const double savedTime = model->getTime();
+
+    auto_ptr<Integrator> integrator(IntegratorFactory::New(&integratorOptions,
+            model));
+    integrator->restart(savedTime);
+
+    double t = savedTime;
+    double duration = initialDuration;
+    int64_t cvodeRhs = 0;
+
+    for (int i = 0; i < maxAttempts; ++i)
+    {
+        {
+            RR_TRACE_SCOPE("HybridSteadyStateSolver::integrate", "steadystate");
+            t = integrator->integrate(t, duration);
+        }
+        timeIntegrated += duration;
+        ++integrationRounds;
+
+        // the integrator counts are cumulative, only count what was
+        // added by this round.
+        int64_t nfevals = integratorRhsEvaluations(integrator.get());
+        rhsEvaluations += nfevals - cvodeRhs;
+        cvodeRhs = nfevals;
+
+        norm = rateNorm();
+
+        Log(Logger::LOG_DEBUG) << "Hybrid steady state, integrated to " << t
+                << ", rate norm: " << norm;
+
+        if (norm < tolerance || tryNewton(yin))
+        {
+            model->setTime(savedTime);
+            return rateNorm();
+        }
+
+        // NLEQ may have moved the state, continue integrating from where
+        // the integrator left off.
+        integrator->restart(t);
+
+        duration *= durationGrowth;
+    }
+
+    model->setTime(savedTime);
+
+    std::stringstream ss;
+    ss << "Hybrid steady state solver did not converge after integrating for "
+            << timeIntegrated << " time units and " << newtonAttempts
+            << " Newton attempts";
+    throw NLEQException(ss.str());
+}
+
+void HybridSteadyStateSolver::getStatistics(BasicDictionary& stats) const
+{
+    stats.setItem("timeIntegrated", timeIntegrated);
+    stats.setItem("integrationRounds", integrationRounds);
+    stats.setItem("newtonAttempts", newtonAttempts);
+    stats.setItem("rhsEvaluations", rhsEvaluations);
+}
+
+void HybridSteadyStateSolver::setItem(const std::string& key,
+        const rr::Variant& value)
+{
+    if (key == "initialDuration")
+    {
+        initialDuration = value.convert<double>();
+    }
+    else if (key == "durationGrowth")
+    {
+        durationGrowth = value.convert<double>();
+    }
+    else if (key == "maxAttempts")
+    {
+        maxAttempts = value.convert<int>();
+    }
+    else if (key == "tolerance")
+    {
+        tolerance = value.convert<double>();
+    }
+    else
+    {
+        throw std::invalid_argument("invalid key: " + key);
+    }
+}
+
+Variant HybridSteadyStateSolver::getItem(const std::string& key) const
+{
+    if (key == "initialDuration")
+    {
+        return initialDuration;
+    }
+    else if (key == "durationGrowth")
+    {
+        return durationGrowth;
+    }
+    else if (key == "maxAttempts")
+    {
+        return maxAttempts;
+    }
+    else if (key == "tolerance")
+    {
+        return tolerance;
+    }
+    throw std::invalid_argument("invalid key: " + key);
+}
+
+bool HybridSteadyStateSolver::hasKey(const std::string& key) const
+{
+    return key == "initialDuration" || key == "durationGrowth"
+            || key == "maxAttempts" || key == "tolerance";
+}
+
+int HybridSteadyStateSolver::deleteItem(const std::string& key)
+{
+    return -1;
+}
+
+std::vector<std::string> HybridSteadyStateSolver::getKeys() const
+{
+    return std::vector<std::string>(&keys[0], &keys[sizeof(keys)/sizeof(char*)]);
+}
+
+const Dictionary* HybridSteadyStateSolver::getSteadyStateOptions()
+{
+    static BasicDictionary dict;
+
+    dict.setItem("steadyState", "Hybrid");
+    dict.setItem("steadyState.hint", "Alternate time integration and NLEQ");
+    dict.setItem("steadyState.description", "Integrates the model for geometrically "
+            "growing durations, trying NLEQ after each integration, until a "
+            "steady state is found.");
+
+    dict.setItem("initialDuration", 1.0);
+    dict.setItem("durationGrowth", 10.0);
+    dict.setItem("maxAttempts", 10);
+    dict.setItem("tolerance", 1.e-6);
+
+    dict.setItem("initialDuration.description", "duration of the first integration");
+    dict.setItem("durationGrowth.description", "factor the integration duration grows by after each attempt");
+    dict.setItem("maxAttempts.description", "maximum number of integration rounds");
+    dict.setItem("tolerance.description", "steady state tolerance on the 2-norm of the state vector rate");
+
+    dict.setItem("initialDuration.hint", "first integration duration");
+    dict.setItem("durationGrowth.hint", "integration duration growth factor");
+    dict.setItem("maxAttempts.hint", "maximum integration rounds");
+    dict.setItem("tolerance.hint", "rate norm tolerance");
+
+    return &dict;
+}
+
+} /* namespace rr */
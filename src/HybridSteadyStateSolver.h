@@ -0,0 +1,133 @@
+/*
+ * HybridSteadyStateSolver.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_HYBRIDSTEADYSTATESOLVER_H_
+#define RR_HYBRIDSTEADYSTATESOLVER_H_
+
+#include "rrSteadyStateSolver.h"
+#include "SBMLSolverOptions.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+/**
+ * A steady state solver which alternates time integration and Newton
+ * iteration.
+ *
+ * NLEQ frequently fails when the initial state is far from the steady
+ * state. This solver first tries NLEQ from the current state. If that
+ * fails, the model is integrated with CVODE for an initial duration, and
+ * NLEQ is tried again from the integrated state, with the integration
+ * duration growing geometrically between attempts. The solver stops at the
+ * first state where the norm of the state vector rate is below the
+ * tolerance, whether it was reached by the integrator or by NLEQ.
+ *
+ * The model time is restored after the solve, the state is left at the
+ * steady state.
+ *
+ * If the options are a SimulateOptions, the integration uses its
+ * integrator, tolerances and integrator options, SBMLSolver::steadyState
+ * passes its simulate options with the steady state options set on top.
+ * Otherwise, or if the integrator is stochastic, a stiff CVODE integrator
+ * with the default tolerances is used.
+ *
+ * Options:
+ *
+ * initialDuration: duration of the first integration, default 1.
+ *
+ * durationGrowth: factor the duration grows by after each attempt, default 10.
+ *
+ * maxAttempts: maximum number of integration rounds, default 10.
+ *
+ * tolerance: the steady state is accepted when the 2-norm of the state
+ * vector rate is smaller than this, default 1e-6.
+ *
+ * Statistics, available through getStatistics after a solve:
+ *
+ * timeIntegrated: total simulation time integrated.
+ *
+ * integrationRounds: number of integration rounds.
+ *
+ * newtonAttempts: number of NLEQ attempts.
+ *
+ * rhsEvaluations: number of model rate evaluations by the integrator, NLEQ
+ * and the convergence checks.
+ */
+class RR_DECLSPEC HybridSteadyStateSolver : public SteadyStateSolver
+{
+public:
+
+    HybridSteadyStateSolver(ExecutableModel *model, const Dictionary* options = 0);
+
+    ~HybridSteadyStateSolver();
+
+    /**
+     * find the steady state starting from the current model state.
+     *
+     * @return the 2-norm of the state vector rate at the steady state.
+     * @throws NLEQException if no steady state was found within maxAttempts.
+     */
+    double solve(const std::vector<double>& yin);
+
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    /**
+     * Implement Dictionary Interface
+     */
+    virtual void setItem(const std::string& key, const rr::Variant& value);
+
+    virtual Variant getItem(const std::string& key) const;
+
+    virtual bool hasKey(const std::string& key) const;
+
+    virtual int deleteItem(const std::string& key);
+
+    virtual std::vector<std::string> getKeys() const;
+
+    /**
+     * list of keys that this solver supports.
+     */
+    static const Dictionary* getSteadyStateOptions();
+
+private:
+
+    ExecutableModel *model;
+
+    /**
+     * the options the integrator is created with.
+     */
+    SimulateOptions integratorOptions;
+
+    double initialDuration;
+    double durationGrowth;
+    int maxAttempts;
+    double tolerance;
+
+    double timeIntegrated;
+    int integrationRounds;
+    int newtonAttempts;
+    int64_t rhsEvaluations;
+
+    /**
+     * 2-norm of the current state vector rate, this is the convergence
+     * criterion, and is only a single model evaluation.
+     */
+    double rateNorm();
+
+    /**
+     * run NLEQ from the current state. If it fails, the state is reset to
+     * what it was before the attempt.
+     *
+     * @returns true if NLEQ converged to a state that satisfies the tolerance.
+     */
+    bool tryNewton(const std::vector<double>& yin);
+};
+
+} /* namespace rr */
+
+#endif /* RR_HYBRIDSTEADYSTATESOLVER_H_ */
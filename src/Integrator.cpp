@@ -10,6 +10,8 @@
 #include "GillespieIntegrator.h"
 #include "RK4Integrator.h"
 #include "EulerIntegrator.h"
+#include "RosenbrockIntegrator.h"
+#include "Dopri5Integrator.h"
 #include "rrStringUtils.h"
 
 namespace rr
@@ -19,7 +21,23 @@ namespace rr
  * list of interator names, the index should correspond to the
  * Integrator::IntegratorId enum.
  */
-static const char* integratorNames[] = {"cvode", "gillespie", "rk4", "euler"};
+static const char* integratorNames[] = {"cvode", "gillespie", "rk4", "euler",
+        "rosenbrock", "dopri5"};
+
+void Integrator::sample(double t0, double hstep, int count,
+        IntegratorSampleListener& listener)
+{
+    for (int i = 1; i <= count; ++i)
+    {
+        integrate(t0 + (i - 1) * hstep, hstep);
+
+        // the test suite is extremly sensetive to time differences,
+        // so need to use the *exact* time here. occasionally the integrator
+        // will return a value just slightly off from the exact time
+        // value.
+        listener.onSample(i, t0 + i * hstep);
+    }
+}
 
 Integrator* IntegratorFactory::New(const Dictionary* dict, ExecutableModel* m)
 {
@@ -42,6 +60,14 @@ Integrator* IntegratorFactory::New(const Dictionary* dict, ExecutableModel* m)
     {
         result = new EulerIntegrator(m, opt);
     }
+    else if(opt->integrator == Integrator::ROSENBROCK)
+    {
+        result = new RosenbrockIntegrator(m, opt);
+    }
+    else if(opt->integrator == Integrator::DOPRI5)
+    {
+        result = new Dopri5Integrator(m, opt);
+    }
     else
     {
         result = new CVODEIntegrator(m, opt);
@@ -62,7 +88,9 @@ std::vector<const Dictionary*> IntegratorFactory::getIntegratorOptions()
             CVODEIntegrator::getIntegratorOptions(),
             GillespieIntegrator::getIntegratorOptions(),
             RK4Integrator::getIntegratorOptions(),
-            EulerIntegrator::getIntegratorOptions()
+            EulerIntegrator::getIntegratorOptions(),
+            RosenbrockIntegrator::getIntegratorOptions(),
+            Dopri5Integrator::getIntegratorOptions()
     };
     return std::vector<const Dictionary*>(&options[0],
             &options[Integrator::INTEGRATOR_END]);
@@ -82,6 +110,10 @@ const Dictionary* IntegratorFactory::getIntegratorOptions(
         return RK4Integrator::getIntegratorOptions();
     case Integrator::EULER:
         return EulerIntegrator::getIntegratorOptions();
+    case Integrator::ROSENBROCK:
+        return RosenbrockIntegrator::getIntegratorOptions();
+    case Integrator::DOPRI5:
+        return Dopri5Integrator::getIntegratorOptions();
     default:
         throw std::invalid_argument("invalid integrator name");
 
@@ -91,7 +123,8 @@ const Dictionary* IntegratorFactory::getIntegratorOptions(
 Integrator::IntegratorType IntegratorFactory::getIntegratorType(
         Integrator::IntegratorId i)
 {
-    if (i == Integrator::CVODE || i == Integrator::RK4 || i == Integrator::EULER) {
+    if (i == Integrator::CVODE || i == Integrator::RK4 || i == Integrator::EULER
+            || i == Integrator::ROSENBROCK || i == Integrator::DOPRI5) {
         return Integrator::DETERMINISTIC;
     } else {
         return Integrator::STOCHASTIC;
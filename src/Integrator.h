@@ -13,6 +13,7 @@
 #include "Dictionary.h"
 #include "tr1proxy/rr_memory.h"
 #include <stdexcept>
+#include <iostream>
 
 
 namespace rr
@@ -58,6 +59,23 @@ public:
  */
 typedef cxx11_ns::shared_ptr<IntegratorListener> IntegratorListenerPtr;
 
+/**
+ * Receives the output points of a fixed step simulation, see
+ * Integrator::sample.
+ */
+class IntegratorSampleListener
+{
+public:
+
+    /**
+     * is called with the model time and state set to the index'th output
+     * time.
+     */
+    virtual void onSample(int index, double time) = 0;
+
+    virtual ~IntegratorSampleListener() {};
+};
+
 class SimulateOptions;
 
 /**
@@ -86,6 +104,17 @@ public:
      */
     virtual double integrate(double t0, double hstep) = 0;
 
+    /**
+     * integrates the model from t0 through the output times t0 + i * hstep,
+     * i = 1 ... count, and calls listener.onSample for each of them.
+     *
+     * The default calls integrate for each output time, integrators with a
+     * dense output may fill all the output times within each internal
+     * step instead.
+     */
+    virtual void sample(double t0, double hstep, int count,
+            IntegratorSampleListener& listener);
+
     /**
      * copies the state vector out of the model and into cvode vector,
      * re-initializes cvode.
@@ -118,6 +147,35 @@ public:
      */
     virtual std::string getName() const = 0;
 
+    /**
+     * write any integrator state which is not re-created by restart,
+     * such as the state of a random number generator, to a binary stream.
+     *
+     * Most integrators re-initialize everything they need from the model
+     * in restart, so the default does nothing.
+     */
+    virtual void saveState(std::ostream& out) const {};
+
+    /**
+     * restore the state written by saveState.
+     */
+    virtual void loadState(std::istream& in) {};
+
+    /**
+     * add the performance counters of this integrator to stats, such as the
+     * number of steps and right hand side evaluations since the integrator
+     * was created or resetStatistics was called.
+     *
+     * The available keys depend on the integrator, the same values are also
+     * available as read only items through getItem.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const {};
+
+    /**
+     * zero the performance counters.
+     */
+    virtual void resetStatistics() {};
+
     /**
      * this is an interface, provide virtual dtor as instances are
      * returned from New which must be deleted.
@@ -154,6 +212,18 @@ public:
          */
         EULER,
 
+        /**
+         * RODAS4 linearly implicit Rosenbrock integrator with dense
+         * output, for small and medium sized stiff models.
+         */
+        ROSENBROCK,
+
+        /**
+         * Dormand-Prince 5(4) explicit Runge-Kutta integrator with dense
+         * output, for non stiff models.
+         */
+        DOPRI5,
+
         /**
          * Always has to be at the end, this way, this value indicates
          * how many integrators we have.
@@ -0,0 +1,177 @@
+/*
+ * OutputThinning.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "OutputThinning.h"
+#include "TrajectoryFile.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+using namespace std;
+
+namespace rr
+{
+
+/**
+ * the variable step integrators return a row just before and a row at the
+ * time of an event.
+ */
+static bool sameTime(double a, double b)
+{
+    static const double epsilon = std::numeric_limits<double>::epsilon();
+    return fabs(b - a) <= 4. * epsilon * max(1., max(fabs(a), fabs(b)));
+}
+
+OutputThinning::OutputThinning(const SimulateOptions& opt,
+        const std::vector<SelectionRecord>& selections,
+        TrajectoryWriter* output) :
+        mode(opt.thinning),
+        absolute(max(opt.thinningAbsolute, 0.)),
+        relative(max(opt.thinningRelative, 0.)),
+        columns(selections.size()),
+        output(output),
+        anchor(selections.size()),
+        anchorTime(0),
+        pending(selections.size()),
+        pendingTime(0),
+        havePending(false),
+        lower(selections.size()),
+        upper(selections.size()),
+        rows(0),
+        keptRows(0)
+{
+    for (int i = 0; i < columns; ++i)
+    {
+        if (selections[i].selectionType != SelectionRecord::TIME)
+        {
+            compare.push_back(i);
+        }
+    }
+}
+
+void OutputThinning::add(const std::vector<double>& row, double t)
+{
+    rows++;
+
+    if (keptRows == 0 || mode == SimulateOptions::THINNING_NONE)
+    {
+        keep(&row[0], t);
+        return;
+    }
+
+    // keep both rows around an event
+    if (havePending && sameTime(pendingTime, t))
+    {
+        keep(&pending[0], pendingTime);
+        keep(&row[0], t);
+        return;
+    }
+
+    if (sameTime(anchorTime, t))
+    {
+        keep(&row[0], t);
+        return;
+    }
+
+    if (mode == SimulateOptions::THINNING_CHANGE)
+    {
+        for (std::vector<int>::const_iterator i = compare.begin();
+                i != compare.end(); ++i)
+        {
+            if (!(fabs(row[*i] - anchor[*i]) <= tolerance(anchor[*i])))
+            {
+                keep(&row[0], t);
+                return;
+            }
+        }
+    }
+    else if (havePending)
+    {
+        const double dt = t - anchorTime;
+        bool inside = true;
+
+        for (std::vector<int>::const_iterator i = compare.begin();
+                i != compare.end() && inside; ++i)
+        {
+            double slope = (row[*i] - anchor[*i]) / dt;
+            inside = slope >= lower[*i] && slope <= upper[*i];
+        }
+
+        if (inside)
+        {
+            for (std::vector<int>::const_iterator i = compare.begin();
+                    i != compare.end(); ++i)
+            {
+                double tol = tolerance(row[*i]);
+                lower[*i] = max(lower[*i], (row[*i] - tol - anchor[*i]) / dt);
+                upper[*i] = min(upper[*i], (row[*i] + tol - anchor[*i]) / dt);
+            }
+        }
+        else
+        {
+            keep(&pending[0], pendingTime);
+            resetBounds(&row[0], t);
+        }
+    }
+    else
+    {
+        resetBounds(&row[0], t);
+    }
+
+    std::copy(row.begin(), row.end(), pending.begin());
+    pendingTime = t;
+    havePending = true;
+}
+
+void OutputThinning::getResult(ls::DoubleMatrix& result)
+{
+    if (havePending)
+    {
+        keep(&pending[0], pendingTime);
+    }
+
+    const int resultRows = output ? 0 : keptRows;
+    result.resize(resultRows, columns);
+
+    for (int i = 0; i < resultRows && columns > 0; ++i)
+    {
+        const double *row = &kept[i * columns];
+        std::copy(row, row + columns, result[i]);
+    }
+}
+
+void OutputThinning::keep(const double* row, double t)
+{
+    if (output)
+    {
+        output->write(row);
+    }
+    else
+    {
+        kept.insert(kept.end(), row, row + columns);
+    }
+
+    std::copy(row, row + columns, anchor.begin());
+    anchorTime = t;
+    havePending = false;
+    keptRows++;
+}
+
+void OutputThinning::resetBounds(const double* row, double t)
+{
+    const double dt = t - anchorTime;
+
+    for (std::vector<int>::const_iterator i = compare.begin();
+            i != compare.end(); ++i)
+    {
+        double tol = tolerance(row[*i]);
+        lower[*i] = (row[*i] - tol - anchor[*i]) / dt;
+        upper[*i] = (row[*i] + tol - anchor[*i]) / dt;
+    }
+}
+
+} /* namespace rr */
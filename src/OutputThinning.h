@@ -0,0 +1,138 @@
+/*
+ * OutputThinning.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_OUTPUTTHINNING_H_
+#define RR_OUTPUTTHINNING_H_
+
+#include "SBMLSolverOptions.h"
+#include "rrSelectionRecord.h"
+#include "rr-libstruct/lsMatrix.h"
+
+#include <vector>
+
+namespace rr
+{
+
+class TrajectoryWriter;
+
+/**
+ * Records the rows of a simulation result, and drops the rows which are
+ * not needed to reproduce the trajectory within the thinning tolerances,
+ * see SimulateOptions::thinning.
+ *
+ * A value is within the tolerance of a reference value r if it differs
+ * from it by no more than thinningAbsolute + thinningRelative * |r|. Time
+ * columns are not compared.
+ *
+ * With THINNING_CHANGE, a row is kept when any value moved by more than
+ * the tolerance since the last kept row.
+ *
+ * With THINNING_INTERPOLATION, a row is kept when the straight line from
+ * the last kept row to the next row would miss any value of the rows in
+ * between by more than their tolerance (the swinging door algorithm). The
+ * rows are only compared to a set of slope bounds, so each row costs a
+ * few operations per column, independent of how many rows were dropped.
+ *
+ * The first and the last rows are always kept, and so are rows at the same
+ * time, which the variable step integrators return before and after an
+ * event.
+ *
+ * If an output file is given, the kept rows are written to it instead of
+ * kept in memory, and with THINNING_NONE every row is kept.
+ */
+class OutputThinning
+{
+public:
+
+    OutputThinning(const SimulateOptions& opt,
+            const std::vector<SelectionRecord>& selections,
+            TrajectoryWriter* output = 0);
+
+    /**
+     * offers a row of selected values at time t.
+     */
+    void add(const std::vector<double>& row, double t);
+
+    /**
+     * keeps the last row, and copies the kept rows into the result, which
+     * has no rows if they were written to the output file.
+     */
+    void getResult(ls::DoubleMatrix& result);
+
+    /**
+     * the number of rows given to add.
+     */
+    int getRows() const { return rows; }
+
+    /**
+     * the number of rows kept.
+     */
+    int getKeptRows() const { return keptRows; }
+
+private:
+
+    /**
+     * appends the row to the kept rows or writes it to the output file,
+     * and makes it the new anchor.
+     */
+    void keep(const double* row, double t);
+
+    /**
+     * sets the slope bounds of the rows since the anchor to those of the
+     * single row at t.
+     */
+    void resetBounds(const double* row, double t);
+
+    double tolerance(double value) const
+    {
+        return absolute + relative * (value < 0 ? -value : value);
+    }
+
+    SimulateOptions::Thinning mode;
+    double absolute;
+    double relative;
+
+    int columns;
+
+    /**
+     * the columns which are compared, all but time.
+     */
+    std::vector<int> compare;
+
+    TrajectoryWriter* output;
+
+    /**
+     * the kept rows, row major, if there is no output file.
+     */
+    std::vector<double> kept;
+
+    /**
+     * the last kept row.
+     */
+    std::vector<double> anchor;
+    double anchorTime;
+
+    /**
+     * the last row given to add, if it was not kept.
+     */
+    std::vector<double> pending;
+    double pendingTime;
+    bool havePending;
+
+    /**
+     * the range of slopes of the lines from the anchor which pass within
+     * the tolerance of all the rows since the anchor.
+     */
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    int rows;
+    int keptRows;
+};
+
+} /* namespace rr */
+
+#endif /* RR_OUTPUTTHINNING_H_ */
@@ -0,0 +1,1070 @@
+#pragma hdrstop
+#include "ParameterEstimation.h"
+#include "RandomHash.h"
+#include "SBMLSolver.h"
+#include "Integrator.h"
+#include "rrExecutableModel.h"
+#include "rrConstants.h"
+#include "rrLogger.h"
+#include "Tracer.h"
+
+#include <Poco/Condition.h>
+#include <Poco/Environment.h>
+#include <Poco/Mutex.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <math.h>
+
+using std::string;
+using std::vector;
+
+namespace rr
+{
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/**
+ * the number of integrate calls in a row which may end at the time they
+ * started, e.g. at events, and the total number of calls to reach one
+ * experiment time, before the integrator is considered stuck.
+ */
+static const int maxStalledIntegrations = 10;
+static const int maxIntegrations = 100000;
+
+static double sumOfSquares(const vector<double>& r)
+{
+    double result = 0;
+    for (unsigned i = 0; i < r.size(); ++i)
+    {
+        result += r[i] * r[i];
+    }
+    return result;
+}
+
+/**
+ * solve A x = b for a symmetric positive definite n x n matrix A (row
+ * major) by Cholesky decomposition, A is overwritten.
+ *
+ * @returns false if A is not positive definite.
+ */
+static bool choleskySolve(vector<double>& A, const vector<double>& b,
+        vector<double>& x)
+{
+    const int n = b.size();
+
+    for (int j = 0; j < n; ++j)
+    {
+        double d = A[j * n + j];
+        for (int k = 0; k < j; ++k)
+        {
+            d -= A[j * n + k] * A[j * n + k];
+        }
+        if (!(d > 0))
+        {
+            return false;
+        }
+        d = sqrt(d);
+        A[j * n + j] = d;
+
+        for (int i = j + 1; i < n; ++i)
+        {
+            double s = A[i * n + j];
+            for (int k = 0; k < j; ++k)
+            {
+                s -= A[i * n + k] * A[j * n + k];
+            }
+            A[i * n + j] = s / d;
+        }
+    }
+
+    x = b;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int k = 0; k < i; ++k)
+        {
+            x[i] -= A[i * n + k] * x[k];
+        }
+        x[i] /= A[i * n + i];
+    }
+    for (int i = n - 1; i >= 0; --i)
+    {
+        for (int k = i + 1; k < n; ++k)
+        {
+            x[i] -= A[k * n + i] * x[k];
+        }
+        x[i] /= A[i * n + i];
+    }
+    return true;
+}
+
+/**
+ * the residuals of one experiment at one set of parameter values.
+ */
+struct EstimationTask
+{
+    const double* values;
+    int experiment;
+    double* residuals;
+    string* error;
+    int* remaining;
+};
+
+/**
+ * Owns a clone of the solver, and evaluates tasks from the pool queue.
+ */
+class EstimationWorker : public Poco::Runnable
+{
+public:
+    EstimationWorker(EstimationPool& pool, const ParameterEstimation& est);
+
+    virtual void run();
+
+    void evaluate(const EstimationTask& task);
+
+private:
+    EstimationPool& pool;
+    const ParameterEstimation& est;
+    std::auto_ptr<SBMLSolver> solver;
+    vector<SelectionRecord> parameters;
+    vector<vector<SelectionRecord> > conditions;
+    vector<vector<SelectionRecord> > selections;
+    string initialState;
+};
+
+/**
+ * A fixed set of workers, fed from a single queue. The start threads
+ * submit batches of tasks and wait for them to complete, so starts that
+ * run concurrently share the workers.
+ */
+class EstimationPool
+{
+public:
+    EstimationPool(const ParameterEstimation& est, int size) :
+        stop(false)
+    {
+        try
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                workers.push_back(new EstimationWorker(*this, est));
+            }
+        }
+        catch (...)
+        {
+            for (unsigned i = 0; i < workers.size(); ++i)
+            {
+                delete workers[i];
+            }
+            throw;
+        }
+
+        threads = new Poco::Thread[size];
+        for (int i = 0; i < size; ++i)
+        {
+            threads[i].start(*workers[i]);
+        }
+    }
+
+    ~EstimationPool()
+    {
+        {
+            Poco::Mutex::ScopedLock lock(mutex);
+            stop = true;
+            work.broadcast();
+        }
+
+        for (unsigned i = 0; i < workers.size(); ++i)
+        {
+            threads[i].join();
+            delete workers[i];
+        }
+        delete[] threads;
+    }
+
+    /**
+     * run a batch of tasks, blocks until all are done.
+     */
+    void run(vector<EstimationTask>& tasks)
+    {
+        int remaining = tasks.size();
+
+        Poco::Mutex::ScopedLock lock(mutex);
+        for (unsigned i = 0; i < tasks.size(); ++i)
+        {
+            tasks[i].remaining = &remaining;
+            queue.push_back(tasks[i]);
+        }
+        work.broadcast();
+
+        while (remaining)
+        {
+            done.wait(mutex);
+        }
+    }
+
+private:
+    vector<EstimationWorker*> workers;
+    Poco::Thread* threads;
+
+    std::deque<EstimationTask> queue;
+    bool stop;
+    Poco::Mutex mutex;
+    Poco::Condition work;
+    Poco::Condition done;
+
+    /**
+     * the next task, false if the pool is stopping.
+     */
+    bool next(EstimationTask& task)
+    {
+        Poco::Mutex::ScopedLock lock(mutex);
+        while (!stop && queue.empty())
+        {
+            work.wait(mutex);
+        }
+
+        if (stop)
+        {
+            return false;
+        }
+
+        task = queue.front();
+        queue.pop_front();
+        return true;
+    }
+
+    void complete(const EstimationTask& task)
+    {
+        Poco::Mutex::ScopedLock lock(mutex);
+        if (--*task.remaining == 0)
+        {
+            done.broadcast();
+        }
+    }
+
+    friend class EstimationWorker;
+};
+
+EstimationWorker::EstimationWorker(EstimationPool& pool,
+        const ParameterEstimation& est) :
+    pool(pool), est(est), solver(est.solver->clone()),
+    conditions(est.experiments.size()),
+    selections(est.experiments.size())
+{
+    for (unsigned i = 0; i < est.parameters.size(); ++i)
+    {
+        parameters.push_back(solver->createSelection(est.parameters[i].id));
+    }
+
+    for (unsigned e = 0; e < est.experiments.size(); ++e)
+    {
+        const ParameterEstimation::Experiment& x = est.experiments[e];
+        for (unsigned i = 0; i < x.conditionIds.size(); ++i)
+        {
+            conditions[e].push_back(solver->createSelection(x.conditionIds[i]));
+        }
+        for (unsigned i = 0; i < x.selections.size(); ++i)
+        {
+            selections[e].push_back(solver->createSelection(x.selections[i]));
+        }
+    }
+
+    std::stringstream ss;
+    solver->getModel()->saveState(ss);
+    initialState = ss.str();
+}
+
+void EstimationWorker::run()
+{
+    EstimationTask task;
+    while (pool.next(task))
+    {
+        try
+        {
+            evaluate(task);
+        }
+        catch (std::exception& e)
+        {
+            *task.error = *e.what() ? e.what() : "unknown error";
+        }
+        catch (...)
+        {
+            *task.error = "unknown error";
+        }
+        pool.complete(task);
+    }
+}
+
+void EstimationWorker::evaluate(const EstimationTask& task)
+{
+    RR_TRACE_SCOPE("ParameterEstimation::evaluate", "estimation");
+
+    const ParameterEstimation::Experiment& x = est.experiments[task.experiment];
+    const vector<SelectionRecord>& sel = selections[task.experiment];
+    const vector<SelectionRecord>& cond = conditions[task.experiment];
+    const int rows = x.data.numRows();
+    const int cols = sel.size();
+
+    std::stringstream ss(initialState);
+    solver->getModel()->loadState(ss);
+
+    if (cond.size())
+    {
+        solver->setValues(&cond[0], cond.size(), &x.conditionValues[0]);
+    }
+    if (parameters.size())
+    {
+        solver->setValues(&parameters[0], parameters.size(), task.values);
+    }
+
+    Integrator* integrator = solver->getIntegrator();
+    double t = solver->getModel()->getTime();
+    integrator->restart(t);
+
+    for (int k = 0; k < rows; ++k)
+    {
+        const double tk = x.data(k, 0);
+        const double eps = 1.e-12 * std::max(1.0, fabs(tk));
+
+        if (tk < t - eps)
+        {
+            throw std::invalid_argument("experiment times must be increasing, "
+                    "and not before the time of the model");
+        }
+
+        // variable step integrators and events may stop early
+        int integrations = 0;
+        int stalled = 0;
+        while (tk - t > eps)
+        {
+            double next = integrator->integrate(t, tk - t);
+
+            stalled = next > t ? 0 : stalled + 1;
+            if (stalled > maxStalledIntegrations || ++integrations > maxIntegrations)
+            {
+                std::stringstream ss;
+                ss << "integrator made no progress at time " << t
+                        << " towards experiment time " << tk;
+                throw std::runtime_error(ss.str());
+            }
+            t = next;
+        }
+
+        double* r = task.residuals + k * cols;
+        if (cols)
+        {
+            solver->getValues(&sel[0], cols, r);
+        }
+
+        for (int c = 0; c < cols; ++c)
+        {
+            double measured = x.data(k, c + 1);
+            r[c] = measured == measured ? (r[c] - measured) / x.sigma(k, c) : 0;
+
+            if (r[c] != r[c])
+            {
+                throw std::runtime_error("simulated value of " + x.selections[c]
+                        + " is not a number");
+            }
+        }
+    }
+}
+
+/**
+ * Runs starts until none are left.
+ */
+class EstimationStart : public Poco::Runnable
+{
+public:
+    EstimationStart(ParameterEstimation& est, EstimationPool& pool,
+            int& next, Poco::FastMutex& mutex) :
+        est(est), pool(pool), next(next), mutex(mutex)
+    {
+    }
+
+    virtual void run()
+    {
+        for (;;)
+        {
+            int start;
+            {
+                Poco::FastMutex::ScopedLock lock(mutex);
+                if (next >= est.starts)
+                {
+                    return;
+                }
+                start = next++;
+            }
+
+            try
+            {
+                est.runStart(pool, start);
+            }
+            catch (std::exception& e)
+            {
+                est.results[start].error = *e.what() ? e.what() : "unknown error";
+            }
+        }
+    }
+
+private:
+    ParameterEstimation& est;
+    EstimationPool& pool;
+    int& next;
+    Poco::FastMutex& mutex;
+};
+
+ParameterEstimation::ParameterEstimation(SBMLSolver* solver,
+        const Dictionary* options) :
+    solver(solver),
+    central(false),
+    step(1.e-6),
+    maxIterations(100),
+    tolerance(1.e-8),
+    lambda(1.e-3),
+    starts(1),
+    seed(0),
+    threads(0),
+    best(-1)
+{
+    if (!solver || !solver->getModel())
+    {
+        throw std::logic_error(gEmptyModelMessage);
+    }
+
+    if (!options)
+    {
+        return;
+    }
+
+    if (options->hasKey("jacobian"))
+    {
+        string j = options->getItem("jacobian").convert<string>();
+        if (j != "forward" && j != "central")
+        {
+            throw std::invalid_argument("invalid jacobian '" + j
+                    + "', must be 'forward' or 'central'");
+        }
+        central = j == "central";
+    }
+
+    if (options->hasKey("step"))
+    {
+        step = options->getItem("step").convert<double>();
+    }
+    if (options->hasKey("max_iterations"))
+    {
+        maxIterations = options->getItem("max_iterations").convert<int>();
+    }
+    if (options->hasKey("tolerance"))
+    {
+        tolerance = options->getItem("tolerance").convert<double>();
+    }
+    if (options->hasKey("lambda"))
+    {
+        lambda = options->getItem("lambda").convert<double>();
+    }
+    if (options->hasKey("starts"))
+    {
+        starts = options->getItem("starts").convert<int>();
+    }
+    if (options->hasKey("seed"))
+    {
+        seed = options->getItem("seed").convert<unsigned long>();
+    }
+    if (options->hasKey("threads"))
+    {
+        threads = options->getItem("threads").convert<int>();
+    }
+
+    if (!(step > 0) || !(lambda > 0) || starts < 1 || maxIterations < 0)
+    {
+        throw std::invalid_argument("step and lambda must be positive, "
+                "starts at least 1");
+    }
+}
+
+ParameterEstimation::~ParameterEstimation()
+{
+}
+
+void ParameterEstimation::addParameter(const std::string& id, double initial,
+        double lower, double upper, bool logScale)
+{
+    if (!(lower <= initial && initial <= upper))
+    {
+        throw std::invalid_argument("initial value of " + id
+                + " is not within its bounds");
+    }
+
+    if (logScale && (lower < 0 || initial <= 0))
+    {
+        throw std::invalid_argument("log scale parameter " + id
+                + " must be positive");
+    }
+
+    Parameter p;
+    p.id = id;
+    p.initial = initial;
+    p.lower = lower;
+    p.upper = upper;
+    p.logScale = logScale;
+    parameters.push_back(p);
+}
+
+int ParameterEstimation::addExperiment(const ls::DoubleMatrix& data,
+        const std::vector<std::string>& selections)
+{
+    if (data.numCols() != selections.size() + 1)
+    {
+        throw std::invalid_argument("experiment data must have a time column "
+                "and one column per selection");
+    }
+
+    Experiment x;
+    x.data = data;
+    x.selections = selections;
+    x.sigma.resize(data.numRows(), selections.size());
+    for (unsigned i = 0; i < data.numRows(); ++i)
+    {
+        for (unsigned j = 0; j < selections.size(); ++j)
+        {
+            x.sigma(i, j) = 1;
+        }
+    }
+    x.offset = getNumResiduals();
+
+    experiments.push_back(x);
+    return experiments.size() - 1;
+}
+
+void ParameterEstimation::setStandardDeviations(int experiment,
+        const ls::DoubleMatrix& sigma)
+{
+    if (experiment < 0 || experiment >= (int)experiments.size())
+    {
+        throw std::out_of_range("invalid experiment index");
+    }
+
+    Experiment& x = experiments[experiment];
+    if (sigma.numRows() != x.data.numRows() ||
+            sigma.numCols() != x.selections.size())
+    {
+        throw std::invalid_argument("the standard deviations must have one "
+                "value per measured value");
+    }
+
+    for (unsigned i = 0; i < sigma.numRows(); ++i)
+    {
+        for (unsigned j = 0; j < sigma.numCols(); ++j)
+        {
+            if (!(sigma(i, j) > 0))
+            {
+                throw std::invalid_argument("standard deviations must be positive");
+            }
+        }
+    }
+
+    x.sigma = sigma;
+}
+
+void ParameterEstimation::setCondition(int experiment, const std::string& id,
+        double value)
+{
+    if (experiment < 0 || experiment >= (int)experiments.size())
+    {
+        throw std::out_of_range("invalid experiment index");
+    }
+
+    experiments[experiment].conditionIds.push_back(id);
+    experiments[experiment].conditionValues.push_back(value);
+}
+
+int ParameterEstimation::getNumParameters() const
+{
+    return parameters.size();
+}
+
+int ParameterEstimation::getNumExperiments() const
+{
+    return experiments.size();
+}
+
+int ParameterEstimation::getNumResiduals() const
+{
+    int n = 0;
+    for (unsigned e = 0; e < experiments.size(); ++e)
+    {
+        n += experiments[e].data.numRows() * experiments[e].selections.size();
+    }
+    return n;
+}
+
+double ParameterEstimation::toNatural(int i, double theta) const
+{
+    return parameters[i].logScale ? exp(theta) : theta;
+}
+
+double ParameterEstimation::toTransformed(int i, double value) const
+{
+    return parameters[i].logScale ? log(value) : value;
+}
+
+void ParameterEstimation::clamp(std::vector<double>& theta) const
+{
+    for (unsigned i = 0; i < parameters.size(); ++i)
+    {
+        theta[i] = std::max(toTransformed(i, parameters[i].lower),
+                std::min(toTransformed(i, parameters[i].upper), theta[i]));
+    }
+}
+
+bool ParameterEstimation::evaluate(EstimationPool& pool,
+        const std::vector<double>& theta, std::vector<double>& r,
+        std::string& error) const
+{
+    vector<double> values(parameters.size());
+    for (unsigned i = 0; i < parameters.size(); ++i)
+    {
+        values[i] = toNatural(i, theta[i]);
+    }
+
+    r.resize(getNumResiduals());
+    vector<string> errors(experiments.size());
+    vector<EstimationTask> tasks(experiments.size());
+
+    for (unsigned e = 0; e < experiments.size(); ++e)
+    {
+        tasks[e].values = values.empty() ? 0 : &values[0];
+        tasks[e].experiment = e;
+        tasks[e].residuals = r.empty() ? 0 : &r[experiments[e].offset];
+        tasks[e].error = &errors[e];
+    }
+
+    pool.run(tasks);
+
+    for (unsigned e = 0; e < errors.size(); ++e)
+    {
+        if (!errors[e].empty())
+        {
+            error = errors[e];
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParameterEstimation::jacobian(EstimationPool& pool,
+        const std::vector<double>& theta, const std::vector<double>& r,
+        ls::DoubleMatrix& J, std::string& error) const
+{
+    RR_TRACE_SCOPE("ParameterEstimation::jacobian", "estimation");
+
+    const int P = parameters.size();
+    const int M = r.size();
+    const int E = experiments.size();
+
+    // the upper and lower perturbation of each parameter, 0 if the
+    // residuals at theta are used for that side.
+    vector<double> hPlus(P, 0), hMinus(P, 0);
+
+    for (int k = 0; k < P; ++k)
+    {
+        double h = step * std::max(fabs(theta[k]), 1.0);
+        double up = toTransformed(k, parameters[k].upper) - theta[k];
+        double down = theta[k] - toTransformed(k, parameters[k].lower);
+        bool plus = h <= up;
+        bool minus = h <= down;
+
+        if (central && plus && minus)
+        {
+            hPlus[k] = hMinus[k] = h;
+        }
+        else if (plus)
+        {
+            hPlus[k] = h;
+        }
+        else if (minus)
+        {
+            hMinus[k] = h;
+        }
+        else if (up >= down)
+        {
+            // the bounds are closer than h, one sided difference to the
+            // farther bound
+            hPlus[k] = std::max(up, 0.);
+        }
+        else
+        {
+            hMinus[k] = std::max(down, 0.);
+        }
+    }
+
+    // one perturbed parameter vector and residual vector per side
+    vector<vector<double> > values;
+    vector<vector<double> > residuals;
+    vector<int> plusIndex(P, -1), minusIndex(P, -1);
+
+    for (int k = 0; k < P; ++k)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            double h = side == 0 ? hPlus[k] : -hMinus[k];
+            if (h == 0)
+            {
+                continue;
+            }
+
+            (side == 0 ? plusIndex : minusIndex)[k] = values.size();
+
+            vector<double> v(P);
+            for (int i = 0; i < P; ++i)
+            {
+                v[i] = toNatural(i, i == k ? theta[i] + h : theta[i]);
+            }
+            values.push_back(v);
+            residuals.push_back(vector<double>(M));
+        }
+    }
+
+    vector<string> errors(values.size() * E);
+    vector<EstimationTask> tasks;
+
+    for (unsigned s = 0; s < values.size(); ++s)
+    {
+        for (int e = 0; e < E; ++e)
+        {
+            EstimationTask task;
+            task.values = &values[s][0];
+            task.experiment = e;
+            task.residuals = M ? &residuals[s][experiments[e].offset] : 0;
+            task.error = &errors[s * E + e];
+            tasks.push_back(task);
+        }
+    }
+
+    pool.run(tasks);
+
+    for (unsigned i = 0; i < errors.size(); ++i)
+    {
+        if (!errors[i].empty())
+        {
+            error = errors[i];
+            return false;
+        }
+    }
+
+    J.resize(M, P);
+    for (int k = 0; k < P; ++k)
+    {
+        const vector<double>& rp = plusIndex[k] >= 0 ? residuals[plusIndex[k]] : r;
+        const vector<double>& rm = minusIndex[k] >= 0 ? residuals[minusIndex[k]] : r;
+        const double h = hPlus[k] + hMinus[k];
+
+        // a parameter with equal bounds can not move
+        for (int i = 0; i < M; ++i)
+        {
+            J(i, k) = h > 0 ? (rp[i] - rm[i]) / h : 0;
+        }
+    }
+    return true;
+}
+
+void ParameterEstimation::runStart(EstimationPool& pool, int start)
+{
+    RR_TRACE_SCOPE("ParameterEstimation::start", "estimation");
+
+    const int P = parameters.size();
+    Start& result = results[start];
+
+    vector<double> theta(P);
+    for (int i = 0; i < P; ++i)
+    {
+        if (start == 0)
+        {
+            theta[i] = toTransformed(i, parameters[i].initial);
+        }
+        else
+        {
+            double lower = toTransformed(i, parameters[i].lower);
+            double upper = toTransformed(i, parameters[i].upper);
+            uint64_t n = (seed * 0x9E3779B97F4A7C15ULL) + (uint64_t)start * P + i;
+            theta[i] = lower + hashToUnit(splitmix64(n)) * (upper - lower);
+        }
+    }
+    clamp(theta);
+
+    vector<double> r;
+    if (!evaluate(pool, theta, r, result.error))
+    {
+        return;
+    }
+    double ssr = sumOfSquares(r);
+
+    const int M = r.size();
+    double mu = lambda;
+    int iteration = 0;
+    bool converged = false;
+
+    ls::DoubleMatrix J;
+    vector<double> A(P * P), g(P), delta(P), trial(P), rTrial;
+
+    while (!converged && iteration < maxIterations)
+    {
+        ++iteration;
+
+        if (!jacobian(pool, theta, r, J, result.error))
+        {
+            return;
+        }
+
+        // normal equations, J^T J and the gradient J^T r
+        vector<double> JtJ(P * P, 0);
+        double gmax = 0;
+        for (int a = 0; a < P; ++a)
+        {
+            double s = 0;
+            for (int i = 0; i < M; ++i)
+            {
+                s += J(i, a) * r[i];
+            }
+            g[a] = -s;
+            gmax = std::max(gmax, fabs(s));
+
+            for (int b = 0; b <= a; ++b)
+            {
+                double t = 0;
+                for (int i = 0; i < M; ++i)
+                {
+                    t += J(i, a) * J(i, b);
+                }
+                JtJ[a * P + b] = JtJ[b * P + a] = t;
+            }
+        }
+
+        if (gmax == 0)
+        {
+            break;
+        }
+
+        // increase the damping until a step reduces the sum of squares
+        for (;;)
+        {
+            A = JtJ;
+            for (int a = 0; a < P; ++a)
+            {
+                A[a * P + a] += mu * std::max(JtJ[a * P + a], 1.e-12);
+            }
+
+            bool solved = choleskySolve(A, g, delta);
+
+            double stepNorm = 0, thetaNorm = 0;
+            if (solved)
+            {
+                for (int a = 0; a < P; ++a)
+                {
+                    trial[a] = theta[a] + delta[a];
+                }
+                clamp(trial);
+
+                for (int a = 0; a < P; ++a)
+                {
+                    stepNorm += (trial[a] - theta[a]) * (trial[a] - theta[a]);
+                    thetaNorm += theta[a] * theta[a];
+                }
+
+                if (sqrt(stepNorm) <= tolerance * (sqrt(thetaNorm) + tolerance))
+                {
+                    converged = true;
+                    break;
+                }
+            }
+
+            string error;
+            if (solved && evaluate(pool, trial, rTrial, error))
+            {
+                double ssrTrial = sumOfSquares(rTrial);
+                if (ssrTrial < ssr)
+                {
+                    converged = ssr - ssrTrial <= tolerance * ssr;
+                    theta.swap(trial);
+                    r.swap(rTrial);
+                    ssr = ssrTrial;
+                    mu = std::max(mu / 10, 1.e-12);
+                    break;
+                }
+            }
+            else if (solved)
+            {
+                Log(Logger::LOG_DEBUG) << "parameter estimation start " << start
+                        << ", trial point failed: " << error;
+            }
+
+            mu *= 10;
+            if (mu > 1.e16)
+            {
+                // no step reduces the sum of squares
+                converged = true;
+                break;
+            }
+        }
+
+        Log(Logger::LOG_DEBUG) << "parameter estimation start " << start
+                << ", iteration " << iteration << ", sum of squares " << ssr
+                << ", lambda " << mu;
+    }
+
+    result.values.resize(P);
+    for (int i = 0; i < P; ++i)
+    {
+        result.values[i] = toNatural(i, theta[i]);
+    }
+    result.residuals.swap(r);
+    result.ssr = ssr;
+    result.iterations = iteration;
+}
+
+double ParameterEstimation::run()
+{
+    RR_TRACE_SCOPE("ParameterEstimation::run", "estimation");
+
+    if (parameters.empty() || experiments.empty())
+    {
+        throw std::invalid_argument("parameter estimation requires at least "
+                "one parameter and one experiment");
+    }
+
+    if (starts > 1)
+    {
+        for (unsigned i = 0; i < parameters.size(); ++i)
+        {
+            if (fabs(toTransformed(i, parameters[i].lower)) ==
+                    std::numeric_limits<double>::infinity() ||
+                    fabs(toTransformed(i, parameters[i].upper)) ==
+                    std::numeric_limits<double>::infinity())
+            {
+                throw std::invalid_argument("multiple starts require finite "
+                        "bounds, parameter " + parameters[i].id);
+            }
+        }
+    }
+
+    Start empty;
+    empty.ssr = NaN;
+    empty.iterations = 0;
+    results.assign(starts, empty);
+    best = -1;
+
+    int tasks = experiments.size() * (parameters.size() + 1);
+    int nThreads = threads > 0 ? threads : Poco::Environment::processorCount();
+    nThreads = std::max(1, std::min(nThreads, tasks * starts));
+
+    {
+        EstimationPool pool(*this, nThreads);
+
+        int next = 0;
+        Poco::FastMutex mutex;
+
+        int nStarts = std::min(starts, nThreads);
+        vector<EstimationStart*> drivers;
+        for (int i = 0; i < nStarts; ++i)
+        {
+            drivers.push_back(new EstimationStart(*this, pool, next, mutex));
+        }
+
+        if (nStarts == 1)
+        {
+            drivers[0]->run();
+        }
+        else
+        {
+            Poco::Thread* startThreads = new Poco::Thread[nStarts];
+            for (int i = 0; i < nStarts; ++i)
+            {
+                startThreads[i].start(*drivers[i]);
+            }
+            for (int i = 0; i < nStarts; ++i)
+            {
+                startThreads[i].join();
+            }
+            delete[] startThreads;
+        }
+
+        for (int i = 0; i < nStarts; ++i)
+        {
+            delete drivers[i];
+        }
+    }
+
+    for (int i = 0; i < starts; ++i)
+    {
+        if (!results[i].error.empty())
+        {
+            results[i].ssr = NaN;
+            Log(Logger::LOG_WARNING) << "parameter estimation start " << i
+                    << " failed: " << results[i].error;
+        }
+        else if (best < 0 || results[i].ssr < results[best].ssr)
+        {
+            best = i;
+        }
+    }
+
+    if (best < 0)
+    {
+        throw std::runtime_error("parameter estimation failed: " + results[0].error);
+    }
+
+    Log(Logger::LOG_INFORMATION) << "parameter estimation, best of " << starts
+            << " starts: sum of squares " << results[best].ssr << " after "
+            << results[best].iterations << " iterations";
+
+    return results[best].ssr;
+}
+
+std::vector<double> ParameterEstimation::getParameterValues() const
+{
+    return best < 0 ? vector<double>() : results[best].values;
+}
+
+double ParameterEstimation::getResidualSumOfSquares() const
+{
+    return best < 0 ? NaN : results[best].ssr;
+}
+
+std::vector<double> ParameterEstimation::getResiduals() const
+{
+    return best < 0 ? vector<double>() : results[best].residuals;
+}
+
+int ParameterEstimation::getNumIterations() const
+{
+    return best < 0 ? 0 : results[best].iterations;
+}
+
+ls::DoubleMatrix ParameterEstimation::getStartResults() const
+{
+    const int P = parameters.size();
+    ls::DoubleMatrix result(results.size(), P + 2);
+
+    for (unsigned s = 0; s < results.size(); ++s)
+    {
+        for (int i = 0; i < P; ++i)
+        {
+            result(s, i) = i < (int)results[s].values.size() ?
+                    results[s].values[i] : NaN;
+        }
+        result(s, P) = results[s].ssr;
+        result(s, P + 1) = results[s].iterations;
+    }
+    return result;
+}
+
+} /* namespace rr */
@@ -0,0 +1,242 @@
+/*
+ * ParameterEstimation.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_PARAMETERESTIMATION_H_
+#define RR_PARAMETERESTIMATION_H_
+
+#include "rrExporter.h"
+#include "Dictionary.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <stdint.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class SBMLSolver;
+class EstimationPool;
+
+/**
+ * Least squares parameter estimation with the Levenberg-Marquardt method.
+ *
+ * The data is a set of experiments, each a table of measured time courses
+ * of a set of selections, optionally with experiment specific conditions,
+ * values that are set before the experiment is simulated, such as initial
+ * concentrations or parameters that are not estimated.
+ *
+ * The residuals are (simulated - measured) / sigma for each measured value,
+ * NaN measurements are missing values and are ignored. The residual
+ * function and its Jacobian are evaluated on a pool of worker threads,
+ * each of which owns a clone of the solver (see SBMLSolver::clone). Each
+ * experiment is a separate task, and the Jacobian is computed by finite
+ * differences, so each perturbed parameter of each experiment is a task as
+ * well. Multiple starts run concurrently and share the pool.
+ *
+ * Parameters may be estimated on a log scale, and are kept within their
+ * bounds by projecting each step onto the bounds.
+ *
+ * Every evaluation starts from the state of the template solver at the
+ * time the estimation was created, and integrates from its current time
+ * to each measured time point.
+ *
+ * The following options are recognized:
+ *
+ * jacobian: "forward" (default) or "central" finite differences.
+ *
+ * step: relative finite difference step in the (log) parameter space,
+ * default 1e-6.
+ *
+ * max_iterations: Levenberg-Marquardt iterations per start, default 100.
+ *
+ * tolerance: relative reduction of the sum of squares, and relative step
+ * size, below which a start has converged, default 1e-8.
+ *
+ * lambda: initial damping, default 1e-3.
+ *
+ * starts: number of starts, default 1. The first start uses the initial
+ * parameter values, the others uniform (or log uniform) random values
+ * within the bounds, which must then be finite.
+ *
+ * seed: seed of the random starts, default 0.
+ *
+ * threads: number of worker threads, default 0, the number of cpus.
+ */
+class RR_DECLSPEC ParameterEstimation
+{
+public:
+
+    /**
+     * The solver is borrowed and used as the template the workers are
+     * cloned from, it must not be modified while the estimation runs.
+     *
+     * @throws std::logic_error if no model is loaded.
+     */
+    ParameterEstimation(SBMLSolver* solver, const Dictionary* options = 0);
+
+    ~ParameterEstimation();
+
+    /**
+     * add an estimated parameter, a selection that can be set with
+     * SBMLSolver::setValue.
+     *
+     * @param logScale estimate the logarithm of the parameter, requires
+     * positive values and bounds.
+     */
+    void addParameter(const std::string& id, double initial,
+            double lower = -std::numeric_limits<double>::infinity(),
+            double upper = std::numeric_limits<double>::infinity(),
+            bool logScale = false);
+
+    /**
+     * add an experiment.
+     *
+     * @param data the first column are increasing times, the others the
+     * measured values of the selections, NaN for missing values.
+     *
+     * @param selections the measured selections, one per data column after
+     * time.
+     *
+     * @returns the index of the experiment.
+     */
+    int addExperiment(const ls::DoubleMatrix& data,
+            const std::vector<std::string>& selections);
+
+    /**
+     * set the standard deviations of the measurements of an experiment,
+     * one per data value, without the time column. By default, all are 1.
+     */
+    void setStandardDeviations(int experiment, const ls::DoubleMatrix& sigma);
+
+    /**
+     * set a value before the experiment is simulated.
+     */
+    void setCondition(int experiment, const std::string& id, double value);
+
+    int getNumParameters() const;
+
+    int getNumExperiments() const;
+
+    /**
+     * the total number of residuals, the number of measured values.
+     */
+    int getNumResiduals() const;
+
+    /**
+     * run all starts.
+     *
+     * @returns the sum of squared residuals of the best start.
+     *
+     * @throws std::runtime_error if every start failed.
+     */
+    double run();
+
+    /**
+     * the parameter values of the best start.
+     */
+    std::vector<double> getParameterValues() const;
+
+    /**
+     * the sum of squared residuals of the best start.
+     */
+    double getResidualSumOfSquares() const;
+
+    /**
+     * the residuals at the best parameter values, ordered by experiment,
+     * then row, then column.
+     */
+    std::vector<double> getResiduals() const;
+
+    /**
+     * the number of iterations of the best start.
+     */
+    int getNumIterations() const;
+
+    /**
+     * the result of each start, one row per start, with the final
+     * parameter values, the sum of squares and the number of iterations.
+     * Starts that failed have a NaN sum of squares.
+     */
+    ls::DoubleMatrix getStartResults() const;
+
+private:
+    struct Parameter
+    {
+        std::string id;
+        double initial;
+        double lower;
+        double upper;
+        bool logScale;
+    };
+
+    struct Experiment
+    {
+        ls::DoubleMatrix data;
+        ls::DoubleMatrix sigma;
+        std::vector<std::string> selections;
+        std::vector<std::string> conditionIds;
+        std::vector<double> conditionValues;
+        int offset;
+    };
+
+    struct Start
+    {
+        std::vector<double> values;
+        std::vector<double> residuals;
+        double ssr;
+        int iterations;
+        std::string error;
+    };
+
+    SBMLSolver* solver;
+    bool central;
+    double step;
+    int maxIterations;
+    double tolerance;
+    double lambda;
+    int starts;
+    uint64_t seed;
+    int threads;
+
+    std::vector<Parameter> parameters;
+    std::vector<Experiment> experiments;
+
+    std::vector<Start> results;
+    int best;
+
+    /**
+     * run a single start, called concurrently from the start threads.
+     */
+    void runStart(EstimationPool& pool, int start);
+
+    /**
+     * the residuals of all experiments at a point of the transformed
+     * parameter space.
+     */
+    bool evaluate(EstimationPool& pool, const std::vector<double>& theta,
+            std::vector<double>& r, std::string& error) const;
+
+    /**
+     * the Jacobian at theta, one row per residual, r are the residuals at
+     * theta.
+     */
+    bool jacobian(EstimationPool& pool, const std::vector<double>& theta,
+            const std::vector<double>& r, ls::DoubleMatrix& J,
+            std::string& error) const;
+
+    double toNatural(int i, double theta) const;
+    double toTransformed(int i, double value) const;
+    void clamp(std::vector<double>& theta) const;
+
+    friend class EstimationPool;
+    friend class EstimationWorker;
+    friend class EstimationStart;
+};
+
+} /* namespace rr */
+
+#endif /* RR_PARAMETERESTIMATION_H_ */
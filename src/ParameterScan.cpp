@@ -0,0 +1,592 @@
+#pragma hdrstop
+#include "ParameterScan.h"
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "Integrator.h"
+#include "rrExecutableModel.h"
+#include "rrConstants.h"
+#include "rrLogger.h"
+#include "Tracer.h"
+#include "TrajectoryFile.h"
+
+#include <Poco/Environment.h>
+#include <Poco/Mutex.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+using std::string;
+using std::vector;
+
+namespace rr
+{
+
+/**
+ * Hands out point indices to the workers. Each worker owns a range of
+ * points, and takes them from the front. A worker whose range is empty
+ * steals the back half of the largest remaining range.
+ */
+class ScanQueue
+{
+public:
+    ScanQueue(unsigned size, unsigned workers) :
+        ranges(workers)
+    {
+        for (unsigned w = 0; w < workers; ++w)
+        {
+            ranges[w] = new Range();
+            ranges[w]->begin = (uint64_t)size * w / workers;
+            ranges[w]->end = (uint64_t)size * (w + 1) / workers;
+        }
+    }
+
+    ~ScanQueue()
+    {
+        for (unsigned w = 0; w < ranges.size(); ++w)
+        {
+            delete ranges[w];
+        }
+    }
+
+    bool next(unsigned worker, unsigned& index)
+    {
+        Range& own = *ranges[worker];
+        {
+            Poco::FastMutex::ScopedLock lock(own.mutex);
+            if (own.begin < own.end)
+            {
+                index = own.begin++;
+                return true;
+            }
+        }
+        return steal(worker, index);
+    }
+
+private:
+    struct Range
+    {
+        unsigned begin;
+        unsigned end;
+        Poco::FastMutex mutex;
+    };
+
+    vector<Range*> ranges;
+
+    bool steal(unsigned worker, unsigned& index)
+    {
+        for (;;)
+        {
+            unsigned victim = worker;
+            unsigned most = 0;
+
+            for (unsigned w = 0; w < ranges.size(); ++w)
+            {
+                if (w == worker)
+                {
+                    continue;
+                }
+                Poco::FastMutex::ScopedLock lock(ranges[w]->mutex);
+                if (ranges[w]->end - ranges[w]->begin > most)
+                {
+                    most = ranges[w]->end - ranges[w]->begin;
+                    victim = w;
+                }
+            }
+
+            if (most == 0)
+            {
+                return false;
+            }
+
+            unsigned begin, end;
+            {
+                Range& v = *ranges[victim];
+                Poco::FastMutex::ScopedLock lock(v.mutex);
+
+                // emptied since we looked, look again
+                if (v.begin == v.end)
+                {
+                    continue;
+                }
+
+                begin = v.begin + (v.end - v.begin) / 2;
+                end = v.end;
+                v.end = begin;
+            }
+
+            Range& own = *ranges[worker];
+            Poco::FastMutex::ScopedLock lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            index = begin;
+            return true;
+        }
+    }
+};
+
+class ScanWorker : public Poco::Runnable
+{
+public:
+    ScanWorker(ParameterScan& scan, ScanQueue& queue, unsigned id,
+            double* result) :
+        scan(scan), queue(queue), id(id), result(result),
+        solver(scan.solver->clone())
+    {
+        for (unsigned i = 0; i < scan.ids.size(); ++i)
+        {
+            parameters.push_back(solver->createSelection(scan.ids[i]));
+        }
+
+        if (scan.type == ParameterScan::TIME_COURSE)
+        {
+            solver->setSelections(scan.selections);
+
+            // every point fills the same number of time points, so the
+            // output is never thinned, whatever the template is set to.
+            solver->getSimulateOptions().thinning = SimulateOptions::THINNING_NONE;
+        }
+        else
+        {
+            for (unsigned i = 0; i < scan.selections.size(); ++i)
+            {
+                selections.push_back(solver->createSelection(scan.selections[i]));
+            }
+        }
+
+        // every point that is not warm started starts from the state of
+        // the template solver.
+        std::stringstream ss;
+        solver->getModel()->saveState(ss);
+        initialState = ss.str();
+    }
+
+    virtual void run()
+    {
+        const int timePoints = scan.getNumTimePoints();
+        const int numSelections = scan.selections.size();
+        const size_t pointSize = (size_t)timePoints * numSelections;
+
+        vector<double> values(parameters.size() + 1);
+        long last = -2;
+        unsigned i;
+
+        while (queue.next(id, i))
+        {
+            RR_TRACE_SCOPE("ParameterScan::point", "scan");
+
+            double* out = result + i * pointSize;
+
+            try
+            {
+                scan.getPoint(i, &values[0]);
+
+                if (scan.type == ParameterScan::STEADY_STATE)
+                {
+                    bool warm = scan.warmStart && (long)i == last + 1;
+
+                    try
+                    {
+                        if (!warm)
+                        {
+                            restoreInitialState();
+                        }
+                        setParameters(&values[0]);
+                        solver->steadyState();
+                    }
+                    catch (std::exception& e)
+                    {
+                        if (!warm)
+                        {
+                            throw;
+                        }
+
+                        Log(Logger::LOG_DEBUG) << "parameter scan point " << i
+                                << " failed from the previous steady state, "
+                                << "retrying from the initial state: " << e.what();
+
+                        restoreInitialState();
+                        setParameters(&values[0]);
+                        solver->steadyState();
+                    }
+
+                    if (numSelections)
+                    {
+                        solver->getValues(&selections[0], numSelections, out);
+                    }
+                }
+                else
+                {
+                    restoreInitialState();
+                    setParameters(&values[0]);
+
+                    const ls::DoubleMatrix& m = *solver->simulate();
+
+                    if (m.numRows() != (unsigned)timePoints ||
+                            m.numCols() != (unsigned)numSelections)
+                    {
+                        throw std::runtime_error("unexpected simulation result size");
+                    }
+
+                    if (pointSize)
+                    {
+                        memcpy(out, &m(0, 0), pointSize * sizeof(double));
+                    }
+                }
+
+                last = i;
+            }
+            catch (std::exception& e)
+            {
+                std::fill(out, out + pointSize,
+                        std::numeric_limits<double>::quiet_NaN());
+
+                // each point is processed by exactly one worker
+                scan.errors[i] = *e.what() ? e.what() : "unknown error";
+                last = -2;
+            }
+        }
+    }
+
+private:
+    ParameterScan& scan;
+    ScanQueue& queue;
+    unsigned id;
+    double* result;
+    std::auto_ptr<SBMLSolver> solver;
+    vector<SelectionRecord> parameters;
+    vector<SelectionRecord> selections;
+    string initialState;
+
+    void restoreInitialState()
+    {
+        std::stringstream ss(initialState);
+        solver->getModel()->loadState(ss);
+    }
+
+    void setParameters(const double* values)
+    {
+        if (parameters.size())
+        {
+            solver->setValues(&parameters[0], parameters.size(), values);
+        }
+    }
+};
+
+ParameterScan::ParameterScan(SBMLSolver* solver, const Dictionary* options) :
+    solver(solver),
+    type(TIME_COURSE),
+    threads(0),
+    warmStart(true),
+    grid(true)
+{
+    if (!solver || !solver->getModel())
+    {
+        throw std::logic_error(gEmptyModelMessage);
+    }
+
+    if (options)
+    {
+        if (options->hasKey("type"))
+        {
+            string t = options->getItem("type").convert<string>();
+            if (t == "time_course")
+            {
+                type = TIME_COURSE;
+            }
+            else if (t == "steady_state")
+            {
+                type = STEADY_STATE;
+            }
+            else
+            {
+                throw std::invalid_argument("invalid parameter scan type '" + t
+                        + "', must be 'time_course' or 'steady_state'");
+            }
+        }
+
+        if (options->hasKey("threads"))
+        {
+            threads = options->getItem("threads").convert<int>();
+        }
+
+        if (options->hasKey("warm_start"))
+        {
+            warmStart = options->getItem("warm_start").convert<bool>();
+        }
+    }
+}
+
+ParameterScan::~ParameterScan()
+{
+}
+
+void ParameterScan::addAxis(const std::string& id,
+        const std::vector<double>& values)
+{
+    if (!grid)
+    {
+        ids.clear();
+        points.resize(0, 0);
+        grid = true;
+    }
+
+    ids.push_back(id);
+    axes.push_back(values);
+}
+
+void ParameterScan::setPoints(const std::vector<std::string>& ids,
+        const ls::DoubleMatrix& points)
+{
+    if (points.numCols() != ids.size())
+    {
+        throw std::invalid_argument("the scan points must have one column per id");
+    }
+
+    this->ids = ids;
+    this->points = points;
+    axes.clear();
+    grid = false;
+}
+
+void ParameterScan::setSelections(const std::vector<std::string>& selections)
+{
+    this->selections = selections;
+}
+
+std::vector<std::string> ParameterScan::getSelections() const
+{
+    if (selections.size())
+    {
+        return selections;
+    }
+
+    const vector<SelectionRecord>& records = type == TIME_COURSE ?
+            solver->getSelections() : solver->getSteadyStateSelections();
+
+    vector<string> result;
+    for (unsigned i = 0; i < records.size(); ++i)
+    {
+        result.push_back(records[i].to_string());
+    }
+    return result;
+}
+
+std::vector<std::string> ParameterScan::getParameterIds() const
+{
+    return ids;
+}
+
+ls::DoubleMatrix ParameterScan::getPoints() const
+{
+    ls::DoubleMatrix result(getNumPoints(), ids.size());
+
+    for (int i = 0; i < getNumPoints(); ++i)
+    {
+        getPoint(i, &result(i, 0));
+    }
+    return result;
+}
+
+int ParameterScan::getNumPoints() const
+{
+    if (!grid)
+    {
+        return points.numRows();
+    }
+
+    if (axes.empty())
+    {
+        return 0;
+    }
+
+    int n = 1;
+    for (unsigned i = 0; i < axes.size(); ++i)
+    {
+        n *= axes[i].size();
+    }
+    return n;
+}
+
+int ParameterScan::getNumTimePoints() const
+{
+    return type == TIME_COURSE ? solver->getSimulateOptions().steps + 1 : 1;
+}
+
+int ParameterScan::getNumSelections() const
+{
+    return getSelections().size();
+}
+
+size_t ParameterScan::getResultSize() const
+{
+    return (size_t)getNumPoints() * getNumTimePoints() * getNumSelections();
+}
+
+void ParameterScan::getPoint(int i, double* values) const
+{
+    if (!grid)
+    {
+        for (unsigned j = 0; j < ids.size(); ++j)
+        {
+            values[j] = points(i, j);
+        }
+        return;
+    }
+
+    // last axis varies fastest
+    for (int j = axes.size() - 1; j >= 0; --j)
+    {
+        values[j] = axes[j][i % axes[j].size()];
+        i /= axes[j].size();
+    }
+}
+
+int ParameterScan::run()
+{
+    vector<double> block(getResultSize());
+    int failed = run(block.empty() ? 0 : &block[0]);
+    result.swap(block);
+    return failed;
+}
+
+int ParameterScan::run(double* block)
+{
+    RR_TRACE_SCOPE("ParameterScan::run", "scan");
+
+    const int n = getNumPoints();
+
+    if (n == 0)
+    {
+        throw std::invalid_argument("parameter scan has no points");
+    }
+
+    if (type == TIME_COURSE &&
+            solver->getSimulateOptions().integratorFlags & Integrator::VARIABLE_STEP)
+    {
+        throw std::invalid_argument("time course scans require fixed time steps");
+    }
+
+    result.clear();
+    selections = getSelections();
+    errors.assign(n, string());
+
+    int nThreads = threads > 0 ? threads : Poco::Environment::processorCount();
+    nThreads = std::max(1, std::min(nThreads, n));
+
+    ScanQueue queue(n, nThreads);
+
+    vector<ScanWorker*> workers;
+    try
+    {
+        for (int i = 0; i < nThreads; ++i)
+        {
+            workers.push_back(new ScanWorker(*this, queue, i, block));
+        }
+    }
+    catch (...)
+    {
+        for (unsigned i = 0; i < workers.size(); ++i)
+        {
+            delete workers[i];
+        }
+        throw;
+    }
+
+    if (nThreads == 1)
+    {
+        workers[0]->run();
+    }
+    else
+    {
+        Poco::Thread* pool = new Poco::Thread[nThreads];
+        for (int i = 0; i < nThreads; ++i)
+        {
+            pool[i].start(*workers[i]);
+        }
+        for (int i = 0; i < nThreads; ++i)
+        {
+            pool[i].join();
+        }
+        delete[] pool;
+    }
+
+    for (int i = 0; i < nThreads; ++i)
+    {
+        delete workers[i];
+    }
+
+    int failed = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!errors[i].empty())
+        {
+            ++failed;
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "parameter scan of " << n << " points using "
+            << nThreads << " threads, " << failed << " failed";
+
+    return failed;
+}
+
+const std::vector<double>& ParameterScan::getResult() const
+{
+    return result;
+}
+
+void ParameterScan::write(const std::string& fileName,
+        const double* block) const
+{
+    if (!block)
+    {
+        if (result.empty())
+        {
+            throw std::logic_error("parameter scan has no result to write");
+        }
+        block = &result[0];
+    }
+
+    const int n = getNumPoints();
+    const int nTimes = getNumTimePoints();
+    const int nIds = ids.size();
+    const int nSel = selections.size();
+
+    vector<string> columns(ids);
+    columns.insert(columns.end(), selections.begin(), selections.end());
+
+    TrajectoryWriter output(fileName, columns);
+    vector<double> row(columns.size());
+
+    for (int i = 0; i < n; ++i)
+    {
+        getPoint(i, &row[0]);
+
+        for (int j = 0; j < nTimes; ++j)
+        {
+            const double* values = block + ((size_t)i * nTimes + j) * nSel;
+            std::copy(values, values + nSel, row.begin() + nIds);
+            output.write(&row[0]);
+        }
+    }
+
+    output.close();
+}
+
+const std::vector<std::string>& ParameterScan::getErrors() const
+{
+    return errors;
+}
+
+ParameterScan::ScanType ParameterScan::getScanType() const
+{
+    return type;
+}
+
+} /* namespace rr */
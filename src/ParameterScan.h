@@ -0,0 +1,201 @@
+/*
+ * ParameterScan.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_PARAMETERSCAN_H_
+#define RR_PARAMETERSCAN_H_
+
+#include "rrExporter.h"
+#include "Dictionary.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class SBMLSolver;
+
+/**
+ * Parallel parameter scan.
+ *
+ * Evaluates a model at a set of parameter points, either as a time course
+ * using the simulate options of the solver, except that the output is
+ * never thinned (see SimulateOptions::thinning), or as a steady state. The
+ * points are either the full factorial grid of a set of axes, or the rows
+ * of an explicit sample matrix.
+ *
+ * The scan runs on a number of worker threads, each of which owns a clone
+ * of the solver (see SBMLSolver::clone), so the compiled model code is
+ * shared and nothing is recompiled. Each worker starts with a contiguous
+ * range of points, and when it runs out steals the second half of the
+ * largest remaining range of another worker. Workers therefore mostly
+ * process neighboring points in order, which is what makes warm starting
+ * steady states from the previous point effective.
+ *
+ * All results are written into a single preallocated block of
+ * points x time points x selections doubles, in that (row major) order. A
+ * steady state scan has a single time point. Points that fail are filled
+ * with NaN and their error message is kept.
+ *
+ * The following options are recognized:
+ *
+ * type: "time_course" (default) or "steady_state".
+ *
+ * threads: number of worker threads, default 0, the number of cpus.
+ *
+ * warm_start: steady state scans start each point from the steady state
+ * of the previous point when the two are neighbors, and fall back to the
+ * initial conditions if that fails, default true. If false, every point
+ * starts from the initial conditions.
+ *
+ * Note that the NLEQ steady state solver is not reentrant, and is
+ * serialized between threads, so steady state scans scale less well than
+ * time course scans.
+ */
+class RR_DECLSPEC ParameterScan
+{
+public:
+
+    enum ScanType
+    {
+        TIME_COURSE = 0,
+        STEADY_STATE = 1
+    };
+
+    /**
+     * Create a scan of a loaded model.
+     *
+     * The solver is borrowed, it is only used as the template the workers
+     * are cloned from, and must not be modified while the scan runs. Its
+     * current state, parameter values and simulate options are the starting
+     * point of every scan point.
+     *
+     * @throws std::logic_error if no model is loaded.
+     */
+    ParameterScan(SBMLSolver* solver, const Dictionary* options = 0);
+
+    ~ParameterScan();
+
+    /**
+     * add an axis of the scan grid, the points are the full factorial
+     * product of all axes, with the last added axis varying fastest.
+     *
+     * Removes points set by setPoints.
+     *
+     * @param id a selection that can be set with SBMLSolver::setValue, e.g.
+     * a global parameter, or init(S1) for an initial value.
+     */
+    void addAxis(const std::string& id, const std::vector<double>& values);
+
+    /**
+     * set explicit scan points, replacing any axes.
+     *
+     * @param ids the varied selections.
+     * @param points one row per point, one column per id.
+     */
+    void setPoints(const std::vector<std::string>& ids,
+            const ls::DoubleMatrix& points);
+
+    /**
+     * set the result selections. By default, the time course selections
+     * of the solver are used for time course scans, and its steady state
+     * selections for steady state scans.
+     */
+    void setSelections(const std::vector<std::string>& selections);
+
+    std::vector<std::string> getSelections() const;
+
+    /**
+     * the varied selections.
+     */
+    std::vector<std::string> getParameterIds() const;
+
+    /**
+     * the parameter values of each point, one row per point.
+     */
+    ls::DoubleMatrix getPoints() const;
+
+    int getNumPoints() const;
+
+    /**
+     * simulate steps + 1 for time course scans, 1 for steady state scans.
+     */
+    int getNumTimePoints() const;
+
+    int getNumSelections() const;
+
+    /**
+     * getNumPoints() * getNumTimePoints() * getNumSelections().
+     */
+    size_t getResultSize() const;
+
+    /**
+     * run the scan into an internal result block.
+     *
+     * @returns the number of failed points.
+     */
+    int run();
+
+    /**
+     * run the scan into a caller owned block of getResultSize() doubles.
+     *
+     * @returns the number of failed points.
+     */
+    int run(double* result);
+
+    /**
+     * the result block of the last run(), empty if the last run wrote into
+     * a caller owned block.
+     */
+    const std::vector<double>& getResult() const;
+
+    /**
+     * write the result of the last run to a trajectory file, see
+     * TrajectoryWriter, with a row per point and time point. The columns
+     * are the parameter ids followed by the selections.
+     *
+     * @param block the caller owned block the last run wrote into, or 0
+     * for the internal result block.
+     *
+     * @throws std::logic_error if there is no result to write.
+     */
+    void write(const std::string& fileName, const double* block = 0) const;
+
+    /**
+     * the error message of each point of the last run, empty for points
+     * that succeeded.
+     */
+    const std::vector<std::string>& getErrors() const;
+
+    ScanType getScanType() const;
+
+private:
+    SBMLSolver* solver;
+    ScanType type;
+    int threads;
+    bool warmStart;
+
+    std::vector<std::string> ids;
+    std::vector<std::vector<double> > axes;
+    ls::DoubleMatrix points;
+    bool grid;
+
+    std::vector<std::string> selections;
+
+    std::vector<double> result;
+    std::vector<std::string> errors;
+
+    /**
+     * parameter values of point i.
+     */
+    void getPoint(int i, double* values) const;
+
+    friend class ScanWorker;
+};
+
+} /* namespace rr */
+
+#endif /* RR_PARAMETERSCAN_H_ */
@@ -0,0 +1,43 @@
+/*
+ * RandomHash.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_RANDOMHASH_H_
+#define RR_RANDOMHASH_H_
+
+#include <stdint.h>
+
+namespace rr
+{
+
+/**
+ * Counter based random numbers, used where samples must be reproducible
+ * from a seed and an index, independent of the order or the thread they
+ * are generated in, such as the random samples of the sensitivity
+ * analysis and the random starts of the parameter estimation.
+ */
+
+/**
+ * the splitmix64 generator of Steele, Lea and Flood, used as a 64 bit hash.
+ */
+inline uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * uniform in [0, 1) from the upper 53 bits of a 64 bit hash.
+ */
+inline double hashToUnit(uint64_t x)
+{
+    return (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+} /* namespace rr */
+
+#endif /* RR_RANDOMHASH_H_ */
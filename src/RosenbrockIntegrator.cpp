@@ -0,0 +1,534 @@
+/*
+ * RosenbrockIntegrator.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "RosenbrockIntegrator.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <math.h>
+
+extern "C" {
+#include <clapack/f2c.h>
+#include <clapack/clapack.h>
+}
+
+// the f2c min and max macros hide std::min and std::max
+#undef max
+#undef min
+
+using namespace std;
+
+namespace rr
+{
+
+/**
+ * the RODAS4 coefficients of Hairer and Wanner, in the transformed form
+ * which avoids matrix vector products with the Jacobian.
+ */
+static const double gam = 0.25;
+
+static const double c2 = 0.386;
+static const double c3 = 0.21;
+static const double c4 = 0.63;
+
+static const double d1 = 0.25;
+static const double d2 = -0.1043;
+static const double d3 = 0.1035;
+static const double d4 = -0.3620000000000023e-01;
+
+static const double a21 = 0.1544000000000000e+01;
+static const double a31 = 0.9466785280815826e+00;
+static const double a32 = 0.2557011698983284e+00;
+static const double a41 = 0.3314825187068521e+01;
+static const double a42 = 0.2896124015972201e+01;
+static const double a43 = 0.9986419139977817e+00;
+static const double a51 = 0.1221224509226641e+01;
+static const double a52 = 0.6019134481288629e+01;
+static const double a53 = 0.1253708332932087e+02;
+static const double a54 = -0.6878860361058950e+00;
+
+static const double c21 = -0.5668800000000000e+01;
+static const double c31 = -0.2430093356833875e+01;
+static const double c32 = -0.2063599157091915e+00;
+static const double c41 = -0.1073529058151375e+00;
+static const double c42 = -0.9594562251023355e+01;
+static const double c43 = -0.2047028614809616e+02;
+static const double c51 = 0.7496443313967647e+01;
+static const double c52 = -0.1024680431464352e+02;
+static const double c53 = -0.3399990352819905e+02;
+static const double c54 = 0.1170890893206160e+02;
+static const double c61 = 0.8083246795921522e+01;
+static const double c62 = -0.7981132988064893e+01;
+static const double c63 = -0.3152159432874371e+02;
+static const double c64 = 0.1631930543123136e+02;
+static const double c65 = -0.6058818238834054e+01;
+
+static const double d21 = 0.1012623508344586e+02;
+static const double d22 = -0.7487995877610167e+01;
+static const double d23 = -0.3480091861555747e+02;
+static const double d24 = -0.7992771707568823e+01;
+static const double d25 = 0.1025137723295662e+01;
+static const double d31 = -0.6762803392801253e+00;
+static const double d32 = 0.6087714651680015e+01;
+static const double d33 = 0.1643084320892478e+02;
+static const double d34 = 0.2476722511418386e+02;
+static const double d35 = -0.6594389125716872e+01;
+
+/**
+ * step size control, the step size changes by at most these factors.
+ */
+static const double safety = 0.9;
+static const double maxIncrease = 6.0;
+static const double maxDecrease = 0.2;
+
+RosenbrockIntegrator::RosenbrockIntegrator(ExecutableModel *m,
+        const SimulateOptions *o) :
+        AdaptiveIntegrator(m, o),
+        jacobianColoring(true),
+        hprev(0),
+        errprev(0),
+        firstStep(true),
+        jacEvals(0),
+        decomps(0)
+{
+    Log(Logger::LOG_INFORMATION) << "creating rosenbrock integrator";
+
+    ytmp.resize(n);
+    ftmp.resize(n);
+    dfdt.resize(n);
+    err.resize(n);
+    k.resize(5 * n);
+    cont1.resize(n);
+    cont2.resize(n);
+    jac.resize(n * n);
+    lu.resize(n * n);
+    pivots.resize(n);
+}
+
+RosenbrockIntegrator::~RosenbrockIntegrator()
+{
+}
+
+/**
+ * the finite difference increment of a variable.
+ */
+static double increment(double value)
+{
+    static const double eps = std::numeric_limits<double>::epsilon();
+    double delta = sqrt(eps * max(1.e-5, fabs(value)));
+
+    // make the increment exactly representable
+    return (value + delta) - value;
+}
+
+void RosenbrockIntegrator::computeSparsity()
+{
+    sparsity.assign(n, std::vector<int>());
+    columnGroups.clear();
+
+    // entries which happen to be zero at the current state, such as the
+    // derivative of k*A*B to A when B is zero, are picked up at a second,
+    // generic, state.
+    std::vector<double> base[2], baseRate[2];
+    base[0] = y;
+    base[1] = y;
+    for (int j = 0; j < n; ++j)
+    {
+        base[1][j] += 0.1 * (fabs(y[j]) + 1.) * (1. + (double)j / n);
+    }
+
+    std::vector<std::vector<char> > nonZero(n, std::vector<char>(n, 0));
+
+    for (int s = 0; s < 2; ++s)
+    {
+        baseRate[s].resize(n);
+        evalRate(t, &base[s][0], &baseRate[s][0]);
+
+        for (int j = 0; j < n; ++j)
+        {
+            ytmp = base[s];
+            ytmp[j] += increment(ytmp[j]);
+            evalRate(t, &ytmp[0], &ftmp[0]);
+
+            for (int i = 0; i < n; ++i)
+            {
+                // non finite rates are assumed to depend on the variable
+                if (!(ftmp[i] == baseRate[s][i]))
+                {
+                    nonZero[j][i] = 1;
+                }
+            }
+        }
+    }
+
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            if (nonZero[j][i])
+            {
+                sparsity[j].push_back(i);
+            }
+        }
+    }
+
+    // greedy coloring, a column joins the first group where none of the
+    // columns has a non zero in the same row.
+    std::vector<std::vector<char> > groupRows;
+    for (int j = 0; j < n; ++j)
+    {
+        unsigned g = 0;
+        for (; g < columnGroups.size(); ++g)
+        {
+            bool conflict = false;
+            for (unsigned i = 0; i < sparsity[j].size() && !conflict; ++i)
+            {
+                conflict = groupRows[g][sparsity[j][i]];
+            }
+            if (!conflict)
+            {
+                break;
+            }
+        }
+
+        if (g == columnGroups.size())
+        {
+            columnGroups.push_back(std::vector<int>());
+            groupRows.push_back(std::vector<char>(n, 0));
+        }
+
+        columnGroups[g].push_back(j);
+        for (unsigned i = 0; i < sparsity[j].size(); ++i)
+        {
+            groupRows[g][sparsity[j][i]] = 1;
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "rosenbrock jacobian of " << n << " variables "
+            << "is computed with " << columnGroups.size() << " rate evaluations";
+}
+
+void RosenbrockIntegrator::computeJacobian()
+{
+    ++jacEvals;
+
+    if (jacobianColoring && !columnGroups.empty())
+    {
+        std::fill(jac.begin(), jac.end(), 0.);
+
+        for (unsigned g = 0; g < columnGroups.size(); ++g)
+        {
+            const std::vector<int>& group = columnGroups[g];
+
+            ytmp = y;
+            for (unsigned c = 0; c < group.size(); ++c)
+            {
+                ytmp[group[c]] += increment(y[group[c]]);
+            }
+
+            evalRate(t, &ytmp[0], &ftmp[0]);
+
+            for (unsigned c = 0; c < group.size(); ++c)
+            {
+                int j = group[c];
+                double delta = ytmp[j] - y[j];
+                for (unsigned i = 0; i < sparsity[j].size(); ++i)
+                {
+                    int row = sparsity[j][i];
+                    jac[j * n + row] = (ftmp[row] - f0[row]) / delta;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            ytmp = y;
+            double delta = increment(y[j]);
+            ytmp[j] += delta;
+
+            evalRate(t, &ytmp[0], &ftmp[0]);
+
+            for (int i = 0; i < n; ++i)
+            {
+                jac[j * n + i] = (ftmp[i] - f0[i]) / delta;
+            }
+        }
+    }
+
+    // the rates of models with time dependent rules or parameters depend
+    // explicitly on time
+    double dt = increment(t);
+    evalRate(t + dt, &y[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        dfdt[i] = (ftmp[i] - f0[i]) / dt;
+    }
+}
+
+double RosenbrockIntegrator::attemptStep(double hstep)
+{
+    integer N = n;
+    integer one = 1;
+    integer info = 0;
+    char trans = 'N';
+
+    // I/(gamma h) - J
+    for (int i = 0; i < n * n; ++i)
+    {
+        lu[i] = -jac[i];
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        lu[i * n + i] += 1. / (gam * hstep);
+    }
+
+    ++decomps;
+    dgetrf_(&N, &N, &lu[0], &N, &pivots[0], &info);
+
+    if (info != 0)
+    {
+        Log(Logger::LOG_DEBUG) << "rosenbrock iteration matrix is singular "
+                "at time " << t << " with step size " << hstep;
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double *k1 = &k[0], *k2 = &k[n], *k3 = &k[2 * n], *k4 = &k[3 * n],
+            *k5 = &k[4 * n];
+
+    for (int i = 0; i < n; ++i)
+    {
+        k1[i] = f0[i] + hstep * d1 * dfdt[i];
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], k1, &N, &info);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + a21 * k1[i];
+    }
+    evalRate(t + c2 * hstep, &ytmp[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        k2[i] = ftmp[i] + hstep * d2 * dfdt[i] + c21 * k1[i] / hstep;
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], k2, &N, &info);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + a31 * k1[i] + a32 * k2[i];
+    }
+    evalRate(t + c3 * hstep, &ytmp[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        k3[i] = ftmp[i] + hstep * d3 * dfdt[i]
+                + (c31 * k1[i] + c32 * k2[i]) / hstep;
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], k3, &N, &info);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + a41 * k1[i] + a42 * k2[i] + a43 * k3[i];
+    }
+    evalRate(t + c4 * hstep, &ytmp[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        k4[i] = ftmp[i] + hstep * d4 * dfdt[i]
+                + (c41 * k1[i] + c42 * k2[i] + c43 * k3[i]) / hstep;
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], k4, &N, &info);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] = y[i] + a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i];
+    }
+    evalRate(t + hstep, &ytmp[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        k5[i] = ftmp[i]
+                + (c51 * k1[i] + c52 * k2[i] + c53 * k3[i] + c54 * k4[i]) / hstep;
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], k5, &N, &info);
+
+    // the last two stages are the 3rd order embedded solution and the
+    // correction to the 4th order one.
+    for (int i = 0; i < n; ++i)
+    {
+        ytmp[i] += k5[i];
+    }
+    evalRate(t + hstep, &ytmp[0], &ftmp[0]);
+    for (int i = 0; i < n; ++i)
+    {
+        err[i] = ftmp[i] + (c61 * k1[i] + c62 * k2[i] + c63 * k3[i]
+                + c64 * k4[i] + c65 * k5[i]) / hstep;
+    }
+    dgetrs_(&trans, &N, &one, &lu[0], &N, &pivots[0], &err[0], &N, &info);
+
+    for (int i = 0; i < n; ++i)
+    {
+        ynew[i] = ytmp[i] + err[i];
+    }
+
+    return errorNorm(&err[0]);
+}
+
+void RosenbrockIntegrator::beginStep()
+{
+    if (jacobianColoring && sparsity.empty())
+    {
+        computeSparsity();
+    }
+
+    evalRate(t, &y[0], &f0[0]);
+    computeJacobian();
+}
+
+double RosenbrockIntegrator::stepSizeFactor(double h, double e, bool accepted)
+{
+    double fac = max(1. / maxIncrease,
+            min(1. / maxDecrease, pow(e, 0.25) / safety));
+
+    if (!accepted)
+    {
+        return firstStep ? 10. : fac;
+    }
+
+    if (!firstStep)
+    {
+        double facgus = (hprev / h) * pow(e * e / errprev, 0.25) / safety;
+        facgus = max(1. / maxIncrease, min(1. / maxDecrease, facgus));
+        fac = max(fac, facgus);
+    }
+
+    hprev = h;
+    errprev = max(1.e-2, e);
+    firstStep = false;
+
+    return fac;
+}
+
+void RosenbrockIntegrator::acceptStep()
+{
+    const double *k1 = &k[0], *k2 = &k[n], *k3 = &k[2 * n], *k4 = &k[3 * n],
+            *k5 = &k[4 * n];
+
+    for (int i = 0; i < n; ++i)
+    {
+        cont1[i] = d21 * k1[i] + d22 * k2[i] + d23 * k3[i] + d24 * k4[i]
+                + d25 * k5[i];
+        cont2[i] = d31 * k1[i] + d32 * k2[i] + d33 * k3[i] + d34 * k4[i]
+                + d35 * k5[i];
+    }
+}
+
+void RosenbrockIntegrator::denseOutput(double s, double* result)
+{
+    double s1 = 1. - s;
+
+    for (int i = 0; i < n; ++i)
+    {
+        result[i] = yold[i] * s1
+                + s * (ynew[i] + s1 * (cont1[i] + s * cont2[i]));
+    }
+}
+
+void RosenbrockIntegrator::resetHistory()
+{
+    firstStep = true;
+    sparsity.clear();
+    columnGroups.clear();
+}
+
+std::string RosenbrockIntegrator::toRepr() const
+{
+    std::stringstream ss;
+    ss << "< roadrunner.RosenbrockIntegrator() { 'this' : "
+            << (void*)this << " }>";
+    return ss.str();
+}
+
+std::string RosenbrockIntegrator::getName() const
+{
+    return "rosenbrock";
+}
+
+void RosenbrockIntegrator::getStatistics(BasicDictionary& dict) const
+{
+    AdaptiveIntegrator::getStatistics(dict);
+    dict.setItem("NumJacEvals", jacEvals);
+    dict.setItem("NumDecomps", decomps);
+}
+
+void RosenbrockIntegrator::resetStatistics()
+{
+    AdaptiveIntegrator::resetStatistics();
+    jacEvals = decomps = 0;
+}
+
+void RosenbrockIntegrator::setItem(const std::string& key,
+        const rr::Variant& value)
+{
+    if (key == "JacobianColoring")
+    {
+        jacobianColoring = value.convert<bool>();
+        sparsity.clear();
+        columnGroups.clear();
+        return;
+    }
+    AdaptiveIntegrator::setItem(key, value);
+}
+
+Variant RosenbrockIntegrator::getItem(const std::string& key) const
+{
+    if (key == "JacobianColoring")
+    {
+        return jacobianColoring;
+    }
+    else if (key == "NumJacEvals")
+    {
+        return jacEvals;
+    }
+    else if (key == "NumDecomps")
+    {
+        return decomps;
+    }
+    return AdaptiveIntegrator::getItem(key);
+}
+
+bool RosenbrockIntegrator::hasKey(const std::string& key) const
+{
+    return key == "JacobianColoring" || key == "NumJacEvals"
+            || key == "NumDecomps" || AdaptiveIntegrator::hasKey(key);
+}
+
+std::vector<std::string> RosenbrockIntegrator::getKeys() const
+{
+    std::vector<std::string> keys = AdaptiveIntegrator::getKeys();
+    keys.push_back("JacobianColoring");
+    return keys;
+}
+
+const Dictionary* RosenbrockIntegrator::getIntegratorOptions()
+{
+    // static instance
+    static SimulateOptions opt;
+
+    // defaults could have changed, so re-load them.
+    opt = SimulateOptions();
+
+    opt.setItem("integrator", "rosenbrock");
+    opt.setItem("integrator.description", "RODAS4 linearly implicit "
+            "Rosenbrock method with dense output, for small and medium "
+            "sized stiff models");
+    opt.setItem("integrator.hint", "stiff models with few species");
+
+    return &opt;
+}
+
+} /* namespace rr */
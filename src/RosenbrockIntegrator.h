@@ -0,0 +1,176 @@
+/*
+ * RosenbrockIntegrator.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_ROSENBROCKINTEGRATOR_H_
+#define RR_ROSENBROCKINTEGRATOR_H_
+
+#include "AdaptiveIntegrator.h"
+
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+/**
+ * A linearly implicit Rosenbrock integrator for stiff models, the 4th
+ * order RODAS4 method of Hairer and Wanner with an embedded 3rd order error
+ * estimate and a 3rd order dense output.
+ *
+ * Each step needs one LU decomposition of I/(gamma h) - J and six solves,
+ * and no nonlinear iterations. The decomposition is dense, so the
+ * integrator is meant for small and medium sized models.
+ *
+ * The Jacobian is computed by finite differences of the model rate
+ * function. The sparsity pattern of the Jacobian is found when the
+ * integrator is restarted, and the columns which do not share a row are
+ * perturbed together, so a Jacobian of a model where each species only
+ * interacts with a few others takes a few rate evaluations instead of one
+ * per species.
+ */
+class RosenbrockIntegrator: public AdaptiveIntegrator
+{
+public:
+
+    /**
+     * Creates a new RosenbrockIntegrator.
+     *
+     * The IntegratorFactory is the ONLY object that creates integrators.
+     *
+     * @param m: a borrowed reference to an existing ExecutableModel object.
+     * @param o: a reference to a SimulatOptions object where the configuration
+     * parameters will be read from.
+     */
+    RosenbrockIntegrator(ExecutableModel *m, const SimulateOptions *o);
+
+    virtual ~RosenbrockIntegrator();
+
+    /**
+     * get a short descriptions of this object, compatable with python __repr__.
+     */
+    virtual std::string toRepr() const;
+
+    /**
+     * get the name of this integrator
+     */
+    virtual std::string getName() const;
+
+    /**
+     * adds NumJacEvals and NumDecomps to the common statistics.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    virtual void resetStatistics();
+
+    /**
+     * Adds the key JacobianColoring to the common keys, if true, the
+     * default, the columns of the Jacobian are perturbed in groups,
+     * otherwise one at a time.
+     */
+    virtual void setItem(const std::string& key, const rr::Variant& value);
+
+    virtual Variant getItem(const std::string& key) const;
+
+    virtual bool hasKey(const std::string& key) const;
+
+    virtual std::vector<std::string> getKeys() const;
+
+    /**
+     * list of keys that this integrator supports.
+     *
+     * This method is called by the IntegratorFactory to build a list of
+     * all the options that all the integrators support.
+     */
+    static const Dictionary* getIntegratorOptions();
+
+protected:
+
+    /**
+     * the rates and the Jacobian at the start of the step.
+     */
+    virtual void beginStep();
+
+    virtual double attemptStep(double h);
+
+    /**
+     * the predictive controller of Gustafsson.
+     */
+    virtual double stepSizeFactor(double h, double err, bool accepted);
+
+    virtual void acceptStep();
+
+    virtual void denseOutput(double s, double* result);
+
+    /**
+     * discards the step size history, and the Jacobian sparsity pattern,
+     * as events may have changed parameters.
+     */
+    virtual void resetHistory();
+
+    /**
+     * the Jacobian at the start of the step, column major.
+     */
+    std::vector<double> jac;
+
+private:
+
+    /**
+     * find the non zero pattern of the Jacobian, and group its columns.
+     */
+    void computeSparsity();
+
+    /**
+     * the Jacobian at (t, y), column major, and the partial derivative of
+     * the rates to time.
+     */
+    void computeJacobian();
+
+    bool jacobianColoring;
+
+    /**
+     * step size control history.
+     */
+    double hprev;
+    double errprev;
+    bool firstStep;
+
+    std::vector<double> ytmp;
+    std::vector<double> ftmp;
+    std::vector<double> dfdt;
+    std::vector<double> err;
+
+    /**
+     * the stages, k[i * n ... (i + 1) * n).
+     */
+    std::vector<double> k;
+
+    /**
+     * dense output coefficients.
+     */
+    std::vector<double> cont1;
+    std::vector<double> cont2;
+
+    /**
+     * the LU decomposition of I/(gamma h) - J, column major.
+     */
+    std::vector<double> lu;
+    std::vector<long> pivots;
+
+    /**
+     * the rows of the non zero entries of each Jacobian column, and the
+     * groups of columns perturbed together. Empty until the first step
+     * after a restart.
+     */
+    std::vector<std::vector<int> > sparsity;
+    std::vector<std::vector<int> > columnGroups;
+
+    int64_t jacEvals;
+    int64_t decomps;
+};
+
+} /* namespace rr */
+
+#endif /* RR_ROSENBROCKINTEGRATOR_H_ */
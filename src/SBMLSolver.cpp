@@ -14,6 +14,7 @@
 #include "rrCompiler.h"
 #include "rrLogger.h"
 #include "rrUtils.h"
+#include "Tracer.h"
 #include "rrExecutableModel.h"
 #include "rrSBMLModelSimulation.h"
 #include "rr-libstruct/lsLA.h"
@@ -22,14 +23,21 @@
 #include "rrVersionInfo.h"
 #include "Integrator.h"
 #include "rrSteadyStateSolver.h"
+#include "Continuation.h"
 #include "rrSBMLReader.h"
 #include "rrConfig.h"
 #include "SBMLValidator.h"
+#include "StateSaving.h"
+#include "StructuralCache.h"
+#include "FrequencyResponse.h"
+#include "OutputThinning.h"
+#include "TrajectoryFile.h"
 
 #include <sbml/conversion/SBMLLocalParameterConverter.h>
 #include <sbml/conversion/SBMLLevelVersionConverter.h>
 
 #include <iostream>
+#include <fstream>
 #include <math.h>
 #include <assert.h>
 #include <rr-libstruct/lsLibStructural.h>
@@ -88,19 +96,6 @@ static vector<string> createModelStringList(ExecutableModel *model,
  */
 static std::vector<std::string> createSelectionList(const SimulateOptions& o);
 
-/**
- * Some functions needed for the freq. analysis code
- * From Frank Bergmann code, ported to C++ by Totte Karlson
- * Generate log spaced array, algorithm from matlab, note operator precedence
- * y = (10).^ [d1+(0:n-2)*(d2-d1)/(floor(n)-1), d2];
- *
- * d1 = starting value (10^d1)
- * d2 = ending value (10^d2)
- * n = number of values in the generated series
- */
-static vector<double>  logspace(const double& startW, const double& d2, const int& n);
-static double          phase(Complex& val);
-static double          getAdjustment(Complex& z);
 
 /**
  * variable time step integration data struct
@@ -154,6 +149,25 @@ enum ParameterType
  */
 #define assert_similar(a, b) assert(std::abs(a - b) < 1e-13)
 
+/**
+ * simulate performance counters, times are in microseconds.
+ */
+struct SimulateCounters
+{
+    SimulateCounters() : calls(0), time(0), outputRows(0), outputTime(0),
+            resultRows(0) {}
+
+    int64_t calls;
+    int64_t time;
+    int64_t outputRows;
+    int64_t outputTime;
+
+    /**
+     * rows in the results, fewer than outputRows if thinning is on.
+     */
+    int64_t resultRows;
+};
+
 /**
  * implemention class, hide all details here.
  */
@@ -195,6 +209,12 @@ public:
      */
     LibStructural* mLS;
 
+    /**
+     * the shared structural analysis of the current sbml, used by the
+     * structural and MCA queries.
+     */
+    StructuralAnalysisPtr structuralAnalysis;
+
     /**
      * options that are specific to the simulation
      */
@@ -212,6 +232,18 @@ public:
      */
     std::string configurationXML;
 
+    /**
+     * statistics of the last steady state solve.
+     */
+    BasicDictionary steadyStateStatistics;
+
+    /**
+     * counters of the simulate calls, and the dictionary returned by
+     * getPerformanceCounters.
+     */
+    SimulateCounters simulateCounters;
+    BasicDictionary performanceCounters;
+
     /**
      * store the integrators in a map. When the integrator is switched,
      * this way it saves the previous state. Usefull for correct
@@ -240,6 +272,7 @@ public:
                 model(0),
                 mCurrentSBML(),
                 mLS(0),
+                structuralAnalysis(),
                 simulateOpt(),
                 mInstanceID(0),
                 loadOpt(dict),
@@ -261,6 +294,7 @@ public:
                 model(0),
                 mCurrentSBML(),
                 mLS(0),
+                structuralAnalysis(),
                 simulateOpt(),
                 mInstanceID(0),
                 compiler(Compiler::New())
@@ -518,6 +552,26 @@ ls::LibStructural* SBMLSolver::getLibStruct()
     }
 }
 
+/**
+ * the shared structural analysis of the current sbml.
+ */
+static StructuralAnalysisPtr getStructuralAnalysis(RoadRunnerImpl& self)
+{
+    Mutex::ScopedLock lock(roadRunnerMutex);
+
+    if (!self.structuralAnalysis)
+    {
+        if (self.mCurrentSBML.empty())
+        {
+            throw std::invalid_argument("could not create structural analysis with no loaded sbml");
+        }
+
+        self.structuralAnalysis = StructuralCache::get(self.mCurrentSBML);
+    }
+
+    return self.structuralAnalysis;
+}
+
 Compiler* SBMLSolver::getCompiler()
 {
     return impl->compiler;
@@ -669,6 +723,10 @@ double SBMLSolver::getValue(const SelectionRecord& record)
 
     switch (record.selectionType)
     {
+    case SelectionRecord::TIME:
+        dResult = impl->model->getTime();
+        break;
+
     case SelectionRecord::FLOATING_CONCENTRATION:
 
         dResult = 0;
@@ -791,6 +849,101 @@ double SBMLSolver::getValue(const SelectionRecord& record)
     return dResult;
 }
 
+void SBMLSolver::getValues(const SelectionRecord* records, int n, double* values)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        values[i] = getValue(records[i]);
+    }
+}
+
+/**
+ * set a value without resetting the model.
+ *
+ * @returns true if an initial value was set and the model needs a reset.
+ */
+static bool setSelectionValue(ExecutableModel* model,
+        const SelectionRecord& record, double value)
+{
+    const int* index = &record.index;
+
+    switch (record.selectionType)
+    {
+    case SelectionRecord::TIME:
+        model->setTime(value);
+        break;
+    case SelectionRecord::FLOATING_AMOUNT:
+        model->setFloatingSpeciesAmounts(1, index, &value);
+        break;
+    case SelectionRecord::FLOATING_CONCENTRATION:
+        model->setFloatingSpeciesConcentrations(1, index, &value);
+        break;
+    case SelectionRecord::BOUNDARY_CONCENTRATION:
+        model->setBoundarySpeciesConcentrations(1, index, &value);
+        break;
+    case SelectionRecord::COMPARTMENT:
+        model->setCompartmentVolumes(1, index, &value);
+        break;
+    case SelectionRecord::GLOBAL_PARAMETER:
+        if (record.index >= model->getNumGlobalParameters())
+        {
+            // conserved moieties are selected as global parameters past
+            // the end of the parameters, same as in getValue
+            int cmIndex = record.index - model->getNumGlobalParameters();
+            model->setConservedMoietyValues(1, &cmIndex, &value);
+        }
+        else
+        {
+            model->setGlobalParameterValues(1, index, &value);
+        }
+        break;
+    case SelectionRecord::INITIAL_CONCENTRATION:
+    case SelectionRecord::INITIAL_FLOATING_CONCENTRATION:
+        model->setFloatingSpeciesInitConcentrations(1, index, &value);
+        return true;
+    case SelectionRecord::INITIAL_FLOATING_AMOUNT:
+        model->setFloatingSpeciesInitAmounts(1, index, &value);
+        return true;
+    case SelectionRecord::BOUNDARY_AMOUNT:
+        // not part of the ExecutableModel index interface
+        model->setValue(record.p1, value);
+        break;
+    default:
+        throw std::invalid_argument("Invalid selection '" + record.to_string()
+                + "' for setting value");
+    }
+    return false;
+}
+
+void SBMLSolver::setValue(const SelectionRecord& record, double value)
+{
+    check_model();
+
+    if (setSelectionValue(impl->model, record, value))
+    {
+        reset();
+    }
+}
+
+void SBMLSolver::setValues(const SelectionRecord* records, int n,
+        const double* values)
+{
+    check_model();
+
+    bool needsReset = false;
+
+    for (int i = 0; i < n; ++i)
+    {
+        needsReset = setSelectionValue(impl->model, records[i], values[i])
+                || needsReset;
+    }
+
+    if (needsReset)
+    {
+        reset();
+    }
+}
+
 double SBMLSolver::getNthSelectedOutput(unsigned index, double currentTime)
 {
     const SelectionRecord &record = impl->mSelectionList[index];
@@ -807,11 +960,16 @@ double SBMLSolver::getNthSelectedOutput(unsigned index, double currentTime)
 
 void SBMLSolver::getSelectedValues(DoubleMatrix& results, int nRow, double currentTime)
 {
+    int64_t start = getMicroSeconds();
+
     for (u_int j = 0; j < impl->mSelectionList.size(); j++)
     {
         double out =  getNthSelectedOutput(j, currentTime);
         results(nRow,j) = out;
     }
+
+    impl->simulateCounters.outputTime += getMicroSeconds() - start;
+    impl->simulateCounters.outputRows++;
 }
 
 void SBMLSolver::getSelectedValues(std::vector<double>& results,
@@ -820,21 +978,28 @@ void SBMLSolver::getSelectedValues(std::vector<double>& results,
     assert(results.size() == impl->mSelectionList.size()
             && "given vector and selection list different size");
 
+    int64_t start = getMicroSeconds();
+
     u_int size = results.size();
     for (u_int i = 0; i < size; ++i)
     {
         results[i] = getNthSelectedOutput(i, currentTime);
     }
+
+    impl->simulateCounters.outputTime += getMicroSeconds() - start;
+    impl->simulateCounters.outputRows++;
 }
 
 
 vector<double> SBMLSolver::getConservedMoietyValues()
 {
-    return getLibStruct()->getConservedSums();
+    return getStructuralAnalysis(*impl)->conservedSums;
 }
 
 void SBMLSolver::load(const string& uriOrSbml, const Dictionary *dict)
 {
+    RR_TRACE_SCOPE("SBMLSolver::load", "load");
+
     Mutex::ScopedLock lock(roadRunnerMutex);
 
     get_self();
@@ -844,6 +1009,11 @@ void SBMLSolver::load(const string& uriOrSbml, const Dictionary *dict)
     delete impl->model;
     impl->model = 0;
 
+    // the analysis of the previous model
+    delete self.mLS;
+    self.mLS = 0;
+    self.structuralAnalysis.reset();
+
     if(dict) {
         self.loadOpt = LoadSBMLOptions(dict);
     }
@@ -945,6 +1115,169 @@ void SBMLSolver::reset(int options)
     }
 }
 
+/**
+ * identifies a binary SBMLSolver state snapshot, followed by a byte order
+ * mark and the format version.
+ */
+static const char stateMagic[8] = {'S', 'B', 'M', 'L', 'S', 'T', 'A', 'T'};
+static const uint32_t stateByteOrder = 0x01020304;
+static const uint32_t stateVersion = 1;
+
+void SBMLSolver::saveState(std::ostream& out)
+{
+    get_self();
+
+    if (!self.model)
+    {
+        throw CoreException(gEmptyModelMessage);
+    }
+
+    out.write(stateMagic, sizeof(stateMagic));
+    saveBinary(out, stateByteOrder);
+    saveBinary(out, stateVersion);
+
+    saveBinary(out, getMD5(self.mCurrentSBML));
+    saveBinary(out, self.mCurrentSBML);
+    saveBinary(out, self.loadOpt.modelGeneratorOpt);
+    saveBinary(out, (int32_t)self.simulateOpt.integrator);
+
+    self.model->saveState(out);
+    self.integrator->saveState(out);
+
+    if (!out)
+    {
+        throw std::runtime_error("error writing model state");
+    }
+}
+
+void SBMLSolver::restoreState(std::istream& in)
+{
+    get_self();
+
+    char magic[sizeof(stateMagic)];
+    in.read(magic, sizeof(magic));
+    if (!in || memcmp(magic, stateMagic, sizeof(stateMagic)) != 0)
+    {
+        throw std::invalid_argument("stream does not contain an SBMLSolver state");
+    }
+
+    uint32_t byteOrder = 0, version = 0;
+    loadBinary(in, byteOrder);
+    loadBinary(in, version);
+
+    if (byteOrder != stateByteOrder)
+    {
+        throw std::invalid_argument("SBMLSolver state was saved on a machine "
+                "with a different byte order");
+    }
+
+    if (version != stateVersion)
+    {
+        std::stringstream ss;
+        ss << "unsupported SBMLSolver state version " << version
+                << ", expected " << stateVersion;
+        throw std::invalid_argument(ss.str());
+    }
+
+    string md5;
+    string sbml;
+    uint32_t modelGeneratorOpt = 0;
+    int32_t integratorId = 0;
+
+    loadBinary(in, md5);
+    loadBinary(in, sbml);
+    loadBinary(in, modelGeneratorOpt);
+    loadBinary(in, integratorId);
+
+    if (integratorId < 0 || integratorId >= Integrator::INTEGRATOR_END)
+    {
+        throw std::invalid_argument("invalid integrator in SBMLSolver state");
+    }
+
+    if (!self.model)
+    {
+        self.loadOpt.modelGeneratorOpt = modelGeneratorOpt;
+        load(sbml);
+    }
+    else if (md5 != getMD5(self.mCurrentSBML)
+            || self.loadOpt.getConservedMoietyConversion() !=
+                    bool(modelGeneratorOpt & LoadSBMLOptions::CONSERVED_MOIETIES))
+    {
+        throw std::invalid_argument("SBMLSolver state was saved from a "
+                "different model than the currently loaded model");
+    }
+
+    self.simulateOpt.integrator = (Integrator::IntegratorId)integratorId;
+    updateIntegrator();
+
+    self.model->loadState(in);
+    self.integrator->loadState(in);
+
+    // the integrator history is not part of the state, start a new
+    // integration at the restored time.
+    self.integrator->restart(self.model->getTime());
+}
+
+void SBMLSolver::saveState(const std::string& fileName)
+{
+    std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary);
+
+    if (!out)
+    {
+        throw std::invalid_argument("could not open " + fileName + " for writing");
+    }
+
+    saveState(out);
+}
+
+void SBMLSolver::restoreState(const std::string& fileName)
+{
+    std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+
+    if (!in)
+    {
+        throw std::invalid_argument("could not open " + fileName + " for reading");
+    }
+
+    restoreState(in);
+}
+
+SBMLSolver* SBMLSolver::clone()
+{
+    Mutex::ScopedLock lock(roadRunnerMutex);
+
+    get_self();
+
+    SBMLSolver *result = new SBMLSolver();
+    RoadRunnerImpl& copy = *result->impl;
+
+    copy.mCurrentSBML = self.mCurrentSBML;
+    copy.structuralAnalysis = self.structuralAnalysis;
+    copy.loadOpt = self.loadOpt;
+    copy.simulateOpt = self.simulateOpt;
+    copy.roadRunnerOptions = self.roadRunnerOptions;
+    copy.configurationXML = self.configurationXML;
+    copy.mSelectionList = self.mSelectionList;
+    copy.mSteadyStateSelection = self.mSteadyStateSelection;
+
+    if (self.model)
+    {
+        try
+        {
+            copy.model = self.model->clone();
+            result->updateIntegrator();
+            copy.integrator->restart(copy.model->getTime());
+        }
+        catch (...)
+        {
+            delete result;
+            throw;
+        }
+    }
+
+    return result;
+}
+
 bool SBMLSolver::populateResult()
 {
     vector<string> list(impl->mSelectionList.size());
@@ -966,6 +1299,8 @@ std::vector<rr::SelectionRecord>& SBMLSolver::getSelections()
 
 double SBMLSolver::steadyState(const Dictionary* dict)
 {
+    RR_TRACE_SCOPE("SBMLSolver::steadyState", "steadystate");
+
     if (!impl->model)
     {
         throw CoreException(gEmptyModelMessage);
@@ -981,26 +1316,186 @@ double SBMLSolver::steadyState(const Dictionary* dict)
         Log(Logger::LOG_WARNING) << "to remove this warning, set SBMLSOLVER_DISABLE_WARNINGS to 1 or 3 in the config file";
     }
 
-    SteadyStateSolver *steadyStateSolver = SteadyStateSolverFactory::New(dict, impl->model);
+    // solvers which integrate use the simulate options, with the steady
+    // state options on top
+    SimulateOptions opt = impl->simulateOpt;
+
+    if (dict)
+    {
+        std::vector<std::string> keys = dict->getKeys();
+        for (std::vector<std::string>::const_iterator i = keys.begin();
+                i != keys.end(); ++i)
+        {
+            opt.setItem(*i, dict->getItem(*i));
+        }
+    }
+
+    SteadyStateSolver *steadyStateSolver = SteadyStateSolverFactory::New(&opt, impl->model);
 
     //Get a std vector for the solver
     vector<double> someAmounts(impl->model->getNumIndFloatingSpecies(), 0);
     impl->model->getFloatingSpeciesAmounts(someAmounts.size(), 0, &someAmounts[0]);
 
-    double ss = steadyStateSolver->solve(someAmounts);
+    impl->steadyStateStatistics = BasicDictionary();
+
+    double ss = 0;
+
+    try
+    {
+        ss = steadyStateSolver->solve(someAmounts);
+    }
+    catch (...)
+    {
+        steadyStateSolver->getStatistics(impl->steadyStateStatistics);
+        delete steadyStateSolver;
+        throw;
+    }
+
     if(ss < 0)
     {
         Log(Logger::LOG_ERROR)<<"Steady State solver failed...";
     }
 
+    steadyStateSolver->getStatistics(impl->steadyStateStatistics);
 
     delete steadyStateSolver;
 
     return ss;
 }
 
+const Dictionary* SBMLSolver::getSteadyStateStatistics() const
+{
+    return &impl->steadyStateStatistics;
+}
+
+/**
+ * copy the items of src into dst with the keys prefixed.
+ */
+static void addPrefixed(BasicDictionary& dst, const std::string& prefix,
+        const Dictionary& src)
+{
+    std::vector<std::string> keys = src.getKeys();
+    for (std::vector<std::string>::const_iterator i = keys.begin();
+            i != keys.end(); ++i)
+    {
+        dst.setItem(prefix + *i, src.getItem(*i));
+    }
+}
 
+const Dictionary* SBMLSolver::getPerformanceCounters()
+{
+    get_self();
 
+    BasicDictionary& counters = self.performanceCounters;
+    counters = BasicDictionary();
+
+    counters.setItem("simulate.calls", self.simulateCounters.calls);
+    counters.setItem("simulate.time", self.simulateCounters.time / 1.e6);
+    counters.setItem("simulate.outputRows", self.simulateCounters.outputRows);
+    counters.setItem("simulate.outputTime", self.simulateCounters.outputTime / 1.e6);
+    counters.setItem("simulate.resultRows", self.simulateCounters.resultRows);
+    counters.setItem("simulate.compressionRatio",
+            self.simulateCounters.resultRows > 0 ?
+            (double)self.simulateCounters.outputRows / self.simulateCounters.resultRows : 1.);
+
+    if (self.integrator)
+    {
+        BasicDictionary stats;
+        self.integrator->getStatistics(stats);
+        addPrefixed(counters, "integrator.", stats);
+    }
+
+    if (self.model)
+    {
+        BasicDictionary stats;
+        self.model->getStatistics(stats);
+        addPrefixed(counters, "model.", stats);
+    }
+
+    addPrefixed(counters, "steadyState.", self.steadyStateStatistics);
+
+    return &counters;
+}
+
+void SBMLSolver::resetPerformanceCounters()
+{
+    get_self();
+
+    self.simulateCounters = SimulateCounters();
+
+    for (int i = 0; i < Integrator::INTEGRATOR_END; ++i)
+    {
+        if (self.integrators[i])
+        {
+            self.integrators[i]->resetStatistics();
+        }
+    }
+
+    if (self.model)
+    {
+        self.model->resetStatistics();
+    }
+}
+
+
+
+
+ls::DoubleMatrix SBMLSolver::continuation(const std::string& parameterId,
+        double start, double end, const Dictionary* options)
+{
+    check_model();
+
+    get_self();
+
+    if (!self.loadOpt.getConservedMoietyConversion() &&
+            (Config::getBool(Config::SBMLSOLVER_DISABLE_WARNINGS)
+                & Config::SBMLSOLVER_DISABLE_WARNINGS_STEADYSTATE) == 0)
+    {
+        Log(Logger::LOG_WARNING) << "Conserved Moiety Analysis is not enabled, continuation may fail with singular Jacobian";
+    }
+
+    Continuation continuation(self.model, parameterId, options);
+
+    // the continuation moves the model along the branch, save the
+    // current state so it can be put back.
+    int index = self.model->getGlobalParameterIndex(parameterId);
+    double savedValue = 0;
+    self.model->getGlobalParameterValues(1, &index, &savedValue);
+
+    vector<double> savedAmounts(self.model->getNumIndFloatingSpecies());
+    if (savedAmounts.size())
+    {
+        self.model->getFloatingSpeciesAmounts(savedAmounts.size(), 0, &savedAmounts[0]);
+    }
+
+    DoubleMatrix result;
+
+    try
+    {
+        result = continuation.run(start, end);
+    }
+    catch (...)
+    {
+        self.model->setGlobalParameterValues(1, &index, &savedValue);
+        if (savedAmounts.size())
+        {
+            self.model->setFloatingSpeciesAmounts(savedAmounts.size(), 0, &savedAmounts[0]);
+        }
+        throw;
+    }
+
+    self.model->setGlobalParameterValues(1, &index, &savedValue);
+    if (savedAmounts.size())
+    {
+        self.model->setFloatingSpeciesAmounts(savedAmounts.size(), 0, &savedAmounts[0]);
+    }
+
+    Log(Logger::LOG_DEBUG) << "continuation of " << parameterId << ": "
+            << continuation.getNumSteps() << " steps, "
+            << continuation.getNumRejectedSteps() << " rejected";
+
+    return result;
+}
 
 void SBMLSolver::setConservedMoietyAnalysis(bool value)
 {
@@ -1190,8 +1685,49 @@ void SBMLSolver::evalModel()
 }
 
 
+/**
+ * copies the selected values at the output times of a fixed step
+ * simulation into the result matrix, or gives them to the thinning.
+ */
+class SimulateSampleListener : public IntegratorSampleListener
+{
+public:
+    SimulateSampleListener(SBMLSolver* solver, DoubleMatrix& result,
+            OutputThinning* thinning, std::vector<double>& row) :
+        solver(solver), result(result), thinning(thinning), row(row)
+    {
+    }
+
+    virtual void onSample(int index, double time)
+    {
+        if (thinning)
+        {
+            solver->getSelectedValues(row, time);
+            thinning->add(row, time);
+        }
+        else
+        {
+            solver->getSelectedValues(result, index, time);
+        }
+    }
+
+private:
+    SBMLSolver* solver;
+    DoubleMatrix& result;
+    OutputThinning* thinning;
+    std::vector<double>& row;
+};
+
 const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
 {
+    return simulate(dict, 0);
+}
+
+const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict,
+        TrajectoryWriter* output)
+{
+    RR_TRACE_SCOPE("SBMLSolver::simulate", "simulate");
+
     get_self();
     check_model();
 
@@ -1203,12 +1739,27 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
 
     updateSimulateOptions();
 
+    if (output && output->getNumColumns() != (int)self.mSelectionList.size())
+    {
+        throw std::invalid_argument("the output file has "
+                + toString(output->getNumColumns()) + " columns, but there are "
+                + toString((int)self.mSelectionList.size()) + " selections");
+    }
+
+    const int64_t simulateStart = getMicroSeconds();
+
     const double timeEnd = self.simulateOpt.duration + self.simulateOpt.start;
     const double timeStart = self.simulateOpt.start;
 
     // evalute the model with its current state
     self.model->getStateVectorRate(timeStart, 0, 0);
 
+    // output rows go through the thinning instead of into the result, which
+    // writes the rows it keeps to the output file if there is one
+    OutputThinning thinning(self.simulateOpt, self.mSelectionList, output);
+    const bool thin = (self.simulateOpt.thinning != SimulateOptions::THINNING_NONE
+            || output) && self.mSelectionList.size() > 0;
+
     // Variable Time Step Integration
     if (self.simulateOpt.integratorFlags & Integrator::VARIABLE_STEP )
     {
@@ -1221,7 +1772,14 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
         {
             // add current state as first row
             getSelectedValues(row, timeStart);
-            results.push_back(row);
+            if (thin)
+            {
+                thinning.add(row, timeStart);
+            }
+            else
+            {
+                results.push_back(row);
+            }
 
             self.integrator->restart(timeStart);
 
@@ -1241,11 +1799,25 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
                 {
                     // time step is at infinity so bail, but get the last value
                     getSelectedValues(row, timeEnd);
-                    results.push_back(row);
+                    if (thin)
+                    {
+                        thinning.add(row, timeEnd);
+                    }
+                    else
+                    {
+                        results.push_back(row);
+                    }
                     break;
                 }
                 getSelectedValues(row, tout);
-                results.push_back(row);
+                if (thin)
+                {
+                    thinning.add(row, tout);
+                }
+                else
+                {
+                    results.push_back(row);
+                }
             }
         }
         catch (EventListenerException& e)
@@ -1253,15 +1825,22 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
             Log(Logger::LOG_NOTICE) << e.what();
         }
 
-        // stuff list values into result matrix
-        self.simulationResult.resize(results.size(), row.size());
-        uint rowi = 0;
-        for (DoubleVectorList::const_iterator i = results.begin();
-                i != results.end(); ++i, ++rowi)
+        if (thin)
         {
-            // evidently [] operator gets row, go figure...
-            double* prow = self.simulationResult[rowi];
-            std::copy(i->begin(), i->end(), prow);
+            thinning.getResult(self.simulationResult);
+        }
+        else
+        {
+            // stuff list values into result matrix
+            self.simulationResult.resize(results.size(), row.size());
+            uint rowi = 0;
+            for (DoubleVectorList::const_iterator i = results.begin();
+                    i != results.end(); ++i, ++rowi)
+            {
+                // evidently [] operator gets row, go figure...
+                double* prow = self.simulationResult[rowi];
+                std::copy(i->begin(), i->end(), prow);
+            }
         }
     }
 
@@ -1287,13 +1866,26 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
 
         Log(Logger::LOG_DEBUG) << "starting simulation with " << nrCols << " selected columns";
 
+        std::vector<double> row(nrCols);
+
         // ignored if same
-        self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        if (!thin)
+        {
+            self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        }
 
         try
         {
             // add current state as first row
-            getSelectedValues(self.simulationResult, 0, timeStart);
+            if (thin)
+            {
+                getSelectedValues(row, timeStart);
+                thinning.add(row, timeStart);
+            }
+            else
+            {
+                getSelectedValues(self.simulationResult, 0, timeStart);
+            }
 
             self.integrator->restart(timeStart);
 
@@ -1316,7 +1908,15 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
                 // get the output, always get at least one output
                 do
                 {
-                    getSelectedValues(self.simulationResult, i, next);
+                    if (thin)
+                    {
+                        getSelectedValues(row, next);
+                        thinning.add(row, next);
+                    }
+                    else
+                    {
+                        getSelectedValues(self.simulationResult, i, next);
+                    }
                     i++;
                     next = timeStart + i * hstep;
                 }
@@ -1327,6 +1927,11 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
         {
             Log(Logger::LOG_NOTICE) << e.what();
         }
+
+        if (thin)
+        {
+            thinning.getResult(self.simulationResult);
+        }
     }
 
     // Deterministic Fixed Step Integration
@@ -1348,44 +1953,56 @@ const DoubleMatrix* SBMLSolver::simulate(const Dictionary* dict)
 
         Log(Logger::LOG_DEBUG) << "starting simulation with " << nrCols << " selected columns";
 
+        std::vector<double> row(nrCols);
+
         // ignored if same
-        self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        if (!thin)
+        {
+            self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        }
 
         try
         {
+            SimulateSampleListener listener(this, self.simulationResult,
+                    thin ? &thinning : 0, row);
+
             // add current state as first row
-            getSelectedValues(self.simulationResult, 0, timeStart);
+            listener.onSample(0, timeStart);
 
             self.integrator->restart(timeStart);
 
             // optimiziation for certain getValue operations.
             self.model->setIntegration(true);
 
-            double tout = timeStart;
-
-            for (int i = 1; i < self.simulateOpt.steps + 1; i++)
-            {
-                Log(Logger::LOG_DEBUG)<<"Step "<<i;
-                double itime = self.integrator->integrate(tout, hstep);
-
-                // the test suite is extremly sensetive to time differences,
-                // so need to use the *exact* time here. occasionally the integrator
-                // will return a value just slightly off from the exact time
-                // value.
-                tout = timeStart + i * hstep;
-                getSelectedValues(self.simulationResult, i, tout);
-            }
+            self.integrator->sample(timeStart, hstep, self.simulateOpt.steps,
+                    listener);
         }
         catch (EventListenerException& e)
         {
             Log(Logger::LOG_NOTICE) << e.what();
         }
+
+        if (thin)
+        {
+            thinning.getResult(self.simulationResult);
+        }
     }
 
     // done with integration
 
     self.model->setIntegration(false);
 
+    if (thin && self.simulateOpt.thinning != SimulateOptions::THINNING_NONE)
+    {
+        Log(Logger::LOG_INFORMATION) << "thinning kept " << thinning.getKeptRows()
+                << " of " << thinning.getRows() << " rows";
+    }
+
+    self.simulateCounters.calls++;
+    self.simulateCounters.time += getMicroSeconds() - simulateStart;
+    self.simulateCounters.resultRows += thin ? thinning.getKeptRows()
+            : self.simulationResult.numRows();
+
     Log(Logger::LOG_DEBUG) << "Simulation done..";
 
     return &self.simulationResult;
@@ -1463,19 +2080,12 @@ DoubleMatrix SBMLSolver::getFullJacobian()
 
     DoubleMatrix uelast = getUnscaledElasticityMatrix();
 
-    // ptr to libstruct owned obj.
-    DoubleMatrix *rsm;
-    LibStructural *ls = getLibStruct();
-    if (self.loadOpt.getConservedMoietyConversion())
-    {
-        rsm = ls->getReorderedStoichiometryMatrix();
-    }
-    else
-    {
-        rsm = ls->getStoichiometryMatrix();
-    }
+    // shared, read only analysis
+    StructuralAnalysisPtr sa = getStructuralAnalysis(self);
+    const DoubleMatrix& rsm = self.loadOpt.getConservedMoietyConversion() ?
+            sa->reorderedStoichiometryMatrix : sa->stoichiometryMatrix;
 
-    DoubleMatrix jac = ls::mult(*rsm, uelast);
+    DoubleMatrix jac = ls::mult(rsm, uelast);
 
     // get the row/column ids, independent floating species
     std::list<std::string> list;
@@ -1493,10 +2103,9 @@ DoubleMatrix SBMLSolver::getFullReorderedJacobian()
 {
     check_model();
 
-    LibStructural *ls = getLibStruct();
+    StructuralAnalysisPtr sa = getStructuralAnalysis(*impl);
     DoubleMatrix uelast = getUnscaledElasticityMatrix();
-    DoubleMatrix *rsm = ls->getStoichiometryMatrix();
-    return mult(*rsm, uelast);
+    return mult(sa->stoichiometryMatrix, uelast);
 }
 
 DoubleMatrix SBMLSolver::getReducedJacobian(double h)
@@ -1594,14 +2203,7 @@ DoubleMatrix SBMLSolver::getLinkMatrix()
 {
     check_model();
 
-    ls::LibStructural *ls = getLibStruct();
-
-    // pointer to owned matrix
-    DoubleMatrix res = *ls->getLinkMatrix();
-
-    ls->getLinkMatrixLabels(res.getRowNames(), res.getColNames());
-
-    return res;
+    return getStructuralAnalysis(*impl)->linkMatrix;
 }
 
 DoubleMatrix SBMLSolver::getReducedStoichiometryMatrix()
@@ -1613,28 +2215,14 @@ DoubleMatrix SBMLSolver::getNrMatrix()
 {
     check_model();
 
-    ls::LibStructural *ls = getLibStruct();
-
-    // pointer to owned matrix
-    DoubleMatrix res = *ls->getNrMatrix();
-
-    ls->getNrMatrixLabels(res.getRowNames(), res.getColNames());
-
-    return res;
+    return getStructuralAnalysis(*impl)->nrMatrix;
 }
 
 DoubleMatrix SBMLSolver::getKMatrix()
 {
     check_model();
 
-    ls::LibStructural *ls = getLibStruct();
-
-    // pointer to owned matrix
-    DoubleMatrix res = *ls->getKMatrix();
-
-    ls->getKMatrixLabels(res.getRowNames(), res.getColNames());
-
-    return res;
+    return getStructuralAnalysis(*impl)->kMatrix;
 }
 
 
@@ -1642,35 +2230,19 @@ DoubleMatrix SBMLSolver::getFullStoichiometryMatrix()
 {
     check_model();
     get_self();
-    ls::LibStructural *ls = getLibStruct();
+    StructuralAnalysisPtr sa = getStructuralAnalysis(self);
 
     if (self.loadOpt.getConservedMoietyConversion()) {
-        // pointer to mat owned by ls
-        DoubleMatrix m = *ls->getReorderedStoichiometryMatrix();
-        ls->getFullyReorderedStoichiometryMatrixLabels(
-                m.getRowNames(), m.getColNames());
-        return m;
+        return sa->reorderedStoichiometryMatrix;
     }
 
-    // pointer to owned matrix
-    DoubleMatrix m = *ls->getStoichiometryMatrix();
-    ls->getStoichiometryMatrixLabels(m.getRowNames(), m.getColNames());
-    return m;
+    return sa->stoichiometryMatrix;
 }
 
 DoubleMatrix SBMLSolver::getL0Matrix()
 {
     check_model();
-    ls::LibStructural *ls = getLibStruct();
-
-    // the libstruct getL0Matrix returns a NEW matrix,
-    // nice consistent API yes?!?!?
-    DoubleMatrix *tmp = ls->getL0Matrix();
-    DoubleMatrix m = *tmp;
-    delete tmp;
-
-    ls->getL0MatrixLabels(m.getRowNames(), m.getColNames());
-    return m;
+    return getStructuralAnalysis(*impl)->l0Matrix;
 }
 
 
@@ -1682,16 +2254,14 @@ DoubleMatrix SBMLSolver::getConservationMatrix()
     {
        if (impl->model)
        {
-           DoubleMatrix* aMat = getLibStruct()->getGammaMatrix();
-            if (aMat)
+            StructuralAnalysisPtr sa = getStructuralAnalysis(*impl);
+            const DoubleMatrix* aMat = &sa->gammaMatrix;
+            mat.resize(aMat->numRows(), aMat->numCols());
+            for(int row = 0; row < mat.RSize(); row++)
             {
-                mat.resize(aMat->numRows(), aMat->numCols());
-                for(int row = 0; row < mat.RSize(); row++)
+                for(int col = 0; col < mat.CSize(); col++)
                 {
-                    for(int col = 0; col < mat.CSize(); col++)
-                    {
-                        mat(row,col) = (*aMat)(row,col);
-                    }
+                    mat(row,col) = (*aMat)(row,col);
                 }
             }
             return mat;
@@ -1713,7 +2283,7 @@ int SBMLSolver::getNumberOfDependentSpecies()
         if (impl->model)
         {
             //return mStructAnalysis.GetInstance()->getNumDepSpecies();
-            return getLibStruct()->getNumDepSpecies();
+            return getStructuralAnalysis(*impl)->numDependentSpecies;
         }
 
         throw CoreException(gEmptyModelMessage);
@@ -1732,7 +2302,7 @@ int SBMLSolver::getNumberOfIndependentSpecies()
     {
         if (impl->model)
         {
-            return getLibStruct()->getNumIndSpecies();
+            return getStructuralAnalysis(*impl)->numIndependentSpecies;
         }
         //return StructAnalysis.getNumIndSpecies();
         throw CoreException(gEmptyModelMessage);
@@ -2557,30 +3127,28 @@ DoubleMatrix SBMLSolver::getScaledElasticityMatrix()
 
     check_model();
 
-    DoubleMatrix uelast = getUnscaledElasticityMatrix();
-    DoubleMatrix result(uelast.RSize(), uelast.CSize());
-
-    result.setColNames(uelast.getColNames());
-    result.setRowNames(uelast.getRowNames());
+    // scaled in place
+    DoubleMatrix result = getUnscaledElasticityMatrix();
 
     vector<double> rates(self.model->getNumReactions());
     self.model->getReactionRates(rates.size(), 0, &rates[0]);
 
-    if (uelast.RSize() != rates.size())
+    vector<double> concentrations(self.model->getNumFloatingSpecies());
+    self.model->getFloatingSpeciesConcentrations(concentrations.size(), 0,
+            &concentrations[0]);
+
+    if (result.RSize() != rates.size())
     {
         // this should NEVER happen
         throw std::runtime_error("row count of unscaled elasticity different "
                 "than # of reactions");
     }
 
-    for (int i = 0; i < uelast.RSize(); i++)
+    for (int i = 0; i < result.RSize(); i++)
     {
-        for (int j = 0; j < uelast.CSize(); j++) // Columns are species
+        for (int j = 0; j < result.CSize(); j++) // Columns are species
         {
-            double concentration = 0;
-            self.model->getFloatingSpeciesConcentrations(1, &j, &concentration);
-
-            result[i][j] = uelast[i][j]*concentration/rates[i];
+            result[i][j] = result[i][j]*concentrations[j]/rates[i];
         }
     }
     return result;
@@ -2639,26 +3207,26 @@ DoubleMatrix SBMLSolver::getUnscaledConcentrationControlCoefficientMatrix()
         }
     }
 
-    // Compute the Jacobian first
-    DoubleMatrix uelast     = getUnscaledElasticityMatrix();
-    DoubleMatrix Nr         = getNrMatrix();
-    DoubleMatrix T1 = mult(Nr, uelast);
-    DoubleMatrix LinkMatrix = getLinkMatrix();
-    DoubleMatrix Jac = mult(T1, LinkMatrix);
+    // the shared Nr and L, not copies
+    StructuralAnalysisPtr sa = getStructuralAnalysis(self);
+    const DoubleMatrix& Nr = sa->nrMatrix;
+    const DoubleMatrix& LinkMatrix = sa->linkMatrix;
 
-    // Compute -Jac
-    DoubleMatrix T2 = Jac * (-1.0);
+    // Compute the Jacobian first
+    DoubleMatrix uelast = getUnscaledElasticityMatrix();
+    DoubleMatrix Jac = mult(mult(Nr, uelast), LinkMatrix);
 
-    ComplexMatrix temp(T2); //Get a complex matrix from a double one. Imag part is zero
-    ComplexMatrix Inv = GetInverse(temp);
+    // Compute -Jac, in place
+    for (unsigned i = 0; i < Jac.size(); ++i)
+    {
+        Jac[0][i] = -Jac[0][i];
+    }
 
-    // &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&
-    // Sauro: mult which takes complex matrix need to be implemented
-    DoubleMatrix T3 = mult(Inv, Nr); // Compute ( - Jac)^-1 . Nr
+    ComplexMatrix Inv = GetInverse(ComplexMatrix(Jac)); //Imag part is zero
 
-    // Finally include the dependent set as well.
-    DoubleMatrix T4 = mult(LinkMatrix, T3); // Compute L (iwI - Jac)^-1 . Nr
-    return T4;
+    // Compute ( - Jac)^-1 . Nr, then include the dependent set as well,
+    // L (iwI - Jac)^-1 . Nr
+    return mult(LinkMatrix, mult(Inv, Nr));
 }
 
 
@@ -2672,16 +3240,17 @@ DoubleMatrix SBMLSolver::getScaledConcentrationControlCoefficientMatrix()
 
     if (ucc.size() > 0 )
     {
+        vector<double> conc(ucc.RSize());
+        self.model->getFloatingSpeciesConcentrations(conc.size(), 0, &conc[0]);
+
+        vector<double> rates(ucc.CSize());
+        self.model->getReactionRates(rates.size(), 0, &rates[0]);
+
         for (int i = 0; i < ucc.RSize(); i++)
         {
             for (int j = 0; j < ucc.CSize(); j++)
             {
-                double conc = 0;
-                self.model->getFloatingSpeciesConcentrations(1, &i, &conc);
-
-                double rate = 0;
-                self.model->getReactionRates(1, &j, &rate);
-                ucc[i][j] = ucc[i][j] * rate / conc;
+                ucc[i][j] = ucc[i][j] * rates[j] / conc[i];
             }
         }
     }
@@ -2696,10 +3265,8 @@ DoubleMatrix SBMLSolver::getUnscaledFluxControlCoefficientMatrix()
 
     check_model();
 
-    DoubleMatrix ucc = getUnscaledConcentrationControlCoefficientMatrix();
-    DoubleMatrix uee = getUnscaledElasticityMatrix();
-
-    DoubleMatrix T1 = mult(uee, ucc);
+    DoubleMatrix T1 = mult(getUnscaledElasticityMatrix(),
+            getUnscaledConcentrationControlCoefficientMatrix());
 
     // Add an identity matrix I to T1, that is add a 1 to every diagonal of T1
     for (int i=0; i<T1.RSize(); i++) {
@@ -2723,16 +3290,17 @@ DoubleMatrix SBMLSolver::getScaledFluxControlCoefficientMatrix()
 
         if (ufcc.RSize() > 0)
         {
+            vector<double> rates(impl->model->getNumReactions());
+            impl->model->getReactionRates(rates.size(), 0, &rates[0]);
+
             for (int i = 0; i < ufcc.RSize(); i++)
             {
                 for (int j = 0; j < ufcc.CSize(); j++)
                 {
-                    double irate = 0;
-                    impl->model->getReactionRates(1, &i, &irate);
+                    double irate = rates[i];
                     if(irate !=0)
                     {
-                        double jrate = 0;
-                        impl->model->getReactionRates(1, &j, &jrate);
+                        double jrate = rates[j];
                         ufcc[i][j] = ufcc[i][j] * jrate / irate;
                     }
                     else
@@ -3200,117 +3768,25 @@ Matrix<double> SBMLSolver::getFrequencyResponse(double startFrequency,
 
     try
     {
-        vector<string> reactionNames = getReactionIds();
-        vector<string> speciesNames = getFloatingSpeciesIds();
-
-        // Prepare the dv/dp array
-        Matrix< Complex > dvdp(reactionNames.size(), 1);
-
-        //Guess we don't need to simulate here?? (TK)
-        //        SimulateOptions opt;
-        //        opt.start = 0;
-        //        opt.duration = 50.0;
-        //        opt.steps = 1;
-        //        simulate(&opt);
-        if(steadyState() > 1E-2)
-        {
-            throw Exception("Unable to locate steady state during frequency response computation");
-        }
-
-        ComplexMatrix uelast(getUnscaledElasticityMatrix());
-        ComplexMatrix Nr = getNrMatrix();
-        ComplexMatrix LinkMatrix = getLinkMatrix();
+        BasicDictionary options;
+        options.setItem("use_db", useDB);
+        options.setItem("use_hz", useHz);
 
-        // Compute dv/dp
-        for (int j = 0; j < reactionNames.size(); j++)
-        {
-            double val = getUnscaledParameterElasticity(reactionNames[j], parameterName);
-            dvdp(j, 0) = Complex(val, 0.0);
-            Log(lDebug)<<"dv/dp: " << dvdp(j, 0);
-        }
-
-        // Compute the Jacobian first
-        ComplexMatrix T1(Nr.RSize(), uelast.CSize());
-        T1 = mult(Nr, uelast);
-        Log(lInfo)<<T1;
-
-        ComplexMatrix Jac(Nr.RSize(), LinkMatrix.CSize());
-        Jac = mult(T1, LinkMatrix);
+        FrequencyResponse response(this, &options);
+        response.addParameter(parameterName);
+        response.addVariable(variableName);
+        response.run(startFrequency, numberOfDecades, numberOfPoints);
 
-        ComplexMatrix Id(Nr.RSize(), Nr.RSize());
-
-        //Create Identity matrix
-        for(int i = 0; i < Id.RSize(); i++)
-        {
-            Id(i,i) = Complex(1,0);
-        }
-
-        ComplexMatrix T2(Nr.RSize(), LinkMatrix.CSize());   // Stores iwI - Jac  and (iwI - Jac)^-1
-        ComplexMatrix T3(LinkMatrix.RSize(), 1);            // Stores (iwI - Jac)^-1 . Nr
-        ComplexMatrix T4(Nr.RSize(), Nr.CSize());
-        ComplexMatrix T5(LinkMatrix.RSize(), 1);
-        ComplexMatrix Inv(Nr.RSize(), LinkMatrix.CSize());
-
-        // resultArray stores frequency, gain and phase
-        Matrix<double> resultArray(numberOfPoints, 3);
-
-        // Main loop, generate log spaced frequency numbers and compute the gain and phase at each frequency
-        vector<double> w(logspace(startFrequency, numberOfDecades, numberOfPoints));
-
-        for (int i = 0; i < numberOfPoints; i++)
-        {
-            Complex diagVal(0.0, w[i]);
-
-            T1 = multDiag(Id, diagVal); // Compute iwI
-            T2 = subtract(T1, Jac);     // Compute iwI - Jac //// Compute (iwI - Jac)^-1
-            Inv = GetInverse(T2);
-            T3  = mult(Inv, Nr);        // Compute (iwI - Jac)^-1 . Nr
-
-            for (int j = 0; j < reactionNames.size(); j++)
-            {
-                double realPart = getUnscaledParameterElasticity(reactionNames[j], parameterName);
-                dvdp(j, 0) = ls::Complex(realPart, 0.0);
-            }
-
-            T4 = mult(T3, dvdp);    // Compute(iwI - Jac)^-1 . Nr . dvdp
-
-            // Finally include the dependent set as well.
-            T5 = mult(LinkMatrix, T4); // Compute L (iwI - Jac)^-1 . Nr . dvdp
-
-            for (int j = 0; j < speciesNames.size(); j++)
-            {
-                if (speciesNames[j] == variableName)
-                {
-                    double dw = abs(T5(j, 0));
-                    if (useDB)
-                    {
-                        dw = 20.0*log10(dw);
-                    }
-                    resultArray(i,1) = dw;
-                    Complex val(T5(j, 0));
-
-                    double phase = (180.0/M_PI) * rr::phase(val) + getAdjustment(val);
-                    resultArray(i,2) = phase;
-                    break;
-                }
-            }
-            if (useHz)
-            {
-                // Store frequency, convert to Hz by dividing by 2Pi
-                resultArray[i][0] = w[i]/(2.*M_PI);
-            }
-            else
-            {
-                // Store frequency, leave as rad/sec
-                resultArray[i][0] = w[i];
-            }
-        }
-        return resultArray;
+        return response.getResponse(variableName, parameterName);
     }
     catch(const Exception& e)
     {
       throw Exception("Unexpected error in getFrequencyResponse(): " +  e.Message());
     }
+    catch(const std::exception& e)
+    {
+      throw Exception(string("Unexpected error in getFrequencyResponse(): ") +  e.what());
+    }
 }
 
 
@@ -3410,57 +3886,6 @@ double SBMLSolver::getUnscaledParameterElasticity(const string& reactionName, co
 
 
 
-vector<double> logspace(const double& startW, const double& d2, const int& n)
-{
-    double d1 = 0;
-    vector<double> y(n);
-    for (int i = 0; i <= n - 2; i++)
-    {
-        y[i] = i*(d2 - d1);
-        y[i] = y[i]/(n - 1);
-        y[i] = d1 + y[i];
-        y[i] = pow(10, y[i]) * startW;
-    }
-    y[n - 1] = pow(10, d2)*startW;
-    return y;
-}
-
-double phase(Complex& val)
-{
-    if ((std::real(val) == 0.0) && (imag(val) == 0.0))
-    {
-        return 0.0;
-    }
-    else
-    {
-        return atan2(imag(val), std::real(val));
-    }
-}
-
-//This function is used in roadrunners freq analysis code...
-double getAdjustment(Complex& z)
-{
-    double adjustment;
-    if (std::real(z) >= 0 && imag(z) >= 0)
-    {
-        adjustment = 0;
-    }
-    else if (std::real(z) >= 0 && imag(z) < 0)
-    {
-        adjustment = 360;
-    }
-    else if (std::real(z) < 0 && imag(z) >= 0)
-    {
-        adjustment = 0;
-    }
-    else
-    {
-        adjustment = 360;
-    }
-    return adjustment;
-}
-
-
 /************************ Selection Ids Species Section ***********************/
 #if (1) /**********************************************************************/
 /******************************************************************************/
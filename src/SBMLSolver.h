@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <iosfwd>
 #include "include/MxReactionNetwork.h"
 
 namespace ls
@@ -38,6 +39,7 @@ class ModelGenerator;
 class SBMLModelSimulation;
 class ExecutableModel;
 class Integrator;
+class TrajectoryWriter;
 
 /**
  * The main SBMLSolver class.
@@ -208,6 +210,21 @@ public:
      */
     const ls::DoubleMatrix *simulate(const Dictionary* options = 0);
 
+    /**
+     * simulate, and write the result rows to a trajectory file as they are
+     * produced, instead of keeping them in the result matrix, which is left
+     * without rows. The rows are thinned first if the thinning option is set.
+     *
+     * The file is not closed, so the results of several simulations can be
+     * written to it.
+     *
+     * @param output a trajectory file with a column per selection.
+     * @throws std::invalid_argument if output has a different number of
+     * columns.
+     */
+    const ls::DoubleMatrix *simulate(const Dictionary* options,
+            TrajectoryWriter* output);
+
     /**
      * RoadRunner keeps a copy of the simulation data around until the
      * next call to simulate. This matrix can be obtained here.
@@ -284,6 +301,52 @@ public:
      */
     void reset(int options);
 
+    /**
+     * Write a binary snapshot of the complete simulation state to a stream.
+     *
+     * The snapshot contains the sbml document, the model data block (time,
+     * state vector, parameters, volumes, random number generator and the
+     * pending event queue) and the state of the current integrator. It is
+     * written in the native byte order and can only be restored on a machine
+     * with the same endianness.
+     *
+     * The integrator itself is restarted at the restored time when the state
+     * is loaded, so an adaptive step size history is not preserved.
+     */
+    void saveState(std::ostream& out);
+
+    /**
+     * Restore a snapshot written by saveState.
+     *
+     * If no model is loaded, the model is loaded from the sbml stored in the
+     * snapshot. If a model is loaded, it must have been created from the
+     * same sbml document, otherwise an std::invalid_argument is thrown.
+     */
+    void restoreState(std::istream& in);
+
+    /**
+     * Save the simulation state to a binary file, see saveState(std::ostream&).
+     */
+    void saveState(const std::string& fileName);
+
+    /**
+     * Restore the simulation state from a binary file written by
+     * saveState(const std::string&).
+     */
+    void restoreState(const std::string& fileName);
+
+    /**
+     * Create an independent copy of this object.
+     *
+     * The copy shares the compiled model code with this object, so no
+     * sbml parsing or code generation is performed, but owns a separate
+     * copy of the model data, selections and integrator. The copy can be
+     * used concurrently with the original in a different thread.
+     *
+     * The caller owns the returned object.
+     */
+    SBMLSolver* clone();
+
     /**
      * @internal
      * set the floating species initial concentrations.
@@ -338,6 +401,41 @@ public:
 
     double getValue(const SelectionRecord& record);
 
+    /**
+     * Get the values of several selections at once.
+     *
+     * Selections created with createSelection are resolved handles: they
+     * hold the element type and its index in the model, so getting or
+     * setting them does no string parsing or id lookups. Create them once
+     * outside of a loop, and use getValues / setValues in the loop.
+     *
+     * Selections are bound to the currently loaded model, they must be
+     * re-created after a new model is loaded.
+     *
+     * @param records n resolved selections.
+     * @param n the number of selections.
+     * @param values receives the n values.
+     */
+    void getValues(const SelectionRecord* records, int n, double* values);
+
+    /**
+     * set the value of a resolved selection, see getValues.
+     *
+     * Setting an initial amount or concentration resets the model,
+     * same as setValue(const std::string&, double).
+     *
+     * @throws std::invalid_argument if the selection can not be set.
+     */
+    void setValue(const SelectionRecord& record, double value);
+
+    /**
+     * set the values of several resolved selections at once, see getValues.
+     *
+     * If any initial amounts or concentrations are set, the model is reset
+     * once after all of the values are set.
+     */
+    void setValues(const SelectionRecord* records, int n, const double* values);
+
 
     void setSelections(const std::vector<std::string>& selections);
 
@@ -559,14 +657,70 @@ public:
      * solution
      *
      * The steady state solver and whatever options it needs may be specified
-     * via the given dictionary. For a list of all available steady state solvers,
-     * @see SteadyStateSolverFactory.
+     * via the given dictionary. The solver is chosen by the "steadyState" key,
+     * either "NLEQ" (the default) or "Hybrid", which alternates time integration
+     * and NLEQ for poor initial states. For a list of all available steady state
+     * solvers, @see SteadyStateSolverFactory.
      *
      * @param dict a pointer to a dictionary which has the steady state options.
      * May be NULL, in this case the existing options are used.
      */
     double steadyState(const Dictionary* dict = 0);
 
+    /**
+     * statistics of the last call to steadyState, such as the number of
+     * Newton iterations and model evaluations. The available keys depend on
+     * the steady state solver that was used.
+     *
+     * @returns a borrowed reference, valid until the next steadyState call.
+     */
+    const Dictionary* getSteadyStateStatistics() const;
+
+    /**
+     * Performance counters and timers, these are always collected and cost
+     * an integer increment or a clock read per event.
+     *
+     * simulate.calls, simulate.time, simulate.outputRows, simulate.outputTime:
+     * the number of simulate calls, their total wall clock time in seconds,
+     * and the number of result rows and the seconds spent filling them.
+     *
+     * integrator.*: the counters of the current integrator, e.g. NumSteps,
+     * NumRhsEvals, NumJacEvals and NumErrTestFails for CVODE, and
+     * NumReactionFirings for Gillespie.
+     *
+     * model.*: eventRootEvaluations, eventTriggers, eventsApplied, and the
+     * sbmlProcessingTime and codeGenerationTime of the compiled model.
+     *
+     * steadyState.*: the statistics of the last steadyState call, such as
+     * the NLEQ newtonIterations.
+     *
+     * @returns a borrowed reference, valid until the next call.
+     */
+    const Dictionary* getPerformanceCounters();
+
+    /**
+     * zero the simulate, integrator and model performance counters.
+     */
+    void resetPerformanceCounters();
+
+    /**
+     * Follow the branch of steady states as the global parameter parameterId
+     * is varied from start towards end using pseudo-arclength continuation.
+     *
+     * Each point is obtained from the previous one by a tangent predictor and
+     * a Newton corrector, which is far cheaper and more robust near folds than
+     * a steady state solve per parameter value. The model state and the
+     * parameter value are restored when the continuation is finished.
+     *
+     * @param options continuation options, @see Continuation. May be NULL.
+     * @returns the branch table, one row per point with the parameter value,
+     * the independent floating species amounts, the largest real part of the
+     * reduced Jacobian eigenvalues and the Continuation::PointType (regular,
+     * fold or Hopf point).
+     */
+    ls::DoubleMatrix continuation(const std::string& parameterId,
+            double start, double end, const Dictionary* options = 0);
+
     /**
      * returns the current set of steady state selections.
      */
@@ -857,6 +1011,7 @@ public:
 
 private:
 
+    friend class SimulateSampleListener;
 
     int createDefaultSteadyStateSelectionList();
     int createDefaultTimeCourseSelectionList();
@@ -40,6 +40,9 @@ static const char* SimulateOptionsKeys[] = {
         "stiff",
         "multiStep",
         "variableStep",
+        "thinning",
+        "thinningAbsolute",
+        "thinningRelative",
 
         "steps.description",
         "start.description",
@@ -55,6 +58,9 @@ static const char* SimulateOptionsKeys[] = {
         "stiff.description",
         "multiStep.description",
         "variableStep.description",
+        "thinning.description",
+        "thinningAbsolute.description",
+        "thinningRelative.description",
 
         "steps.hint",
         "start.hint",
@@ -69,7 +75,10 @@ static const char* SimulateOptionsKeys[] = {
         "copyResult.hint",
         "stiff.hint",
         "multiStep.hint",
-        "variableStep.hint"
+        "variableStep.hint",
+        "thinning.hint",
+        "thinningAbsolute.hint",
+        "thinningRelative.hint"
 };
 
 static const char* SimulateOptionsDesc[] = {
@@ -86,7 +95,10 @@ static const char* SimulateOptionsDesc[] = {
         "copyResult.description",
         "stiff.description",
         "multiStep.description",
-        "variableStep.description"
+        "variableStep.description",
+        "thinning.description",
+        "thinningAbsolute.description",
+        "thinningRelative.description"
 };
 
 static const char* SimulateOptionsHints[] = {
@@ -103,7 +115,10 @@ static const char* SimulateOptionsHints[] = {
         "copyResult.hint",
         "stiff.hint",
         "multiStep.hint",
-        "variableStep.hint"
+        "variableStep.hint",
+        "thinning.hint",
+        "thinningAbsolute.hint",
+        "thinningRelative.hint"
 };
 
 enum key_index {
@@ -122,6 +137,9 @@ enum key_index {
     KEY_STIFF,
     KEY_MULTISTEP,
     KEY_VARIABLESTEP,
+    KEY_THINNING,
+    KEY_THINNINGABSOLUTE,
+    KEY_THINNINGRELATIVE,
 
     KEY_STEPS_DESCRIPTION,
     KEY_START_DESCRIPTION,
@@ -137,6 +155,9 @@ enum key_index {
     KEY_STIFF_DESCRIPTION,
     KEY_MULTISTEP_DESCRIPTION,
     KEY_VARIABLESTEP_DESCRIPTION,
+    KEY_THINNING_DESCRIPTION,
+    KEY_THINNINGABSOLUTE_DESCRIPTION,
+    KEY_THINNINGRELATIVE_DESCRIPTION,
 
     KEY_STEPS_HINT,
     KEY_START_HINT,
@@ -152,31 +173,52 @@ enum key_index {
     KEY_STIFF_HINT,
     KEY_MULTISTEP_HINT,
     KEY_VARIABLESTEP_HINT,
+    KEY_THINNING_HINT,
+    KEY_THINNINGABSOLUTE_HINT,
+    KEY_THINNINGRELATIVE_HINT,
     KEY_END
 };
 
 static bool isDescription(int index) {
     return index >= KEY_STEPS_DESCRIPTION
-            && index <= KEY_VARIABLESTEP_DESCRIPTION;
+            && index <= KEY_THINNINGRELATIVE_DESCRIPTION;
 }
 
 static const char* getDescription(key_index index) {
     assert(sizeof(SimulateOptionsDesc)/sizeof(char*)
-            == KEY_VARIABLESTEP_DESCRIPTION - KEY_STEPS_DESCRIPTION + 1);
+            == KEY_THINNINGRELATIVE_DESCRIPTION - KEY_STEPS_DESCRIPTION + 1);
     return SimulateOptionsDesc[index - KEY_STEPS_DESCRIPTION];
 }
 
 static bool isHint(int index) {
     return index >= KEY_STEPS_HINT
-            && index <= KEY_VARIABLESTEP_HINT;
+            && index <= KEY_THINNINGRELATIVE_HINT;
 }
 
 static const char* getHint(int index) {
     assert(sizeof(SimulateOptionsHints)/sizeof(char*)
-            == KEY_VARIABLESTEP_HINT - KEY_STEPS_HINT + 1);
+            == KEY_THINNINGRELATIVE_HINT - KEY_STEPS_HINT + 1);
     return SimulateOptionsHints[index - KEY_STEPS_HINT];
 }
 
+static const char* ThinningNames[] = {
+        "none",
+        "change",
+        "interpolation"
+};
+
+static SimulateOptions::Thinning thinningFromName(const string& name)
+{
+    for (int i = 0; i < sizeof(ThinningNames)/sizeof(char*); ++i) {
+        if (rr::compareNoCase(name, ThinningNames[i]) == 0) {
+            return (SimulateOptions::Thinning)i;
+        }
+    }
+
+    throw std::invalid_argument("invalid thinning \"" + name
+            + "\", must be one of \"none\", \"change\" or \"interpolation\"");
+}
+
 static key_index indexFromString(const string& str)
 {
     assert(sizeof(SimulateOptionsKeys)/sizeof(char*) == KEY_END);
@@ -246,6 +288,15 @@ static Variant itemFromIndex(const SimulateOptions& opt, key_index index)
     case KEY_VARIABLESTEP:
         return (opt.integratorFlags & Integrator::VARIABLE_STEP) != 0;
 
+    case KEY_THINNING:
+        return std::string(ThinningNames[opt.thinning]);
+
+    case KEY_THINNINGABSOLUTE:
+        return opt.thinningAbsolute;
+
+    case KEY_THINNINGRELATIVE:
+        return opt.thinningRelative;
+
     default:
         throw std::invalid_argument("invalid key index: " + toString(index));
 
@@ -360,6 +411,17 @@ static void setItemWithIndex(SimulateOptions& opt, int index, const Variant& val
     }
     break;
 
+    case KEY_THINNING:
+        opt.thinning = thinningFromName(value);
+        break;
+
+    case KEY_THINNINGABSOLUTE:
+        opt.thinningAbsolute = value;
+        break;
+
+    case KEY_THINNINGRELATIVE:
+        opt.thinningRelative = value;
+        break;
 
     default:
         throw std::invalid_argument("invalid key index: " + toString(index));
@@ -426,6 +488,12 @@ static void getConfigValues(SimulateOptions *s)
     else if (Config::getString(Config::SIMULATEOPTIONS_INTEGRATOR) == "GILLESPIE") {
         s->integrator = Integrator::GILLESPIE;
     }
+    else if (Config::getString(Config::SIMULATEOPTIONS_INTEGRATOR) == "ROSENBROCK") {
+        s->integrator = Integrator::ROSENBROCK;
+    }
+    else if (Config::getString(Config::SIMULATEOPTIONS_INTEGRATOR) == "DOPRI5") {
+        s->integrator = Integrator::DOPRI5;
+    }
     else {
         Log(Logger::LOG_WARNING) << "Invalid integrator specified in configuration: "
                 << Config::getString(Config::SIMULATEOPTIONS_INTEGRATOR)
@@ -471,7 +539,10 @@ integratorFlags(0),
 initialTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_INITIAL_TIMESTEP)),
 minimumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MINIMUM_TIMESTEP)),
 maximumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MAXIMUM_TIMESTEP)),
-maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS))
+maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS)),
+thinning(thinningFromName(Config::getString(Config::SIMULATEOPTIONS_THINNING))),
+thinningAbsolute(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_ABSOLUTE)),
+thinningRelative(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_RELATIVE))
 {
     getConfigValues(this);
 }
@@ -489,7 +560,10 @@ integratorFlags(0),
 initialTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_INITIAL_TIMESTEP)),
 minimumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MINIMUM_TIMESTEP)),
 maximumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MAXIMUM_TIMESTEP)),
-maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS))
+maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS)),
+thinning(thinningFromName(Config::getString(Config::SIMULATEOPTIONS_THINNING))),
+thinningAbsolute(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_ABSOLUTE)),
+thinningRelative(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_RELATIVE))
 {
     getConfigValues(this);
 
@@ -668,6 +742,14 @@ std::string SimulateOptions::toString() const
         ss << "\"gillespie\"," << std::endl;
     }
 
+    else if (integrator == Integrator::ROSENBROCK ) {
+        ss << "\"rosenbrock\"," << std::endl;
+    }
+
+    else if (integrator == Integrator::DOPRI5 ) {
+        ss << "\"dopri5\"," << std::endl;
+    }
+
     else {
         ss << "\"unknown\"," << std::endl;
     }
@@ -700,7 +782,13 @@ std::string SimulateOptions::toString() const
 
     ss << "'maximumTimeStep' : " << maximumTimeStep << "," <<  std::endl;
 
-    ss << "'maximumNumSteps' : " << maximumNumSteps;
+    ss << "'maximumNumSteps' : " << maximumNumSteps << "," <<  std::endl;
+
+    ss << "'thinning' : \"" << ThinningNames[thinning] << "\"," <<  std::endl;
+
+    ss << "'thinningAbsolute' : " << thinningAbsolute << "," <<  std::endl;
+
+    ss << "'thinningRelative' : " << thinningRelative;
 
     std::vector<std::string> keys = getKeys();
 
@@ -769,15 +857,17 @@ SimulateOptions::SimulateOptions(const Dictionary* dict) :
     initialTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_INITIAL_TIMESTEP)),
     minimumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MINIMUM_TIMESTEP)),
     maximumTimeStep(Config::getDouble(Config::SIMULATEOPTIONS_MAXIMUM_TIMESTEP)),
-    maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS))
-
+    maximumNumSteps(Config::getInt(Config::SIMULATEOPTIONS_MAXIMUM_NUM_STEPS)),
+    thinning(thinningFromName(Config::getString(Config::SIMULATEOPTIONS_THINNING))),
+    thinningAbsolute(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_ABSOLUTE)),
+    thinningRelative(Config::getDouble(Config::SIMULATEOPTIONS_THINNING_RELATIVE))
 {
     getConfigValues(this);
     const SimulateOptions *o = dynamic_cast<const SimulateOptions*>(dict);
     if(o) {
         *this = *o;
     } else if(dict) {
-        for(int i = KEY_INTEGRATOR; i <= KEY_VARIABLESTEP; ++i) {
+        for(int i = KEY_INTEGRATOR; i <= KEY_THINNINGRELATIVE; ++i) {
             if(dict->hasKey(SimulateOptionsKeys[i])) {
                 setItemWithIndex(*this, i, dict->getItem(SimulateOptionsKeys[i]));
             }
@@ -880,6 +970,12 @@ void LoadSBMLOptions::defaultInit()
     if (Config::getBool(Config::LLVM_SYMBOL_CACHE))
         modelGeneratorOpt |= LoadSBMLOptions::LLVM_SYMBOL_CACHE;
 
+    if (Config::getBool(Config::LLVM_INVARIANT_CACHE))
+        modelGeneratorOpt |= LoadSBMLOptions::LLVM_INVARIANT_CACHE;
+
+    if (Config::getBool(Config::LOADSBMLOPTIONS_SPARSE_CONSERVED_MOIETIES))
+        modelGeneratorOpt |= LoadSBMLOptions::SPARSE_CONSERVED_MOIETIES;
+
 
     setItem("tempDir", "");
     setItem("compiler", "LLVM");
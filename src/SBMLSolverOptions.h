@@ -133,7 +133,22 @@ public:
         USE_MCJIT =                       (0x1 << 10),
 
 
-        LLVM_SYMBOL_CACHE =               (0x1 << 11)
+        LLVM_SYMBOL_CACHE =               (0x1 << 11),
+
+        /**
+         * evaluate assignment rules which do not depend on time or state
+         * once, whenever a value is set or the model is reset, instead of
+         * every time the model rates are evaluated.
+         */
+        LLVM_INVARIANT_CACHE =            (0x1 << 12),
+
+        /**
+         * find the conserved moieties with sparse elimination instead of
+         * the dense LibStructural analysis, only used together with
+         * CONSERVED_MOIETIES. Much faster for large networks, but may
+         * choose a different set of dependent species.
+         */
+        SPARSE_CONSERVED_MOIETIES =       (0x1 << 13)
     };
 
     enum LoadOpt
@@ -251,6 +266,29 @@ public:
         COPY_RESULT             = (0x1 << 2), // => 0x00000100
     };
 
+    /**
+     * which rows of the simulation result are kept, see OutputThinning.
+     */
+    enum Thinning
+    {
+        /**
+         * keep every output row.
+         */
+        THINNING_NONE = 0,
+
+        /**
+         * keep a row when a selected value moved by more than the
+         * thinning tolerance since the last kept row.
+         */
+        THINNING_CHANGE,
+
+        /**
+         * keep a row when linear interpolation between the kept rows
+         * would miss a dropped row by more than the thinning tolerance.
+         */
+        THINNING_INTERPOLATION
+    };
+
 
     /**
      * init with default options.
@@ -381,6 +419,25 @@ public:
      */
     int maximumNumSteps;
 
+    /**
+     * Which output rows are kept, one of the Thinning values, set by name
+     * with the "thinning" key as "none", "change" or "interpolation".
+     *
+     * Thinning applies to the fixed and variable step results, the first,
+     * the last and the rows around events are always kept.
+     */
+    #ifndef SWIG
+    Thinning thinning;
+    #endif
+
+    /**
+     * The absolute and relative tolerance of the values of the dropped
+     * rows, a row is within the tolerance if it differs by no more than
+     * thinningAbsolute + thinningRelative * |value|.
+     */
+    double thinningAbsolute;
+    double thinningRelative;
+
     /**
      * set an arbitrary key
      */
@@ -0,0 +1,826 @@
+#pragma hdrstop
+#include "SensitivityAnalysis.h"
+#include "ParameterScan.h"
+#include "RandomHash.h"
+#include "SBMLSolver.h"
+#include "rrConstants.h"
+#include "rrLogger.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <sstream>
+#include <math.h>
+
+using std::string;
+using std::vector;
+
+namespace rr
+{
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+static bool isFinite(double value)
+{
+    return value == value && fabs(value) != std::numeric_limits<double>::infinity();
+}
+
+struct Random
+{
+    Random(uint64_t seed) : state(seed) {}
+
+    double uniform()
+    {
+        return hashToUnit(splitmix64(state++));
+    }
+
+    unsigned below(unsigned n)
+    {
+        return std::min<unsigned>(n - 1, uniform() * n);
+    }
+
+    uint64_t state;
+};
+
+/**
+ * Sobol sequence direction numbers from Joe and Kuo (2008), the degree s,
+ * the polynomial coefficients a and the initial direction numbers m of
+ * the dimensions after the first.
+ */
+struct SobolDirection
+{
+    unsigned s;
+    unsigned a;
+    unsigned m[8];
+};
+
+static const SobolDirection sobolDirections[] =
+{
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+    {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+    {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+    {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+    {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+    {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+    {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+    {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+    {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+    {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+    {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+    {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+    {7, 55, {1, 1, 5, 5, 23, 33, 13}},
+    {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+    {7, 59, {1, 1, 7, 9, 13, 61, 49}},
+    {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+    {8, 14, {1, 3, 1, 15, 31, 13, 49, 245}},
+    {8, 21, {1, 3, 5, 15, 31, 59, 63, 97}},
+    {8, 22, {1, 3, 1, 11, 11, 11, 77, 249}}
+};
+
+static const int sobolBits = 32;
+
+static const int maxSobolDimensions =
+        1 + sizeof(sobolDirections) / sizeof(SobolDirection);
+
+/**
+ * the direction numbers of the first dims dimensions, sobolBits per
+ * dimension.
+ */
+static vector<uint32_t> sobolDirectionNumbers(int dims)
+{
+    vector<uint32_t> v(dims * sobolBits);
+
+    for (int b = 0; b < sobolBits; ++b)
+    {
+        v[b] = 1u << (sobolBits - 1 - b);
+    }
+
+    for (int d = 1; d < dims; ++d)
+    {
+        const SobolDirection& dir = sobolDirections[d - 1];
+        uint32_t* vd = &v[d * sobolBits];
+
+        for (unsigned i = 0; i < dir.s; ++i)
+        {
+            vd[i] = dir.m[i] << (sobolBits - 1 - i);
+        }
+
+        for (int i = dir.s; i < sobolBits; ++i)
+        {
+            vd[i] = vd[i - dir.s] ^ (vd[i - dir.s] >> dir.s);
+            for (unsigned k = 1; k < dir.s; ++k)
+            {
+                vd[i] ^= ((dir.a >> (dir.s - 1 - k)) & 1) * vd[i - k];
+            }
+        }
+    }
+    return v;
+}
+
+/**
+ * coordinate d of the Sobol point with the given index, the points are
+ * generated in Gray code order, which gives the same first 2^m points as
+ * the natural order.
+ */
+static double sobolCoordinate(const vector<uint32_t>& v, uint32_t index, int d)
+{
+    uint32_t gray = index ^ (index >> 1);
+    uint32_t x = 0;
+    for (int b = 0; gray; ++b, gray >>= 1)
+    {
+        if (gray & 1)
+        {
+            x ^= v[d * sobolBits + b];
+        }
+    }
+    return x / 4294967296.0;
+}
+
+/**
+ * the q quantile of the finite values, linearly interpolated.
+ */
+static double quantile(const vector<double>& samples, double q)
+{
+    vector<double> values;
+    for (unsigned i = 0; i < samples.size(); ++i)
+    {
+        if (isFinite(samples[i]))
+        {
+            values.push_back(samples[i]);
+        }
+    }
+
+    if (values.empty())
+    {
+        return NaN;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double pos = q * (values.size() - 1);
+    size_t lower = (size_t)pos;
+    size_t upper = std::min(lower + 1, values.size() - 1);
+    return values[lower] + (pos - lower) * (values[upper] - values[lower]);
+}
+
+/**
+ * the first order and total indices from the evaluations of the given
+ * base rows, y holds P + 2 values per row: f(A), f(B), f(AB_1) ... f(AB_P).
+ */
+static void sobolEstimate(const double* y, int P, const vector<int>& rows,
+        double* first, double* total)
+{
+    const int stride = P + 2;
+    const int n = rows.size();
+
+    double mean = 0;
+    for (int k = 0; k < n; ++k)
+    {
+        mean += y[rows[k] * stride] + y[rows[k] * stride + 1];
+    }
+    mean /= 2 * n;
+
+    double variance = 0;
+    for (int k = 0; k < n; ++k)
+    {
+        double a = y[rows[k] * stride] - mean;
+        double b = y[rows[k] * stride + 1] - mean;
+        variance += a * a + b * b;
+    }
+    variance /= 2 * n;
+
+    for (int i = 0; i < P; ++i)
+    {
+        double s = 0, t = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            const double* row = y + rows[k] * stride;
+            double fA = row[0], fB = row[1], fAB = row[2 + i];
+            s += fB * (fAB - fA);
+            t += (fA - fAB) * (fA - fAB);
+        }
+
+        first[i] = variance > 0 ? s / n / variance : NaN;
+        total[i] = variance > 0 ? 0.5 * t / n / variance : NaN;
+    }
+}
+
+SensitivityAnalysis::SensitivityAnalysis(SBMLSolver* solver,
+        const Dictionary* options) :
+    solver(solver),
+    method(SOBOL),
+    steadyState(false),
+    samples(1024),
+    sobolSampler(true),
+    seed(0),
+    bootstrap(100),
+    confidence(0.95),
+    trajectories(20),
+    levels(4),
+    batchSize(4096),
+    threads(0),
+    failed(0)
+{
+    if (!solver || !solver->getModel())
+    {
+        throw std::logic_error(gEmptyModelMessage);
+    }
+
+    directions = sobolDirectionNumbers(maxSobolDimensions);
+
+    if (!options)
+    {
+        return;
+    }
+
+    if (options->hasKey("method"))
+    {
+        string m = options->getItem("method").convert<string>();
+        if (m == "sobol")
+        {
+            method = SOBOL;
+        }
+        else if (m == "morris")
+        {
+            method = MORRIS;
+        }
+        else
+        {
+            throw std::invalid_argument("invalid sensitivity method '" + m
+                    + "', must be 'sobol' or 'morris'");
+        }
+    }
+
+    if (options->hasKey("type"))
+    {
+        string t = options->getItem("type").convert<string>();
+        if (t != "time_course" && t != "steady_state")
+        {
+            throw std::invalid_argument("invalid evaluation type '" + t
+                    + "', must be 'time_course' or 'steady_state'");
+        }
+        steadyState = t == "steady_state";
+    }
+
+    if (options->hasKey("sampler"))
+    {
+        string s = options->getItem("sampler").convert<string>();
+        if (s != "sobol" && s != "random")
+        {
+            throw std::invalid_argument("invalid sampler '" + s
+                    + "', must be 'sobol' or 'random'");
+        }
+        sobolSampler = s == "sobol";
+    }
+
+    if (options->hasKey("samples"))
+    {
+        samples = options->getItem("samples").convert<int>();
+    }
+    if (options->hasKey("seed"))
+    {
+        seed = options->getItem("seed").convert<unsigned long>();
+    }
+    if (options->hasKey("bootstrap"))
+    {
+        bootstrap = options->getItem("bootstrap").convert<int>();
+    }
+    if (options->hasKey("confidence"))
+    {
+        confidence = options->getItem("confidence").convert<double>();
+    }
+    if (options->hasKey("trajectories"))
+    {
+        trajectories = options->getItem("trajectories").convert<int>();
+    }
+    if (options->hasKey("levels"))
+    {
+        levels = options->getItem("levels").convert<int>();
+    }
+    if (options->hasKey("batch_size"))
+    {
+        batchSize = options->getItem("batch_size").convert<int>();
+    }
+    if (options->hasKey("threads"))
+    {
+        threads = options->getItem("threads").convert<int>();
+    }
+
+    if (samples < 2 || trajectories < 2 || batchSize < 1 || bootstrap < 0)
+    {
+        throw std::invalid_argument("samples and trajectories must be at least 2, "
+                "batch_size at least 1");
+    }
+
+    if (levels < 2 || levels % 2)
+    {
+        throw std::invalid_argument("morris levels must be even");
+    }
+
+    if (confidence <= 0 || confidence >= 1)
+    {
+        throw std::invalid_argument("confidence must be between 0 and 1");
+    }
+}
+
+SensitivityAnalysis::~SensitivityAnalysis()
+{
+}
+
+void SensitivityAnalysis::addParameter(const std::string& id, double lower,
+        double upper, bool logScale)
+{
+    if (!(lower < upper) || (logScale && lower <= 0))
+    {
+        throw std::invalid_argument("invalid range of parameter " + id);
+    }
+
+    Parameter p;
+    p.id = id;
+    p.lower = lower;
+    p.upper = upper;
+    p.logScale = logScale;
+    parameters.push_back(p);
+}
+
+void SensitivityAnalysis::addOutput(const std::string& selection,
+        const std::string& summary)
+{
+    Output o;
+    o.selection = selection;
+
+    if (summary == "final")
+    {
+        o.summary = FINAL;
+    }
+    else if (summary == "mean")
+    {
+        o.summary = MEAN;
+    }
+    else if (summary == "min")
+    {
+        o.summary = MIN;
+    }
+    else if (summary == "max")
+    {
+        o.summary = MAX;
+    }
+    else if (summary == "auc")
+    {
+        o.summary = AUC;
+    }
+    else
+    {
+        throw std::invalid_argument("invalid output summary '" + summary + "'");
+    }
+
+    outputs.push_back(o);
+}
+
+int SensitivityAnalysis::getNumEvaluations() const
+{
+    const int P = parameters.size();
+    return method == SOBOL ? samples * (P + 2) : trajectories * (P + 1);
+}
+
+void SensitivityAnalysis::generateTrajectories()
+{
+    const int P = parameters.size();
+    const double delta = levels / (2.0 * (levels - 1));
+
+    Random random(seed);
+
+    morrisPoints.assign(trajectories * (P + 1) * P, 0);
+    morrisFactors.assign(trajectories * P, 0);
+
+    vector<int> order(P);
+
+    for (int t = 0; t < trajectories; ++t)
+    {
+        double* x = &morrisPoints[t * (P + 1) * P];
+
+        for (int i = 0; i < P; ++i)
+        {
+            x[i] = (double)random.below(levels) / (levels - 1);
+            order[i] = i;
+        }
+
+        // random factor order
+        for (int i = P - 1; i > 0; --i)
+        {
+            std::swap(order[i], order[random.below(i + 1)]);
+        }
+
+        for (int s = 1; s <= P; ++s)
+        {
+            double* prev = x + (s - 1) * P;
+            double* next = x + s * P;
+            int f = order[s - 1];
+
+            std::copy(prev, prev + P, next);
+
+            // levels below the middle move up, the others down, so the
+            // points stay on the grid.
+            next[f] += prev[f] + delta <= 1 + 1.e-12 ? delta : -delta;
+            morrisFactors[t * P + s - 1] = f;
+        }
+    }
+}
+
+void SensitivityAnalysis::getUnitPoint(int evaluation, double* u) const
+{
+    const int P = parameters.size();
+
+    if (method == MORRIS)
+    {
+        const double* x = &morrisPoints[evaluation * P];
+        std::copy(x, x + P, u);
+        return;
+    }
+
+    // Saltelli scheme, each base row j has the evaluations A_j, B_j, and
+    // AB_ij, A_j with column i from B_j.
+    const int row = evaluation / (P + 2);
+    const int k = evaluation % (P + 2);
+
+    // the first Sobol point is all zeros, skip it
+    const uint32_t index = row + 1;
+
+    for (int i = 0; i < P; ++i)
+    {
+        int d = (k == 1 || k == i + 2) ? P + i : i;
+        u[i] = sobolSampler ? sobolCoordinate(directions, index, d) :
+                hashToUnit(splitmix64(seed * 0x9E3779B97F4A7C15ULL
+                        + (uint64_t)index * 2 * P + d));
+    }
+}
+
+void SensitivityAnalysis::getPoint(int evaluation, double* x) const
+{
+    getUnitPoint(evaluation, x);
+
+    for (unsigned i = 0; i < parameters.size(); ++i)
+    {
+        const Parameter& p = parameters[i];
+        if (p.logScale)
+        {
+            x[i] = exp(log(p.lower) + x[i] * (log(p.upper) - log(p.lower)));
+        }
+        else
+        {
+            x[i] = p.lower + x[i] * (p.upper - p.lower);
+        }
+    }
+}
+
+ls::DoubleMatrix SensitivityAnalysis::getSamples() const
+{
+    if (method == MORRIS && morrisPoints.empty())
+    {
+        const_cast<SensitivityAnalysis*>(this)->generateTrajectories();
+    }
+
+    ls::DoubleMatrix result(getNumEvaluations(), parameters.size());
+    for (int e = 0; e < getNumEvaluations(); ++e)
+    {
+        getPoint(e, &result(e, 0));
+    }
+    return result;
+}
+
+double SensitivityAnalysis::summarize(const double* point, int timePoints,
+        int columns, int column, Summary summary)
+{
+    if (timePoints == 1)
+    {
+        return point[column];
+    }
+
+    // column 0 is time
+    const double* t = point;
+    const double* x = point + column;
+    const int stride = columns;
+
+    switch (summary)
+    {
+    case FINAL:
+        return x[(timePoints - 1) * stride];
+    case MIN:
+    case MAX:
+    {
+        double result = x[0];
+        for (int k = 1; k < timePoints; ++k)
+        {
+            double v = x[k * stride];
+            result = summary == MIN ? std::min(result, v) : std::max(result, v);
+        }
+        return result;
+    }
+    default:
+    {
+        double auc = 0;
+        for (int k = 1; k < timePoints; ++k)
+        {
+            auc += 0.5 * (t[k * stride] - t[(k - 1) * stride])
+                    * (x[k * stride] + x[(k - 1) * stride]);
+        }
+        if (summary == AUC)
+        {
+            return auc;
+        }
+        double duration = t[(timePoints - 1) * stride] - t[0];
+        return duration > 0 ? auc / duration : x[0];
+    }
+    }
+}
+
+void SensitivityAnalysis::run()
+{
+    RR_TRACE_SCOPE("SensitivityAnalysis::run", "scan");
+
+    const int P = parameters.size();
+
+    if (P == 0 || outputs.empty())
+    {
+        throw std::invalid_argument("sensitivity analysis requires at least "
+                "one parameter and one output");
+    }
+
+    if (method == SOBOL && sobolSampler && 2 * P > maxSobolDimensions)
+    {
+        std::stringstream ss;
+        ss << "the sobol sampler supports at most " << maxSobolDimensions / 2
+                << " parameters, use the random sampler";
+        throw std::invalid_argument(ss.str());
+    }
+
+    if (method == MORRIS)
+    {
+        generateTrajectories();
+    }
+
+    BasicDictionary scanOptions;
+    scanOptions.setItem("type", steadyState ? "steady_state" : "time_course");
+    scanOptions.setItem("threads", threads);
+    scanOptions.setItem("warm_start", false);
+
+    ParameterScan scan(solver, &scanOptions);
+
+    // time courses get time as the first column for the integral summaries
+    vector<string> selections;
+    if (!steadyState)
+    {
+        selections.push_back("time");
+    }
+    for (unsigned o = 0; o < outputs.size(); ++o)
+    {
+        selections.push_back(outputs[o].selection);
+    }
+    const int offset = steadyState ? 0 : 1;
+
+    scan.setSelections(selections);
+
+    vector<string> ids;
+    for (int i = 0; i < P; ++i)
+    {
+        ids.push_back(parameters[i].id);
+    }
+
+    const int total = getNumEvaluations();
+    values.assign(outputs.size(), vector<double>(total, NaN));
+    results.clear();
+    failed = 0;
+
+    vector<double> block;
+
+    for (int start = 0; start < total; start += batchSize)
+    {
+        const int n = std::min(batchSize, total - start);
+
+        ls::DoubleMatrix points(n, P);
+        for (int e = 0; e < n; ++e)
+        {
+            getPoint(start + e, &points(e, 0));
+        }
+
+        scan.setPoints(ids, points);
+        block.resize(scan.getResultSize());
+        failed += scan.run(&block[0]);
+
+        const int timePoints = scan.getNumTimePoints();
+        const int columns = selections.size();
+        const size_t pointSize = (size_t)timePoints * columns;
+
+        for (int e = 0; e < n; ++e)
+        {
+            for (unsigned o = 0; o < outputs.size(); ++o)
+            {
+                values[o][start + e] = summarize(&block[e * pointSize],
+                        timePoints, columns, o + offset, outputs[o].summary);
+            }
+        }
+
+        Log(Logger::LOG_DEBUG) << "sensitivity analysis, " << start + n
+                << " of " << total << " evaluations";
+    }
+
+    if (method == SOBOL)
+    {
+        computeSobol();
+    }
+    else
+    {
+        computeMorris();
+    }
+}
+
+void SensitivityAnalysis::computeSobol()
+{
+    const int P = parameters.size();
+    const double alpha = 1 - confidence;
+
+    for (unsigned o = 0; o < outputs.size(); ++o)
+    {
+        const double* y = &values[o][0];
+
+        // rows with a failed evaluation are left out
+        vector<int> rows;
+        for (int j = 0; j < samples; ++j)
+        {
+            bool valid = true;
+            for (int k = 0; k < P + 2 && valid; ++k)
+            {
+                valid = isFinite(y[j * (P + 2) + k]);
+            }
+            if (valid)
+            {
+                rows.push_back(j);
+            }
+        }
+
+        ls::DoubleMatrix result(P, SOBOL_COLUMNS);
+        for (int i = 0; i < P; ++i)
+        {
+            for (int c = 0; c < SOBOL_COLUMNS; ++c)
+            {
+                result(i, c) = NaN;
+            }
+        }
+
+        if (rows.size() < 2)
+        {
+            Log(Logger::LOG_WARNING) << "sensitivity analysis, not enough "
+                    "successful evaluations for output " << outputs[o].selection;
+            results.push_back(result);
+            continue;
+        }
+
+        vector<double> first(P), total(P);
+        sobolEstimate(y, P, rows, &first[0], &total[0]);
+
+        vector<vector<double> > firstSamples(P), totalSamples(P);
+        vector<int> resampled(rows.size());
+        Random random(seed + 1 + o);
+
+        for (int b = 0; b < bootstrap; ++b)
+        {
+            for (unsigned k = 0; k < rows.size(); ++k)
+            {
+                resampled[k] = rows[random.below(rows.size())];
+            }
+
+            vector<double> bf(P), bt(P);
+            sobolEstimate(y, P, resampled, &bf[0], &bt[0]);
+
+            for (int i = 0; i < P; ++i)
+            {
+                firstSamples[i].push_back(bf[i]);
+                totalSamples[i].push_back(bt[i]);
+            }
+        }
+
+        for (int i = 0; i < P; ++i)
+        {
+            result(i, FIRST_ORDER) = first[i];
+            result(i, TOTAL) = total[i];
+
+            if (bootstrap)
+            {
+                result(i, FIRST_ORDER_LOWER) = quantile(firstSamples[i], alpha / 2);
+                result(i, FIRST_ORDER_UPPER) = quantile(firstSamples[i], 1 - alpha / 2);
+                result(i, TOTAL_LOWER) = quantile(totalSamples[i], alpha / 2);
+                result(i, TOTAL_UPPER) = quantile(totalSamples[i], 1 - alpha / 2);
+            }
+        }
+
+        results.push_back(result);
+    }
+}
+
+void SensitivityAnalysis::computeMorris()
+{
+    const int P = parameters.size();
+
+    for (unsigned o = 0; o < outputs.size(); ++o)
+    {
+        const double* y = &values[o][0];
+
+        vector<double> sum(P, 0), sumAbs(P, 0), sumSq(P, 0);
+        vector<int> count(P, 0);
+
+        for (int t = 0; t < trajectories; ++t)
+        {
+            for (int s = 1; s <= P; ++s)
+            {
+                int e = t * (P + 1) + s;
+                int f = morrisFactors[t * P + s - 1];
+                double du = morrisPoints[e * P + f] - morrisPoints[(e - 1) * P + f];
+                double effect = (y[e] - y[e - 1]) / du;
+
+                if (isFinite(effect))
+                {
+                    sum[f] += effect;
+                    sumAbs[f] += fabs(effect);
+                    sumSq[f] += effect * effect;
+                    ++count[f];
+                }
+            }
+        }
+
+        ls::DoubleMatrix result(P, MORRIS_COLUMNS);
+        for (int i = 0; i < P; ++i)
+        {
+            int n = count[i];
+            double mu = n ? sum[i] / n : NaN;
+            result(i, MU) = mu;
+            result(i, MU_STAR) = n ? sumAbs[i] / n : NaN;
+            result(i, SIGMA) = n > 1 ?
+                    sqrt(std::max(0.0, (sumSq[i] - n * mu * mu) / (n - 1))) : NaN;
+        }
+
+        results.push_back(result);
+    }
+}
+
+ls::DoubleMatrix SensitivityAnalysis::getSobolIndices(int output) const
+{
+    if (method != SOBOL)
+    {
+        throw std::logic_error("sobol indices require the sobol method");
+    }
+    if (output < 0 || output >= (int)results.size())
+    {
+        throw std::out_of_range("invalid output index, or run has not been called");
+    }
+    return results[output];
+}
+
+ls::DoubleMatrix SensitivityAnalysis::getMorrisStatistics(int output) const
+{
+    if (method != MORRIS)
+    {
+        throw std::logic_error("morris statistics require the morris method");
+    }
+    if (output < 0 || output >= (int)results.size())
+    {
+        throw std::out_of_range("invalid output index, or run has not been called");
+    }
+    return results[output];
+}
+
+const std::vector<double>& SensitivityAnalysis::getOutputValues(int output) const
+{
+    if (output < 0 || output >= (int)values.size())
+    {
+        throw std::out_of_range("invalid output index, or run has not been called");
+    }
+    return values[output];
+}
+
+int SensitivityAnalysis::getNumFailedEvaluations() const
+{
+    return failed;
+}
+
+} /* namespace rr */
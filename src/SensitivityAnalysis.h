@@ -0,0 +1,248 @@
+/*
+ * SensitivityAnalysis.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_SENSITIVITYANALYSIS_H_
+#define RR_SENSITIVITYANALYSIS_H_
+
+#include "rrExporter.h"
+#include "Dictionary.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class SBMLSolver;
+
+/**
+ * Global sensitivity analysis of scalar model outputs with respect to
+ * uniformly distributed parameters.
+ *
+ * Two methods are available:
+ *
+ * sobol: variance based first order and total indices using the Saltelli
+ * sampling scheme, N (P + 2) evaluations for P parameters and N base
+ * samples. The first order indices use the Saltelli (2010) estimator, the
+ * total indices the Jansen estimator, and confidence intervals are
+ * computed by bootstrapping the base samples.
+ *
+ * morris: elementary effects along r random one factor at a time
+ * trajectories on a p level grid, r (P + 1) evaluations, summarized by
+ * mu, mu* (the mean of the absolute effects) and sigma.
+ *
+ * The model evaluations run through ParameterScan in batches of a fixed
+ * size, each batch of time courses or steady states is reduced to the
+ * scalar outputs before the next one runs, so memory use does not depend
+ * on the number of time points or on the total number of evaluations,
+ * beyond one double per evaluation and output.
+ *
+ * An output is a selection, and for time course evaluations a summary of
+ * its time course: "final" (default), "mean" (time average), "min", "max"
+ * or "auc" (trapezoidal integral). Steady state outputs are the steady
+ * state values.
+ *
+ * The following options are recognized:
+ *
+ * method: "sobol" (default) or "morris".
+ *
+ * type: "time_course" (default) or "steady_state", see ParameterScan.
+ *
+ * samples: sobol base samples N, default 1024.
+ *
+ * sampler: "sobol" (default), a Sobol low discrepancy sequence, at most
+ * 20 parameters, or "random", pseudo random uniform samples.
+ *
+ * seed: seed of the random samples, trajectories and bootstrap, default 0.
+ *
+ * bootstrap: number of bootstrap resamples, default 100.
+ *
+ * confidence: confidence level of the bootstrap intervals, default 0.95.
+ *
+ * trajectories: morris trajectories r, default 20.
+ *
+ * levels: morris grid levels p, default 4.
+ *
+ * batch_size: number of evaluations per batch, default 4096.
+ *
+ * threads: number of threads, default 0, the number of cpus.
+ */
+class RR_DECLSPEC SensitivityAnalysis
+{
+public:
+
+    /**
+     * columns of the sobol index table, one row per parameter.
+     */
+    enum SobolColumn
+    {
+        FIRST_ORDER = 0,
+        FIRST_ORDER_LOWER,
+        FIRST_ORDER_UPPER,
+        TOTAL,
+        TOTAL_LOWER,
+        TOTAL_UPPER,
+        SOBOL_COLUMNS
+    };
+
+    /**
+     * columns of the morris statistics table, one row per parameter.
+     */
+    enum MorrisColumn
+    {
+        MU = 0,
+        MU_STAR,
+        SIGMA,
+        MORRIS_COLUMNS
+    };
+
+    /**
+     * The solver is borrowed and used as the template of the evaluations,
+     * see ParameterScan.
+     */
+    SensitivityAnalysis(SBMLSolver* solver, const Dictionary* options = 0);
+
+    ~SensitivityAnalysis();
+
+    /**
+     * add a parameter uniformly distributed between lower and upper, or
+     * log uniformly if logScale is set.
+     */
+    void addParameter(const std::string& id, double lower, double upper,
+            bool logScale = false);
+
+    /**
+     * add an output, see the class description for the summaries.
+     */
+    void addOutput(const std::string& selection,
+            const std::string& summary = "final");
+
+    /**
+     * the number of model evaluations run needs.
+     */
+    int getNumEvaluations() const;
+
+    /**
+     * the parameter values of all evaluations, one row per evaluation.
+     *
+     * For inspection, run generates these batch by batch.
+     */
+    ls::DoubleMatrix getSamples() const;
+
+    /**
+     * run the evaluations and compute the indices.
+     */
+    void run();
+
+    /**
+     * the sobol indices and their confidence intervals of an output, one
+     * row per parameter, the columns are given by SobolColumn.
+     */
+    ls::DoubleMatrix getSobolIndices(int output) const;
+
+    /**
+     * the morris statistics of an output, one row per parameter, the
+     * columns are given by MorrisColumn.
+     */
+    ls::DoubleMatrix getMorrisStatistics(int output) const;
+
+    /**
+     * the scalar output values of the last run, one per evaluation.
+     */
+    const std::vector<double>& getOutputValues(int output) const;
+
+    /**
+     * number of evaluations that failed in the last run. Sobol rows and
+     * morris steps that depend on a failed evaluation are left out.
+     */
+    int getNumFailedEvaluations() const;
+
+private:
+    enum Method
+    {
+        SOBOL,
+        MORRIS
+    };
+
+    enum Summary
+    {
+        FINAL,
+        MEAN,
+        MIN,
+        MAX,
+        AUC
+    };
+
+    struct Parameter
+    {
+        std::string id;
+        double lower;
+        double upper;
+        bool logScale;
+    };
+
+    struct Output
+    {
+        std::string selection;
+        Summary summary;
+    };
+
+    SBMLSolver* solver;
+    Method method;
+    bool steadyState;
+    int samples;
+    bool sobolSampler;
+    uint64_t seed;
+    int bootstrap;
+    double confidence;
+    int trajectories;
+    int levels;
+    int batchSize;
+    int threads;
+
+    std::vector<Parameter> parameters;
+    std::vector<Output> outputs;
+
+    /**
+     * unit space morris trajectory points, (P + 1) rows of P values
+     * per trajectory, and the factor changed at each step.
+     */
+    std::vector<double> morrisPoints;
+    std::vector<int> morrisFactors;
+
+    /**
+     * Sobol sequence direction numbers, 32 per dimension.
+     */
+    std::vector<uint32_t> directions;
+
+    std::vector<std::vector<double> > values;
+    std::vector<ls::DoubleMatrix> results;
+    int failed;
+
+    void generateTrajectories();
+
+    /**
+     * the unit space point of an evaluation.
+     */
+    void getUnitPoint(int evaluation, double* u) const;
+
+    void getPoint(int evaluation, double* x) const;
+
+    /**
+     * reduce the time course of a column of a point of the scan result to
+     * a scalar.
+     */
+    static double summarize(const double* point, int timePoints,
+            int columns, int column, Summary summary);
+
+    void computeSobol();
+    void computeMorris();
+};
+
+} /* namespace rr */
+
+#endif /* RR_SENSITIVITYANALYSIS_H_ */
@@ -0,0 +1,112 @@
+/*
+ * StateSaving.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_STATESAVING_H_
+#define RR_STATESAVING_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace rr
+{
+
+/**
+ * Helpers used to write the binary model state snapshots.
+ *
+ * Values are written in the native byte order of the machine, the
+ * SBMLSolver state header records the byte order, so a state file can
+ * only be read back on a machine with the same endianness.
+ */
+
+/**
+ * write a plain old data value to a binary stream.
+ */
+template <typename T>
+inline void saveBinary(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * read a plain old data value from a binary stream.
+ *
+ * @throw std::runtime_error if the stream does not contain enough data.
+ */
+template <typename T>
+inline void loadBinary(std::istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+    if (!in)
+    {
+        throw std::runtime_error("unexpected end of model state stream");
+    }
+}
+
+/**
+ * write a length prefixed string.
+ */
+inline void saveBinary(std::ostream& out, const std::string& value)
+{
+    saveBinary(out, (uint64_t)value.size());
+    out.write(value.data(), value.size());
+}
+
+inline void loadBinary(std::istream& in, std::string& value)
+{
+    uint64_t size = 0;
+    loadBinary(in, size);
+    value.resize(size);
+
+    if (size)
+    {
+        in.read(&value[0], size);
+    }
+
+    if (!in)
+    {
+        throw std::runtime_error("unexpected end of model state stream");
+    }
+}
+
+/**
+ * write a length prefixed array of plain old data values.
+ */
+template <typename T>
+inline void saveBinary(std::ostream& out, const std::vector<T>& value)
+{
+    saveBinary(out, (uint64_t)value.size());
+    if (value.size())
+    {
+        out.write(reinterpret_cast<const char*>(&value[0]),
+                value.size() * sizeof(T));
+    }
+}
+
+template <typename T>
+inline void loadBinary(std::istream& in, std::vector<T>& value)
+{
+    uint64_t size = 0;
+    loadBinary(in, size);
+    value.resize(size);
+
+    if (size)
+    {
+        in.read(reinterpret_cast<char*>(&value[0]), size * sizeof(T));
+    }
+
+    if (!in)
+    {
+        throw std::runtime_error("unexpected end of model state stream");
+    }
+}
+
+} /* namespace rr */
+
+#endif /* RR_STATESAVING_H_ */
@@ -0,0 +1,489 @@
+/*
+ * StructuralCache.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "StructuralCache.h"
+#include "StateSaving.h"
+#include "rrConfig.h"
+#include "rrLogger.h"
+#include "rrUtils.h"
+#include "rr-libstruct/lsLibStructural.h"
+
+#include <sbml/Model.h>
+
+#include <Poco/Condition.h>
+#include <Poco/File.h>
+#include <Poco/Mutex.h>
+#include <Poco/Process.h>
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string.h>
+
+using namespace std;
+using ls::DoubleMatrix;
+
+namespace rr
+{
+
+typedef std::list<StructuralAnalysisPtr> AnalysisList;
+
+static Poco::Mutex cacheMutex;
+
+/**
+ * most recently used first.
+ */
+static AnalysisList cachedAnalyses;
+
+/**
+ * an analysis that one thread is loading or computing, other threads that
+ * need the same key wait for it instead of computing it again.
+ */
+struct PendingAnalysis
+{
+    PendingAnalysis() : done(false) {}
+
+    bool done;
+
+    /**
+     * NULL if the analysis failed.
+     */
+    StructuralAnalysisPtr result;
+    string error;
+
+    /**
+     * signaled with the cache mutex when done is set.
+     */
+    Poco::Condition condition;
+};
+
+typedef cxx11_ns::shared_ptr<PendingAnalysis> PendingAnalysisPtr;
+
+/**
+ * the analyses in progress by key, guarded by the cache mutex.
+ */
+static std::map<string, PendingAnalysisPtr> pendingAnalyses;
+
+/**
+ * identifies a structural analysis file, followed by a byte order mark and
+ * the format version.
+ */
+static const char analysisMagic[8] = {'S', 'B', 'M', 'L', 'S', 'T', 'R', 'C'};
+static const uint32_t analysisByteOrder = 0x01020304;
+static const uint32_t analysisVersion = 1;
+
+/**
+ * copy a matrix owned by LibStructural, which may be NULL.
+ */
+static void copyMatrix(const DoubleMatrix* src, DoubleMatrix& dst)
+{
+    if (src)
+    {
+        dst = *src;
+    }
+}
+
+static StructuralAnalysis* analyze(ls::LibStructural& ls)
+{
+    StructuralAnalysis* a = new StructuralAnalysis();
+
+    copyMatrix(ls.getStoichiometryMatrix(), a->stoichiometryMatrix);
+    ls.getStoichiometryMatrixLabels(a->stoichiometryMatrix.getRowNames(),
+            a->stoichiometryMatrix.getColNames());
+
+    copyMatrix(ls.getReorderedStoichiometryMatrix(),
+            a->reorderedStoichiometryMatrix);
+    ls.getFullyReorderedStoichiometryMatrixLabels(
+            a->reorderedStoichiometryMatrix.getRowNames(),
+            a->reorderedStoichiometryMatrix.getColNames());
+
+    copyMatrix(ls.getNrMatrix(), a->nrMatrix);
+    ls.getNrMatrixLabels(a->nrMatrix.getRowNames(), a->nrMatrix.getColNames());
+
+    // the only one that returns a new matrix
+    DoubleMatrix *L0 = ls.getL0Matrix();
+    copyMatrix(L0, a->l0Matrix);
+    delete L0;
+    ls.getL0MatrixLabels(a->l0Matrix.getRowNames(), a->l0Matrix.getColNames());
+
+    copyMatrix(ls.getLinkMatrix(), a->linkMatrix);
+    ls.getLinkMatrixLabels(a->linkMatrix.getRowNames(),
+            a->linkMatrix.getColNames());
+
+    copyMatrix(ls.getKMatrix(), a->kMatrix);
+    ls.getKMatrixLabels(a->kMatrix.getRowNames(), a->kMatrix.getColNames());
+
+    copyMatrix(ls.getGammaMatrix(), a->gammaMatrix);
+
+    a->conservedSums = ls.getConservedSums();
+    a->independentSpecies = ls.getIndependentSpecies();
+    a->dependentSpecies = ls.getDependentSpecies();
+    a->reorderedSpecies = ls.getReorderedSpecies();
+    a->numIndependentSpecies = ls.getNumIndSpecies();
+    a->numDependentSpecies = ls.getNumDepSpecies();
+    a->analysisMessage = ls.getAnalysisMsg();
+
+    return a;
+}
+
+static void saveStrings(std::ostream& out, const vector<string>& strings)
+{
+    saveBinary(out, (uint64_t)strings.size());
+    for (unsigned i = 0; i < strings.size(); ++i)
+    {
+        saveBinary(out, strings[i]);
+    }
+}
+
+static void loadStrings(std::istream& in, vector<string>& strings)
+{
+    uint64_t size = 0;
+    loadBinary(in, size);
+    strings.resize(size);
+    for (unsigned i = 0; i < strings.size(); ++i)
+    {
+        loadBinary(in, strings[i]);
+    }
+}
+
+static void saveMatrix(std::ostream& out, const DoubleMatrix& m)
+{
+    saveBinary(out, (uint32_t)m.numRows());
+    saveBinary(out, (uint32_t)m.numCols());
+    for (unsigned i = 0; i < m.numRows(); ++i)
+    {
+        for (unsigned j = 0; j < m.numCols(); ++j)
+        {
+            saveBinary(out, m(i, j));
+        }
+    }
+    saveStrings(out, m.getRowNames());
+    saveStrings(out, m.getColNames());
+}
+
+static void loadMatrix(std::istream& in, DoubleMatrix& m)
+{
+    uint32_t rows = 0, cols = 0;
+    loadBinary(in, rows);
+    loadBinary(in, cols);
+    m.resize(rows, cols);
+    for (unsigned i = 0; i < rows; ++i)
+    {
+        for (unsigned j = 0; j < cols; ++j)
+        {
+            loadBinary(in, m(i, j));
+        }
+    }
+    loadStrings(in, m.getRowNames());
+    loadStrings(in, m.getColNames());
+}
+
+static string analysisPath(const string& dir, const string& md5)
+{
+    return joinPath(dir, md5 + ".structure");
+}
+
+static void saveAnalysis(const string& dir, const StructuralAnalysis& a)
+{
+    string path = analysisPath(dir, a.md5);
+
+    // written to a unique file and renamed, so concurrent processes never
+    // read a partially written analysis.
+    stringstream tmp;
+    tmp << path << "." << Poco::Process::id() << ".tmp";
+
+    try
+    {
+        std::ofstream out(tmp.str().c_str(), std::ios::binary);
+
+        out.write(analysisMagic, sizeof(analysisMagic));
+        saveBinary(out, analysisByteOrder);
+        saveBinary(out, analysisVersion);
+        saveBinary(out, a.md5);
+
+        saveMatrix(out, a.stoichiometryMatrix);
+        saveMatrix(out, a.reorderedStoichiometryMatrix);
+        saveMatrix(out, a.nrMatrix);
+        saveMatrix(out, a.l0Matrix);
+        saveMatrix(out, a.linkMatrix);
+        saveMatrix(out, a.kMatrix);
+        saveMatrix(out, a.gammaMatrix);
+
+        saveBinary(out, a.conservedSums);
+        saveStrings(out, a.independentSpecies);
+        saveStrings(out, a.dependentSpecies);
+        saveStrings(out, a.reorderedSpecies);
+        saveBinary(out, (int32_t)a.numIndependentSpecies);
+        saveBinary(out, (int32_t)a.numDependentSpecies);
+        saveBinary(out, a.analysisMessage);
+
+        out.close();
+
+        if (!out)
+        {
+            throw std::runtime_error("error writing " + tmp.str());
+        }
+
+        Poco::File(tmp.str()).renameTo(path);
+
+        Log(Logger::LOG_DEBUG) << "saved structural analysis to " << path;
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_WARNING) << "could not save structural analysis: "
+                << e.what();
+
+        try
+        {
+            Poco::File(tmp.str()).remove();
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+}
+
+/**
+ * @returns the analysis in the cache directory, or NULL if there is none,
+ * or it can not be read.
+ */
+static StructuralAnalysis* loadAnalysis(const string& dir, const string& md5)
+{
+    string path = analysisPath(dir, md5);
+
+    std::ifstream in(path.c_str(), std::ios::binary);
+
+    if (!in)
+    {
+        return 0;
+    }
+
+    StructuralAnalysis* a = new StructuralAnalysis();
+
+    try
+    {
+        char magic[sizeof(analysisMagic)];
+        in.read(magic, sizeof(magic));
+        if (!in || memcmp(magic, analysisMagic, sizeof(analysisMagic)) != 0)
+        {
+            throw std::runtime_error("not a structural analysis file");
+        }
+
+        uint32_t byteOrder = 0, version = 0;
+        loadBinary(in, byteOrder);
+        loadBinary(in, version);
+
+        if (byteOrder != analysisByteOrder || version != analysisVersion)
+        {
+            throw std::runtime_error("unsupported byte order or version");
+        }
+
+        loadBinary(in, a->md5);
+
+        if (a->md5 != md5)
+        {
+            throw std::runtime_error("hash does not match the file name");
+        }
+
+        loadMatrix(in, a->stoichiometryMatrix);
+        loadMatrix(in, a->reorderedStoichiometryMatrix);
+        loadMatrix(in, a->nrMatrix);
+        loadMatrix(in, a->l0Matrix);
+        loadMatrix(in, a->linkMatrix);
+        loadMatrix(in, a->kMatrix);
+        loadMatrix(in, a->gammaMatrix);
+
+        int32_t numInd = 0, numDep = 0;
+        loadBinary(in, a->conservedSums);
+        loadStrings(in, a->independentSpecies);
+        loadStrings(in, a->dependentSpecies);
+        loadStrings(in, a->reorderedSpecies);
+        loadBinary(in, numInd);
+        loadBinary(in, numDep);
+        loadBinary(in, a->analysisMessage);
+
+        a->numIndependentSpecies = numInd;
+        a->numDependentSpecies = numDep;
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_WARNING) << "ignoring structural analysis file "
+                << path << ": " << e.what();
+        delete a;
+        return 0;
+    }
+
+    Log(Logger::LOG_DEBUG) << "read structural analysis from " << path;
+
+    return a;
+}
+
+/**
+ * load or compute an analysis, without the cache lock, so other models can
+ * be analyzed at the same time.
+ */
+static StructuralAnalysis* loadOrAnalyze(const string& dir, const string& key,
+        const libsbml::Model* model, const string* sbml)
+{
+    StructuralAnalysis* a = dir.empty() ? 0 : loadAnalysis(dir, key);
+
+    if (!a)
+    {
+        if (model)
+        {
+            ls::LibStructural ls(model);
+            a = analyze(ls);
+        }
+        else
+        {
+            ls::LibStructural ls(*sbml);
+            a = analyze(ls);
+        }
+
+        a->md5 = key;
+
+        Log(Logger::LOG_INFORMATION) << "created structural analysis, messages: "
+                << a->analysisMessage;
+
+        if (!dir.empty())
+        {
+            saveAnalysis(dir, *a);
+        }
+    }
+
+    return a;
+}
+
+/**
+ * look up, or load, or compute the analysis, the model or the sbml are
+ * only used if it needs to be computed.
+ */
+static StructuralAnalysisPtr getAnalysis(const string& key,
+        const libsbml::Model* model, const string* sbml)
+{
+    const int capacity = Config::getInt(Config::STRUCTURAL_CACHE_SIZE);
+    const string dir = Config::getString(Config::STRUCTURAL_CACHE_DIR);
+
+    PendingAnalysisPtr pending;
+
+    {
+        Poco::Mutex::ScopedLock lock(cacheMutex);
+
+        for (AnalysisList::iterator i = cachedAnalyses.begin();
+                i != cachedAnalyses.end(); ++i)
+        {
+            if ((*i)->md5 == key)
+            {
+                StructuralAnalysisPtr result = *i;
+                cachedAnalyses.erase(i);
+                cachedAnalyses.push_front(result);
+
+                Log(Logger::LOG_DEBUG) << "using cached structural analysis for "
+                        "key " << key;
+                return result;
+            }
+        }
+
+        std::map<string, PendingAnalysisPtr>::iterator i =
+                pendingAnalyses.find(key);
+
+        if (i != pendingAnalyses.end())
+        {
+            // another thread is analyzing the same model, wait for it
+            pending = i->second;
+            while (!pending->done)
+            {
+                pending->condition.wait(cacheMutex);
+            }
+
+            if (!pending->result)
+            {
+                throw std::runtime_error("structural analysis failed: "
+                        + pending->error);
+            }
+            return pending->result;
+        }
+
+        pending = PendingAnalysisPtr(new PendingAnalysis());
+        pendingAnalyses[key] = pending;
+    }
+
+    StructuralAnalysisPtr result;
+    string error = "unknown error";
+
+    try
+    {
+        result = StructuralAnalysisPtr(loadOrAnalyze(dir, key, model, sbml));
+    }
+    catch (std::exception& e)
+    {
+        error = e.what();
+    }
+    catch (...)
+    {
+    }
+
+    Poco::Mutex::ScopedLock lock(cacheMutex);
+
+    pendingAnalyses.erase(key);
+
+    pending->result = result;
+    pending->error = error;
+    pending->done = true;
+    pending->condition.broadcast();
+
+    if (!result)
+    {
+        throw std::runtime_error("structural analysis failed: " + error);
+    }
+
+    if (capacity > 0)
+    {
+        cachedAnalyses.push_front(result);
+        while (cachedAnalyses.size() > (unsigned)capacity)
+        {
+            cachedAnalyses.pop_back();
+        }
+    }
+
+    return result;
+}
+
+StructuralAnalysisPtr StructuralCache::get(const std::string& sbml)
+{
+    return getAnalysis(getMD5(sbml), 0, &sbml);
+}
+
+StructuralAnalysisPtr StructuralCache::get(const std::string& md5,
+        const libsbml::Model* model)
+{
+    // the model may have been converted from the document the md5 is of,
+    // and its analysis is not the analysis of the original sbml.
+    stringstream key;
+    key << md5 << "_l" << model->getLevel() << "v" << model->getVersion();
+    return getAnalysis(key.str(), model, 0);
+}
+
+StructuralAnalysisPtr StructuralCache::create(const libsbml::Model* model)
+{
+    ls::LibStructural ls(model);
+    return StructuralAnalysisPtr(analyze(ls));
+}
+
+void StructuralCache::clear()
+{
+    Poco::Mutex::ScopedLock lock(cacheMutex);
+    cachedAnalyses.clear();
+}
+
+int StructuralCache::size()
+{
+    Poco::Mutex::ScopedLock lock(cacheMutex);
+    return cachedAnalyses.size();
+}
+
+} /* namespace rr */
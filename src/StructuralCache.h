@@ -0,0 +1,133 @@
+/*
+ * StructuralCache.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_STRUCTURALCACHE_H_
+#define RR_STRUCTURALCACHE_H_
+
+#include "rrExporter.h"
+#include "rr-libstruct/lsMatrix.h"
+#include "tr1proxy/rr_memory.h"
+
+#include <string>
+#include <vector>
+
+namespace libsbml
+{
+class Model;
+}
+
+namespace rr
+{
+
+/**
+ * The results of the structural analysis of a model, as computed by
+ * ls::LibStructural.
+ *
+ * A snapshot is never modified once it is created, so a single snapshot is
+ * shared by every SBMLSolver and every conserved moiety conversion of the
+ * same model, and may be read from any number of threads.
+ *
+ * The matrices carry the same row and column labels as the corresponding
+ * SBMLSolver methods return.
+ */
+struct RR_DECLSPEC StructuralAnalysis
+{
+    /**
+     * the cache key, the md5 of the sbml the analysis was computed from,
+     * empty if the analysis is not cached.
+     */
+    std::string md5;
+
+    /**
+     * the stoichiometry matrix in model order.
+     */
+    ls::DoubleMatrix stoichiometryMatrix;
+
+    /**
+     * the stoichiometry matrix with the rows ordered as independent then
+     * dependent species, and the reordered columns.
+     */
+    ls::DoubleMatrix reorderedStoichiometryMatrix;
+
+    ls::DoubleMatrix nrMatrix;
+    ls::DoubleMatrix l0Matrix;
+    ls::DoubleMatrix linkMatrix;
+    ls::DoubleMatrix kMatrix;
+    ls::DoubleMatrix gammaMatrix;
+
+    std::vector<double> conservedSums;
+
+    std::vector<std::string> independentSpecies;
+    std::vector<std::string> dependentSpecies;
+    std::vector<std::string> reorderedSpecies;
+
+    int numIndependentSpecies;
+    int numDependentSpecies;
+
+    /**
+     * the messages of the analysis.
+     */
+    std::string analysisMessage;
+};
+
+typedef cxx11_ns::shared_ptr<const StructuralAnalysis> StructuralAnalysisPtr;
+
+/**
+ * Process wide cache of structural analyses, keyed by the md5 of the sbml
+ * of a model.
+ *
+ * Loading many instances of the same model would otherwise repeat the same
+ * QR factorizations for the conserved moiety conversion of every load and
+ * for the MCA and structural queries of every instance. The cache keeps
+ * the most recently used analyses (see Config::STRUCTURAL_CACHE_SIZE), and
+ * optionally writes them to a directory (see Config::STRUCTURAL_CACHE_DIR),
+ * so that a new process loading a model that was analyzed before reads
+ * the analysis instead of computing it.
+ *
+ * An analysis is computed without the cache locked, so different models
+ * are analyzed concurrently, while concurrent loads of the same model wait
+ * for the first one, and compute it only once.
+ */
+class RR_DECLSPEC StructuralCache
+{
+public:
+
+    /**
+     * get the analysis of an sbml document, computing it if it is not
+     * cached.
+     */
+    static StructuralAnalysisPtr get(const std::string& sbml);
+
+    /**
+     * get the analysis of a model, md5 is the hash of the sbml the model
+     * was read from. The model may have been converted to a different
+     * level and version, so the cache key is the md5 followed by the level
+     * and version of the model, and is never the key of the analysis of
+     * the sbml itself.
+     */
+    static StructuralAnalysisPtr get(const std::string& md5,
+            const libsbml::Model* model);
+
+    /**
+     * compute the analysis of a model without caching it.
+     */
+    static StructuralAnalysisPtr create(const libsbml::Model* model);
+
+    /**
+     * remove all analyses from the in memory cache, files in the cache
+     * directory are kept.
+     */
+    static void clear();
+
+    /**
+     * the number of analyses in the in memory cache.
+     */
+    static int size();
+};
+
+} /* namespace rr */
+
+#endif /* RR_STRUCTURALCACHE_H_ */
@@ -0,0 +1,211 @@
+#pragma hdrstop
+#include "Tracer.h"
+#include "rrLogger.h"
+
+#include <Poco/Mutex.h>
+#include <Poco/Process.h>
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define RR_THREAD_LOCAL __declspec(thread)
+#else
+#define RR_THREAD_LOCAL __thread
+#endif
+
+namespace rr
+{
+
+volatile bool Tracer::enabled = false;
+
+namespace
+{
+
+struct TraceEvent
+{
+    const char* name;
+    const char* category;
+    int64_t start;
+    int64_t duration;
+};
+
+/**
+ * the span ring buffer of one thread. Only the owning thread writes
+ * events and bumps count, count is the total number of events ever
+ * recorded, so the newest event is at (count - 1) % capacity.
+ */
+struct ThreadBuffer
+{
+    ThreadBuffer(unsigned capacity, unsigned threadId) :
+        events(capacity), count(0), threadId(threadId)
+    {
+    }
+
+    std::vector<TraceEvent> events;
+    volatile uint64_t count;
+    unsigned threadId;
+};
+
+/**
+ * buffers are registered once per thread, and never freed, so they
+ * outlive the threads and their spans can be written later.
+ */
+Poco::FastMutex registryMutex;
+std::vector<ThreadBuffer*> registry;
+unsigned bufferSize = 65536;
+
+RR_THREAD_LOCAL ThreadBuffer* threadBuffer = 0;
+
+ThreadBuffer* getThreadBuffer()
+{
+    if (!threadBuffer)
+    {
+        Poco::FastMutex::ScopedLock lock(registryMutex);
+        threadBuffer = new ThreadBuffer(bufferSize, registry.size() + 1);
+        registry.push_back(threadBuffer);
+    }
+    return threadBuffer;
+}
+
+void writeJSONString(std::ostream& out, const char* str)
+{
+    out << '"';
+    for (const char* c = str; c && *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+}
+
+void Tracer::enable(unsigned size)
+{
+    if (size == 0)
+    {
+        throw std::invalid_argument("trace buffer size must be positive");
+    }
+
+    Poco::FastMutex::ScopedLock lock(registryMutex);
+    bufferSize = size;
+    enabled = true;
+}
+
+void Tracer::disable()
+{
+    enabled = false;
+}
+
+void Tracer::clear()
+{
+    Poco::FastMutex::ScopedLock lock(registryMutex);
+    for (std::vector<ThreadBuffer*>::iterator i = registry.begin();
+            i != registry.end(); ++i)
+    {
+        (*i)->count = 0;
+    }
+}
+
+int64_t Tracer::now()
+{
+    Poco::Timestamp ts;
+    return ts.epochMicroseconds();
+}
+
+void Tracer::record(const char* name, const char* category,
+        int64_t start, int64_t duration)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    uint64_t count = buffer->count;
+
+    TraceEvent& e = buffer->events[count % buffer->events.size()];
+    e.name = name;
+    e.category = category;
+    e.start = start;
+    e.duration = duration;
+
+    // publish after the event is filled in
+    buffer->count = count + 1;
+}
+
+void Tracer::write(std::ostream& out)
+{
+    Poco::FastMutex::ScopedLock lock(registryMutex);
+
+    const long pid = Poco::Process::id();
+    bool first = true;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (std::vector<ThreadBuffer*>::const_iterator i = registry.begin();
+            i != registry.end(); ++i)
+    {
+        const ThreadBuffer& buffer = **i;
+        const uint64_t count = buffer.count;
+        const uint64_t size = buffer.events.size();
+        const uint64_t n = std::min(count, size);
+
+        if (n == 0)
+        {
+            continue;
+        }
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << buffer.threadId
+                << ",\"args\":{\"name\":\"thread " << buffer.threadId << "\"}}";
+
+        // oldest to newest
+        for (uint64_t j = count - n; j < count; ++j)
+        {
+            const TraceEvent& e = buffer.events[j % size];
+
+            out << ",\n{\"name\":";
+            writeJSONString(out, e.name);
+            out << ",\"cat\":";
+            writeJSONString(out, e.category);
+            out << ",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration
+                    << ",\"pid\":" << pid << ",\"tid\":" << buffer.threadId << "}";
+        }
+
+        if (count > size)
+        {
+            Log(Logger::LOG_NOTICE) << "trace buffer of thread " << buffer.threadId
+                    << " overflowed, " << count - size << " spans were lost";
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+void Tracer::writeFile(const std::string& fileName)
+{
+    std::ofstream out(fileName.c_str());
+
+    if (!out)
+    {
+        throw std::runtime_error("could not open trace file " + fileName);
+    }
+
+    write(out);
+}
+
+std::string Tracer::getTrace()
+{
+    std::stringstream ss;
+    write(ss);
+    return ss.str();
+}
+
+} /* namespace rr */
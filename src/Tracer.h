@@ -0,0 +1,150 @@
+/*
+ * Tracer.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_TRACER_H_
+#define RR_TRACER_H_
+
+#include "rrExporter.h"
+#include <stdint.h>
+#include <string>
+#include <ostream>
+
+namespace rr
+{
+
+/**
+ * A timeline tracer of solver activity.
+ *
+ * Instrumented code marks scoped spans with RR_TRACE_SCOPE, e.g. loading
+ * a model, each code generation unit, simulate, each integrator call,
+ * event handling and the steady state attempts. When the tracer is
+ * enabled, each span is recorded when it ends into a fixed size ring buffer
+ * which belongs to the thread that executed it, so recording takes no
+ * locks, and concurrent solver instances in different threads end up on
+ * separate tracks of the same timeline. When a buffer is full, the oldest
+ * spans are overwritten.
+ *
+ * The tracer is disabled by default, a disabled span costs a single test
+ * of a global flag.
+ *
+ * The recorded spans are written in the Chrome Trace Event JSON format,
+ * which can be viewed with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Spans are recorded without synchronization with the writer, so the
+ * tracer should be disabled, or the traced threads be idle, while the
+ * trace is written.
+ */
+class RR_DECLSPEC Tracer
+{
+public:
+
+    /**
+     * start recording spans.
+     *
+     * @param bufferSize the number of spans each thread buffer holds, only
+     * applies to threads that have not recorded anything yet.
+     */
+    static void enable(unsigned bufferSize = 65536);
+
+    /**
+     * stop recording spans, the recorded spans are kept.
+     */
+    static void disable();
+
+    static bool isEnabled()
+    {
+        return enabled;
+    }
+
+    /**
+     * discard all recorded spans.
+     */
+    static void clear();
+
+    /**
+     * write the recorded spans of all threads as a Chrome Trace Event JSON
+     * document.
+     */
+    static void write(std::ostream& out);
+
+    /**
+     * write the recorded spans to a file.
+     */
+    static void writeFile(const std::string& fileName);
+
+    /**
+     * get the recorded spans as a JSON string.
+     */
+    static std::string getTrace();
+
+    /**
+     * record a complete span in the buffer of the calling thread.
+     *
+     * name and category must be string literals, or otherwise outlive the
+     * tracer, only the pointers are stored.
+     *
+     * @param start start time in microseconds.
+     * @param duration duration in microseconds.
+     */
+    static void record(const char* name, const char* category,
+            int64_t start, int64_t duration);
+
+    /**
+     * the trace clock, microseconds.
+     */
+    static int64_t now();
+
+private:
+    static volatile bool enabled;
+};
+
+/**
+ * Records a span from construction to destruction if the tracer is
+ * enabled when the scope is entered.
+ */
+class RR_DECLSPEC TraceScope
+{
+public:
+    TraceScope(const char* name, const char* category) :
+        name(0), category(category), start(0)
+    {
+        if (Tracer::isEnabled())
+        {
+            this->name = name;
+            start = Tracer::now();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+        {
+            Tracer::record(name, category, start, Tracer::now() - start);
+        }
+    }
+
+private:
+    const char* name;
+    const char* category;
+    int64_t start;
+
+    // not copyable
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+};
+
+#define RR_TRACE_CONCAT_(a, b) a ## b
+#define RR_TRACE_CONCAT(a, b) RR_TRACE_CONCAT_(a, b)
+
+/**
+ * trace the enclosing scope, name and category must be string literals.
+ */
+#define RR_TRACE_SCOPE(name, category) \
+    rr::TraceScope RR_TRACE_CONCAT(_rrTraceScope, __LINE__)(name, category)
+
+} /* namespace rr */
+
+#endif /* RR_TRACER_H_ */
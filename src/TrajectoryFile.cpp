@@ -0,0 +1,763 @@
+/*
+ * TrajectoryFile.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "TrajectoryFile.h"
+#include "StateSaving.h"
+#include "rrLogger.h"
+#include "rrStringUtils.h"
+
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/SharedMemory.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+
+using namespace std;
+
+namespace rr
+{
+
+static const char magic[8] = { 'R', 'R', 'T', 'R', 'A', 'J', '0', '1' };
+
+/**
+ * reads back as a different value on a machine with another byte order.
+ */
+static const uint32_t byteOrderMark = 0x01020304;
+
+static const uint32_t fileVersion = 1;
+
+static const int defaultChunkRows = 4096;
+
+/**
+ * how a column chunk is stored.
+ */
+enum Method
+{
+    /**
+     * the values, uncompressed.
+     */
+    METHOD_RAW = 0,
+
+    /**
+     * each value XOR the previous one.
+     */
+    METHOD_XOR,
+
+    /**
+     * the difference of the bits of each value and the linear
+     * extrapolation of the bits of the previous two, zig zag encoded.
+     */
+    METHOD_DELTA,
+
+    METHOD_END
+};
+
+static inline uint64_t toBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double fromBits(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * leading and trailing zero bits of a non zero value.
+ */
+static inline int leadingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & 0x8000000000000000ULL))
+    {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+static inline int trailingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * the bits of the prediction of a value from the two before it, the
+ * integer arithmetic is exact, so the decoder gets the same prediction on
+ * any compiler.
+ */
+static inline uint64_t predict(int method, uint64_t prev1, uint64_t prev2)
+{
+    return method == METHOD_XOR ? prev1 : 2 * prev1 - prev2;
+}
+
+static inline uint64_t residual(int method, uint64_t bits, uint64_t prediction)
+{
+    if (method == METHOD_XOR)
+    {
+        return bits ^ prediction;
+    }
+
+    int64_t d = (int64_t)(bits - prediction);
+    return ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+}
+
+static inline uint64_t unresidual(int method, uint64_t r, uint64_t prediction)
+{
+    if (method == METHOD_XOR)
+    {
+        return r ^ prediction;
+    }
+
+    uint64_t d = (r >> 1) ^ (0 - (r & 1));
+    return prediction + d;
+}
+
+/**
+ * appends bits, most significant first.
+ */
+class BitWriter
+{
+public:
+    BitWriter(std::vector<uint8_t>& out) : out(out), acc(0), n(0) {}
+
+    void write(uint64_t value, int bits)
+    {
+        if (bits > 32)
+        {
+            write(value >> 32, bits - 32);
+            value &= 0xffffffffULL;
+            bits = 32;
+        }
+
+        acc = (acc << bits) | value;
+        n += bits;
+
+        while (n >= 8)
+        {
+            n -= 8;
+            out.push_back((uint8_t)(acc >> n));
+        }
+
+        acc &= (1ULL << n) - 1;
+    }
+
+    void flush()
+    {
+        if (n > 0)
+        {
+            out.push_back((uint8_t)(acc << (8 - n)));
+            acc = 0;
+            n = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t acc;
+    int n;
+};
+
+/**
+ * reads bits written by BitWriter, zeros past the end.
+ */
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size) :
+        p(data), end(data + size), acc(0), n(0) {}
+
+    uint64_t read(int bits)
+    {
+        if (bits > 32)
+        {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+
+        while (n < bits)
+        {
+            acc = (acc << 8) | (p < end ? *p++ : 0);
+            n += 8;
+        }
+
+        n -= bits;
+        return (acc >> n) & ((1ULL << bits) - 1);
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t acc;
+    int n;
+};
+
+/**
+ * the approximate number of bits a method needs for the values.
+ */
+static uint64_t estimateBits(int method, const uint64_t* bits, int n)
+{
+    uint64_t total = 0;
+    uint64_t prev1 = 0, prev2 = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t r = residual(method, bits[i], i > 1 ?
+                predict(method, prev1, prev2) : prev1);
+        total += r == 0 ? 1 : 14 + 64 - leadingZeros(r) - trailingZeros(r);
+        prev2 = prev1;
+        prev1 = bits[i];
+    }
+
+    return total;
+}
+
+/**
+ * Each residual r is written as
+ *
+ * '0' if r is zero,
+ * '10' and the bits of r inside the window of the last '11' value, if r
+ * has at least as many leading and trailing zeros,
+ * '11', 6 bits of leading zeros, 6 bits of length - 1, and the length
+ * significant bits of r otherwise, which sets the window.
+ *
+ * The first two values are predicted by the previous value, or zero.
+ */
+static void encode(int method, const uint64_t* bits, int n,
+        std::vector<uint8_t>& out)
+{
+    BitWriter writer(out);
+    uint64_t prev1 = 0, prev2 = 0;
+    int windowLeading = -1, windowTrailing = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t r = residual(method, bits[i], i > 1 ?
+                predict(method, prev1, prev2) : prev1);
+        prev2 = prev1;
+        prev1 = bits[i];
+
+        if (r == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+
+        int leading = leadingZeros(r);
+        int trailing = trailingZeros(r);
+
+        if (windowLeading >= 0 && leading >= windowLeading
+                && trailing >= windowTrailing)
+        {
+            writer.write(2, 2);
+            writer.write(r >> windowTrailing,
+                    64 - windowLeading - windowTrailing);
+        }
+        else
+        {
+            int length = 64 - leading - trailing;
+            writer.write(3, 2);
+            writer.write(leading, 6);
+            writer.write(length - 1, 6);
+            writer.write(r >> trailing, length);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+
+    writer.flush();
+}
+
+static void decode(int method, const uint8_t* data, size_t size, int n,
+        double* result)
+{
+    if (method == METHOD_RAW)
+    {
+        memcpy(result, data, n * sizeof(double));
+        return;
+    }
+
+    BitReader reader(data, size);
+    uint64_t prev1 = 0, prev2 = 0;
+    int windowLeading = 0, windowTrailing = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t r = 0;
+
+        if (reader.read(1))
+        {
+            if (reader.read(1) == 0)
+            {
+                r = reader.read(64 - windowLeading - windowTrailing)
+                        << windowTrailing;
+            }
+            else
+            {
+                windowLeading = reader.read(6);
+                int length = reader.read(6) + 1;
+                windowTrailing = max(64 - windowLeading - length, 0);
+                r = reader.read(length) << windowTrailing;
+            }
+        }
+
+        uint64_t bits = unresidual(method, r, i > 1 ?
+                predict(method, prev1, prev2) : prev1);
+        result[i] = fromBits(bits);
+        prev2 = prev1;
+        prev1 = bits;
+    }
+}
+
+/**
+ * compress the n values of a column chunk into out.
+ *
+ * @returns the method, METHOD_RAW if compressing does not help, then out
+ * is not used.
+ */
+static int compress(const double* values, int n, std::vector<uint64_t>& bits,
+        std::vector<uint8_t>& out)
+{
+    bits.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        bits[i] = toBits(values[i]);
+    }
+
+    uint64_t xorBits = estimateBits(METHOD_XOR, &bits[0], n);
+    uint64_t deltaBits = estimateBits(METHOD_DELTA, &bits[0], n);
+
+    int method = xorBits <= deltaBits ? METHOD_XOR : METHOD_DELTA;
+
+    if (min(xorBits, deltaBits) >= (uint64_t)n * 64)
+    {
+        return METHOD_RAW;
+    }
+
+    out.clear();
+    encode(method, &bits[0], n, out);
+
+    return out.size() < n * sizeof(double) ? method : METHOD_RAW;
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::string& fileName,
+        const std::vector<std::string>& columns, int chunkRows) :
+        fileName(fileName),
+        columns(columns),
+        chunkRows(chunkRows > 0 ? chunkRows : defaultChunkRows),
+        bufferedRows(0),
+        rows(0),
+        closed(false)
+{
+    out.open(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if (!out)
+    {
+        throw std::runtime_error("could not create trajectory file " + fileName);
+    }
+
+    buffer.resize(columns.size() * this->chunkRows);
+
+    out.write(magic, sizeof(magic));
+    saveBinary(out, byteOrderMark);
+    saveBinary(out, fileVersion);
+    saveBinary(out, (uint32_t)columns.size());
+    saveBinary(out, (uint32_t)this->chunkRows);
+
+    for (std::vector<std::string>::const_iterator i = columns.begin();
+            i != columns.end(); ++i)
+    {
+        saveBinary(out, *i);
+    }
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    if (!closed)
+    {
+        try
+        {
+            close();
+        }
+        catch (std::exception& e)
+        {
+            Log(Logger::LOG_ERROR) << e.what();
+        }
+    }
+}
+
+void TrajectoryWriter::write(const double* row)
+{
+    if (closed)
+    {
+        throw std::logic_error("trajectory file " + fileName + " is closed");
+    }
+
+    for (unsigned i = 0; i < columns.size(); ++i)
+    {
+        buffer[i * chunkRows + bufferedRows] = row[i];
+    }
+
+    rows++;
+
+    if (++bufferedRows == chunkRows)
+    {
+        writeChunk();
+    }
+}
+
+void TrajectoryWriter::write(const ls::DoubleMatrix& m)
+{
+    if (m.numCols() != columns.size())
+    {
+        throw std::invalid_argument("matrix has " + rr::toString((int)m.numCols())
+                + " columns, the trajectory file has "
+                + rr::toString((int)columns.size()));
+    }
+
+    for (unsigned i = 0; i < m.numRows(); ++i)
+    {
+        write(m[i]);
+    }
+}
+
+void TrajectoryWriter::close()
+{
+    if (closed)
+    {
+        return;
+    }
+
+    writeChunk();
+
+    uint64_t footer = out.tellp();
+
+    saveBinary(out, (uint64_t)rows);
+    saveBinary(out, (uint64_t)chunkSizes.size());
+
+    for (unsigned k = 0; k < chunkSizes.size(); ++k)
+    {
+        saveBinary(out, chunkSizes[k]);
+
+        for (unsigned i = 0; i < columns.size(); ++i)
+        {
+            unsigned j = k * columns.size() + i;
+            saveBinary(out, offsets[j]);
+            saveBinary(out, sizes[j]);
+            saveBinary(out, methods[j]);
+        }
+    }
+
+    saveBinary(out, footer);
+    out.write(magic, sizeof(magic));
+
+    out.close();
+    closed = true;
+
+    if (!out)
+    {
+        throw std::runtime_error("error writing trajectory file " + fileName);
+    }
+}
+
+const std::vector<std::string>& TrajectoryWriter::getColumnNames() const
+{
+    return columns;
+}
+
+int TrajectoryWriter::getNumColumns() const
+{
+    return columns.size();
+}
+
+int64_t TrajectoryWriter::getNumRows() const
+{
+    return rows;
+}
+
+void TrajectoryWriter::writeChunk()
+{
+    if (bufferedRows == 0)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> bits;
+
+    chunkSizes.push_back(bufferedRows);
+
+    for (unsigned i = 0; i < columns.size(); ++i)
+    {
+        const double* values = &buffer[i * chunkRows];
+        int method = compress(values, bufferedRows, bits, encoded);
+
+        offsets.push_back(out.tellp());
+        methods.push_back(method);
+
+        if (method == METHOD_RAW)
+        {
+            out.write((const char*)values, bufferedRows * sizeof(double));
+            sizes.push_back(bufferedRows * sizeof(double));
+        }
+        else
+        {
+            out.write((const char*)&encoded[0], encoded.size());
+            sizes.push_back(encoded.size());
+        }
+    }
+
+    bufferedRows = 0;
+
+    if (!out)
+    {
+        throw std::runtime_error("error writing trajectory file " + fileName);
+    }
+}
+
+/**
+ * reads values out of the mapped file.
+ */
+class TrajectoryCursor
+{
+public:
+    TrajectoryCursor(const char* data, size_t size, size_t offset) :
+        data(data), size(size), offset(offset) {}
+
+    template <typename T>
+    T read()
+    {
+        T value;
+        check(sizeof(T));
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string readString()
+    {
+        uint64_t length = read<uint64_t>();
+        check(length);
+        std::string value(data + offset, length);
+        offset += length;
+        return value;
+    }
+
+private:
+    void check(uint64_t length)
+    {
+        if (length > size || offset > size - length)
+        {
+            throw std::runtime_error("corrupt trajectory file");
+        }
+    }
+
+    const char* data;
+    size_t size;
+    size_t offset;
+};
+
+TrajectoryReader::TrajectoryReader(const std::string& fileName) :
+        mapping(0),
+        data(0),
+        size(0),
+        rows(0)
+{
+    try
+    {
+        mapping = new Poco::SharedMemory(Poco::File(fileName),
+                Poco::SharedMemory::AM_READ);
+    }
+    catch (Poco::Exception& e)
+    {
+        throw std::runtime_error("could not map trajectory file " + fileName
+                + ": " + e.displayText());
+    }
+
+    data = mapping->begin();
+    size = mapping->end() - mapping->begin();
+
+    try
+    {
+        const size_t trailer = sizeof(uint64_t) + sizeof(magic);
+
+        if (size < sizeof(magic) + trailer
+                || memcmp(data, magic, sizeof(magic)) != 0)
+        {
+            throw std::runtime_error(fileName + " is not a trajectory file");
+        }
+
+        TrajectoryCursor header(data, size, sizeof(magic));
+
+        if (header.read<uint32_t>() != byteOrderMark)
+        {
+            throw std::runtime_error(fileName + " was written on a machine "
+                    "with a different byte order");
+        }
+
+        if (header.read<uint32_t>() > fileVersion)
+        {
+            throw std::runtime_error(fileName + " was written by a newer version");
+        }
+
+        uint32_t ncols = header.read<uint32_t>();
+        header.read<uint32_t>();
+
+        for (uint32_t i = 0; i < ncols; ++i)
+        {
+            columns.push_back(header.readString());
+        }
+
+        if (memcmp(data + size - sizeof(magic), magic, sizeof(magic)) != 0)
+        {
+            throw std::runtime_error(fileName + " is truncated, or was not closed");
+        }
+
+        TrajectoryCursor end(data, size, size - trailer);
+        uint64_t footer = end.read<uint64_t>();
+
+        TrajectoryCursor index(data, size - trailer, footer);
+        rows = index.read<uint64_t>();
+        uint64_t chunks = index.read<uint64_t>();
+        int64_t total = 0;
+
+        for (uint64_t k = 0; k < chunks; ++k)
+        {
+            chunkSizes.push_back(index.read<uint32_t>());
+            total += chunkSizes.back();
+
+            for (uint32_t i = 0; i < ncols; ++i)
+            {
+                offsets.push_back(index.read<uint64_t>());
+                sizes.push_back(index.read<uint64_t>());
+                methods.push_back(index.read<uint8_t>());
+
+                if (offsets.back() > footer || sizes.back() > footer - offsets.back()
+                        || methods.back() >= METHOD_END
+                        || (methods.back() == METHOD_RAW
+                                && sizes.back() != chunkSizes.back() * sizeof(double)))
+                {
+                    throw std::runtime_error("corrupt trajectory file " + fileName);
+                }
+            }
+        }
+
+        if (total != rows)
+        {
+            throw std::runtime_error("corrupt trajectory file " + fileName);
+        }
+    }
+    catch (...)
+    {
+        delete mapping;
+        throw;
+    }
+}
+
+TrajectoryReader::~TrajectoryReader()
+{
+    delete mapping;
+}
+
+const std::vector<std::string>& TrajectoryReader::getColumnNames() const
+{
+    return columns;
+}
+
+int TrajectoryReader::getNumColumns() const
+{
+    return columns.size();
+}
+
+int64_t TrajectoryReader::getNumRows() const
+{
+    return rows;
+}
+
+int TrajectoryReader::getColumnIndex(const std::string& name) const
+{
+    std::vector<std::string>::const_iterator i =
+            std::find(columns.begin(), columns.end(), name);
+
+    if (i == columns.end())
+    {
+        throw std::invalid_argument("no column named " + name);
+    }
+
+    return i - columns.begin();
+}
+
+void TrajectoryReader::getColumn(int column, double* result) const
+{
+    if (column < 0 || column >= (int)columns.size())
+    {
+        throw std::invalid_argument("invalid column index " + rr::toString(column));
+    }
+
+    for (unsigned k = 0; k < chunkSizes.size(); ++k)
+    {
+        unsigned j = k * columns.size() + column;
+        decode(methods[j], (const uint8_t*)data + offsets[j], sizes[j],
+                chunkSizes[k], result);
+        result += chunkSizes[k];
+    }
+}
+
+std::vector<double> TrajectoryReader::getColumn(int column) const
+{
+    std::vector<double> result(rows);
+
+    if (rows)
+    {
+        getColumn(column, &result[0]);
+    }
+    else if (column < 0 || column >= (int)columns.size())
+    {
+        throw std::invalid_argument("invalid column index " + rr::toString(column));
+    }
+
+    return result;
+}
+
+ls::DoubleMatrix TrajectoryReader::getMatrix() const
+{
+    ls::DoubleMatrix m(rows, columns.size());
+    std::vector<double> column(rows);
+
+    for (unsigned i = 0; i < columns.size() && rows; ++i)
+    {
+        getColumn(i, &column[0]);
+
+        for (int64_t j = 0; j < rows; ++j)
+        {
+            m(j, i) = column[j];
+        }
+    }
+
+    m.setColNames(columns);
+    return m;
+}
+
+} /* namespace rr */
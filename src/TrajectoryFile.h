@@ -0,0 +1,202 @@
+/*
+ * TrajectoryFile.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RR_TRAJECTORYFILE_H_
+#define RR_TRAJECTORYFILE_H_
+
+#include "rrExporter.h"
+#include "rr-libstruct/lsMatrix.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Poco
+{
+class SharedMemory;
+}
+
+namespace rr
+{
+
+/**
+ * Writes simulation results in a compact binary columnar format, much
+ * smaller and faster to write and read than csv.
+ *
+ * The file starts with a header holding the column names, then the rows
+ * in chunks of a fixed number of rows. Each chunk stores each column on
+ * its own, compressed with the lossless floating point XOR scheme of the
+ * Gorilla time series database: every value is predicted from the ones
+ * before it, and only the bits which differ from the prediction are
+ * written. A column chunk is predicted either by the previous value,
+ * which suits constant and step wise values, or by linear extrapolation
+ * of the two previous values, which suits the time column and smooth
+ * trajectories, whichever is smaller, and stored uncompressed if neither
+ * helps. The file ends with an index of the column chunks, so a reader can
+ * decode any column without touching the others.
+ *
+ * Values are stored in the native byte order, the header records it, so a
+ * file can only be read on a machine with the same endianness.
+ *
+ * Rows can be written one at a time, or a matrix at a time, so several
+ * simulations, e.g. of an ensemble or a scan, can be streamed into the
+ * same file. Only one chunk is kept in memory.
+ */
+class RR_DECLSPEC TrajectoryWriter
+{
+public:
+
+    /**
+     * create a trajectory file, replacing any existing file.
+     *
+     * @param columns the column names, e.g. the selections of a simulation.
+     * @param chunkRows the number of rows per chunk, 0 for the default
+     * of 4096.
+     *
+     * @throws std::runtime_error if the file can not be created.
+     */
+    TrajectoryWriter(const std::string& fileName,
+            const std::vector<std::string>& columns, int chunkRows = 0);
+
+    /**
+     * closes the file if close was not called.
+     */
+    ~TrajectoryWriter();
+
+    /**
+     * write a row of getNumColumns() values.
+     */
+    void write(const double* row);
+
+    /**
+     * write all the rows of a matrix.
+     *
+     * @throws std::invalid_argument if the matrix does not have
+     * getNumColumns() columns.
+     */
+    void write(const ls::DoubleMatrix& rows);
+
+    /**
+     * write the last chunk and the index. No rows can be written after
+     * this.
+     */
+    void close();
+
+    const std::vector<std::string>& getColumnNames() const;
+
+    int getNumColumns() const;
+
+    /**
+     * the number of rows written so far.
+     */
+    int64_t getNumRows() const;
+
+private:
+
+    /**
+     * compress and write the buffered rows.
+     */
+    void writeChunk();
+
+    std::ofstream out;
+    std::string fileName;
+    std::vector<std::string> columns;
+    int chunkRows;
+
+    /**
+     * the rows of the current chunk, column major.
+     */
+    std::vector<double> buffer;
+    int bufferedRows;
+
+    int64_t rows;
+
+    /**
+     * the index, per chunk the number of rows, and per column chunk its
+     * offset, size and compression method.
+     */
+    std::vector<uint32_t> chunkSizes;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> sizes;
+    std::vector<uint8_t> methods;
+
+    std::vector<uint8_t> encoded;
+
+    bool closed;
+
+    // not copyable
+    TrajectoryWriter(const TrajectoryWriter&);
+    TrajectoryWriter& operator=(const TrajectoryWriter&);
+};
+
+/**
+ * Reads a file written by TrajectoryWriter.
+ *
+ * The file is memory mapped, so opening it only reads the header and the
+ * index, and reading a column only touches the pages of that column. The
+ * reader is not modified by reading, so several threads may read columns
+ * at the same time.
+ */
+class RR_DECLSPEC TrajectoryReader
+{
+public:
+
+    /**
+     * @throws std::runtime_error if the file can not be mapped, or is not
+     * a complete trajectory file.
+     */
+    TrajectoryReader(const std::string& fileName);
+
+    ~TrajectoryReader();
+
+    const std::vector<std::string>& getColumnNames() const;
+
+    int getNumColumns() const;
+
+    int64_t getNumRows() const;
+
+    /**
+     * the index of the named column.
+     *
+     * @throws std::invalid_argument if there is no such column.
+     */
+    int getColumnIndex(const std::string& name) const;
+
+    /**
+     * decode a column into getNumRows() values.
+     */
+    void getColumn(int column, double* result) const;
+
+    std::vector<double> getColumn(int column) const;
+
+    /**
+     * read all the columns, with the column names set.
+     */
+    ls::DoubleMatrix getMatrix() const;
+
+private:
+
+    Poco::SharedMemory* mapping;
+    const char* data;
+    size_t size;
+
+    std::vector<std::string> columns;
+    int64_t rows;
+
+    std::vector<uint32_t> chunkSizes;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> sizes;
+    std::vector<uint8_t> methods;
+
+    // not copyable
+    TrajectoryReader(const TrajectoryReader&);
+    TrajectoryReader& operator=(const TrajectoryReader&);
+};
+
+} /* namespace rr */
+
+#endif /* RR_TRAJECTORYFILE_H_ */
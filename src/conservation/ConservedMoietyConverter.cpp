@@ -8,7 +8,7 @@
 #include "ConservedMoietyConverter.h"
 #include "ConservedMoietyPlugin.h"
 #include "ConservationDocumentPlugin.h"
-#include "rr-libstruct/lsLibStructural.h"
+#include "SparseStructural.h"
 
 #include <sbml/conversion/SBMLConverterRegistry.h>
 #include <sbml/conversion/SBMLLevelVersionConverter.h>
@@ -122,7 +122,8 @@ void ConservedMoietyConverter::init()
 ConservedMoietyConverter::ConservedMoietyConverter() :
         SBMLConverter(),
         mModel(0),
-        structural(0),
+        structural(),
+        sparseStructural(0),
         resultDoc(0),
         resultModel(0)
 {
@@ -132,7 +133,8 @@ ConservedMoietyConverter::ConservedMoietyConverter(
         const ConservedMoietyConverter& orig) :
         SBMLConverter(orig),
         mModel(0),
-        structural(0),
+        structural(),
+        sparseStructural(0),
         resultDoc(0),
         resultModel(0)
 {
@@ -140,7 +142,7 @@ ConservedMoietyConverter::ConservedMoietyConverter(
 
 ConservedMoietyConverter::~ConservedMoietyConverter()
 {
-    delete structural;
+    delete sparseStructural;
     delete resultDoc;
 }
 
@@ -154,6 +156,12 @@ ConversionProperties ConservedMoietyConverter::getDefaultProperties() const
     static ConversionProperties prop;
     prop.addOption("sortRules", true,
             "Sort AssignmentRules and InitialAssignments in the model");
+    prop.addOption("sparse", false,
+            "Use sparse elimination instead of LibStructural to find the "
+            "independent species and the link matrix");
+    prop.addOption("structuralCacheKey", "",
+            "The md5 of the sbml the document was read from, if set the "
+            "structural analysis is shared through the StructuralCache");
     return prop;
 }
 
@@ -214,12 +222,22 @@ int ConservedMoietyConverter::convert()
 
     assert(resultModel && "resultModel is NULL");
 
-    vector<string> indSpecies = structural->getIndependentSpecies();
+    vector<string> indSpecies;
+    vector<string> depSpecies;
+    ls::DoubleMatrix *L0;
 
-    vector<string> depSpecies = structural->getDependentSpecies();
-
-    // creates a new matrix
-    ls::DoubleMatrix *L0 = structural->getL0Matrix();
+    if (sparseStructural)
+    {
+        indSpecies = sparseStructural->getIndependentSpecies();
+        depSpecies = sparseStructural->getDependentSpecies();
+        L0 = new ls::DoubleMatrix(sparseStructural->getL0Matrix());
+    }
+    else
+    {
+        indSpecies = structural->independentSpecies;
+        depSpecies = structural->dependentSpecies;
+        L0 = new ls::DoubleMatrix(structural->l0Matrix);
+    }
 
     if (rr::Logger::getLevel() >= loggingLevel)
     {
@@ -227,10 +245,15 @@ int ConservedMoietyConverter::convert()
         Log(loggingLevel) << "independent species: " << toString(indSpecies);
         Log(loggingLevel) << "dependent species: " << toString(depSpecies);
         Log(loggingLevel) << "L0 matrix: " << endl << *L0;
-        Log(loggingLevel) << "Stoichiometry Matrix: " << endl
-                << *(structural->getStoichiometryMatrix());
-        Log(loggingLevel) << "Reordered Stoichiometry Matrix: "
-                << endl << *(structural->getReorderedStoichiometryMatrix());
+
+        // the sparse analysis never forms the dense matrices
+        if (structural)
+        {
+            Log(loggingLevel) << "Stoichiometry Matrix: " << endl
+                    << structural->stoichiometryMatrix;
+            Log(loggingLevel) << "Reordered Stoichiometry Matrix: "
+                    << endl << structural->reorderedStoichiometryMatrix;
+        }
     }
 
     createReorderedSpecies(resultModel, mModel, indSpecies, depSpecies);
@@ -260,7 +283,8 @@ const libsbml::SBMLDocument* ConservedMoietyConverter::getDocument() const
 
 int ConservedMoietyConverter::setDocument(const libsbml::SBMLDocument* doc)
 {
-    delete structural; structural = 0;
+    structural.reset();
+    delete sparseStructural; sparseStructural = 0;
     delete resultDoc; resultDoc = 0;
 
     int result = 0;
@@ -376,7 +400,22 @@ int ConservedMoietyConverter::setDocument(const libsbml::SBMLDocument* doc)
         return LIBSBML_INVALID_OBJECT;
     }
 
-    structural = new ls::LibStructural(mModel);
+    const ConversionProperties* props = getProperties();
+
+    if (props && props->hasOption("sparse") && props->getBoolValue("sparse"))
+    {
+        sparseStructural = new SparseStructural(mModel);
+    }
+    else if (props && props->hasOption("structuralCacheKey") &&
+            !props->getValue("structuralCacheKey").empty())
+    {
+        structural = StructuralCache::get(
+                props->getValue("structuralCacheKey"), mModel);
+    }
+    else
+    {
+        structural = StructuralCache::create(mModel);
+    }
 
     return LIBSBML_OPERATION_SUCCESS;
 }
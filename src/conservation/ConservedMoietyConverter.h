@@ -9,21 +9,19 @@
 #define ConservedMoietyConverter_h
 
 #include "rrExporter.h"
+#include "StructuralCache.h"
 
 #include <sbml/SBMLNamespaces.h>
 #include <sbml/conversion/SBMLConverter.h>
 #include <sbml/conversion/SBMLConverterRegister.h>
 
-
-namespace ls {
-    class LibStructural;
-}
-
 namespace rr
 {
 namespace conservation
 {
 
+class SparseStructural;
+
 
 #ifndef SWIG
 
@@ -152,11 +150,15 @@ public:
 private:
 
     /**
-     * class used to calculate the L0 matrix.
-     *
-     * Will be replaced with a sparse version in next SBMLSolver release.
+     * the analysis used to calculate the L0 matrix, shared through the
+     * StructuralCache if the "structuralCacheKey" property is set.
+     */
+    StructuralAnalysisPtr structural;
+
+    /**
+     * used instead of structural if the "sparse" property is set.
      */
-    ls::LibStructural *structural;
+    SparseStructural *sparseStructural;
 
     /**
      * base class has an mDocument field, use this for the src doc
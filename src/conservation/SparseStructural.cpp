@@ -0,0 +1,463 @@
+/*
+ * SparseStructural.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "SparseStructural.h"
+#include "rrLogger.h"
+
+#include <sbml/Model.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <math.h>
+
+using namespace std;
+using namespace libsbml;
+
+namespace rr
+{
+namespace conservation
+{
+
+/**
+ * A dense scratch vector which tracks its non zero pattern, so it can be
+ * gathered and cleared in time proportional to the number of non zeros.
+ */
+class SparseAccumulator
+{
+public:
+    SparseAccumulator(int size) : values(size, 0), used(size, 0)
+    {
+    }
+
+    /**
+     * @returns true if the index was not used before.
+     */
+    bool add(int i, double value)
+    {
+        values[i] += value;
+        if (!used[i])
+        {
+            used[i] = 1;
+            pattern.push_back(i);
+            return true;
+        }
+        return false;
+    }
+
+    double& operator[](int i)
+    {
+        return values[i];
+    }
+
+    const vector<int>& getPattern() const
+    {
+        return pattern;
+    }
+
+    /**
+     * the entries larger than threshold in magnitude, sorted by index,
+     * and clear.
+     */
+    void gather(vector<pair<int, double> >& result, double threshold = 0)
+    {
+        result.clear();
+        sort(pattern.begin(), pattern.end());
+        for (unsigned i = 0; i < pattern.size(); ++i)
+        {
+            int j = pattern[i];
+            if (fabs(values[j]) > threshold)
+            {
+                result.push_back(make_pair(j, values[j]));
+            }
+        }
+        clear();
+    }
+
+    void clear()
+    {
+        for (unsigned i = 0; i < pattern.size(); ++i)
+        {
+            values[pattern[i]] = 0;
+            used[pattern[i]] = 0;
+        }
+        pattern.clear();
+    }
+
+private:
+    vector<double> values;
+    vector<char> used;
+    vector<int> pattern;
+};
+
+typedef priority_queue<int, vector<int>, greater<int> > MinHeap;
+
+SparseStructural::SparseStructural(const libsbml::Model* model,
+        double tolerance) :
+    tolerance(tolerance)
+{
+    buildStoichiometry(model);
+    eliminate();
+
+    Log(Logger::LOG_DEBUG) << "sparse structural analysis of "
+            << species.size() << " species and " << reactions.size()
+            << " reactions, rank " << independent.size();
+}
+
+SparseStructural::~SparseStructural()
+{
+}
+
+void SparseStructural::buildStoichiometry(const libsbml::Model* model)
+{
+    map<string, int> index;
+
+    for (unsigned i = 0; i < model->getNumSpecies(); ++i)
+    {
+        const Species* s = model->getSpecies(i);
+        if (!s->getBoundaryCondition())
+        {
+            index[s->getId()] = species.size();
+            species.push_back(s->getId());
+        }
+    }
+
+    // the species rows, accumulated as (species, reaction) -> value
+    vector<map<int, double> > entries(species.size());
+
+    for (unsigned r = 0; r < model->getNumReactions(); ++r)
+    {
+        const Reaction* reaction = model->getReaction(r);
+        reactions.push_back(reaction->getId());
+
+        for (unsigned j = 0; j < reaction->getNumReactants(); ++j)
+        {
+            const SpeciesReference* ref = reaction->getReactant(j);
+            map<string, int>::const_iterator i = index.find(ref->getSpecies());
+            if (i != index.end())
+            {
+                entries[i->second][r] -= ref->getStoichiometry();
+            }
+        }
+
+        for (unsigned j = 0; j < reaction->getNumProducts(); ++j)
+        {
+            const SpeciesReference* ref = reaction->getProduct(j);
+            map<string, int>::const_iterator i = index.find(ref->getSpecies());
+            if (i != index.end())
+            {
+                entries[i->second][r] += ref->getStoichiometry();
+            }
+        }
+    }
+
+    rows.resize(species.size());
+    for (unsigned s = 0; s < species.size(); ++s)
+    {
+        for (map<int, double>::const_iterator i = entries[s].begin();
+                i != entries[s].end(); ++i)
+        {
+            if (i->second != 0)
+            {
+                rows[s].push_back(*i);
+            }
+        }
+    }
+}
+
+void SparseStructural::eliminate()
+{
+    const int numSpecies = species.size();
+    const int numReactions = reactions.size();
+
+    // the number of species each reaction changes, pivots are chosen in
+    // the sparsest columns to limit fill in.
+    vector<int> columnCount(numReactions, 0);
+    for (int s = 0; s < numSpecies; ++s)
+    {
+        for (unsigned i = 0; i < rows[s].size(); ++i)
+        {
+            ++columnCount[rows[s][i].first];
+        }
+    }
+
+    // basis index of each pivot column, -1 if not a pivot
+    vector<int> pivotRow(numReactions, -1);
+
+    // each basis row as a combination of the independent species rows
+    vector<SparseVector> transforms;
+
+    SparseAccumulator w(numReactions);
+    SparseAccumulator t(numSpecies);
+    vector<pair<int, double> > multipliers;
+
+    for (int s = 0; s < numSpecies; ++s)
+    {
+        MinHeap heap;
+        double scale = 0;
+
+        for (unsigned i = 0; i < rows[s].size(); ++i)
+        {
+            int c = rows[s][i].first;
+            w.add(c, rows[s][i].second);
+            scale = max(scale, fabs(rows[s][i].second));
+            if (pivotRow[c] >= 0)
+            {
+                heap.push(pivotRow[c]);
+            }
+        }
+
+        // eliminate the pivot columns in basis order, eliminating with row
+        // k can only fill in the pivot columns of later rows.
+        multipliers.clear();
+        while (!heap.empty())
+        {
+            int k = heap.top();
+            heap.pop();
+
+            double x = w[pivots[k]];
+            if (x == 0)
+            {
+                continue;
+            }
+
+            double m = x / pivotValues[k];
+            multipliers.push_back(make_pair(k, m));
+
+            const SparseVector& b = basis[k];
+            for (unsigned i = 0; i < b.size(); ++i)
+            {
+                int c = b[i].first;
+                if (w.add(c, -m * b[i].second) && pivotRow[c] >= 0)
+                {
+                    heap.push(pivotRow[c]);
+                }
+            }
+            w[pivots[k]] = 0;
+        }
+
+        const double threshold = tolerance * max(1.0, scale);
+
+        double largest = 0;
+        const vector<int>& pattern = w.getPattern();
+        for (unsigned i = 0; i < pattern.size(); ++i)
+        {
+            largest = max(largest, fabs(w[pattern[i]]));
+        }
+
+        // the combination of independent rows the multipliers give
+        for (unsigned i = 0; i < multipliers.size(); ++i)
+        {
+            const SparseVector& tk = transforms[multipliers[i].first];
+            for (unsigned j = 0; j < tk.size(); ++j)
+            {
+                t.add(tk[j].first, multipliers[i].second * tk[j].second);
+            }
+        }
+
+        if (largest <= threshold)
+        {
+            // N_s = sum m_k B_k, a row of L0
+            w.clear();
+            dependent.push_back(s);
+            link.push_back(SparseVector());
+            t.gather(link.back(), tolerance);
+            continue;
+        }
+
+        // threshold pivoting, among the large entries take the one in the
+        // sparsest column
+        int pivot = -1;
+        for (unsigned i = 0; i < pattern.size(); ++i)
+        {
+            int c = pattern[i];
+            if (fabs(w[c]) >= 0.1 * largest && (pivot < 0 ||
+                    columnCount[c] < columnCount[pivot] ||
+                    (columnCount[c] == columnCount[pivot] &&
+                            fabs(w[c]) > fabs(w[pivot]))))
+            {
+                pivot = c;
+            }
+        }
+
+        // B_new = N_s - sum m_k B_k, in terms of the independent rows
+        int j = independent.size();
+        const vector<int>& tp = t.getPattern();
+        for (unsigned i = 0; i < tp.size(); ++i)
+        {
+            t[tp[i]] = -t[tp[i]];
+        }
+        t.add(j, 1);
+
+        pivotRow[pivot] = basis.size();
+        pivots.push_back(pivot);
+        pivotValues.push_back(w[pivot]);
+
+        basis.push_back(SparseVector());
+        w.gather(basis.back(), threshold);
+
+        transforms.push_back(SparseVector());
+        t.gather(transforms.back());
+
+        independent.push_back(s);
+    }
+
+    for (unsigned i = 0; i < independent.size(); ++i)
+    {
+        independentIds.push_back(species[independent[i]]);
+    }
+    for (unsigned i = 0; i < dependent.size(); ++i)
+    {
+        dependentIds.push_back(species[dependent[i]]);
+    }
+}
+
+int SparseStructural::getNumSpecies() const
+{
+    return species.size();
+}
+
+int SparseStructural::getNumReactions() const
+{
+    return reactions.size();
+}
+
+int SparseStructural::getRank() const
+{
+    return independent.size();
+}
+
+const std::vector<std::string>& SparseStructural::getSpecies() const
+{
+    return species;
+}
+
+const std::vector<std::string>& SparseStructural::getReactions() const
+{
+    return reactions;
+}
+
+const std::vector<std::string>& SparseStructural::getIndependentSpecies() const
+{
+    return independentIds;
+}
+
+const std::vector<std::string>& SparseStructural::getDependentSpecies() const
+{
+    return dependentIds;
+}
+
+ls::DoubleMatrix SparseStructural::getL0Matrix() const
+{
+    ls::DoubleMatrix L0(dependent.size(), independent.size());
+
+    for (unsigned i = 0; i < link.size(); ++i)
+    {
+        for (unsigned j = 0; j < link[i].size(); ++j)
+        {
+            L0(i, link[i][j].first) = link[i][j].second;
+        }
+    }
+    return L0;
+}
+
+ls::DoubleMatrix SparseStructural::getNrMatrix() const
+{
+    ls::DoubleMatrix Nr(independent.size(), reactions.size());
+
+    for (unsigned i = 0; i < independent.size(); ++i)
+    {
+        const SparseVector& row = rows[independent[i]];
+        for (unsigned j = 0; j < row.size(); ++j)
+        {
+            Nr(i, row[j].first) = row[j].second;
+        }
+    }
+    return Nr;
+}
+
+ls::DoubleMatrix SparseStructural::getKMatrix() const
+{
+    const int numReactions = reactions.size();
+    const int rank = basis.size();
+
+    vector<int> pivotRow(numReactions, -1);
+    for (int k = 0; k < rank; ++k)
+    {
+        pivotRow[pivots[k]] = k;
+    }
+
+    // back substitute to the reduced row echelon form, the later rows are
+    // reduced first, so they are zero in every other pivot column.
+    vector<SparseVector> reduced(basis);
+    SparseAccumulator w(numReactions);
+
+    for (int k = rank - 1; k >= 0; --k)
+    {
+        MinHeap heap;
+        for (unsigned i = 0; i < reduced[k].size(); ++i)
+        {
+            int c = reduced[k][i].first;
+            w.add(c, reduced[k][i].second);
+            if (pivotRow[c] > k)
+            {
+                heap.push(pivotRow[c]);
+            }
+        }
+
+        while (!heap.empty())
+        {
+            int j = heap.top();
+            heap.pop();
+
+            double m = w[pivots[j]] / pivotValues[j];
+            const SparseVector& b = reduced[j];
+            for (unsigned i = 0; i < b.size(); ++i)
+            {
+                w.add(b[i].first, -m * b[i].second);
+            }
+            w[pivots[j]] = 0;
+        }
+
+        w.gather(reduced[k], tolerance * fabs(pivotValues[k]));
+    }
+
+    vector<int> freeColumn(numReactions, -1);
+    int numFree = 0;
+    for (int c = 0; c < numReactions; ++c)
+    {
+        if (pivotRow[c] < 0)
+        {
+            freeColumn[c] = numFree++;
+        }
+    }
+
+    ls::DoubleMatrix K(numReactions, numFree);
+    for (int c = 0; c < numReactions; ++c)
+    {
+        if (freeColumn[c] >= 0)
+        {
+            K(c, freeColumn[c]) = 1;
+        }
+    }
+
+    for (int k = 0; k < rank; ++k)
+    {
+        for (unsigned i = 0; i < reduced[k].size(); ++i)
+        {
+            int c = reduced[k][i].first;
+            if (freeColumn[c] >= 0)
+            {
+                K(pivots[k], freeColumn[c]) = -reduced[k][i].second / pivotValues[k];
+            }
+        }
+    }
+    return K;
+}
+
+} // namespace conservation
+} // namespace rr
@@ -0,0 +1,149 @@
+/*
+ * SparseStructural.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef SparseStructural_H_
+#define SparseStructural_H_
+
+#include "rrExporter.h"
+#include "rr-libstruct/lsMatrix.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace libsbml
+{
+class Model;
+}
+
+namespace rr
+{
+namespace conservation
+{
+
+/**
+ * Structural analysis of the stoichiometry matrix using sparse elimination.
+ *
+ * Computes the same decomposition that ls::LibStructural computes for the
+ * conserved moiety conversion, the partition of the floating species into
+ * independent and dependent species, and the link matrix L0 such that
+ *
+ * N_dep = L0 N_ind,
+ *
+ * without ever forming the dense stoichiometry matrix. The species rows of
+ * N are eliminated one at a time, in model order, against a sparse echelon
+ * basis of the rows seen so far. A row that reduces to zero is a dependent
+ * species, and the multipliers of the elimination are its row of L0. The
+ * pivot of a new basis row is chosen among the entries within a threshold
+ * of the largest one as the reaction that appears in the fewest species,
+ * which keeps the basis sparse.
+ *
+ * The species are therefore split by model order, earlier species are
+ * preferred as independent species, while LibStructural picks them by
+ * column pivoted QR. Both partitions are valid, the rank and the
+ * conservation laws they describe are the same, but for models with
+ * conserved moieties the chosen dependent species, and thus the species
+ * order of the converted model, may differ.
+ *
+ * The memory used is proportional to the number of non zeros of the
+ * stoichiometry matrix and of the elimination basis, and the run time for
+ * genome scale networks is typically a fraction of a second.
+ */
+class RR_DECLSPEC SparseStructural
+{
+public:
+
+    /**
+     * analyze the floating species and reactions of a model, the
+     * stoichiometry is built the same way as LibStructural builds it.
+     */
+    SparseStructural(const libsbml::Model* model, double tolerance = 1.e-9);
+
+    ~SparseStructural();
+
+    int getNumSpecies() const;
+
+    int getNumReactions() const;
+
+    /**
+     * the rank of the stoichiometry matrix.
+     */
+    int getRank() const;
+
+    /**
+     * the floating species in model order.
+     */
+    const std::vector<std::string>& getSpecies() const;
+
+    const std::vector<std::string>& getReactions() const;
+
+    const std::vector<std::string>& getIndependentSpecies() const;
+
+    const std::vector<std::string>& getDependentSpecies() const;
+
+    /**
+     * the link matrix L0, one row per dependent species and one column per
+     * independent species.
+     */
+    ls::DoubleMatrix getL0Matrix() const;
+
+    /**
+     * the reduced stoichiometry matrix Nr, the rows of the independent
+     * species, all reactions in model order.
+     */
+    ls::DoubleMatrix getNrMatrix() const;
+
+    /**
+     * a basis of the null space of the stoichiometry matrix, one row per
+     * reaction in model order, one column per reaction that is not a pivot
+     * of the row echelon form of Nr.
+     */
+    ls::DoubleMatrix getKMatrix() const;
+
+private:
+    typedef std::vector<std::pair<int, double> > SparseVector;
+
+    double tolerance;
+
+    std::vector<std::string> species;
+    std::vector<std::string> reactions;
+
+    /**
+     * the species rows of the stoichiometry matrix.
+     */
+    std::vector<SparseVector> rows;
+
+    /**
+     * indices of the independent and dependent species.
+     */
+    std::vector<int> independent;
+    std::vector<int> dependent;
+
+    std::vector<std::string> independentIds;
+    std::vector<std::string> dependentIds;
+
+    /**
+     * the echelon basis, each basis row is zero in the pivot columns of
+     * the basis rows before it.
+     */
+    std::vector<SparseVector> basis;
+    std::vector<int> pivots;
+    std::vector<double> pivotValues;
+
+    /**
+     * rows of L0 of the dependent species, indexed by independent species.
+     */
+    std::vector<SparseVector> link;
+
+    void buildStoichiometry(const libsbml::Model* model);
+
+    void eliminate();
+};
+
+} // namespace conservation
+} // namespace rr
+
+#endif /* SparseStructural_H_ */
@@ -65,7 +65,8 @@ namespace fbc
     }
 
     
-FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Dictionary* dict)
+FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Dictionary* dict) :
+    solved(false)
 {
 	doc = cxx11_ns::unique_ptr<SBMLDocument>(checkedReadSBMLFromString(sbml.c_str()));
 
@@ -138,7 +139,6 @@ FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Diction
                     stoichRowIndx.push_back(iter->second);
                     stoichColIndx.push_back(rid);
                     
-                    std::cout << "prod stoich, row: " << iter->second << ", rid: " << rid << ", value: " << ref->getStoichiometry() << "\n";
                     stoichValues.push_back(ref->getStoichiometry());
                     
                 }
@@ -164,8 +164,6 @@ FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Diction
                     stoichRowIndx.push_back(sid->second);
                     stoichColIndx.push_back(rid);
 
-                    std::cout << "reac stoich, row: " << sid->second << ", rid: " << rid << ", "
-                              << r->getId() << ", " << ref->getSpecies() << ", value: " << ref->getStoichiometry() << "\n";
                     stoichValues.push_back(-1 * ref->getStoichiometry());
                 }
 			}
@@ -240,7 +238,7 @@ FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Diction
 </fbc:listOfFluxBounds>
 	 */
 
-	std::vector<double> lbound(reactionsMap.size(), COIN_DBL_MIN);
+	std::vector<double> lbound(reactionsMap.size(), -COIN_DBL_MAX);
 	std::vector<double> ubound(reactionsMap.size(), COIN_DBL_MAX);
 
 	{
@@ -277,32 +275,19 @@ FBCExecutableModel::FBCExecutableModel(const std::string sbml, const rr::Diction
 	}
 
 	std::vector<double> rowBounds(floatingSpeciesMap.size(), 0);
-    
-    int *prow = &stoichRowIndx[0];
-    int *pcol = &stoichColIndx[0];
-    double *pval = &stoichValues[0];
-    
-    for (int i = 0; i < stoichValues.size(); ++i) {
-        std::cout << "{" << i << ", " << prow[i] << ", " << pcol[i] << ", " << pval[i] << "}" << std::endl;
-    }
-    
-    
-
-	matrix = CoinPackedMatrix(true, &stoichRowIndx[0], &stoichColIndx[0], &stoichValues[0], stoichValues.size());
 
-	for(int i = 0; i < matrix.getNumRows(); ++i) {
-		std::cout << "row " << i << ": ";
-		for(int j = 0; j < matrix.getNumCols(); ++j) {
-			std::cout << matrix.getCoefficient(i, j) << ",    ";
-		}
-		std::cout << "\n";
-	}
+	CoinPackedMatrix matrix(true, &stoichRowIndx[0], &stoichColIndx[0],
+			&stoichValues[0], stoichValues.size());
 
+	// species and reactions which are not in the stoichiometry would
+	// otherwise be dropped, and the fluxes indexed out of range
+	matrix.setDimensions(rowBounds.size(), lbound.size());
 
+	Log(rr::Logger::LOG_DEBUG) << "FBC stoichiometry matrix: " << matrix.getNumRows()
+			<< " x " << matrix.getNumCols() << ", " << stoichValues.size() << " non-zeros";
 
-	lpModel.loadProblem(matrix, &lbound[0], &ubound[0], &objective[0],
+	lpSolver.loadProblem(matrix, &lbound[0], &ubound[0], &objective[0],
 			&rowBounds[0], &rowBounds[0]);
-
 }
 
 FBCExecutableModel::~FBCExecutableModel()
@@ -574,23 +559,44 @@ int FBCExecutableModel::getNumRateRules()
 
 int FBCExecutableModel::getNumReactions()
 {
-    return 0;
+    return reactionsMap.size();
 }
 
 int FBCExecutableModel::getReactionIndex(const std::string& eid)
 {
-    return 0;
+    StringUIntMap::const_iterator i = reactionsMap.find(eid);
+    return i != reactionsMap.end() ? (int)i->second : -1;
 }
 
 std::string FBCExecutableModel::getReactionId(int index)
 {
-    return "";
+    for (StringUIntMap::const_iterator i = reactionsMap.begin();
+            i != reactionsMap.end(); ++i) {
+        if (i->second == (uint)index) {
+            return i->first;
+        }
+    }
+    throw std::out_of_range("reaction index out of range");
 }
 
 int FBCExecutableModel::getReactionRates(int len, const int* indx,
 		double* values)
 {
-    return 0;
+    // the reaction rates are the optimal fluxes
+    if (!solved) {
+        optimize();
+    }
+
+    const double* fluxes = lpSolver.getSolution();
+
+    for (int i = 0; i < len; ++i) {
+        int j = indx ? indx[i] : i;
+        if (j < 0 || j >= (int)reactionsMap.size()) {
+            throw std::out_of_range("reaction index out of range");
+        }
+        values[i] = fluxes[j];
+    }
+    return len;
 }
 
 void FBCExecutableModel::getRateRuleValues(double* rateRuleValues)
@@ -722,33 +728,49 @@ void FBCExecutableModel::setFlags(uint32_t unsignedInt)
 
 void FBCExecutableModel::writeLP(const std::string& fname)
 {
-	CoinLpIO io;
+	lpSolver.writeLP(fname);
+}
 
-	/*
-	 * void setLpDataWithoutRowAndColNames(
-			      const CoinPackedMatrix& m,
-			      const double* collb, const double* colub,
-			      const double* obj_coeff,
-			      const char* integrality,
-			      const double* rowlb, const double* rowub);
-	 */
+double FBCExecutableModel::optimize()
+{
+	LPSolver::Status status = lpSolver.solve();
 
-	const double* collb = lpModel.getColLower();
-	const double* colub = lpModel.getColUpper();
-	const double* obj = lpModel.getObjCoefficients();
-	const double* rowlb = lpModel.getRowLower();
-	const double* rowub = lpModel.getRowUpper();
+	Log(rr::Logger::LOG_DEBUG) << "FBC optimize, status: " << status
+			<< ", iterations: " << lpSolver.getIterationCount();
 
+	if (status != LPSolver::OPTIMAL) {
+		solved = false;
+		throw std::runtime_error(status == LPSolver::INFEASIBLE ?
+				"flux balance problem is infeasible" :
+				status == LPSolver::UNBOUNDED ?
+				"flux balance problem is unbounded" :
+				"flux balance problem could not be solved");
+	}
 
-	io.setLpDataWithoutRowAndColNames(matrix,
-		      collb, colub,
-		      obj,
-		      NULL,
-		      rowlb, rowub);
+	solved = true;
+	return lpSolver.getObjectiveValue();
+}
 
+void FBCExecutableModel::setFluxBounds(int reactionIndex, double lower,
+		double upper)
+{
+	if (reactionIndex < 0 || reactionIndex >= (int)reactionsMap.size()) {
+		throw std::out_of_range("reaction index out of range");
+	}
+	lpSolver.setColumnBounds(reactionIndex, lower, upper);
+	solved = false;
+}
 
+void FBCExecutableModel::fluxVariability(const std::vector<int>& reactions,
+		double fraction, std::vector<double>& minimum,
+		std::vector<double>& maximum, int nThreads)
+{
+	lpSolver.fluxVariability(reactions, fraction, minimum, maximum, nThreads);
+}
 
-	io.writeLp(fname.c_str(), true);
+const LPSolver& FBCExecutableModel::getLPSolver() const
+{
+	return lpSolver;
 }
 
 } /* namespace fbc */
@@ -21,6 +21,7 @@
 
 #include "coin/ClpSimplex.hpp"
 #include "coin/CoinHelperFunctions.hpp"
+#include "fbc/LPSolver.h"
 #include <stdexcept>
 
 
@@ -595,6 +596,36 @@ public:
 
     void writeLP(const std::string& fname);
 
+    /**
+     * solve the flux balance problem with the fbc objective and flux bounds.
+     *
+     * The solver is warm started from the previous solution, so repeated
+     * optimizations after changing bounds are cheap.
+     *
+     * @returns the optimal objective value.
+     * @throws std::runtime_error if the problem is infeasible or unbounded.
+     */
+    double optimize();
+
+    /**
+     * set the flux bounds of a reaction, invalidates the current solution.
+     */
+    void setFluxBounds(int reactionIndex, double lower, double upper);
+
+    /**
+     * flux variability analysis, the minimum and maximum flux of each of
+     * the given reactions (all reactions if empty) with the objective held
+     * at least fraction of its optimum. @see LPSolver::fluxVariability.
+     */
+    void fluxVariability(const std::vector<int>& reactions, double fraction,
+            std::vector<double>& minimum, std::vector<double>& maximum,
+            int nThreads = 0);
+
+    /**
+     * the linear program built from the fbc constraints.
+     */
+    const LPSolver& getLPSolver() const;
+
 private:
     cxx11_ns::unique_ptr<libsbml::SBMLDocument> doc;
 
@@ -605,8 +636,12 @@ private:
     StringUIntMap reactionsMap;
 
 
-    ClpSimplex  lpModel;
-    CoinPackedMatrix matrix;
+    LPSolver lpSolver;
+
+    /**
+     * is the lpSolver solution current.
+     */
+    bool solved;
 };
 
 } /* namespace fbc */
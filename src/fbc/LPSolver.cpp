@@ -6,21 +6,380 @@
  */
 
 #include <fbc/LPSolver.h>
+#include "rrLogger.h"
+
+#include "coin/CoinError.hpp"
+#include "coin/CoinLpIO.hpp"
+
+#include <Poco/Environment.h>
+#include <Poco/Mutex.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <math.h>
 
 namespace rr
 {
 namespace fbc
 {
 
-LPSolver::LPSolver()
+LPSolver::LPSolver() :
+	status(NOT_SOLVED),
+	solved(false),
+	boundsChanged(false)
 {
-	// TODO Auto-generated constructor stub
-
+	model.setLogLevel(0);
 }
 
 LPSolver::~LPSolver()
 {
-	// TODO Auto-generated destructor stub
+}
+
+LPSolver::LPSolver(int numRows,
+	     int numCols,
+	     const int * rowIndices,
+	     const int * colIndices,
+	     const double * elements,
+	     unsigned n) :
+	status(NOT_SOLVED),
+	solved(false),
+	boundsChanged(false)
+{
+	model.setLogLevel(0);
+
+	CoinPackedMatrix matrix(true, rowIndices, colIndices, elements, n);
+
+	// trailing empty rows and columns are not in the triplets
+	matrix.setDimensions(numRows, numCols);
+
+	std::vector<double> colLower(matrix.getNumCols(), -COIN_DBL_MAX);
+	std::vector<double> colUpper(matrix.getNumCols(), COIN_DBL_MAX);
+	std::vector<double> objective(matrix.getNumCols(), 0.0);
+	std::vector<double> rowBounds(matrix.getNumRows(), 0.0);
+
+	loadProblem(matrix, &colLower[0], &colUpper[0], &objective[0],
+			&rowBounds[0], &rowBounds[0]);
+}
+
+LPSolver::LPSolver(const LPSolver& other) :
+	model(other.model),
+	status(other.status),
+	solved(other.solved),
+	boundsChanged(other.boundsChanged)
+{
+}
+
+LPSolver& LPSolver::operator=(const LPSolver& other)
+{
+	if (this != &other) {
+		model = other.model;
+		status = other.status;
+		solved = other.solved;
+		boundsChanged = other.boundsChanged;
+	}
+	return *this;
+}
+
+void LPSolver::loadProblem(const CoinPackedMatrix& matrix,
+		const double* colLower, const double* colUpper,
+		const double* objective,
+		const double* rowLower, const double* rowUpper)
+{
+	model.loadProblem(matrix, colLower, colUpper, objective, rowLower, rowUpper);
+	model.setOptimizationDirection(-1);
+	status = NOT_SOLVED;
+	solved = false;
+	boundsChanged = false;
+}
+
+int LPSolver::getNumRows() const
+{
+	return model.getNumRows();
+}
+
+int LPSolver::getNumCols() const
+{
+	return model.getNumCols();
+}
+
+void LPSolver::setObjective(const double* objective)
+{
+	for (int i = 0; i < model.getNumCols(); ++i) {
+		model.setObjectiveCoefficient(i, objective[i]);
+	}
+}
+
+void LPSolver::setObjectiveCoefficient(int col, double value)
+{
+	model.setObjectiveCoefficient(col, value);
+}
+
+void LPSolver::setMaximize(bool maximize)
+{
+	model.setOptimizationDirection(maximize ? -1 : 1);
+}
+
+void LPSolver::setColumnBounds(int col, double lower, double upper)
+{
+	model.setColumnBounds(col, lower, upper);
+	boundsChanged = true;
+}
+
+void LPSolver::getColumnBounds(int col, double& lower, double& upper) const
+{
+	lower = model.getColLower()[col];
+	upper = model.getColUpper()[col];
+}
+
+void LPSolver::addRow(const double* coef, double lower, double upper)
+{
+	std::vector<int> columns;
+	std::vector<double> elements;
+
+	for (int i = 0; i < model.getNumCols(); ++i) {
+		if (coef[i] != 0.0) {
+			columns.push_back(i);
+			elements.push_back(coef[i]);
+		}
+	}
+
+	model.addRow(columns.size(), columns.size() ? &columns[0] : 0,
+			elements.size() ? &elements[0] : 0, lower, upper);
+	boundsChanged = true;
+}
+
+LPSolver::Status LPSolver::solve()
+{
+	if (!solved) {
+		model.initialSolve();
+	} else if (boundsChanged) {
+		// previous basis is still dual feasible
+		model.dual();
+	} else {
+		// only the objective changed, previous basis is still primal feasible
+		model.primal();
+	}
+
+	solved = true;
+	boundsChanged = false;
+
+	switch (model.status()) {
+	case 0:
+		status = OPTIMAL;
+		break;
+	case 1:
+		status = INFEASIBLE;
+		break;
+	case 2:
+		status = UNBOUNDED;
+		break;
+	case 3:
+		status = ITERATION_LIMIT;
+		break;
+	default:
+		status = ERROR;
+		// the basis may be garbage, start from scratch next time
+		solved = false;
+		break;
+	}
+
+	return status;
+}
+
+LPSolver::Status LPSolver::getStatus() const
+{
+	return status;
+}
+
+int LPSolver::getIterationCount() const
+{
+	return model.getIterationCount();
+}
+
+double LPSolver::getObjectiveValue() const
+{
+	return model.getObjValue();
+}
+
+const double* LPSolver::getSolution() const
+{
+	return model.getColSolution();
+}
+
+/**
+ * shared state of the flux variability workers, the next column to
+ * process is handed out under the mutex.
+ */
+struct VariabilityTask
+{
+	const std::vector<int>* columns;
+	std::vector<double>* minimum;
+	std::vector<double>* maximum;
+	Poco::Mutex mutex;
+	unsigned next;
+	std::string error;
+};
+
+/**
+ * the optimum of a column, or +/- infinity if unbounded,
+ * NaN if not solved.
+ */
+static double optimum(const LPSolver& solver, LPSolver::Status status,
+		bool maximize)
+{
+	switch (status) {
+	case LPSolver::OPTIMAL:
+		return solver.getObjectiveValue();
+	case LPSolver::UNBOUNDED:
+		return maximize ? std::numeric_limits<double>::infinity() :
+				-std::numeric_limits<double>::infinity();
+	default:
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+}
+
+class VariabilityWorker : public Poco::Runnable
+{
+public:
+	VariabilityWorker(const LPSolver& base, VariabilityTask& task) :
+		solver(base), task(task)
+	{
+		std::vector<double> zero(solver.getNumCols(), 0.0);
+		solver.setObjective(&zero[0]);
+	}
+
+	virtual void run()
+	{
+		try {
+			for (;;) {
+				unsigned i;
+				{
+					Poco::Mutex::ScopedLock lock(task.mutex);
+					if (task.next >= task.columns->size() || !task.error.empty()) {
+						return;
+					}
+					i = task.next++;
+				}
+
+				int col = (*task.columns)[i];
+
+				// each solve starts from the basis of the previous one
+				solver.setObjectiveCoefficient(col, 1.0);
+
+				solver.setMaximize(true);
+				(*task.maximum)[i] = optimum(solver, solver.solve(), true);
+
+				solver.setMaximize(false);
+				(*task.minimum)[i] = optimum(solver, solver.solve(), false);
+
+				solver.setObjectiveCoefficient(col, 0.0);
+			}
+		} catch (std::exception& e) {
+			Poco::Mutex::ScopedLock lock(task.mutex);
+			task.error = e.what();
+		} catch (CoinError& e) {
+			// must not escape the thread
+			Poco::Mutex::ScopedLock lock(task.mutex);
+			task.error = e.className() + "::" + e.methodName() + ": " + e.message();
+		}
+	}
+
+private:
+	LPSolver solver;
+	VariabilityTask& task;
+};
+
+void LPSolver::fluxVariability(const std::vector<int>& _columns, double fraction,
+		std::vector<double>& minimum, std::vector<double>& maximum,
+		int nThreads) const
+{
+	std::vector<int> columns(_columns);
+	if (columns.empty()) {
+		for (int i = 0; i < getNumCols(); ++i) {
+			columns.push_back(i);
+		}
+	}
+
+	for (unsigned i = 0; i < columns.size(); ++i) {
+		if (columns[i] < 0 || columns[i] >= getNumCols()) {
+			throw std::out_of_range("flux variability column index out of range");
+		}
+	}
+
+	LPSolver base(*this);
+
+	if (base.solve() != OPTIMAL) {
+		throw std::runtime_error("flux variability analysis requires an optimal "
+				"solution of the flux balance problem");
+	}
+
+	// constrain the objective to stay within fraction of its optimum
+	double opt = base.getObjectiveValue();
+	double slack = (1.0 - fraction) * fabs(opt);
+	bool maximize = base.model.getObjSense() < 0;
+
+	base.addRow(base.model.getObjCoefficients(),
+			maximize ? opt - slack : -COIN_DBL_MAX,
+			maximize ? COIN_DBL_MAX : opt + slack);
+
+	minimum.assign(columns.size(), 0.0);
+	maximum.assign(columns.size(), 0.0);
+
+	if (nThreads <= 0) {
+		nThreads = Poco::Environment::processorCount();
+	}
+	nThreads = std::max(1, std::min<int>(nThreads, columns.size()));
+
+	VariabilityTask task;
+	task.columns = &columns;
+	task.minimum = &minimum;
+	task.maximum = &maximum;
+	task.next = 0;
+
+	std::vector<VariabilityWorker*> workers;
+	for (int i = 0; i < nThreads; ++i) {
+		workers.push_back(new VariabilityWorker(base, task));
+	}
+
+	if (nThreads == 1) {
+		workers[0]->run();
+	} else {
+		Poco::Thread* threads = new Poco::Thread[nThreads];
+		for (int i = 0; i < nThreads; ++i) {
+			threads[i].start(*workers[i]);
+		}
+		for (int i = 0; i < nThreads; ++i) {
+			threads[i].join();
+		}
+		delete[] threads;
+	}
+
+	for (int i = 0; i < nThreads; ++i) {
+		delete workers[i];
+	}
+
+	if (!task.error.empty()) {
+		throw std::runtime_error("flux variability analysis failed: " + task.error);
+	}
+
+	Log(Logger::LOG_DEBUG) << "flux variability of " << columns.size()
+			<< " columns using " << nThreads << " threads";
+}
+
+void LPSolver::writeLP(const std::string& fname) const
+{
+	CoinLpIO io;
+
+	io.setLpDataWithoutRowAndColNames(*model.matrix(),
+			model.getColLower(), model.getColUpper(),
+			model.getObjCoefficients(),
+			NULL,
+			model.getRowLower(), model.getRowUpper());
+
+	io.writeLp(fname.c_str(), true);
 }
 
 } /* namespace fbc */
@@ -8,6 +8,9 @@
 #ifndef SOURCE_FBC_LPSOLVER_H_
 #define SOURCE_FBC_LPSOLVER_H_
 
+#include "coin/ClpSimplex.hpp"
+#include <string>
+#include <vector>
 #include <list>
 
 namespace rr
@@ -15,18 +18,157 @@ namespace rr
 namespace fbc
 {
 
+/**
+ * Linear program solver for flux balance problems.
+ *
+ * Solves max c'v subject to A v = 0 and lb <= v <= ub, where A is the
+ * (sparse) stoichiometry matrix, using the Clp revised simplex. The simplex
+ * basis is kept between calls to solve, so after changing the objective or
+ * the bounds, the next solve is warm started from the previous optimal basis,
+ * which is typically only a few pivots away.
+ *
+ * An LPSolver can be copied, the copy has its own problem data and basis, so
+ * copies can be solved concurrently in different threads.
+ */
 class LPSolver
 {
 public:
+
+	/**
+	 * status of the last solve.
+	 */
+	enum Status
+	{
+		OPTIMAL = 0,
+		INFEASIBLE = 1,
+		UNBOUNDED = 2,
+		ITERATION_LIMIT = 3,
+		ERROR = 4,
+		NOT_SOLVED = 5
+	};
+
 	LPSolver();
 	virtual ~LPSolver();
 
-	LPSolver(const int * rowIndices,
+	/**
+	 * create a solver from the constraint matrix in coordinate (triplet)
+	 * form, the rows are constrained to zero, the columns are unbounded,
+	 * and the objective is zero. The counts are given explicitly, so rows
+	 * and columns without any elements are kept.
+	 */
+	LPSolver(int numRows,
+		     int numCols,
+		     const int * rowIndices,
 		     const int * colIndices,
 		     const double * elements,
 		     unsigned n);
 
+	/**
+	 * copy the problem and the current basis.
+	 */
+	LPSolver(const LPSolver& other);
+
+	LPSolver& operator=(const LPSolver& other);
+
+	/**
+	 * load a problem with a constraint matrix, column bounds,
+	 * objective, and row bounds.
+	 *
+	 * The objective is maximized.
+	 */
+	void loadProblem(const CoinPackedMatrix& matrix,
+			const double* colLower, const double* colUpper,
+			const double* objective,
+			const double* rowLower, const double* rowUpper);
+
+	int getNumRows() const;
+	int getNumCols() const;
+
+	/**
+	 * replace the objective coefficients, the array must have getNumCols
+	 * elements.
+	 */
+	void setObjective(const double* objective);
+
+	void setObjectiveCoefficient(int col, double value);
+
+	/**
+	 * set the objective sense, true for maximize (the default),
+	 * false for minimize.
+	 */
+	void setMaximize(bool maximize);
+
+	void setColumnBounds(int col, double lower, double upper);
+
+	void getColumnBounds(int col, double& lower, double& upper) const;
+
+	/**
+	 * add the constraint lower <= coef' v <= upper.
+	 */
+	void addRow(const double* coef, double lower, double upper);
+
+	/**
+	 * solve the problem, starting from the basis of the previous solve
+	 * if there is one.
+	 */
+	Status solve();
+
+	Status getStatus() const;
+
+	/**
+	 * number of simplex iterations used by the last solve.
+	 */
+	int getIterationCount() const;
+
+	double getObjectiveValue() const;
+
+	/**
+	 * the column values of the last solution, getNumCols long.
+	 */
+	const double* getSolution() const;
+
+	/**
+	 * Flux variability analysis.
+	 *
+	 * Solves the problem with the current objective, adds the constraint that
+	 * the objective is at least fraction times its optimum, and then minimizes
+	 * and maximizes each of the given columns.
+	 *
+	 * The min / max solves are distributed over nThreads workers. Each worker
+	 * owns a copy of this solver, and warm starts each solve from the basis
+	 * of its previous solve. If nThreads is <= 0, the number of cpus is used.
+	 *
+	 * This object is not modified.
+	 *
+	 * @param columns the columns to vary, if empty, all columns are used.
+	 * @param minimum receives the minimum value of each column.
+	 * @param maximum receives the maximum value of each column.
+	 * @throws std::runtime_error if the initial problem is not optimal.
+	 */
+	void fluxVariability(const std::vector<int>& columns, double fraction,
+			std::vector<double>& minimum, std::vector<double>& maximum,
+			int nThreads = 0) const;
+
+	/**
+	 * write the problem in the CPLEX LP format.
+	 */
+	void writeLP(const std::string& fname) const;
+
+private:
+	ClpSimplex model;
+	Status status;
+
+	/**
+	 * is there a basis from a previous solve.
+	 */
+	bool solved;
 
+	/**
+	 * bounds or rows changed since the last solve, the previous basis is
+	 * then dual feasible but may be primal infeasible, so the dual simplex
+	 * is used.
+	 */
+	bool boundsChanged;
 };
 
 } /* namespace fbc */
@@ -91,8 +91,10 @@ Value* EvalInitialConditionsCodeGen::codeGen()
     // read init values from sbml and store in model data
     codeGenGlobalParameters(modelDataResolver, initialValueResolver);
 
-    // read values from the model data state vector
-    ModelDataLoadSymbolResolver modelValueResolver(modelData, this->modelGenContext);
+    // read values from the model data state vector, the invariant values
+    // have not been evaluated yet at this point.
+    ModelDataLoadSymbolResolver modelValueResolver(modelData,
+            this->modelGenContext, false);
 
 
     // initializes the values stored in the model
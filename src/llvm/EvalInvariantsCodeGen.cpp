@@ -0,0 +1,62 @@
+/*
+ * EvalInvariantsCodeGen.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+#pragma hdrstop
+#include "EvalInvariantsCodeGen.h"
+
+#include "LLVMException.h"
+#include "ModelDataSymbolResolver.h"
+#include "rrLogger.h"
+
+#include <vector>
+#include <Poco/Logger.h>
+
+namespace rrllvm
+{
+using namespace rr;
+using namespace llvm;
+using namespace libsbml;
+using namespace std;
+
+const char* EvalInvariantsCodeGen::FunctionName = "evalInvariants";
+
+EvalInvariantsCodeGen::EvalInvariantsCodeGen(
+        const ModelGeneratorContext &mgc) :
+        CodeGenBase<EvalInvariantsCodeGen_FunctionPtr>(mgc)
+{
+}
+
+EvalInvariantsCodeGen::~EvalInvariantsCodeGen()
+{
+}
+
+Value* EvalInvariantsCodeGen::codeGen()
+{
+    Value *modelData = 0;
+
+    codeGenVoidModelDataHeader(FunctionName, modelData);
+
+    // this function computes the invariant values, so it has to evaluate
+    // the rules, not load the previously stored values.
+    ModelDataLoadSymbolResolver resolver(modelData, modelGenContext, false);
+
+    ModelDataIRBuilder mdbuilder(modelData, dataSymbols, builder);
+
+    vector<string> ids = dataSymbols.getInvariantAssignmentRuleIds();
+
+    for (vector<string>::const_iterator i = ids.begin(); i != ids.end(); ++i)
+    {
+        Log(Logger::LOG_DEBUG) << "generating invariant code for " << *i;
+
+        Value *value = resolver.loadSymbolValue(*i);
+        mdbuilder.createInvariantValueStore(*i, value);
+    }
+
+    builder.CreateRetVoid();
+
+    return verifyFunction();
+}
+
+} /* namespace rrllvm */
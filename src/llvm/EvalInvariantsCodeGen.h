@@ -0,0 +1,44 @@
+/*
+ * EvalInvariantsCodeGen.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef EVALINVARIANTSCODEGEN_H_
+#define EVALINVARIANTSCODEGEN_H_
+
+#include "CodeGenBase.h"
+#include "ModelGeneratorContext.h"
+#include "SymbolForest.h"
+#include "ASTNodeFactory.h"
+#include "ModelDataIRBuilder.h"
+#include <sbml/Model.h>
+
+namespace rrllvm
+{
+
+typedef void (*EvalInvariantsCodeGen_FunctionPtr)(LLVMModelData*);
+
+/**
+ * generates a function which evaluates all of the time invariant
+ * assignment rules and stores thier values in the invariant values
+ * block of the model data.
+ *
+ * All of the other generated functions load the stored values, so this
+ * needs to be called whenever a value that an invariant rule depends
+ * on is changed, i.e. on reset or when a value is set.
+ */
+class EvalInvariantsCodeGen:
+        public CodeGenBase<EvalInvariantsCodeGen_FunctionPtr>
+{
+public:
+    EvalInvariantsCodeGen(const ModelGeneratorContext &mgc);
+    virtual ~EvalInvariantsCodeGen();
+
+    llvm::Value *codeGen();
+
+    static const char* FunctionName;
+};
+
+} /* namespace rrllvm */
+#endif /* EVALINVARIANTSCODEGEN_H_ */
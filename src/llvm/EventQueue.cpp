@@ -60,6 +60,18 @@ Event::Event(LLVMExecutableModel& model, uint id) :
             ": " << *this;
 }
 
+Event::Event(LLVMExecutableModel& model, uint id, double delay,
+        double assignTime, uint dataSize, const double* data) :
+        model(model),
+        id(id),
+        delay(delay),
+        assignTime(assignTime),
+        dataSize(dataSize),
+        data(new double[dataSize])
+{
+    std::copy(data, data + dataSize, this->data);
+}
+
 Event::Event(const Event& o) :
         model(o.model),
         id(o.id),
@@ -291,6 +303,21 @@ double EventQueue::getNextPendingEventTime()
     }
 }
 
+void EventQueue::clear()
+{
+    c.clear();
+}
+
+EventQueue::const_iterator EventQueue::begin() const
+{
+    return c.begin();
+}
+
+EventQueue::const_iterator EventQueue::end() const
+{
+    return c.end();
+}
+
 std::ostream& operator<< (std::ostream& stream, const EventQueue& queue)
 {
     stream << "EventQueue {" << std::endl;
@@ -23,6 +23,13 @@ class Event
 {
 public:
     Event(LLVMExecutableModel&, uint id);
+
+    /**
+     * re-create an event from a saved model state, or copy an event
+     * from another model.
+     */
+    Event(LLVMExecutableModel&, uint id, double delay, double assignTime,
+            uint dataSize, const double* data);
     Event(const Event& other);
     Event& operator=( const Event& rhs );
     ~Event();
@@ -125,6 +132,15 @@ public:
      */
     double getNextPendingEventTime();
 
+    /**
+     * remove all events from the queue.
+     */
+    void clear();
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
 
     friend std::ostream& operator<< (std::ostream& stream, const EventQueue& queue);
 
@@ -0,0 +1,223 @@
+#pragma hdrstop
+#include "KernelBenchmark.h"
+#include "LLVMExecutableModel.h"
+#include "rrUtils.h"
+
+#include <stdexcept>
+
+namespace rrllvm
+{
+
+/**
+ * calls of a function taking only the model data.
+ */
+template <typename FunctionPtr>
+struct ModelDataCall
+{
+    ModelDataCall(FunctionPtr func, LLVMModelData* data) :
+        func(func), data(data) {}
+
+    void operator()(uint64_t)
+    {
+        func(data);
+    }
+
+    FunctionPtr func;
+    LLVMModelData* data;
+};
+
+/**
+ * calls of a getter, cycling through the indices.
+ */
+template <typename FunctionPtr>
+struct GetCall
+{
+    GetCall(FunctionPtr func, LLVMModelData* data, int size) :
+        func(func), data(data), size(size) {}
+
+    void operator()(uint64_t i)
+    {
+        func(data, i % size);
+    }
+
+    FunctionPtr func;
+    LLVMModelData* data;
+    int size;
+};
+
+/**
+ * calls of a setter, cycling through the indices, setting the current
+ * values.
+ */
+template <typename FunctionPtr>
+struct SetCall
+{
+    SetCall(FunctionPtr func, LLVMModelData* data,
+            const std::vector<double>& values) :
+        func(func), data(data), values(values) {}
+
+    void operator()(uint64_t i)
+    {
+        int index = i % values.size();
+        func(data, index, values[index]);
+    }
+
+    FunctionPtr func;
+    LLVMModelData* data;
+    const std::vector<double>& values;
+};
+
+struct StateVectorRateCall
+{
+    StateVectorRateCall(rr::ExecutableModel* model, double* rates) :
+        model(model), time(model->getTime()), rates(rates) {}
+
+    void operator()(uint64_t)
+    {
+        model->getStateVectorRate(time, 0, rates);
+    }
+
+    rr::ExecutableModel* model;
+    double time;
+    double* rates;
+};
+
+template <typename Call>
+static void timeKernel(std::vector<KernelTiming>& timings, const char* name,
+        Call call, double minSeconds)
+{
+    // check the clock only once per batch, so its cost does not show up
+    // in the cheap accessors.
+    const unsigned batch = 256;
+    const int64_t budget = minSeconds * 1.e6;
+    const int64_t start = rr::getMicroSeconds();
+    int64_t elapsed = 0;
+    uint64_t calls = 0;
+
+    do
+    {
+        for (unsigned i = 0; i < batch; ++i)
+        {
+            call(calls + i);
+        }
+        calls += batch;
+        elapsed = rr::getMicroSeconds() - start;
+    }
+    while (elapsed < budget);
+
+    KernelTiming t;
+    t.name = name;
+    t.calls = calls;
+    t.nanoseconds = 1.e3 * elapsed / calls;
+    timings.push_back(t);
+}
+
+template <typename GetPtr, typename SetPtr>
+static void timeAccessors(std::vector<KernelTiming>& timings,
+        const char* getName, GetPtr getPtr, const char* setName, SetPtr setPtr,
+        LLVMModelData* data, int size, double minSeconds)
+{
+    if (size <= 0 || !getPtr)
+    {
+        return;
+    }
+
+    timeKernel(timings, getName, GetCall<GetPtr>(getPtr, data, size), minSeconds);
+
+    if (setPtr)
+    {
+        std::vector<double> values(size);
+        for (int i = 0; i < size; ++i)
+        {
+            values[i] = getPtr(data, i);
+        }
+        timeKernel(timings, setName, SetCall<SetPtr>(setPtr, data, values), minSeconds);
+    }
+}
+
+std::vector<KernelTiming> KernelBenchmark::run(rr::ExecutableModel* model,
+        double minSeconds)
+{
+    LLVMExecutableModel* m = dynamic_cast<LLVMExecutableModel*>(model);
+
+    if (!m)
+    {
+        throw std::invalid_argument("kernel benchmarks require an LLVM model");
+    }
+
+    LLVMModelData* data = m->modelData;
+    std::vector<KernelTiming> timings;
+
+    // buffers the rate functions write to, these are only set while the
+    // model evaluates its rates.
+    std::vector<double> rates(model->getStateVector(0) + 1);
+    data->rateRuleRates = &rates[0];
+    data->floatingSpeciesAmountRates = &rates[data->numRateRules];
+
+    timeKernel(timings, "evalReactionRates",
+            ModelDataCall<EvalReactionRatesCodeGen::FunctionPtr>(
+                    m->evalReactionRatesPtr, data), minSeconds);
+
+    if (data->numRateRules)
+    {
+        timeKernel(timings, "evalRateRuleRates",
+                ModelDataCall<EvalRateRuleRatesCodeGen::FunctionPtr>(
+                        m->evalRateRuleRatesPtr, data), minSeconds);
+    }
+
+    timeKernel(timings, "evalVolatileStoich",
+            ModelDataCall<EvalVolatileStoichCodeGen::FunctionPtr>(
+                    m->evalVolatileStoichPtr, data), minSeconds);
+
+    timeKernel(timings, "evalConversionFactor",
+            ModelDataCall<EvalConversionFactorCodeGen::FunctionPtr>(
+                    m->evalConversionFactorPtr, data), minSeconds);
+
+    data->rateRuleRates = 0;
+    data->floatingSpeciesAmountRates = 0;
+
+    if (model->getNumEvents())
+    {
+        timeKernel(timings, "getEventTrigger",
+                GetCall<GetEventTriggerCodeGen::FunctionPtr>(
+                        m->getEventTriggerPtr, data, model->getNumEvents()),
+                minSeconds);
+    }
+
+    timeAccessors(timings,
+            "getFloatingSpeciesAmount", m->getFloatingSpeciesAmountPtr,
+            "setFloatingSpeciesAmount", m->setFloatingSpeciesAmountPtr,
+            data, model->getNumFloatingSpecies(), minSeconds);
+
+    timeAccessors(timings,
+            "getFloatingSpeciesConcentration", m->getFloatingSpeciesConcentrationPtr,
+            "setFloatingSpeciesConcentration", m->setFloatingSpeciesConcentrationPtr,
+            data, model->getNumFloatingSpecies(), minSeconds);
+
+    timeAccessors(timings,
+            "getBoundarySpeciesAmount", m->getBoundarySpeciesAmountPtr,
+            "setBoundarySpeciesAmount", m->setBoundarySpeciesAmountPtr,
+            data, model->getNumBoundarySpecies(), minSeconds);
+
+    timeAccessors(timings,
+            "getBoundarySpeciesConcentration", m->getBoundarySpeciesConcentrationPtr,
+            "setBoundarySpeciesConcentration", m->setBoundarySpeciesConcentrationPtr,
+            data, model->getNumBoundarySpecies(), minSeconds);
+
+    timeAccessors(timings,
+            "getCompartmentVolume", m->getCompartmentVolumePtr,
+            "setCompartmentVolume", m->setCompartmentVolumePtr,
+            data, model->getNumCompartments(), minSeconds);
+
+    timeAccessors(timings,
+            "getGlobalParameter", m->getGlobalParameterPtr,
+            "setGlobalParameter", m->setGlobalParameterPtr,
+            data, model->getNumGlobalParameters(), minSeconds);
+
+    timeKernel(timings, "getStateVectorRate",
+            StateVectorRateCall(model, &rates[0]), minSeconds);
+
+    return timings;
+}
+
+} /* namespace rrllvm */
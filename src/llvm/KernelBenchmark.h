@@ -0,0 +1,67 @@
+/*
+ * KernelBenchmark.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RRLLVM_KERNELBENCHMARK_H_
+#define RRLLVM_KERNELBENCHMARK_H_
+
+#include "rrExporter.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace rr
+{
+class ExecutableModel;
+}
+
+namespace rrllvm
+{
+
+/**
+ * the measured cost of one generated function.
+ */
+struct KernelTiming
+{
+    std::string name;
+
+    /**
+     * average wall clock time per call in nanoseconds.
+     */
+    double nanoseconds;
+
+    uint64_t calls;
+};
+
+/**
+ * Measures the cost per call of the generated functions of an LLVM model,
+ * calling them directly on the model data, so the numbers include no
+ * ExecutableModel overhead, except for getStateVectorRate, which is the
+ * complete rate function path used by the integrators.
+ *
+ * Indexed accessors are called for each index in turn, setters are called
+ * with the value the matching getter returns, so the model state does not
+ * change. Functions the model was generated without, e.g. setters of read
+ * only models, or event triggers of a model without events, are skipped.
+ */
+class RR_DECLSPEC KernelBenchmark
+{
+public:
+
+    /**
+     * time each generated function of the model.
+     *
+     * Each function is called in batches until at least minSeconds have
+     * passed.
+     *
+     * @throws std::invalid_argument if the model is not an LLVM model.
+     */
+    static std::vector<KernelTiming> run(rr::ExecutableModel* model,
+            double minSeconds = 0.02);
+};
+
+} /* namespace rrllvm */
+
+#endif /* RRLLVM_KERNELBENCHMARK_H_ */
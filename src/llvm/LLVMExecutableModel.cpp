@@ -15,6 +15,9 @@
 #include "LLVMException.h"
 #include "rrStringUtils.h"
 #include "rrConfig.h"
+#include "StateSaving.h"
+#include "Dictionary.h"
+#include "Random.h"
 #include <iomanip>
 #include <cstdlib>
 
@@ -26,6 +29,7 @@ using rr::EventListener;
 using rr::EventListenerPtr;
 using rr::EventListenerException;
 using rr::Config;
+using rr::BasicDictionary;
 
 #if defined (_WIN32)
 #define isnan _isnan
@@ -184,6 +188,7 @@ LLVMExecutableModel::LLVMExecutableModel() :
     eventAssignPtr(0),
     evalVolatileStoichPtr(0),
     evalConversionFactorPtr(0),
+    evalInvariantsPtr(0),
     setBoundarySpeciesAmountPtr(0),
     setFloatingSpeciesAmountPtr(0),
     setBoundarySpeciesConcentrationPtr(0),
@@ -199,7 +204,10 @@ LLVMExecutableModel::LLVMExecutableModel() :
     getGlobalParameterInitValuePtr(0),
     setGlobalParameterInitValuePtr(0),
     dirty(0),
-    flags(defaultFlags())
+    flags(defaultFlags()),
+    eventRootEvaluations(0),
+    eventTriggers(0),
+    eventsApplied(0)
 {
     std::srand((unsigned)std::time(0));
 }
@@ -226,6 +234,7 @@ LLVMExecutableModel::LLVMExecutableModel(
     eventAssignPtr(rc->eventAssignPtr),
     evalVolatileStoichPtr(rc->evalVolatileStoichPtr),
     evalConversionFactorPtr(rc->evalConversionFactorPtr),
+    evalInvariantsPtr(rc->evalInvariantsPtr),
     setBoundarySpeciesAmountPtr(rc->setBoundarySpeciesAmountPtr),
     setFloatingSpeciesAmountPtr(rc->setFloatingSpeciesAmountPtr),
     setBoundarySpeciesConcentrationPtr(rc->setBoundarySpeciesConcentrationPtr),
@@ -242,7 +251,10 @@ LLVMExecutableModel::LLVMExecutableModel(
     setGlobalParameterInitValuePtr(rc->setGlobalParameterInitValuePtr),
     eventListeners(modelData->numEvents, EventListenerPtr()), // init eventHandlers vector
     dirty(0),
-    flags(defaultFlags())
+    flags(defaultFlags()),
+    eventRootEvaluations(0),
+    eventTriggers(0),
+    eventsApplied(0)
 {
 
     modelData->time = -1.0; // time is initially before simulation starts
@@ -627,6 +639,7 @@ string LLVMExecutableModel::getReactionId(int id)
 void LLVMExecutableModel::evalInitialConditions(uint32_t flags)
 {
     evalInitialConditionsPtr(modelData, flags);
+    evalInvariantsPtr(modelData);
 }
 
 void LLVMExecutableModel::reset()
@@ -757,6 +770,10 @@ void LLVMExecutableModel::reset(int opt)
     }
 
 
+    // values may have been re-initialized without going through
+    // any of the setters.
+    evalInvariantsPtr(modelData);
+
     // this sets up the event system to pull the initial value
     // before the simulation starts.
     setTime(-1.0);
@@ -1352,6 +1369,7 @@ int LLVMExecutableModel::setBoundarySpeciesAmounts(int len, const int* indx,
     {
         result = setValues(setBoundarySpeciesAmountPtr,
                 &LLVMExecutableModel::getBoundarySpeciesId, len, indx, values);
+        evalInvariantsPtr(modelData);
     }
     return result;
 }
@@ -1575,6 +1593,7 @@ int LLVMExecutableModel::setBoundarySpeciesConcentrations(int len,
     {
         result = setValues(setBoundarySpeciesConcentrationPtr,
                 &LLVMExecutableModel::getBoundarySpeciesId, len, indx, values);
+        evalInvariantsPtr(modelData);
     }
     return result;
 }
@@ -1594,6 +1613,9 @@ int LLVMExecutableModel::setGlobalParameterValues(int len, const int* indx,
         result = setValues(setGlobalParameterPtr,
                 &LLVMExecutableModel::getGlobalParameterId, len, indx, values);
 
+        // time invariant rules may depend on global parameters
+        evalInvariantsPtr(modelData);
+
         for (int i = 0; i < len; ++i)
         {
             int j = indx ? indx[i] : i;
@@ -1774,6 +1796,7 @@ int LLVMExecutableModel::setCompartmentVolumes(int len, const int* indx,
     {
         result = setValues(setCompartmentVolumePtr,
                 &LLVMExecutableModel::getCompartmentId, len, indx, values);
+        evalInvariantsPtr(modelData);
     }
     return result;
 }
@@ -1888,6 +1911,8 @@ int LLVMExecutableModel::applyEvents(double timeEnd,
             assignedEvents++;
             std::swap(p1, p2);
         }
+
+        eventsApplied += assignedEvents;
     }
 
     if(finalState) {
@@ -1902,6 +1927,8 @@ void  LLVMExecutableModel::getEventRoots(double time, const double* y, double* g
 {
     modelData->time = time;
 
+    ++eventRootEvaluations;
+
     double *savedRateRules = modelData->rateRuleValuesAlias;
     double *savedFloatingSpeciesAmounts = modelData->floatingSpeciesAmountsAlias;
 
@@ -1932,6 +1959,26 @@ void  LLVMExecutableModel::getEventRoots(double time, const double* y, double* g
     return;
 }
 
+void LLVMExecutableModel::getStatistics(BasicDictionary& stats) const
+{
+    stats.setItem("eventRootEvaluations", eventRootEvaluations);
+    stats.setItem("eventTriggers", eventTriggers);
+    stats.setItem("eventsApplied", eventsApplied);
+
+    if (resources)
+    {
+        stats.setItem("sbmlProcessingTime", resources->sbmlProcessingTime);
+        stats.setItem("codeGenerationTime", resources->codeGenerationTime);
+    }
+}
+
+void LLVMExecutableModel::resetStatistics()
+{
+    eventRootEvaluations = 0;
+    eventTriggers = 0;
+    eventsApplied = 0;
+}
+
 double LLVMExecutableModel::getNextPendingEventTime(bool pop)
 {
     return pendingEvents.getNextPendingEventTime();
@@ -1969,6 +2016,7 @@ bool LLVMExecutableModel::applyEvents(unsigned char* prevEventState,
                     throw EventListenerException(result);
                 }
             }
+            ++eventTriggers;
             pendingEvents.push(rrllvm::Event(*this, i));
         }
     }
@@ -2187,4 +2235,194 @@ double LLVMExecutableModel::getRandom()
 /******************************************************************************/
 
 
+/******************************* State Saving Section *************************/
+#if (1) /**********************************************************************/
+/******************************************************************************/
+
+/**
+ * bump this whenever the layout written by saveState changes.
+ */
+static const uint32_t modelStateVersion = 1;
+
+void LLVMExecutableModel::saveState(std::ostream& out)
+{
+    // sizes are used to verify that a state belongs to this model
+    rr::saveBinary(out, modelStateVersion);
+    rr::saveBinary(out, modelData->size);
+    rr::saveBinary(out, modelData->numIndFloatingSpecies);
+    rr::saveBinary(out, modelData->numRateRules);
+    rr::saveBinary(out, modelData->numReactions);
+    rr::saveBinary(out, modelData->numEvents);
+
+    rr::saveBinary(out, modelData->time);
+
+    // all of the values are stored in the trailing data block, the
+    // aliases point into it and are set up by createModelData.
+    out.write((const char*)modelData->data,
+            modelData->size - sizeof(LLVMModelData));
+
+    // species references may be changed by rules or events
+    rr::saveBinary(out, modelData->stoichiometry->nnz);
+    out.write((const char*)modelData->stoichiometry->values,
+            modelData->stoichiometry->nnz * sizeof(double));
+
+    unsigned char hasRandom = modelData->random != 0;
+    rr::saveBinary(out, hasRandom);
+    if (hasRandom)
+    {
+        modelData->random->saveState(out);
+    }
+
+    rr::saveBinary(out, eventAssignTimes);
+
+    rr::saveBinary(out, pendingEvents.size());
+    for (EventQueue::const_iterator i = pendingEvents.begin();
+            i != pendingEvents.end(); ++i)
+    {
+        rr::saveBinary(out, i->id);
+        rr::saveBinary(out, i->delay);
+        rr::saveBinary(out, i->assignTime);
+        rr::saveBinary(out, i->dataSize);
+        out.write((const char*)i->data, i->dataSize * sizeof(double));
+    }
+
+    rr::saveBinary(out, conversionFactor);
+    rr::saveBinary(out, dirty);
+}
+
+void LLVMExecutableModel::loadState(std::istream& in)
+{
+    uint32_t version;
+    unsigned size, numIndFloatingSpecies, numRateRules, numReactions, numEvents;
+
+    rr::loadBinary(in, version);
+    rr::loadBinary(in, size);
+    rr::loadBinary(in, numIndFloatingSpecies);
+    rr::loadBinary(in, numRateRules);
+    rr::loadBinary(in, numReactions);
+    rr::loadBinary(in, numEvents);
+
+    if (version != modelStateVersion)
+    {
+        std::stringstream ss;
+        ss << "unsupported model state version " << version
+                << ", expected " << modelStateVersion;
+        throw std::invalid_argument(ss.str());
+    }
+
+    if (size != modelData->size
+            || numIndFloatingSpecies != modelData->numIndFloatingSpecies
+            || numRateRules != modelData->numRateRules
+            || numReactions != modelData->numReactions
+            || numEvents != modelData->numEvents)
+    {
+        throw std::invalid_argument("the saved model state was created from a "
+                "different model than " + getModelName());
+    }
+
+    rr::loadBinary(in, modelData->time);
+
+    in.read((char*)modelData->data, modelData->size - sizeof(LLVMModelData));
+
+    unsigned nnz;
+    rr::loadBinary(in, nnz);
+
+    if (nnz != modelData->stoichiometry->nnz)
+    {
+        throw std::invalid_argument("the saved model state has a different "
+                "stoichiometry than " + getModelName());
+    }
+
+    in.read((char*)modelData->stoichiometry->values, nnz * sizeof(double));
+
+    unsigned char hasRandom;
+    rr::loadBinary(in, hasRandom);
+    if (hasRandom)
+    {
+        if (modelData->random == 0)
+        {
+            modelData->random = new Random();
+        }
+        modelData->random->loadState(in);
+    }
+
+    rr::loadBinary(in, eventAssignTimes);
+
+    pendingEvents.clear();
+
+    uint numPending;
+    rr::loadBinary(in, numPending);
+    for (uint i = 0; i < numPending; ++i)
+    {
+        uint id, dataSize;
+        double delay, assignTime;
+
+        rr::loadBinary(in, id);
+        rr::loadBinary(in, delay);
+        rr::loadBinary(in, assignTime);
+        rr::loadBinary(in, dataSize);
+
+        vector<double> data(dataSize);
+        if (dataSize)
+        {
+            in.read((char*)&data[0], dataSize * sizeof(double));
+        }
+
+        pendingEvents.push(rrllvm::Event(*this, id, delay, assignTime,
+                dataSize, dataSize ? &data[0] : 0));
+    }
+
+    rr::loadBinary(in, conversionFactor);
+    rr::loadBinary(in, dirty);
+
+    if (!in)
+    {
+        throw std::runtime_error("unexpected end of model state stream");
+    }
+}
+
+ExecutableModel* LLVMExecutableModel::clone()
+{
+    // the ctor needs a non-const ptr, but the resources are never modified
+    // after the generator creates them.
+    cxx11_ns::shared_ptr<ModelResources> rc =
+            cxx11_ns::const_pointer_cast<ModelResources>(resources);
+
+    LLVMExecutableModel *result = new LLVMExecutableModel(rc,
+            createModelData(*symbols, modelData->random));
+
+    LLVMModelData *dst = result->modelData;
+
+    dst->time = modelData->time;
+    memcpy(dst->data, modelData->data, modelData->size - sizeof(LLVMModelData));
+    memcpy(dst->stoichiometry->values, modelData->stoichiometry->values,
+            modelData->stoichiometry->nnz * sizeof(double));
+
+    // the Random copy ctor re-seeds, we want an exact copy of the RNG
+    if (modelData->random)
+    {
+        *dst->random = *modelData->random;
+    }
+
+    result->eventAssignTimes = eventAssignTimes;
+
+    for (EventQueue::const_iterator i = pendingEvents.begin();
+            i != pendingEvents.end(); ++i)
+    {
+        result->pendingEvents.push(rrllvm::Event(*result, i->id, i->delay,
+                i->assignTime, i->dataSize, i->data));
+    }
+
+    result->conversionFactor = conversionFactor;
+    result->dirty = dirty;
+    result->flags = flags;
+
+    return result;
+}
+
+/******************************* End State Saving Section *********************/
+#endif  /**********************************************************************/
+/******************************************************************************/
+
+
 } /* namespace rr */
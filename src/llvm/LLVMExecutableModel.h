@@ -25,6 +25,7 @@
 #include "EventTriggerCodeGen.h"
 #include "EvalVolatileStoichCodeGen.h"
 #include "EvalConversionFactorCodeGen.h"
+#include "EvalInvariantsCodeGen.h"
 #include "SetValuesCodeGen.h"
 #include "SetInitialValuesCodeGen.h"
 #include "EventQueue.h"
@@ -529,6 +530,33 @@ public:
      */
     virtual void setFlags(uint32_t val) { flags = val; }
 
+    /**
+     * Write the model data block, stoichiometry, pending events and
+     * RNG state to a binary stream.
+     */
+    virtual void saveState(std::ostream& out);
+
+    /**
+     * Restore a state written by saveState. The model data layout of the
+     * saved state must be the same as this model.
+     */
+    virtual void loadState(std::istream& in);
+
+    /**
+     * Create a new model which shares the ModelResources (compiled code
+     * and symbols) with this one and has a copy of the model data.
+     */
+    virtual ExecutableModel* clone();
+
+    /**
+     * adds eventRootEvaluations, eventTriggers and eventsApplied, and the
+     * sbmlProcessingTime and codeGenerationTime (seconds) of the compile
+     * that created the shared model resources.
+     */
+    virtual void getStatistics(rr::BasicDictionary& stats) const;
+
+    virtual void resetStatistics();
+
 private:
 
     /**
@@ -589,6 +617,7 @@ private:
     EventAssignCodeGen::FunctionPtr eventAssignPtr;
     EvalVolatileStoichCodeGen::FunctionPtr evalVolatileStoichPtr;
     EvalConversionFactorCodeGen::FunctionPtr evalConversionFactorPtr;
+    EvalInvariantsCodeGen::FunctionPtr evalInvariantsPtr;
 
     // set model values externally.
     SetBoundarySpeciesAmountCodeGen::FunctionPtr setBoundarySpeciesAmountPtr;
@@ -641,6 +670,8 @@ private:
 
     friend class LLVMModelGenerator;
 
+    friend class KernelBenchmark;
+
     template <typename a_type, typename b_type>
     friend void copyCachedModel(a_type* src, b_type* dst);
 
@@ -673,6 +704,14 @@ private:
 
 
     uint32_t flags;
+
+    /**
+     * performance counters, number of getEventRoots calls, of events
+     * transitioning to triggered, and of event assignments applied.
+     */
+    int64_t eventRootEvaluations;
+    int64_t eventTriggers;
+    int64_t eventsApplied;
 };
 
 } /* namespace rr */
@@ -225,6 +225,12 @@ struct LLVMModelData
      *
      * rateRuleValues                    [numRateRules]                   // 39
      * floatingSpeciesAmounts            [numIndFloatingSpecies]          // 40
+     *
+     * invariantValues                   [numInvariants]                  // 41
+     *
+     * The invariantValues block caches the values of assignment rules
+     * which do not depend on time or state, it is only accessed from
+     * generated code, so there is no alias for it.
      */
     double                              data[0];                          // not listed
 };
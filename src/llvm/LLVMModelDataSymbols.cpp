@@ -86,7 +86,8 @@ static const char* modelDataFieldsNames[] =  {
         "InitGlobalParameters",                 // 37
         "ReactionRates",                        // 38
         "NotSafe_RateRuleValues",               // 39
-        "NotSafe_FloatingSpeciesAmounts"        // 40
+        "NotSafe_FloatingSpeciesAmounts",       // 40
+        "InvariantValues"                       // 41
 };
 
 
@@ -116,7 +117,7 @@ LLVMModelDataSymbols::LLVMModelDataSymbols() :
     independentInitCompartmentSize(0)
 {
     assert(sizeof(modelDataFieldsNames) / sizeof(const char*)
-            == NotSafe_FloatingSpeciesAmounts + 1
+            == InvariantValues + 1
             && "wrong number of items in modelDataFieldsNames");
 }
 
@@ -132,7 +133,7 @@ LLVMModelDataSymbols::LLVMModelDataSymbols(const libsbml::Model *model,
     independentInitCompartmentSize(0)
 {
     assert(sizeof(modelDataFieldsNames) / sizeof(const char*)
-            == NotSafe_FloatingSpeciesAmounts + 1
+            == InvariantValues + 1
             && "wrong number of items in modelDataFieldsNames");
 
     modelName = model->getName();
@@ -197,6 +198,11 @@ LLVMModelDataSymbols::LLVMModelDataSymbols(const libsbml::Model *model,
     initReactions(model);
 
     initEvents(model);
+
+    if (options & rr::LoadSBMLOptions::LLVM_INVARIANT_CACHE)
+    {
+        initInvariantAssignmentRules(model);
+    }
 }
 
 LLVMModelDataSymbols::~LLVMModelDataSymbols()
@@ -530,7 +536,7 @@ bool LLVMModelDataSymbols::isIndependentCompartment(const std::string& id) const
 
 const char* LLVMModelDataSymbols::getFieldName(ModelDataFields field)
 {
-    if (field >= Size && field <= ReactionRates)
+    if (field >= Size && field <= InvariantValues)
     {
         return modelDataFieldsNames[field];
     }
@@ -1353,6 +1359,169 @@ uint LLVMModelDataSymbols::getEventBufferSize(uint eventId) const
     return eventAssignmentsSize[eventId];
 }
 
+void LLVMModelDataSymbols::initInvariantAssignmentRules(
+        const libsbml::Model* model)
+{
+    // events can change values while the model is integrated, so anything
+    // that an event assigns to is not invariant.
+    std::set<std::string> eventTargets;
+
+    const ListOfEvents *events = model->getListOfEvents();
+    for (uint i = 0; i < events->size(); ++i)
+    {
+        const ListOfEventAssignments *assignments =
+                events->get(i)->getListOfEventAssignments();
+        for (uint j = 0; j < assignments->size(); ++j)
+        {
+            eventTargets.insert(assignments->get(j)->getVariable());
+        }
+    }
+
+    std::map<std::string, bool> visited;
+
+    const ListOfRules *rules = model->getListOfRules();
+    for (uint i = 0; i < rules->size(); ++i)
+    {
+        const AssignmentRule *rule =
+                dynamic_cast<const AssignmentRule*>(rules->get(i));
+
+        // rules that are just a number or a name are already as cheap
+        // to evaluate as a load from the invariant block.
+        if (rule == 0 || !rule->isSetMath() ||
+                rule->getMath()->getNumChildren() == 0)
+        {
+            continue;
+        }
+
+        const std::string& id = rule->getVariable();
+
+        if (isInvariantSymbol(model, id, eventTargets, visited))
+        {
+            uint idx = invariantAssignmentRules.size();
+            invariantAssignmentRules[id] = idx;
+
+            Log(Logger::LOG_DEBUG) << "assignment rule for " << id
+                    << " is time invariant, stored at invariant index " << idx;
+        }
+    }
+
+    Log(Logger::LOG_INFORMATION) << "found " << invariantAssignmentRules.size()
+            << " time invariant assignment rules";
+}
+
+bool LLVMModelDataSymbols::isInvariantSymbol(const libsbml::Model* model,
+        const std::string& id, const std::set<std::string>& eventTargets,
+        std::map<std::string, bool>& visited) const
+{
+    std::map<std::string, bool>::const_iterator i = visited.find(id);
+    if (i != visited.end())
+    {
+        return i->second;
+    }
+
+    // mark as variant while we are visiting it, a recursive rule is an
+    // error, which is reported when the rule code is generated.
+    visited[id] = false;
+
+    bool result = false;
+
+    if (eventTargets.find(id) != eventTargets.end() || hasRateRule(id))
+    {
+        result = false;
+    }
+    else if (hasAssignmentRule(id))
+    {
+        const AssignmentRule *rule = model->getAssignmentRule(id);
+        result = rule && rule->isSetMath() &&
+                isInvariantASTNode(model, rule->getMath(), eventTargets, visited);
+    }
+    else if (isIndependentGlobalParameter(id))
+    {
+        // conserved moieties are changed as a side effect of setting
+        // floating species, be conservative and leave them out.
+        result = !isConservedMoietyParameter(getGlobalParameterIndex(id));
+    }
+    else if (isIndependentCompartment(id))
+    {
+        result = true;
+    }
+    else if (isIndependentBoundarySpecies(id))
+    {
+        // boundary species are loaded as concentrations, so the
+        // compartment also has to be invariant.
+        const Species *species = model->getSpecies(id);
+        result = species && (species->getHasOnlySubstanceUnits() ||
+                isInvariantSymbol(model, species->getCompartment(),
+                        eventTargets, visited));
+    }
+
+    visited[id] = result;
+    return result;
+}
+
+bool LLVMModelDataSymbols::isInvariantASTNode(const libsbml::Model* model,
+        const libsbml::ASTNode* ast, const std::set<std::string>& eventTargets,
+        std::map<std::string, bool>& visited) const
+{
+    switch (ast->getType())
+    {
+    case AST_NAME_TIME:
+    case AST_FUNCTION_DELAY:
+        return false;
+    case AST_NAME:
+        return isInvariantSymbol(model, ast->getName(), eventTargets, visited);
+    case AST_FUNCTION:
+        // only user defined functions, distrib and other built in
+        // functions may be random.
+        if (model->getFunctionDefinition(ast->getName()) == 0)
+        {
+            return false;
+        }
+        break;
+    default:
+        break;
+    }
+
+    for (uint i = 0; i < ast->getNumChildren(); ++i)
+    {
+        if (!isInvariantASTNode(model, ast->getChild(i), eventTargets, visited))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LLVMModelDataSymbols::isInvariantAssignmentRule(const std::string& id) const
+{
+    return invariantAssignmentRules.find(id) != invariantAssignmentRules.end();
+}
+
+uint LLVMModelDataSymbols::getInvariantAssignmentRuleIndex(
+        const std::string& id) const
+{
+    StringUIntMap::const_iterator i = invariantAssignmentRules.find(id);
+    if (i != invariantAssignmentRules.end())
+    {
+        return i->second;
+    }
+    else
+    {
+        throw LLVMException("could not find invariant assignment rule with id "
+                + id, __FUNC__);
+    }
+}
+
+uint LLVMModelDataSymbols::getInvariantAssignmentRuleSize() const
+{
+    return invariantAssignmentRules.size();
+}
+
+std::vector<std::string> LLVMModelDataSymbols::getInvariantAssignmentRuleIds() const
+{
+    return getIds(invariantAssignmentRules);
+}
+
 bool LLVMModelDataSymbols::isNamedSpeciesReference(const std::string& id) const
 {
     return namedSpeciesReferenceInfo.find(id) != namedSpeciesReferenceInfo.end();
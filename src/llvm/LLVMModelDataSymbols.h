@@ -79,6 +79,7 @@ enum ModelDataFields {
     ReactionRates,                            // 38
     NotSafe_RateRuleValues,                   // 39
     NotSafe_FloatingSpeciesAmounts,           // 40
+    InvariantValues                           // 41
 };
 
 enum EventAtributes
@@ -326,6 +327,35 @@ public:
     const SpeciesReferenceInfo& getNamedSpeciesReferenceInfo(
             const std::string& id) const;
 
+    /**
+     * is this symbol defined by an assignment rule whose value does
+     * not depend on time, the state vector or anything that events or
+     * rate rules may change.
+     *
+     * The values of these rules are evaluated once, whenever the model
+     * is reset or an independent value is set, and stored in the
+     * invariant values block of the model data. Generated code then just
+     * loads the stored value instead of re-evaluating the rule.
+     */
+    bool isInvariantAssignmentRule(const std::string& id) const;
+
+    /**
+     * index of an invariant assignment rule in the invariant values block.
+     * @throw exception if the symbol is not an invariant assignment rule.
+     */
+    uint getInvariantAssignmentRuleIndex(const std::string& id) const;
+
+    /**
+     * number of invariant assignment rules, size of the invariant values
+     * block.
+     */
+    uint getInvariantAssignmentRuleSize() const;
+
+    /**
+     * the ids of the invariant assignment rules ordered by their index.
+     */
+    std::vector<std::string> getInvariantAssignmentRuleIds() const;
+
 
 /******* Conserved Moiety Section ********************************************/
 #if (1) /*********************************************************************/
@@ -640,6 +670,12 @@ private:
      */
     StringUIntMap rateRules;
 
+    /**
+     * assignment rules which only depend on invariant values,
+     * index in the invariant values block by variable name.
+     */
+    StringUIntMap invariantAssignmentRules;
+
     /**
      * are global params defined by rate rules,
      * set in initGlobalParam
@@ -693,6 +729,34 @@ private:
 
     void initEvents(const libsbml::Model *model);
 
+    /**
+     * find all the assignment rules which do not depend on time, the
+     * state vector, or any value that can change while the model
+     * is integrated. Must be called after all of the other symbols are
+     * initialized.
+     */
+    void initInvariantAssignmentRules(const libsbml::Model *model);
+
+    /**
+     * does the given sbml symbol only depend on values which can
+     * only be changed by the user.
+     *
+     * @param eventTargets symbols that are assigned by events.
+     * @param visited memoized result of previously checked symbols.
+     */
+    bool isInvariantSymbol(const libsbml::Model *model, const std::string& id,
+            const std::set<std::string>& eventTargets,
+            std::map<std::string, bool>& visited) const;
+
+    /**
+     * go through the AST tree and see if every name references an
+     * invariant symbol.
+     */
+    bool isInvariantASTNode(const libsbml::Model *model,
+            const libsbml::ASTNode *ast,
+            const std::set<std::string>& eventTargets,
+            std::map<std::string, bool>& visited) const;
+
     /**
      * determine is this species can be used as a species reference,
      * in the sense that it will add a column to the stochiometry
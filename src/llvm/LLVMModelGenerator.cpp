@@ -16,7 +16,9 @@
 #include "Random.h"
 #include <rrLogger.h>
 #include <rrUtils.h>
+#include <Tracer.h>
 #include <Poco/Mutex.h>
+#include <memory>
 
 using rr::Logger;
 using rr::getLogger;
@@ -34,6 +36,16 @@ typedef cxx11_ns::unordered_map<std::string, WeakModelPtr> ModelPtrMap;
 static Poco::Mutex cachedModelsMutex;
 static ModelPtrMap cachedModels;
 
+/**
+ * generate one function, each code generator is a separate span in the
+ * solver trace.
+ */
+template <typename CodeGen>
+static typename CodeGen::FunctionPtr createFunction(ModelGeneratorContext& context)
+{
+    RR_TRACE_SCOPE(CodeGen::FunctionName, "codegen");
+    return CodeGen(context).createFunction();
+}
 
 /**
  * copy the cached model fields between a cached model, and a
@@ -67,12 +79,15 @@ void copyCachedModel(a_type* src, b_type* dst)
     dst->eventAssignPtr = src->eventAssignPtr;
     dst->evalVolatileStoichPtr = src->evalVolatileStoichPtr;
     dst->evalConversionFactorPtr = src->evalConversionFactorPtr;
+    dst->evalInvariantsPtr = src->evalInvariantsPtr;
 }
 
 
 ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
         uint options)
 {
+    RR_TRACE_SCOPE("LLVMModelGenerator::createModel", "load");
+
     bool forceReCompile = options & LoadSBMLOptions::RECOMPILE;
 
     string md5;
@@ -85,6 +100,18 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
         if (options & LoadSBMLOptions::CONSERVED_MOIETIES)
         {
             md5 += "_conserved";
+
+            // the sparse analysis may pick other dependent species
+            if (options & LoadSBMLOptions::SPARSE_CONSERVED_MOIETIES)
+            {
+                md5 += "_sparse";
+            }
+        }
+
+        // the invariant rules are evaluated by different generated code
+        if (options & LoadSBMLOptions::LLVM_INVARIANT_CACHE)
+        {
+            md5 += "_invariant";
         }
 
         ModelPtrMap::const_iterator i;
@@ -117,55 +144,67 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
 
     SharedModelPtr rc(new ModelResources());
 
-    ModelGeneratorContext context(sbml, options);
+    int64_t startTime = rr::getMicroSeconds();
+
+    std::auto_ptr<ModelGeneratorContext> contextPtr;
+    {
+        RR_TRACE_SCOPE("ModelGeneratorContext", "load");
+        contextPtr.reset(new ModelGeneratorContext(sbml, options));
+    }
+    ModelGeneratorContext& context = *contextPtr;
+
+    int64_t contextTime = rr::getMicroSeconds();
 
     rc->evalInitialConditionsPtr =
-            EvalInitialConditionsCodeGen(context).createFunction();
+            createFunction<EvalInitialConditionsCodeGen>(context);
 
     rc->evalReactionRatesPtr =
-            EvalReactionRatesCodeGen(context).createFunction();
+            createFunction<EvalReactionRatesCodeGen>(context);
 
     rc->getBoundarySpeciesAmountPtr =
-            GetBoundarySpeciesAmountCodeGen(context).createFunction();
+            createFunction<GetBoundarySpeciesAmountCodeGen>(context);
 
     rc->getFloatingSpeciesAmountPtr =
-            GetFloatingSpeciesAmountCodeGen(context).createFunction();
+            createFunction<GetFloatingSpeciesAmountCodeGen>(context);
 
     rc->getBoundarySpeciesConcentrationPtr =
-            GetBoundarySpeciesConcentrationCodeGen(context).createFunction();
+            createFunction<GetBoundarySpeciesConcentrationCodeGen>(context);
 
     rc->getFloatingSpeciesConcentrationPtr =
-            GetFloatingSpeciesConcentrationCodeGen(context).createFunction();
+            createFunction<GetFloatingSpeciesConcentrationCodeGen>(context);
 
     rc->getCompartmentVolumePtr =
-            GetCompartmentVolumeCodeGen(context).createFunction();
+            createFunction<GetCompartmentVolumeCodeGen>(context);
 
     rc->getGlobalParameterPtr =
-            GetGlobalParameterCodeGen(context).createFunction();
+            createFunction<GetGlobalParameterCodeGen>(context);
 
     rc->evalRateRuleRatesPtr =
-            EvalRateRuleRatesCodeGen(context).createFunction();
+            createFunction<EvalRateRuleRatesCodeGen>(context);
 
     rc->getEventTriggerPtr =
-            GetEventTriggerCodeGen(context).createFunction();
+            createFunction<GetEventTriggerCodeGen>(context);
 
     rc->getEventPriorityPtr =
-            GetEventPriorityCodeGen(context).createFunction();
+            createFunction<GetEventPriorityCodeGen>(context);
 
     rc->getEventDelayPtr =
-            GetEventDelayCodeGen(context).createFunction();
+            createFunction<GetEventDelayCodeGen>(context);
 
     rc->eventTriggerPtr =
-            EventTriggerCodeGen(context).createFunction();
+            createFunction<EventTriggerCodeGen>(context);
 
     rc->eventAssignPtr =
-            EventAssignCodeGen(context).createFunction();
+            createFunction<EventAssignCodeGen>(context);
 
     rc->evalVolatileStoichPtr =
-            EvalVolatileStoichCodeGen(context).createFunction();
+            createFunction<EvalVolatileStoichCodeGen>(context);
 
     rc->evalConversionFactorPtr =
-            EvalConversionFactorCodeGen(context).createFunction();
+            createFunction<EvalConversionFactorCodeGen>(context);
+
+    rc->evalInvariantsPtr =
+            createFunction<EvalInvariantsCodeGen>(context);
 
     if (options & LoadSBMLOptions::READ_ONLY)
     {
@@ -178,46 +217,44 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
     }
     else
     {
-        rc->setBoundarySpeciesAmountPtr = SetBoundarySpeciesAmountCodeGen(
-                context).createFunction();
+        rc->setBoundarySpeciesAmountPtr = createFunction<SetBoundarySpeciesAmountCodeGen>(context);
 
         rc->setBoundarySpeciesConcentrationPtr =
-                SetBoundarySpeciesConcentrationCodeGen(context).createFunction();
+                createFunction<SetBoundarySpeciesConcentrationCodeGen>(context);
 
         rc->setFloatingSpeciesConcentrationPtr =
-                SetFloatingSpeciesConcentrationCodeGen(context).createFunction();
+                createFunction<SetFloatingSpeciesConcentrationCodeGen>(context);
 
         rc->setCompartmentVolumePtr =
-                SetCompartmentVolumeCodeGen(context).createFunction();
+                createFunction<SetCompartmentVolumeCodeGen>(context);
 
-        rc->setFloatingSpeciesAmountPtr = SetFloatingSpeciesAmountCodeGen(
-                context).createFunction();
+        rc->setFloatingSpeciesAmountPtr = createFunction<SetFloatingSpeciesAmountCodeGen>(context);
 
         rc->setGlobalParameterPtr =
-                SetGlobalParameterCodeGen(context).createFunction();
+                createFunction<SetGlobalParameterCodeGen>(context);
     }
 
     if (options & LoadSBMLOptions::MUTABLE_INITIAL_CONDITIONS)
     {
         rc->getFloatingSpeciesInitConcentrationsPtr =
-                GetFloatingSpeciesInitConcentrationCodeGen(context).createFunction();
+                createFunction<GetFloatingSpeciesInitConcentrationCodeGen>(context);
         rc->setFloatingSpeciesInitConcentrationsPtr =
-                SetFloatingSpeciesInitConcentrationCodeGen(context).createFunction();
+                createFunction<SetFloatingSpeciesInitConcentrationCodeGen>(context);
 
         rc->getFloatingSpeciesInitAmountsPtr =
-                GetFloatingSpeciesInitAmountCodeGen(context).createFunction();
+                createFunction<GetFloatingSpeciesInitAmountCodeGen>(context);
         rc->setFloatingSpeciesInitAmountsPtr =
-                SetFloatingSpeciesInitAmountCodeGen(context).createFunction();
+                createFunction<SetFloatingSpeciesInitAmountCodeGen>(context);
 
         rc->getCompartmentInitVolumesPtr =
-                GetCompartmentInitVolumeCodeGen(context).createFunction();
+                createFunction<GetCompartmentInitVolumeCodeGen>(context);
         rc->setCompartmentInitVolumesPtr =
-                SetCompartmentInitVolumeCodeGen(context).createFunction();
+                createFunction<SetCompartmentInitVolumeCodeGen>(context);
 
         rc->getGlobalParameterInitValuePtr =
-                GetGlobalParameterInitValueCodeGen(context).createFunction();
+                createFunction<GetGlobalParameterInitValueCodeGen>(context);
         rc->setGlobalParameterInitValuePtr =
-                SetGlobalParameterInitValueCodeGen(context).createFunction();
+                createFunction<SetGlobalParameterInitValueCodeGen>(context);
     }
     else
     {
@@ -235,6 +272,14 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
     }
 
 
+    int64_t codeGenTime = rr::getMicroSeconds();
+
+    rc->sbmlProcessingTime = (contextTime - startTime) / 1.e6;
+    rc->codeGenerationTime = (codeGenTime - contextTime) / 1.e6;
+
+    Log(Logger::LOG_DEBUG) << "sbml processing time: " << rc->sbmlProcessingTime
+            << "s, code generation time: " << rc->codeGenerationTime << "s";
+
     // if anything up to this point throws an exception, thats OK, because
     // we have not allocated any memory yet that is not taken care of by
     // something else.
@@ -343,6 +388,9 @@ LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
     uint numRateRules = symbols.getRateRuleSize();
     uint numReactions = symbols.getReactionSize();
 
+    // cached values of time invariant assignment rules
+    uint numInvariants = symbols.getInvariantAssignmentRuleSize();
+
     uint modelDataSize = modelDataBaseSize +
         sizeof(double) * (
             numIndCompartments +
@@ -354,7 +402,8 @@ LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
             numInitGlobalParameters +
             numReactions +
             numRateRules +
-            numIndFloatingSpecies
+            numIndFloatingSpecies +
+            numInvariants
             );
 
     LLVMModelData *modelData = (LLVMModelData*)calloc(
@@ -408,6 +457,9 @@ LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
     modelData->floatingSpeciesAmountsAlias = &modelData->data[offset];
     offset += numIndFloatingSpecies;
 
+    // no alias for invariant values, only used by generated code.
+    offset += numInvariants;
+
     assert (modelDataBaseSize + offset * sizeof(double) == modelDataSize  &&
             "LLVMModelData size not equal to base size + data");
 
@@ -76,9 +76,10 @@ static bool isArray(ModelDataFields f)
      GlobalParametersInit,                     // 36
      RateRuleValues,                           // 37
      ReactionRates,                            // 38
+     InvariantValues,                          // 41
      */
 
-    return f >= CompartmentVolumes && f <= NotSafe_FloatingSpeciesAmounts;
+    return f >= CompartmentVolumes && f <= InvariantValues;
 }
 
 
@@ -507,6 +508,21 @@ llvm::Value* ModelDataIRBuilder::createReactionRateStore(const std::string& id,
     return createStore(ReactionRates, idx, value, id);
 }
 
+llvm::Value* ModelDataIRBuilder::createInvariantValueLoad(const std::string& id,
+        const llvm::Twine& name)
+{
+    int idx = symbols.getInvariantAssignmentRuleIndex(id);
+    return createLoad(InvariantValues, idx,
+            name.isTriviallyEmpty() ? id + "_invariant" : name);
+}
+
+llvm::Value* ModelDataIRBuilder::createInvariantValueStore(const std::string& id,
+        llvm::Value* value)
+{
+    int idx = symbols.getInvariantAssignmentRuleIndex(id);
+    return createStore(InvariantValues, idx, value, id + "_invariant");
+}
+
 llvm::Value* ModelDataIRBuilder::createStoichiometryStore(uint row, uint col,
         llvm::Value* value, const llvm::Twine& name)
 {
@@ -585,6 +601,9 @@ llvm::StructType *ModelDataIRBuilder::createModelDataStructType(llvm::Module *mo
         uint numRateRules = symbols.getRateRuleSize();
         uint numReactions = symbols.getReactionSize();
 
+        // evaluated whenever a value is set
+        uint numInvariants = symbols.getInvariantAssignmentRuleSize();
+
         LLVMContext &context = module->getContext();
 
         Type *csrSparseType = getCSRSparseStructType(module, engine);
@@ -648,6 +667,7 @@ llvm::StructType *ModelDataIRBuilder::createModelDataStructType(llvm::Module *mo
         elements.push_back(ArrayType::get(doubleType, numReactions));           // 38 reactionRates
         elements.push_back(ArrayType::get(doubleType, numRateRules));           // 39 rateRuleValues
         elements.push_back(ArrayType::get(doubleType, numIndFloatingSpecies));  // 40 floatingSpeciesAmounts
+        elements.push_back(ArrayType::get(doubleType, numInvariants));          // 41 invariantValues
 
         // creates a named struct,
         // the act of creating a named struct should
@@ -200,6 +200,18 @@ public:
     llvm::Value *createReactionRateStore(const std::string &id,
             llvm::Value *value);
 
+    /**
+     * load the cached value of an invariant assignment rule
+     */
+    llvm::Value *createInvariantValueLoad(const std::string& id,
+            const llvm::Twine& name = "");
+
+    /**
+     * store the value of an invariant assignment rule in the cache
+     */
+    llvm::Value *createInvariantValueStore(const std::string &id,
+            llvm::Value *value);
+
     /**
      * rate rule GEP
      */
@@ -23,9 +23,10 @@ namespace rrllvm
 {
 
 ModelDataLoadSymbolResolver::ModelDataLoadSymbolResolver(llvm::Value *modelData,
-        const ModelGeneratorContext& ctx) :
+        const ModelGeneratorContext& ctx, bool loadInvariants) :
             LoadSymbolResolverBase(ctx),
-            modelData(modelData)
+            modelData(modelData),
+            loadInvariants(loadInvariants)
 {
 }
 
@@ -87,6 +88,13 @@ llvm::Value* ModelDataLoadSymbolResolver::loadSymbolValue(
                 symbol);
         if (i != modelSymbols.getAssigmentRules().end())
         {
+            // value is computed by evalInvariants, just read it.
+            if (loadInvariants && modelDataSymbols.isInvariantAssignmentRule(symbol))
+            {
+                return cacheValue(symbol, args,
+                        mdbuilder.createInvariantValueLoad(symbol));
+            }
+
             recursiveSymbolPush(symbol);
             Value* result = ASTNodeCodeGen(builder, *this).codeGen(i->second);
             recursiveSymbolPop();
@@ -25,8 +25,14 @@ namespace rrllvm
 class ModelDataLoadSymbolResolver: public LoadSymbolResolverBase
 {
 public:
+    /**
+     * @param loadInvariants if true, assignment rules which have been
+     * determined to be time invariant are loaded from the invariant values
+     * block instead of being evaluated. This must be false for any function
+     * that is called before the invariant values are evaluated.
+     */
     ModelDataLoadSymbolResolver(llvm::Value *modelData,
-            const ModelGeneratorContext& ctx);
+            const ModelGeneratorContext& ctx, bool loadInvariants = true);
 
     virtual ~ModelDataLoadSymbolResolver() {};
 
@@ -37,6 +43,7 @@ public:
 
 private:
     llvm::Value *modelData;
+    bool loadInvariants;
 };
 
 class ModelDataStoreSymbolResolver: public StoreSymbolResolver
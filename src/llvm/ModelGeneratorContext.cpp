@@ -16,6 +16,7 @@
 #include "conservation/ConservationExtension.h"
 #include <SBMLSolverOptions.h>
 #include "rrConfig.h"
+#include "rrUtils.h"
 
 #include <sbml/SBMLReader.h>
 #include <string>
@@ -119,6 +120,21 @@ ModelGeneratorContext::ModelGeneratorContext(std::string const &sbml,
             {
                 moietyConverter = new rr::conservation::ConservedMoietyConverter();
 
+                ConversionProperties props = moietyConverter->getDefaultProperties();
+
+                if (options & LoadSBMLOptions::SPARSE_CONSERVED_MOIETIES)
+                {
+                    props.setBoolValue("sparse", true);
+                }
+                else
+                {
+                    // reuse the analysis of earlier loads of this sbml,
+                    // the cache keys it by the converted document.
+                    props.setValue("structuralCacheKey", rr::getMD5(sbml));
+                }
+
+                moietyConverter->setProperties(&props);
+
                 if (moietyConverter->setDocument(ownedDoc) != LIBSBML_OPERATION_SUCCESS)
                 {
                     throw_llvm_exception("error setting conserved moiety converter document");
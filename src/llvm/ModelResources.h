@@ -26,6 +26,13 @@ public:
     const class Random *random;
     const std::string *errStr;
 
+    /**
+     * wall clock seconds spent reading the sbml and building the symbols,
+     * and generating, optimizing and compiling the model functions.
+     */
+    double sbmlProcessingTime;
+    double codeGenerationTime;
+
     EvalInitialConditionsCodeGen::FunctionPtr evalInitialConditionsPtr;
     EvalReactionRatesCodeGen::FunctionPtr evalReactionRatesPtr;
     GetBoundarySpeciesAmountCodeGen::FunctionPtr getBoundarySpeciesAmountPtr;
@@ -42,6 +49,7 @@ public:
     EventAssignCodeGen::FunctionPtr eventAssignPtr;
     EvalVolatileStoichCodeGen::FunctionPtr evalVolatileStoichPtr;
     EvalConversionFactorCodeGen::FunctionPtr evalConversionFactorPtr;
+    EvalInvariantsCodeGen::FunctionPtr evalInvariantsPtr;
     SetBoundarySpeciesAmountCodeGen::FunctionPtr setBoundarySpeciesAmountPtr;
     SetFloatingSpeciesAmountCodeGen::FunctionPtr setFloatingSpeciesAmountPtr;
     SetBoundarySpeciesConcentrationCodeGen::FunctionPtr setBoundarySpeciesConcentrationPtr;
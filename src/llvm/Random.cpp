@@ -11,7 +11,9 @@
 #include "rrLogger.h"
 #include "rrConfig.h"
 #include "rrUtils.h"
+#include "StateSaving.h"
 #include <stdint.h>
+#include <sstream>
 
 
 #if INTPTR_MAX == INT32_MAX
@@ -81,6 +83,7 @@ Random::Random()
 Random& Random::operator =(const Random& rhs)
 {
     engine = rhs.engine;
+    randomSeed = rhs.randomSeed;
     return *this;
 }
 
@@ -176,5 +179,26 @@ int64_t Random::getRandomSeed()
     return randomSeed;
 }
 
+void Random::saveState(std::ostream& out) const
+{
+    // the standard only defines a textual representation of the engine.
+    std::stringstream ss;
+    ss << engine;
+
+    rr::saveBinary(out, randomSeed);
+    rr::saveBinary(out, ss.str());
+}
+
+void Random::loadState(std::istream& in)
+{
+    std::string str;
+
+    rr::loadBinary(in, randomSeed);
+    rr::loadBinary(in, str);
+
+    std::stringstream ss(str);
+    ss >> engine;
+}
+
 } /* namespace rrllvm */
 
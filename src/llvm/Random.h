@@ -10,6 +10,7 @@
 
 #include "tr1proxy/rr_random.h" // rr proxy to <random>
 #include <stdint.h>
+#include <iostream>
 
 namespace rrllvm
 {
@@ -85,6 +86,17 @@ public:
      */
     int64_t getRandomSeed();
 
+    /**
+     * write the seed and the complete state of the RNG engine to a
+     * binary stream.
+     */
+    void saveState(std::ostream& out) const;
+
+    /**
+     * restore the seed and the RNG engine state that was written by saveState.
+     */
+    void loadState(std::istream& in);
+
     /**
      * RNG engine.
      */
@@ -22,6 +22,9 @@
 
 #include "TestVariant.h"
 
+#include "rrExecutableModel.h"
+#include "conservation/SparseStructural.h"
+
 #include <sbml/SBMLDocument.h>
 #include <sbml/Model.h>
 #include <sbml/SBMLReader.h>
@@ -29,6 +32,8 @@
 #include <stdio.h>
 #include <cmath>
 #include <stdint.h>
+#include <fstream>
+#include <memory>
 
 
 
@@ -476,6 +481,514 @@ int matnames_test(int argc, char* argv[]) {
 }
 
 
+/**
+ * the SBML section of an rrtest file, the lines after [SBML] up to the
+ * next section header.
+ */
+static std::string rrtestSBML(const std::string& fname)
+{
+    std::ifstream in(fname.c_str());
+    if (!in)
+    {
+        throw std::runtime_error("could not open " + fname);
+    }
+
+    std::string line;
+    std::string sbml;
+    bool inSBML = false;
+
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+
+        if (!line.empty() && line[0] == '[')
+        {
+            if (inSBML)
+            {
+                break;
+            }
+            inSBML = line == "[SBML]";
+            continue;
+        }
+
+        if (inSBML)
+        {
+            sbml += line + "\n";
+        }
+    }
+
+    if (sbml.empty())
+    {
+        throw std::runtime_error(fname + " has no SBML section");
+    }
+    return sbml;
+}
+
+static bool isClose(double a, double b, double tol)
+{
+    return fabs(a - b) <= tol * std::max(1.0, std::max(fabs(a), fabs(b)));
+}
+
+/**
+ * the floating species amounts of a model, in the order of the given ids.
+ */
+static vector<double> speciesAmounts(ExecutableModel* m, const vector<string>& ids)
+{
+    vector<double> amounts(ids.size());
+    for (unsigned i = 0; i < ids.size(); ++i)
+    {
+        int index = m->getFloatingSpeciesIndex(ids[i]);
+        if (index < 0)
+        {
+            throw std::runtime_error("model has no floating species " + ids[i]);
+        }
+        m->getFloatingSpeciesAmounts(1, &index, &amounts[i]);
+    }
+    return amounts;
+}
+
+/**
+ * compare the conserved moiety reduced models of the dense LibStructural
+ * path and the sparse elimination path. Both must have the same number of
+ * independent and dependent species, give the same species amounts
+ * before and after a simulation, and the conserved totals of the sparse
+ * model must match the totals computed from the dense model's amounts with
+ * the sparse link matrix, T = S_dep - L0 S_ind.
+ */
+static bool sparse_cm_compare(const std::string& fname)
+{
+    const double initialTol = 1.e-9;
+    const double simulateTol = 1.e-4;
+
+    std::string sbml = rrtestSBML(fname);
+
+    LoadSBMLOptions denseOpt;
+    denseOpt.modelGeneratorOpt |= LoadSBMLOptions::CONSERVED_MOIETIES;
+
+    LoadSBMLOptions sparseOpt;
+    sparseOpt.modelGeneratorOpt |= LoadSBMLOptions::CONSERVED_MOIETIES
+            | LoadSBMLOptions::SPARSE_CONSERVED_MOIETIES;
+
+    SBMLSolver dense(sbml, &denseOpt);
+    SBMLSolver sparse(sbml, &sparseOpt);
+
+    ExecutableModel* dm = dense.getModel();
+    ExecutableModel* sm = sparse.getModel();
+
+    bool result = true;
+
+    if (dm->getNumIndFloatingSpecies() != sm->getNumIndFloatingSpecies()
+            || dm->getNumDepFloatingSpecies() != sm->getNumDepFloatingSpecies()
+            || dm->getNumConservedMoieties() != sm->getNumConservedMoieties())
+    {
+        cout << fname << ": dense model has " << dm->getNumIndFloatingSpecies()
+                << " independent, " << dm->getNumDepFloatingSpecies()
+                << " dependent species and " << dm->getNumConservedMoieties()
+                << " conserved moieties, sparse model has "
+                << sm->getNumIndFloatingSpecies() << ", "
+                << sm->getNumDepFloatingSpecies() << " and "
+                << sm->getNumConservedMoieties() << endl;
+        return false;
+    }
+
+    // the sparse partition and link matrix of the same document
+    std::auto_ptr<libsbml::SBMLDocument> doc(libsbml::readSBMLFromString(sbml.c_str()));
+    conservation::SparseStructural structural(doc->getModel());
+
+    const vector<string>& ind = structural.getIndependentSpecies();
+    const vector<string>& dep = structural.getDependentSpecies();
+    ls::DoubleMatrix L0 = structural.getL0Matrix();
+
+    vector<string> ids;
+    for (int i = 0; i < dm->getNumFloatingSpecies(); ++i)
+    {
+        ids.push_back(dm->getFloatingSpeciesId(i));
+    }
+
+    // the sparse totals by the index in their cm_<index>_ id, the order of
+    // the dependent species.
+    vector<double> totals(dep.size(), 0);
+    for (int i = 0; i < sm->getNumConservedMoieties(); ++i)
+    {
+        int index = atoi(sm->getConservedMoietyId(i).c_str() + 3);
+        if (index < 0 || index >= (int)totals.size())
+        {
+            cout << fname << ": unexpected conserved moiety id "
+                    << sm->getConservedMoietyId(i) << endl;
+            return false;
+        }
+        sm->getConservedMoietyValues(1, &i, &totals[index]);
+    }
+
+    SimulateOptions opt;
+    opt.start = 0;
+    opt.duration = 10;
+    opt.steps = 10;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const char* when = pass == 0 ? "initial" : "simulated";
+        const double tol = pass == 0 ? initialTol : simulateTol;
+
+        if (pass == 1)
+        {
+            dense.simulate(&opt);
+            sparse.simulate(&opt);
+        }
+
+        vector<double> d = speciesAmounts(dm, ids);
+        vector<double> s = speciesAmounts(sm, ids);
+
+        for (unsigned i = 0; i < ids.size(); ++i)
+        {
+            if (!isClose(d[i], s[i], tol))
+            {
+                cout << fname << ": " << when << " amount of " << ids[i]
+                        << " is " << d[i] << " in the dense model and "
+                        << s[i] << " in the sparse model" << endl;
+                result = false;
+            }
+        }
+
+        vector<double> si = speciesAmounts(dm, ind);
+        vector<double> sd = speciesAmounts(dm, dep);
+
+        for (unsigned i = 0; i < dep.size(); ++i)
+        {
+            double total = sd[i];
+            for (unsigned j = 0; j < ind.size(); ++j)
+            {
+                total -= L0(i, j) * si[j];
+            }
+
+            if (!isClose(total, totals[i], tol))
+            {
+                cout << fname << ": " << when << " conserved total of "
+                        << dep[i] << " is " << total
+                        << " from the dense model and " << totals[i]
+                        << " in the sparse model" << endl;
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+int sparse_cm_test(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cout << "usage: llvm_testing sparse_cm file.rrtest [file.rrtest ...]" << endl;
+        return -1;
+    }
+
+    int failed = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        try
+        {
+            bool passed = sparse_cm_compare(argv[i]);
+            cout << argv[i] << (passed ? ": passed" : ": FAILED") << endl;
+            failed += !passed;
+        }
+        catch (std::exception& e)
+        {
+            cout << argv[i] << ": FAILED, " << e.what() << endl;
+            ++failed;
+        }
+    }
+
+    cout << argc - 2 - failed << " of " << argc - 2 << " models passed" << endl;
+
+    return failed;
+}
+
+/**
+ * the Robertson chemical kinetics problem, the usual stiff test problem,
+ * y1 + y2 + y3 = 1 is conserved.
+ */
+static const char* robertsonSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"robertson\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y1\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"y2\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"y3\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"r1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 0.04 </cn><ci> y1 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"r2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <listOfModifiers><modifierSpeciesReference species=\"y3\"/></listOfModifiers>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 10000 </cn><ci> y2 </ci><ci> y3 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"r3\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y3\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 30000000 </cn><apply><power/><ci> y2 </ci><cn> 2 </cn></apply></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * simulate the Robertson problem with the cvode integrator starting with
+ * the Adams method, returns the number of method switches, or -1 if the
+ * simulation failed or did not conserve the total.
+ */
+static int robertsonMethodSwitches(bool stiffnessDetection)
+{
+    SBMLSolver r(robertsonSBML);
+
+    Integrator *itg = r.getIntegrator(Integrator::CVODE);
+    itg->setItem("StiffnessDetection", stiffnessDetection);
+
+    SimulateOptions o;
+    o.start = 0;
+    o.duration = 4.e5;
+    o.steps = 20;
+    o.integrator = Integrator::CVODE;
+    o.integratorFlags &= ~Integrator::STIFF;
+    o.relative = 1.e-6;
+    o.absolute = 1.e-10;
+
+    try
+    {
+        r.simulate(&o);
+    }
+    catch (std::exception& e)
+    {
+        cout << "simulation with StiffnessDetection " << stiffnessDetection
+                << " failed: " << e.what() << endl;
+        return -1;
+    }
+
+    double total = r.getValue("y1") + r.getValue("y2") + r.getValue("y3");
+    if (fabs(total - 1) > 1.e-4)
+    {
+        cout << "y1 + y2 + y3 is " << total << " instead of 1" << endl;
+        return -1;
+    }
+
+    // the statistics and the read only key must agree
+    BasicDictionary stats;
+    itg->getStatistics(stats);
+
+    if (!stats.hasKey("NumMethodSwitches"))
+    {
+        cout << "the statistics have no NumMethodSwitches" << endl;
+        return -1;
+    }
+
+    int switches = stats.getItem("NumMethodSwitches").convert<int>();
+
+    if (itg->getItem("NumMethodSwitches").convert<int>() != switches)
+    {
+        cout << "NumMethodSwitches differs between the statistics and the "
+                "integrator key" << endl;
+        return -1;
+    }
+
+    return switches;
+}
+
+/**
+ * the stiff Robertson problem, started with the Adams method, must switch
+ * to BDF and report the switch in NumMethodSwitches if stiffness detection
+ * is on, and never switch if it is off.
+ */
+int stiffness_test(int argc, char* argv[])
+{
+    int failed = 0;
+
+    int switches = robertsonMethodSwitches(true);
+    cout << "StiffnessDetection on, NumMethodSwitches: " << switches << endl;
+    if (switches < 1)
+    {
+        cout << "FAILED, expected at least one switch to BDF" << endl;
+        ++failed;
+    }
+
+    // adams alone may fail on the stiff problem, only a reported switch is
+    // an error
+    switches = robertsonMethodSwitches(false);
+    cout << "StiffnessDetection off, NumMethodSwitches: " << switches << endl;
+    if (switches > 0)
+    {
+        cout << "FAILED, expected no switches" << endl;
+        ++failed;
+    }
+
+    cout << (failed ? "FAILED" : "passed") << endl;
+
+    return failed;
+}
+
+/**
+ * y decays and is reset to 1 by an event whenever it drops below 0.5,
+ * z grows linearly, and a delayed event triggered at t = 3.3 resets z
+ * and doubles the decay rate at t = 4.5.
+ */
+static const char* eventsSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"events\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"z\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"k\" value=\"1\" constant=\"false\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"decay\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k </ci><ci> y </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"growth\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfProducts><speciesReference species=\"z\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <cn> 1 </cn>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "    <listOfEvents>\n"
+    "      <event id=\"reset\" useValuesFromTriggerTime=\"true\">\n"
+    "        <trigger initialValue=\"false\" persistent=\"true\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><lt/><ci> y </ci><cn> 0.5 </cn></apply>\n"
+    "        </math></trigger>\n"
+    "        <listOfEventAssignments>\n"
+    "          <eventAssignment variable=\"y\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math></eventAssignment>\n"
+    "        </listOfEventAssignments>\n"
+    "      </event>\n"
+    "      <event id=\"delayed\" useValuesFromTriggerTime=\"true\">\n"
+    "        <trigger initialValue=\"false\" persistent=\"true\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><geq/><csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\"> t </csymbol><cn> 3.3 </cn></apply>\n"
+    "        </math></trigger>\n"
+    "        <delay><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1.2 </cn></math></delay>\n"
+    "        <listOfEventAssignments>\n"
+    "          <eventAssignment variable=\"z\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 0 </cn></math></eventAssignment>\n"
+    "          <eventAssignment variable=\"k\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 2 </cn></math></eventAssignment>\n"
+    "        </listOfEventAssignments>\n"
+    "      </event>\n"
+    "    </listOfEvents>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+static ls::DoubleMatrix simulateEvents(bool denseOutputSampling, int steps)
+{
+    SBMLSolver r(eventsSBML);
+
+    Integrator *itg = r.getIntegrator(Integrator::CVODE);
+    itg->setItem("DenseOutputSampling", denseOutputSampling);
+
+    SimulateOptions o;
+    o.start = 0;
+    o.duration = 10;
+    o.steps = steps;
+    o.integrator = Integrator::CVODE;
+    o.relative = 1.e-9;
+    o.absolute = 1.e-12;
+
+    return *r.simulate(&o);
+}
+
+/**
+ * the fixed step output of the cvode integrator with DenseOutputSampling
+ * must match the per point loop, with the same times, the same events,
+ * and the values within the integration tolerance. The output grids are
+ * fine enough to have several points per step and coarse enough to have
+ * several steps per point.
+ */
+int dense_output_test(int argc, char* argv[])
+{
+    const int grids[] = {7, 100, 1000, 10000};
+    const double tol = 1.e-6;
+
+    int failed = 0;
+
+    for (unsigned g = 0; g < sizeof(grids) / sizeof(int); ++g)
+    {
+        try
+        {
+            ls::DoubleMatrix loop = simulateEvents(false, grids[g]);
+            ls::DoubleMatrix dense = simulateEvents(true, grids[g]);
+
+            if (loop.numRows() != dense.numRows()
+                    || loop.numCols() != dense.numCols())
+            {
+                cout << grids[g] << " steps: the per point loop gives "
+                        << loop.numRows() << "x" << loop.numCols()
+                        << " values, the dense output " << dense.numRows()
+                        << "x" << dense.numCols() << endl;
+                ++failed;
+                continue;
+            }
+
+            int mismatches = 0;
+            for (unsigned i = 0; i < loop.numRows(); ++i)
+            {
+                // the times must be exact, col 0
+                if (loop(i, 0) != dense(i, 0))
+                {
+                    cout << grids[g] << " steps: time " << i << " is "
+                            << loop(i, 0) << " and " << dense(i, 0) << endl;
+                    ++mismatches;
+                }
+
+                for (unsigned j = 1; j < loop.numCols(); ++j)
+                {
+                    if (!isClose(loop(i, j), dense(i, j), tol))
+                    {
+                        cout << grids[g] << " steps: at time " << loop(i, 0)
+                                << " column " << j << " is " << loop(i, j)
+                                << " in the per point loop and "
+                                << dense(i, j) << " in the dense output"
+                                << endl;
+                        ++mismatches;
+                    }
+                }
+            }
+
+            cout << grids[g] << " steps: " << (mismatches ? "FAILED" : "passed")
+                    << endl;
+            failed += mismatches > 0;
+        }
+        catch (std::exception& e)
+        {
+            cout << grids[g] << " steps: FAILED, " << e.what() << endl;
+            ++failed;
+        }
+    }
+
+    return failed;
+}
+
 
 int main(int argc, char* argv[])
 {
@@ -525,6 +1038,18 @@ int main(int argc, char* argv[])
         return matnames_test(argc, argv);
     }
 
+    if(strcmp("sparse_cm", argv[1]) == 0) {
+        return sparse_cm_test(argc, argv);
+    }
+
+    if(strcmp("stiffness", argv[1]) == 0) {
+        return stiffness_test(argc, argv);
+    }
+
+    if(strcmp("dense_output", argv[1]) == 0) {
+        return dense_output_test(argc, argv);
+    }
+
 
 
     cout << "error, invalid test name: " << argv[1] << endl;
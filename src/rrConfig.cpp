@@ -125,7 +125,14 @@ static Variant values[] =  {
     Variant(-1),                              // RANDOM_SEED
     Variant(true),      // PYTHON_ENABLE_NAMED_MATRIX
     Variant(true),      // LLVM_SYMBOL_CACHE
-    Variant(true)       // OPTIMIZE_REACTION_RATE_SELECTION
+    Variant(true),      // OPTIMIZE_REACTION_RATE_SELECTION
+    Variant(true),      // LLVM_INVARIANT_CACHE
+    Variant(false),     // LOADSBMLOPTIONS_SPARSE_CONSERVED_MOIETIES
+    Variant(32),        // STRUCTURAL_CACHE_SIZE
+    Variant(std::string("")), // STRUCTURAL_CACHE_DIR
+    Variant(std::string("none")), // SIMULATEOPTIONS_THINNING
+    Variant(1.e-9),     // SIMULATEOPTIONS_THINNING_ABSOLUTE
+    Variant(1.e-3)      // SIMULATEOPTIONS_THINNING_RELATIVE
     // add space after develop keys to clean up merging
 
 
@@ -225,6 +232,13 @@ static void getKeyNames(StringIntMap& keys)
     keys["PYTHON_ENABLE_NAMED_MATRIX"] = rr::Config::PYTHON_ENABLE_NAMED_MATRIX;
     keys["LLVM_SYMBOL_CACHE"] = rr::Config::LLVM_SYMBOL_CACHE;
     keys["OPTIMIZE_REACTION_RATE_SELECTION"] = rr::Config::OPTIMIZE_REACTION_RATE_SELECTION;
+    keys["LLVM_INVARIANT_CACHE"] = rr::Config::LLVM_INVARIANT_CACHE;
+    keys["LOADSBMLOPTIONS_SPARSE_CONSERVED_MOIETIES"] = rr::Config::LOADSBMLOPTIONS_SPARSE_CONSERVED_MOIETIES;
+    keys["STRUCTURAL_CACHE_SIZE"] = rr::Config::STRUCTURAL_CACHE_SIZE;
+    keys["STRUCTURAL_CACHE_DIR"] = rr::Config::STRUCTURAL_CACHE_DIR;
+    keys["SIMULATEOPTIONS_THINNING"] = rr::Config::SIMULATEOPTIONS_THINNING;
+    keys["SIMULATEOPTIONS_THINNING_ABSOLUTE"] = rr::Config::SIMULATEOPTIONS_THINNING_ABSOLUTE;
+    keys["SIMULATEOPTIONS_THINNING_RELATIVE"] = rr::Config::SIMULATEOPTIONS_THINNING_RELATIVE;
 
 
 
@@ -430,6 +430,46 @@ public:
          */
         OPTIMIZE_REACTION_RATE_SELECTION,
 
+        /**
+         * evaluate time invariant assignment rules once when values
+         * are set instead of on every model evaluation.
+         */
+        LLVM_INVARIANT_CACHE,
+
+        /**
+         * use sparse elimination for the conserved moiety analysis,
+         * see LoadSBMLOptions::SPARSE_CONSERVED_MOIETIES.
+         */
+        LOADSBMLOPTIONS_SPARSE_CONSERVED_MOIETIES,
+
+        /**
+         * the number of structural analyses kept in memory by the
+         * StructuralCache, 0 disables the cache.
+         */
+        STRUCTURAL_CACHE_SIZE,
+
+        /**
+         * a directory the StructuralCache reads and writes analyses in,
+         * empty to keep them in memory only.
+         */
+        STRUCTURAL_CACHE_DIR,
+
+        /**
+         * the default SimulateOptions::thinning, "none", "change" or
+         * "interpolation".
+         */
+        SIMULATEOPTIONS_THINNING,
+
+        /**
+         * the default SimulateOptions::thinningAbsolute.
+         */
+        SIMULATEOPTIONS_THINNING_ABSOLUTE,
+
+        /**
+         * the default SimulateOptions::thinningRelative.
+         */
+        SIMULATEOPTIONS_THINNING_RELATIVE,
+
 
         // add lots of space so not to conflict with other branches.
 
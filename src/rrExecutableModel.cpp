@@ -4,6 +4,7 @@
 #include "rrExecutableModel.h"
 #include "rrSparse.h"
 #include <iomanip>
+#include <stdexcept>
 
 using namespace std;
 
@@ -102,6 +103,32 @@ std::ostream& operator <<(std::ostream &stream, ExecutableModel* model)
     return stream;
 }
 
+void ExecutableModel::saveState(std::ostream& out)
+{
+    throw std::logic_error("saving the model state is not supported by "
+            "this model type, model: " + getModelName());
+}
+
+void ExecutableModel::loadState(std::istream& in)
+{
+    throw std::logic_error("loading the model state is not supported by "
+            "this model type, model: " + getModelName());
+}
+
+ExecutableModel* ExecutableModel::clone()
+{
+    throw std::logic_error("cloning is not supported by this model type, "
+            "model: " + getModelName());
+}
+
+void ExecutableModel::getStatistics(BasicDictionary& stats) const
+{
+}
+
+void ExecutableModel::resetStatistics()
+{
+}
+
 
 
 
@@ -6,6 +6,7 @@
 #include <string>
 #include <list>
 #include <ostream>
+#include <istream>
 
 
 #include "tr1proxy/rr_memory.h"
@@ -14,6 +15,7 @@ namespace rr
 {
 
 class ExecutableModel;
+class BasicDictionary;
 
 /**
  * RoadRunner has the capatiblity to notify user objects of any sbml event.
@@ -661,6 +663,52 @@ public:
      */
     virtual void setFlags(uint32_t) = 0;
 
+    /**
+     * Write the complete dynamic state of the model to a binary stream.
+     *
+     * This includes all of the values in the model data, the pending
+     * events and the state of the random number generator, but not the
+     * compiled model code, so the state can only be loaded into a model
+     * that was created from the same sbml.
+     *
+     * The default implementation throws a std::logic_error, models which
+     * support state saving override this.
+     */
+    virtual void saveState(std::ostream& out);
+
+    /**
+     * Restore the dynamic state of the model that was previously written
+     * with saveState.
+     *
+     * @throw std::invalid_argument if the state was saved from a model with
+     * a different structure.
+     */
+    virtual void loadState(std::istream& in);
+
+    /**
+     * Create a new model which shares the compiled code with this one,
+     * and has an identical copy of the current dynamic state, including the
+     * random number generator state.
+     *
+     * Event listeners are not copied. The caller owns the returned object.
+     */
+    virtual ExecutableModel* clone();
+
+    /**
+     * Add the performance counters of this model to stats, such as the
+     * number of event root evaluations and event assignments, and the
+     * time it took to generate the model code.
+     *
+     * The counters are plain integer increments, cheap enough to always
+     * be on. The default implementation adds nothing.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
+
+    /**
+     * zero the performance counters.
+     */
+    virtual void resetStatistics();
+
     enum ExecutableModelFlags {
         /**
          * A simulation is currently running. This means that the model
@@ -1,5 +1,6 @@
 #pragma hdrstop
 #include "rrNLEQInterface.h"
+#include "Tracer.h"
 #include "rrExecutableModel.h"
 #include "rrStringUtils.h"
 #include "rrUtils.h"
@@ -30,6 +31,20 @@ static Mutex mutex;
 // the NLEQ callback, we use same data types as f2c here.
 static void ModelFunction(int* nx, double* y, double* fval, int* pErr);
 
+void NLEQInterface::getStatistics(BasicDictionary& stats) const
+{
+    if (!IWK)
+    {
+        return;
+    }
+
+    stats.setItem("newtonIterations", (int)IWK[0]);
+    stats.setItem("correctorSteps", (int)IWK[2]);
+    stats.setItem("modelEvaluations", (int)IWK[3]);
+    stats.setItem("jacobianEvaluations", (int)IWK[4]);
+    stats.setItem("modelEvaluationsForJacobian", (int)IWK[7]);
+}
+
 static string ErrorForStatus(int error);
 
 static bool isError(int e)
@@ -133,6 +148,9 @@ bool NLEQInterface::isAvailable()
 
 double NLEQInterface::solve(const vector<double>& yin)
 {
+    // includes waiting for the lock, so contention shows up in traces
+    RR_TRACE_SCOPE("NLEQInterface::solve", "steadystate");
+
     // lock so only one thread can be here.
     Mutex::ScopedLock lock(mutex);
 
@@ -348,7 +366,7 @@ int NLEQInterface::getNumberOfModelEvaluationsForJacobian()
     return IWK[7];
 }
 
-string ErrorForStatus(int error)
+static string ErrorForStatus(int error)
 {
     switch (error)
     {
@@ -67,26 +67,10 @@ public:
      */
     static const Dictionary* getSteadyStateOptions();
 
-
-private:
-    int nOpts;
-    long *IWK;
-    long LIWK;
-    long LWRK;
-    double *RWK;
-    double *XScal;
-    long ierr;
-    long *iopt;
-    ExecutableModel *model; // Model generated from the SBML. Static so we can access it from standalone function
-    long n;
-    void setup();
-
-    bool isAvailable();
-
-    int maxIterations;
-    double relativeTolerance;
-    double minDamping;
-
+    /**
+     * the NLEQ iteration counts of the last solve.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const;
 
     /// <summary>
     /// Sets the Scaling Factors
@@ -125,6 +109,27 @@ private:
     int                             getNumberOfModelEvaluationsForJacobian();
 
 
+
+private:
+    int nOpts;
+    long *IWK;
+    long LIWK;
+    long LWRK;
+    double *RWK;
+    double *XScal;
+    long ierr;
+    long *iopt;
+    ExecutableModel *model; // Model generated from the SBML. Static so we can access it from standalone function
+    long n;
+    void setup();
+
+    bool isAvailable();
+
+    int maxIterations;
+    double relativeTolerance;
+    double minDamping;
+
+
     double                          computeSumsOfSquares();
 
 
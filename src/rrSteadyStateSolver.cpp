@@ -1,5 +1,7 @@
 #include "rrSteadyStateSolver.h"
 #include "rrNLEQInterface.h"
+#include "HybridSteadyStateSolver.h"
+#include <stdexcept>
 
 using namespace std;
 
@@ -8,16 +10,33 @@ namespace rr
 {
 
 
-SteadyStateSolver* SteadyStateSolverFactory::New(const Dictionary* doct,
+SteadyStateSolver* SteadyStateSolverFactory::New(const Dictionary* dict,
         ExecutableModel* model)
 {
-    return new NLEQInterface(model);
+    std::string name = "NLEQ";
+
+    if (dict && dict->hasKey("steadyState"))
+    {
+        name = dict->getItem("steadyState").convert<std::string>();
+    }
+
+    if (name == "NLEQ")
+    {
+        return new NLEQInterface(model);
+    }
+    else if (name == "Hybrid")
+    {
+        return new HybridSteadyStateSolver(model, dict);
+    }
+
+    throw std::invalid_argument("invalid steady state solver: " + name);
 }
 
 std::vector<std::string> rr::SteadyStateSolverFactory::getSteadyStateNames()
 {
     std::vector<std::string> res;
     res.push_back("NLEQ");
+    res.push_back("Hybrid");
     return res;
 }
 
@@ -25,13 +44,23 @@ std::vector<const Dictionary*> rr::SteadyStateSolverFactory::getSteadyStateOptio
 {
     std::vector<const Dictionary*> res;
     res.push_back(NLEQInterface::getSteadyStateOptions());
+    res.push_back(HybridSteadyStateSolver::getSteadyStateOptions());
     return res;
 }
 
 const Dictionary* rr::SteadyStateSolverFactory::getSteadyStateOptions(
         const std::string& name)
 {
-    return NLEQInterface::getSteadyStateOptions();;
+    if (name == "NLEQ")
+    {
+        return NLEQInterface::getSteadyStateOptions();
+    }
+    else if (name == "Hybrid")
+    {
+        return HybridSteadyStateSolver::getSteadyStateOptions();
+    }
+
+    throw std::invalid_argument("invalid steady state solver: " + name);
 }
 
 }
@@ -28,6 +28,12 @@ public:
 
     virtual ~SteadyStateSolver() {};
     virtual double solve(const std::vector<double>& yin) = 0;
+
+    /**
+     * copy the statistics of the last call to solve, such as the number
+     * of Newton iterations or model evaluations, into the given dictionary.
+     */
+    virtual void getStatistics(BasicDictionary& stats) const {};
 };
 
 /**
@@ -41,6 +47,12 @@ public:
 
     /**
      * factory method to create a new steady state solver.
+     *
+     * The solver is selected by the "steadyState" key of the dictionary,
+     * which is the name of one of the solvers in getSteadyStateNames.
+     * If the key is not present, NLEQ is used.
+     *
+     * @throws std::invalid_argument if the solver name is not valid.
      */
     static SteadyStateSolver* New(const Dictionary* dict, ExecutableModel* model);
 
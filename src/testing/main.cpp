@@ -95,6 +95,22 @@ int main(int argc, char* argv[])
     //    clog<<"Running TestSuite Tests\n";
     runner1.RunTestsIf(Test::GetTestList(), "SBML_l2v4",       True(), 0);
 
+    runner1.RunTestsIf(Test::GetTestList(), "OutputThinning",  True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "TrajectoryFile",  True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "ParameterScan",   True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "SensitivityAnalysis", True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "ParameterEstimation", True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "StructuralCache", True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "FrequencyResponse", True(), 0);
+
+    runner1.RunTestsIf(Test::GetTestList(), "AdaptiveIntegrators", True(), 0);
+
     //Finish outputs result to xml file
     runner1.Finish();
     //    Pause();
@@ -0,0 +1,491 @@
+#include "unit_test/UnitTest++.h"
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "RosenbrockIntegrator.h"
+
+#include <math.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+/**
+ * y' = -y, y(0) = 1.
+ */
+static const char* decaySBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"decay\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"k\" value=\"1\" constant=\"true\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J0\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k </ci><ci> y </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * y' = -y, reset to 1 whenever it drops below 0.5, which happens at
+ * t = ln 2, 2 ln 2, ... The event counts itself, and records the last and
+ * the sum of the event times.
+ */
+static const char* resetSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"reset\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"count\" value=\"0\" constant=\"false\"/>\n"
+    "      <parameter id=\"tlast\" value=\"0\" constant=\"false\"/>\n"
+    "      <parameter id=\"tsum\" value=\"0\" constant=\"false\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J0\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><ci> y </ci></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "    <listOfEvents>\n"
+    "      <event id=\"reset\" useValuesFromTriggerTime=\"true\">\n"
+    "        <trigger initialValue=\"false\" persistent=\"true\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><lt/><ci> y </ci><cn> 0.5 </cn></apply>\n"
+    "        </math></trigger>\n"
+    "        <listOfEventAssignments>\n"
+    "          <eventAssignment variable=\"y\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math></eventAssignment>\n"
+    "          <eventAssignment variable=\"count\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "            <apply><plus/><ci> count </ci><cn> 1 </cn></apply>\n"
+    "          </math></eventAssignment>\n"
+    "          <eventAssignment variable=\"tlast\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "            <csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\"> t </csymbol>\n"
+    "          </math></eventAssignment>\n"
+    "          <eventAssignment variable=\"tsum\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "            <apply><plus/><ci> tsum </ci>\n"
+    "              <csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\"> t </csymbol>\n"
+    "            </apply>\n"
+    "          </math></eventAssignment>\n"
+    "        </listOfEventAssignments>\n"
+    "      </event>\n"
+    "    </listOfEvents>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * y' = -k y and z' = 1, an event triggered at t = 3.3 with a delay of 1.2
+ * resets z and doubles k at t = 4.5.
+ */
+static const char* delayedSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"delayed\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"z\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"k\" value=\"1\" constant=\"false\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"decay\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k </ci><ci> y </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"growth\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfProducts><speciesReference species=\"z\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "    <listOfEvents>\n"
+    "      <event id=\"delayed\" useValuesFromTriggerTime=\"true\">\n"
+    "        <trigger initialValue=\"false\" persistent=\"true\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><geq/><csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\"> t </csymbol><cn> 3.3 </cn></apply>\n"
+    "        </math></trigger>\n"
+    "        <delay><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1.2 </cn></math></delay>\n"
+    "        <listOfEventAssignments>\n"
+    "          <eventAssignment variable=\"z\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 0 </cn></math></eventAssignment>\n"
+    "          <eventAssignment variable=\"k\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 2 </cn></math></eventAssignment>\n"
+    "        </listOfEventAssignments>\n"
+    "      </event>\n"
+    "    </listOfEvents>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * the Robertson chemical kinetics problem, the usual stiff test problem.
+ */
+static const char* robertsonSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"robertson\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"y1\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"y2\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"y3\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"r1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 0.04 </cn><ci> y1 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"r2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <listOfModifiers><modifierSpeciesReference species=\"y3\"/></listOfModifiers>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 10000 </cn><ci> y2 </ci><ci> y3 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"r3\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"y2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"y3\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><cn> 30000000 </cn><apply><power/><ci> y2 </ci><cn> 2 </cn></apply></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * a chain S1 -> S2 -> S3 -> S4 -> S5, and S1 + S3 -> S5, each species
+ * only interacts with a few others, so the Jacobian columns can be
+ * perturbed in fewer groups than there are species.
+ */
+static const char* chainSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"chain\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"S1\" compartment=\"c\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S2\" compartment=\"c\" initialAmount=\"2\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S3\" compartment=\"c\" initialAmount=\"3\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S4\" compartment=\"c\" initialAmount=\"4\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S5\" compartment=\"c\" initialAmount=\"5\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><cn> 1.5 </cn><ci> S1 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><cn> 0.7 </cn><ci> S2 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J3\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S4\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><cn> 2.5 </cn><ci> S3 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J4\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S4\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S5\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><cn> 0.3 </cn><ci> S4 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J5\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants>\n"
+    "          <speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/>\n"
+    "          <speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/>\n"
+    "        </listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S5\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><cn> 0.2 </cn><ci> S1 </ci><ci> S3 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+/**
+ * exposes the Jacobian of the first step.
+ */
+class JacobianProbe : public RosenbrockIntegrator
+{
+public:
+    JacobianProbe(ExecutableModel *m, const SimulateOptions *o) :
+        RosenbrockIntegrator(m, o)
+    {
+    }
+
+    vector<double> jacobian()
+    {
+        beginStep();
+        return jac;
+    }
+};
+
+/**
+ * the integrators every test of the common behavior runs with.
+ */
+static const Integrator::IntegratorId adaptiveIntegrators[] = {
+        Integrator::DOPRI5, Integrator::ROSENBROCK};
+static const int numAdaptiveIntegrators = 2;
+
+static SimulateOptions integratorOptions(Integrator::IntegratorId id,
+        double duration, int steps)
+{
+    SimulateOptions o;
+    o.start = 0;
+    o.duration = duration;
+    o.steps = steps;
+    o.integrator = id;
+    return o;
+}
+
+static int numSteps(SBMLSolver& r, Integrator::IntegratorId id)
+{
+    return r.getIntegrator(id)->getItem("NumSteps").convert<int>();
+}
+
+/**
+ * the error of y(1) of y' = -y integrated with the fixed step size h, the
+ * tolerances are so loose that no step is rejected, and the step size is
+ * held at h by the maximum step size.
+ */
+static double fixedStepError(Integrator::IntegratorId id, double h,
+        int* steps)
+{
+    SBMLSolver r(decaySBML);
+
+    SimulateOptions o = integratorOptions(id, 1, 1);
+    o.initialTimeStep = h;
+    o.maximumTimeStep = h;
+    o.relative = 1;
+    o.absolute = 1;
+
+    const ls::DoubleMatrix& m = *r.simulate(&o);
+    *steps = numSteps(r, id);
+
+    return fabs(m(m.numRows() - 1, 1) - exp(-1.));
+}
+
+/**
+ * the observed order of convergence between the step sizes h and h / 2.
+ */
+static double convergenceOrder(Integrator::IntegratorId id, double h)
+{
+    int steps = 0, halfSteps = 0;
+    double e = fixedStepError(id, h, &steps);
+    double eHalf = fixedStepError(id, h / 2, &halfSteps);
+
+    if (steps != (int)(1 / h + 0.5) || halfSteps != 2 * steps)
+    {
+        return 0;
+    }
+
+    return log(e / eHalf) / log(2.);
+}
+
+SUITE(AdaptiveIntegrators)
+{
+    TEST(ROSENBROCK_ROBERTSON)
+    {
+        SBMLSolver r(robertsonSBML);
+
+        SimulateOptions o = integratorOptions(Integrator::ROSENBROCK, 40, 1);
+        o.relative = 1.e-8;
+        o.absolute = 1.e-14;
+
+        r.simulate(&o);
+
+        // the reference solution at t = 40
+        CHECK_CLOSE(0.7158270687193941, r.getValue("y1"), 1.e-5 * 0.7158270687193941);
+        CHECK_CLOSE(9.185534764557338e-06, r.getValue("y2"), 1.e-5 * 9.185534764557338e-06);
+        CHECK_CLOSE(0.2841637457458413, r.getValue("y3"), 1.e-5 * 0.2841637457458413);
+        CHECK_CLOSE(1, r.getValue("y1") + r.getValue("y2") + r.getValue("y3"), 1.e-10);
+
+        Integrator* itg = r.getIntegrator(Integrator::ROSENBROCK);
+        CHECK(itg->getItem("NumJacEvals").convert<int>() > 0);
+        CHECK(itg->getItem("NumDecomps").convert<int>() >= numSteps(r, Integrator::ROSENBROCK));
+
+        // the step size grows with the stiffness, an explicit method would
+        // need tens of thousands of steps
+        CHECK(numSteps(r, Integrator::ROSENBROCK) < 2000);
+    }
+
+    TEST(DOPRI5_CONVERGENCE)
+    {
+        const double h[] = {1. / 2, 1. / 4, 1. / 8};
+
+        for (int i = 0; i < 3; ++i)
+        {
+            double order = convergenceOrder(Integrator::DOPRI5, h[i]);
+            CHECK(order > 4.8 && order < 5.8);
+        }
+    }
+
+    TEST(ROSENBROCK_CONVERGENCE)
+    {
+        // h divides 1 exactly, so the last step ends at t = 1
+        const double h[] = {1. / 4, 1. / 8, 1. / 16};
+
+        for (int i = 0; i < 3; ++i)
+        {
+            double order = convergenceOrder(Integrator::ROSENBROCK, h[i]);
+            CHECK(order > 3.7 && order < 4.3);
+        }
+    }
+
+    TEST(DENSE_OUTPUT)
+    {
+        for (int i = 0; i < numAdaptiveIntegrators; ++i)
+        {
+            const Integrator::IntegratorId id = adaptiveIntegrators[i];
+            SBMLSolver r(decaySBML);
+
+            SimulateOptions o = integratorOptions(id, 10, 1000);
+            o.relative = 1.e-8;
+            o.absolute = 1.e-14;
+
+            const ls::DoubleMatrix& m = *r.simulate(&o);
+
+            CHECK_EQUAL(1001, m.numRows());
+
+            for (unsigned j = 0; j < m.numRows(); ++j)
+            {
+                const double t = m(j, 0);
+                CHECK_CLOSE(0.01 * j, t, 1.e-12);
+                CHECK_CLOSE(exp(-t), m(j, 1), 1.e-6 * exp(-t));
+            }
+
+            // the output points are interpolated, not stepped to
+            CHECK(numSteps(r, id) < 500);
+        }
+    }
+
+    TEST(EVENT_TIMES)
+    {
+        for (int i = 0; i < numAdaptiveIntegrators; ++i)
+        {
+            SBMLSolver r(resetSBML);
+
+            SimulateOptions o = integratorOptions(adaptiveIntegrators[i], 5, 50);
+            o.relative = 1.e-8;
+            o.absolute = 1.e-12;
+
+            r.simulate(&o);
+
+            // the events are at ln 2, 2 ln 2, ... 7 ln 2
+            const double ln2 = log(2.);
+
+            CHECK_EQUAL(7, r.getValue("count"));
+            CHECK_CLOSE(7 * ln2, r.getValue("tlast"), 1.e-6);
+            CHECK_CLOSE(28 * ln2, r.getValue("tsum"), 1.e-5);
+            CHECK_CLOSE(exp(-(5 - 7 * ln2)), r.getValue("y"), 1.e-6);
+        }
+    }
+
+    TEST(DELAYED_EVENT)
+    {
+        for (int i = 0; i < numAdaptiveIntegrators; ++i)
+        {
+            SBMLSolver r(delayedSBML);
+
+            SimulateOptions o = integratorOptions(adaptiveIntegrators[i], 6, 60);
+            o.relative = 1.e-8;
+            o.absolute = 1.e-12;
+
+            const ls::DoubleMatrix& m = *r.simulate(&o);
+
+            CHECK_EQUAL(61, m.numRows());
+
+            for (unsigned j = 0; j < m.numRows(); ++j)
+            {
+                const double t = m(j, 0);
+
+                // the output at the event time may be either side of it
+                if (fabs(t - 4.5) < 1.e-6)
+                {
+                    continue;
+                }
+
+                const double y = t < 4.5 ? exp(-t) : exp(-4.5 - 2 * (t - 4.5));
+                const double z = t < 4.5 ? t : t - 4.5;
+
+                CHECK_CLOSE(y, m(j, 1), 1.e-6 * y);
+                CHECK_CLOSE(z, m(j, 2), 1.e-8);
+            }
+
+            CHECK_EQUAL(2, r.getValue("k"));
+        }
+    }
+
+    TEST(ROSENBROCK_JACOBIAN_COLORING)
+    {
+        SBMLSolver r(chainSBML);
+        SimulateOptions o;
+
+        JacobianProbe colored(r.getModel(), &o);
+        JacobianProbe uncolored(r.getModel(), &o);
+        uncolored.setItem("JacobianColoring", false);
+
+        colored.restart(0);
+        uncolored.restart(0);
+
+        vector<double> jc = colored.jacobian();
+        vector<double> ju = uncolored.jacobian();
+
+        CHECK_EQUAL(25, (int)jc.size());
+        CHECK_EQUAL(jc.size(), ju.size());
+
+        for (unsigned i = 0; i < jc.size() && jc.size() == ju.size(); ++i)
+        {
+            CHECK_CLOSE(ju[i], jc[i], 1.e-10 * (1 + fabs(ju[i])));
+        }
+
+        // and both are the Jacobian of the model, column major
+        ls::DoubleMatrix J = r.getFullJacobian();
+
+        CHECK_EQUAL(5, J.numRows());
+        for (unsigned i = 0; i < J.numRows() && jc.size() == 25; ++i)
+        {
+            for (unsigned j = 0; j < J.numCols(); ++j)
+            {
+                CHECK_CLOSE(J(i, j), jc[j * 5 + i], 1.e-5);
+            }
+        }
+
+        // once the sparsity is known, the colored Jacobian takes a rate
+        // evaluation per group of columns, the uncolored one per column
+        int coloredEvals = colored.getItem("NumRhsEvals").convert<int>();
+        int uncoloredEvals = uncolored.getItem("NumRhsEvals").convert<int>();
+
+        colored.jacobian();
+        uncolored.jacobian();
+
+        coloredEvals = colored.getItem("NumRhsEvals").convert<int>() - coloredEvals;
+        uncoloredEvals = uncolored.getItem("NumRhsEvals").convert<int>() - uncoloredEvals;
+
+        CHECK_EQUAL(7, uncoloredEvals);
+        CHECK(coloredEvals < uncoloredEvals);
+    }
+}
@@ -0,0 +1,269 @@
+#include "unit_test/UnitTest++.h"
+#include "SBMLSolver.h"
+
+#include <complex>
+#include <math.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+typedef std::complex<double> Complex;
+
+/**
+ * a linear network with cycles, S1 is produced at the rate v0, converted
+ * to S2 and S3, which are converted back, and S3 decays. The Jacobian is
+ * a full 3 x 3 matrix, so the Hessenberg reduction is not trivial.
+ */
+static const char* responseSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"response\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"S1\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S2\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S3\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"v0\" value=\"1\" constant=\"true\"/>\n"
+    "      <parameter id=\"k1\" value=\"1\" constant=\"true\"/>\n"
+    "      <parameter id=\"k2\" value=\"2\" constant=\"true\"/>\n"
+    "      <parameter id=\"k3\" value=\"0.5\" constant=\"true\"/>\n"
+    "      <parameter id=\"k4\" value=\"0.3\" constant=\"true\"/>\n"
+    "      <parameter id=\"k5\" value=\"0.4\" constant=\"true\"/>\n"
+    "      <parameter id=\"k6\" value=\"0.2\" constant=\"true\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J0\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfProducts><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><ci> v0 </ci></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k1 </ci><ci> S1 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k2 </ci><ci> S2 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J3\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k3 </ci><ci> S3 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J4\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k4 </ci><ci> S3 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J5\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k5 </ci><ci> S2 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J6\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S3\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><apply><times/><ci> k6 </ci><ci> S1 </ci></apply></math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+static const double v0 = 1, k1 = 1, k2 = 2, k3 = 0.5, k4 = 0.3, k5 = 0.4,
+        k6 = 0.2;
+
+/**
+ * the exact Jacobian of the network.
+ */
+static void responseJacobian(double J[3][3])
+{
+    const double j[3][3] = {
+            {-k1 - k6, k5, k4},
+            {k1, -k2 - k5, 0},
+            {k6, k2, -k3 - k4}};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            J[i][k] = j[i][k];
+        }
+    }
+}
+
+/**
+ * the derivative of the rates of change of the species with respect to a
+ * parameter, at the species values S.
+ */
+static void responseInput(const string& parameter, const double S[3],
+        double b[3])
+{
+    b[0] = b[1] = b[2] = 0;
+
+    if (parameter == "v0")
+    {
+        b[0] = 1;
+    }
+    else if (parameter == "k1")
+    {
+        b[0] = -S[0];
+        b[1] = S[0];
+    }
+    else if (parameter == "k2")
+    {
+        b[1] = -S[1];
+        b[2] = S[1];
+    }
+    else if (parameter == "k3")
+    {
+        b[2] = -S[2];
+    }
+}
+
+/**
+ * x = (iwI - J)^-1 b by dense complex Gaussian elimination with partial
+ * pivoting.
+ */
+static void denseSolve(const double J[3][3], double w, const double b[3],
+        Complex x[3])
+{
+    Complex A[3][4];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            A[i][k] = -J[i][k];
+        }
+        A[i][i] += Complex(0, w);
+        A[i][3] = b[i];
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+        int pivot = k;
+        for (int i = k + 1; i < 3; ++i)
+        {
+            if (abs(A[i][k]) > abs(A[pivot][k]))
+            {
+                pivot = i;
+            }
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            swap(A[k][j], A[pivot][j]);
+        }
+
+        for (int i = k + 1; i < 3; ++i)
+        {
+            Complex l = A[i][k] / A[k][k];
+            for (int j = k; j < 4; ++j)
+            {
+                A[i][j] -= l * A[k][j];
+            }
+        }
+    }
+
+    for (int k = 2; k >= 0; --k)
+    {
+        Complex s = A[k][3];
+        for (int j = k + 1; j < 3; ++j)
+        {
+            s -= A[k][j] * x[j];
+        }
+        x[k] = s / A[k][k];
+    }
+}
+
+/**
+ * the phase in degrees in [0, 360), as the frequency response reports it.
+ */
+static double phaseDegrees(const Complex& z)
+{
+    double phase = atan2(imag(z), real(z)) * 180 / M_PI;
+    return imag(z) >= 0 ? phase : phase + 360;
+}
+
+/**
+ * the difference of two phases, near 0 and 360 are the same phase.
+ */
+static double phaseDifference(double a, double b)
+{
+    double d = fmod(fabs(a - b), 360);
+    return min(d, 360 - d);
+}
+
+SUITE(FrequencyResponse)
+{
+    TEST(HESSENBERG_MATCHES_DENSE_SOLVE)
+    {
+        SBMLSolver r(responseSBML);
+
+        const char* variables[] = {"S1", "S2", "S3"};
+        const char* parameters[] = {"v0", "k1", "k2", "k3"};
+
+        const double startFrequency = 0.01;
+        const int decades = 4;
+        const int points = 9;
+
+        double J[3][3];
+        responseJacobian(J);
+
+        for (int v = 0; v < 3; ++v)
+        {
+            for (int p = 0; p < 4; ++p)
+            {
+                ls::DoubleMatrix m = r.getFrequencyResponse(startFrequency,
+                        decades, points, parameters[p], variables[v], false,
+                        false);
+
+                CHECK_EQUAL(points, m.numRows());
+                CHECK_EQUAL(3, m.numCols());
+
+                // the solver is at its steady state
+                const double S[3] = {r.getValue("S1"), r.getValue("S2"),
+                        r.getValue("S3")};
+
+                double b[3];
+                responseInput(parameters[p], S, b);
+
+                for (int i = 0; i < points && m.numRows() == points; ++i)
+                {
+                    const double w = startFrequency
+                            * pow(10., (double)decades * i / (points - 1));
+                    CHECK_CLOSE(w, m(i, 0), 1.e-12 * w);
+
+                    Complex x[3];
+                    denseSolve(J, w, b, x);
+
+                    const double gain = abs(x[v]);
+                    CHECK_CLOSE(gain, m(i, 1), 1.e-6 * gain);
+                    CHECK(phaseDifference(phaseDegrees(x[v]), m(i, 2)) < 1.e-4);
+                }
+            }
+        }
+    }
+
+    TEST(DECIBEL_AND_HERTZ)
+    {
+        SBMLSolver r(responseSBML);
+
+        ls::DoubleMatrix m = r.getFrequencyResponse(0.1, 2, 5, "k2", "S3",
+                false, false);
+        ls::DoubleMatrix db = r.getFrequencyResponse(0.1, 2, 5, "k2", "S3",
+                true, true);
+
+        CHECK_EQUAL(5, db.numRows());
+
+        for (unsigned i = 0; i < m.numRows() && i < db.numRows(); ++i)
+        {
+            CHECK_CLOSE(m(i, 0) / (2 * M_PI), db(i, 0), 1.e-12);
+            CHECK_CLOSE(20 * log10(m(i, 1)), db(i, 1), 1.e-9);
+            CHECK_CLOSE(m(i, 2), db(i, 2), 1.e-9);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#include "unit_test/UnitTest++.h"
+#include "OutputThinning.h"
+
+#include <math.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+/**
+ * a time column and value columns.
+ */
+static vector<SelectionRecord> thinningSelections(int values)
+{
+    vector<SelectionRecord> selections(values + 1);
+    selections[0].selectionType = SelectionRecord::TIME;
+    for (int i = 1; i <= values; ++i)
+    {
+        selections[i].selectionType = SelectionRecord::FLOATING_CONCENTRATION;
+    }
+    return selections;
+}
+
+static SimulateOptions thinningOptions(SimulateOptions::Thinning mode)
+{
+    SimulateOptions opt;
+    opt.thinning = mode;
+    opt.thinningAbsolute = 1.e-6;
+    opt.thinningRelative = 1.e-3;
+    return opt;
+}
+
+static void addRow(OutputThinning& thinning, double t, double value)
+{
+    vector<double> row(2);
+    row[0] = t;
+    row[1] = value;
+    thinning.add(row, t);
+}
+
+/**
+ * the value of a kept trajectory at t, by linear interpolation.
+ */
+static double interpolate(const ls::DoubleMatrix& m, double t)
+{
+    int k = 0;
+    while (k + 2 < m.numRows() && m(k + 1, 0) < t)
+    {
+        ++k;
+    }
+    double s = (t - m(k, 0)) / (m(k + 1, 0) - m(k, 0));
+    return m(k, 1) + s * (m(k + 1, 1) - m(k, 1));
+}
+
+SUITE(OutputThinning)
+{
+    TEST(FIRST_AND_LAST_ROWS)
+    {
+        // a straight line needs no rows in between
+        OutputThinning line(thinningOptions(SimulateOptions::THINNING_INTERPOLATION),
+                thinningSelections(1));
+        for (int i = 0; i <= 100; ++i)
+        {
+            addRow(line, i * 0.1, 1 + 2 * i * 0.1);
+        }
+
+        ls::DoubleMatrix m;
+        line.getResult(m);
+
+        CHECK_EQUAL(101, line.getRows());
+        CHECK_EQUAL(2, line.getKeptRows());
+        CHECK_EQUAL(2, m.numRows());
+        CHECK_EQUAL(0, m(0, 0));
+        CHECK_EQUAL(1, m(0, 1));
+        CHECK_EQUAL(100 * 0.1, m(1, 0));
+        CHECK_EQUAL(1 + 2 * 100 * 0.1, m(1, 1));
+
+        // a constant needs no rows in between either
+        OutputThinning constant(thinningOptions(SimulateOptions::THINNING_CHANGE),
+                thinningSelections(1));
+        for (int i = 0; i <= 100; ++i)
+        {
+            addRow(constant, i * 0.1, 5);
+        }
+
+        constant.getResult(m);
+
+        CHECK_EQUAL(2, m.numRows());
+        CHECK_EQUAL(0, m(0, 0));
+        CHECK_EQUAL(100 * 0.1, m(1, 0));
+
+        // a single row is both the first and the last
+        OutputThinning single(thinningOptions(SimulateOptions::THINNING_INTERPOLATION),
+                thinningSelections(1));
+        addRow(single, 0, 1);
+        single.getResult(m);
+
+        CHECK_EQUAL(1, m.numRows());
+    }
+
+    TEST(EVENT_ROWS)
+    {
+        // a ramp reset at t = 3, the integrator returns a row before and a
+        // row after the event at the same time.
+        const double t[] = {0, 1, 2, 3, 3, 4, 5, 6};
+        const double y[] = {0, 1, 2, 3, 0, 1, 2, 3};
+
+        for (int mode = SimulateOptions::THINNING_CHANGE;
+                mode <= SimulateOptions::THINNING_INTERPOLATION; ++mode)
+        {
+            OutputThinning thinning(thinningOptions((SimulateOptions::Thinning)mode),
+                    thinningSelections(1));
+            for (int i = 0; i < 8; ++i)
+            {
+                addRow(thinning, t[i], y[i]);
+            }
+
+            ls::DoubleMatrix m;
+            thinning.getResult(m);
+
+            int before = -1;
+            for (int i = 0; i + 1 < m.numRows(); ++i)
+            {
+                if (m(i, 0) == 3 && m(i + 1, 0) == 3)
+                {
+                    before = i;
+                }
+            }
+
+            CHECK(before >= 0);
+            if (before >= 0)
+            {
+                CHECK_EQUAL(3, m(before, 1));
+                CHECK_EQUAL(0, m(before + 1, 1));
+            }
+
+            CHECK_EQUAL(0, m(0, 0));
+            CHECK_EQUAL(6, m(m.numRows() - 1, 0));
+        }
+    }
+
+    TEST(SWINGING_DOOR_BOUND)
+    {
+        SimulateOptions opt = thinningOptions(SimulateOptions::THINNING_INTERPOLATION);
+        OutputThinning thinning(opt, thinningSelections(1));
+
+        const int n = 10001;
+        for (int i = 0; i < n; ++i)
+        {
+            double t = 10. * i / (n - 1);
+            addRow(thinning, t, exp(-t));
+        }
+
+        ls::DoubleMatrix m;
+        thinning.getResult(m);
+
+        CHECK(m.numRows() < n / 10);
+        CHECK_EQUAL(10, m(m.numRows() - 1, 0));
+
+        // every dropped row is within its tolerance of the line through
+        // the kept rows around it
+        for (int i = 0; i < n; ++i)
+        {
+            double t = 10. * i / (n - 1);
+            double tol = opt.thinningAbsolute + opt.thinningRelative * exp(-t);
+            CHECK(fabs(interpolate(m, t) - exp(-t)) <= tol * (1 + 1.e-9));
+        }
+    }
+
+    TEST(CHANGE_BOUND)
+    {
+        SimulateOptions opt = thinningOptions(SimulateOptions::THINNING_CHANGE);
+        OutputThinning thinning(opt, thinningSelections(1));
+
+        const int n = 10001;
+        for (int i = 0; i < n; ++i)
+        {
+            double t = 10. * i / (n - 1);
+            addRow(thinning, t, exp(-t));
+        }
+
+        ls::DoubleMatrix m;
+        thinning.getResult(m);
+
+        CHECK(m.numRows() < n);
+
+        // every dropped row is within the tolerance of the last kept row
+        int k = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            double t = 10. * i / (n - 1);
+            while (k + 1 < m.numRows() && m(k + 1, 0) <= t)
+            {
+                ++k;
+            }
+            double tol = opt.thinningAbsolute + opt.thinningRelative * fabs(m(k, 1));
+            CHECK(fabs(m(k, 1) - exp(-t)) <= tol * (1 + 1.e-9));
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#include "unit_test/UnitTest++.h"
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "ParameterEstimation.h"
+
+#include <math.h>
+#include <memory>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+/**
+ * A decays with the rate constant k1, and is converted to B with the rate
+ * constant k2. A determines k1 + k2, and B the share of k2.
+ */
+static const char* estimationSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"estimation\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"A\" compartment=\"c\" initialAmount=\"10\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"B\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"k1\" value=\"0.3\" constant=\"true\"/>\n"
+    "      <parameter id=\"k2\" value=\"0.1\" constant=\"true\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"A\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k1 </ci><ci> A </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"A\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"B\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k2 </ci><ci> A </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+static const double trueK1 = 0.3;
+static const double trueK2 = 0.1;
+
+static vector<string> measuredSelections()
+{
+    vector<string> selections;
+    selections.push_back("A");
+    selections.push_back("B");
+    return selections;
+}
+
+/**
+ * the data and the fits are integrated with tight tolerances, so the sum
+ * of squares at the true values is close to zero.
+ */
+static void setTolerances(SimulateOptions& o)
+{
+    o.relative = 1.e-10;
+    o.absolute = 1.e-12;
+}
+
+/**
+ * the time courses of A and B at the true parameter values, simulated by
+ * a separate solver, so the template solver stays at its initial state.
+ */
+static ls::DoubleMatrix simulatedData()
+{
+    SBMLSolver r(estimationSBML);
+
+    vector<string> selections = measuredSelections();
+    selections.insert(selections.begin(), "time");
+    r.setSelections(selections);
+
+    SimulateOptions o;
+    o.start = 0;
+    o.duration = 10;
+    o.steps = 20;
+    setTolerances(o);
+
+    return *r.simulate(&o);
+}
+
+static ParameterEstimation* newEstimation(SBMLSolver& r, int starts)
+{
+    BasicDictionary options;
+    options.setItem("threads", 2);
+    options.setItem("starts", starts);
+
+    // the workers are cloned with the simulate options of the template
+    setTolerances(r.getSimulateOptions());
+
+    ParameterEstimation* est = new ParameterEstimation(&r, &options);
+    est->addExperiment(simulatedData(), measuredSelections());
+    return est;
+}
+
+SUITE(ParameterEstimation)
+{
+    TEST(RECOVERS_PARAMETERS)
+    {
+        SBMLSolver r(estimationSBML);
+        std::auto_ptr<ParameterEstimation> est(newEstimation(r, 1));
+
+        // start well away from the true values
+        est->addParameter("k1", 1.0, 0.01, 10);
+        est->addParameter("k2", 0.5, 0.01, 10);
+
+        CHECK_EQUAL(2, est->getNumParameters());
+        CHECK_EQUAL(21 * 2, est->getNumResiduals());
+
+        double ssr = est->run();
+        vector<double> values = est->getParameterValues();
+
+        CHECK_EQUAL(2, (int)values.size());
+        CHECK_CLOSE(trueK1, values[0], 1.e-3 * trueK1);
+        CHECK_CLOSE(trueK2, values[1], 1.e-3 * trueK2);
+        CHECK(ssr < 1.e-6);
+        CHECK_EQUAL(ssr, est->getResidualSumOfSquares());
+        CHECK(est->getNumIterations() > 0);
+        CHECK_EQUAL(21 * 2, (int)est->getResiduals().size());
+    }
+
+    TEST(ACTIVE_BOUND)
+    {
+        SBMLSolver r(estimationSBML);
+        std::auto_ptr<ParameterEstimation> est(newEstimation(r, 1));
+
+        // the true k1 is above its upper bound, so the fit ends on the bound
+        est->addParameter("k1", 0.1, 0.01, 0.2);
+        est->addParameter("k2", 0.5, 0.01, 10);
+
+        double ssr = est->run();
+        vector<double> values = est->getParameterValues();
+
+        CHECK_CLOSE(0.2, values[0], 1.e-9);
+        CHECK(values[1] >= 0.01 && values[1] <= 10);
+        CHECK(ssr > 1.e-3);
+
+        // and k2 is the best fit with k1 fixed at the bound
+        SBMLSolver fixed(estimationSBML);
+        std::auto_ptr<ParameterEstimation> conditional(newEstimation(fixed, 1));
+        conditional->setCondition(0, "k1", 0.2);
+        conditional->addParameter("k2", 0.5, 0.01, 10);
+
+        double conditionalSsr = conditional->run();
+
+        CHECK_CLOSE(conditional->getParameterValues()[0], values[1], 1.e-4);
+        CHECK_CLOSE(conditionalSsr, ssr, 1.e-6 * ssr);
+    }
+
+    TEST(LOG_PARAMETERS)
+    {
+        SBMLSolver r(estimationSBML);
+        std::auto_ptr<ParameterEstimation> est(newEstimation(r, 4));
+
+        // the log scale spans several orders of magnitude, the first start
+        // is the initial value, the others random
+        est->addParameter("k1", 5.0, 1.e-3, 100, true);
+        est->addParameter("k2", 0.01, 1.e-3, 100, true);
+
+        double ssr = est->run();
+        vector<double> values = est->getParameterValues();
+
+        CHECK_CLOSE(trueK1, values[0], 1.e-3 * trueK1);
+        CHECK_CLOSE(trueK2, values[1], 1.e-3 * trueK2);
+        CHECK(ssr < 1.e-6);
+
+        ls::DoubleMatrix starts = est->getStartResults();
+        CHECK_EQUAL(4, starts.numRows());
+
+        // every start stays within the bounds
+        for (unsigned i = 0; i < starts.numRows(); ++i)
+        {
+            for (unsigned j = 0; j < 2; ++j)
+            {
+                CHECK(starts(i, j) >= 1.e-3 && starts(i, j) <= 100);
+            }
+        }
+    }
+}
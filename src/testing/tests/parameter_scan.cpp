@@ -0,0 +1,309 @@
+#include "unit_test/UnitTest++.h"
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "ParameterScan.h"
+#include "rrExecutableModel.h"
+
+#include <limits>
+#include <math.h>
+#include <memory>
+#include <sstream>
+#include <string.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+/**
+ * S1 is produced at the rate v0 and converted to S2, which decays, the
+ * steady state is S1 = v0 / k1, S2 = v0 / k2.
+ */
+static const char* scanSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"scan\">\n"
+    "    <listOfCompartments>\n"
+    "      <compartment id=\"c\" spatialDimensions=\"3\" size=\"1\" constant=\"true\"/>\n"
+    "    </listOfCompartments>\n"
+    "    <listOfSpecies>\n"
+    "      <species id=\"S1\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "      <species id=\"S2\" compartment=\"c\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>\n"
+    "    </listOfSpecies>\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"v0\" value=\"1\" constant=\"true\"/>\n"
+    "      <parameter id=\"k1\" value=\"1\" constant=\"true\"/>\n"
+    "      <parameter id=\"k2\" value=\"0.5\" constant=\"true\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfReactions>\n"
+    "      <reaction id=\"J0\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfProducts><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <ci> v0 </ci>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J1\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S1\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <listOfProducts><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfProducts>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k1 </ci><ci> S1 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "      <reaction id=\"J2\" reversible=\"false\" fast=\"false\">\n"
+    "        <listOfReactants><speciesReference species=\"S2\" stoichiometry=\"1\" constant=\"true\"/></listOfReactants>\n"
+    "        <kineticLaw><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "          <apply><times/><ci> k2 </ci><ci> S2 </ci></apply>\n"
+    "        </math></kineticLaw>\n"
+    "      </reaction>\n"
+    "    </listOfReactions>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+static vector<string> scanIds()
+{
+    vector<string> ids;
+    ids.push_back("k1");
+    ids.push_back("k2");
+    return ids;
+}
+
+static vector<string> scanSelections(bool time)
+{
+    vector<string> selections;
+    if (time)
+    {
+        selections.push_back("time");
+    }
+    selections.push_back("S1");
+    selections.push_back("S2");
+    return selections;
+}
+
+static void setScanOptions(SBMLSolver& r)
+{
+    SimulateOptions& o = r.getSimulateOptions();
+    o.start = 0;
+    o.duration = 10;
+    o.steps = 50;
+}
+
+static ParameterScan* newScan(SBMLSolver& r, const string& type, int threads)
+{
+    BasicDictionary options;
+    options.setItem("type", type);
+    options.setItem("threads", threads);
+    options.setItem("warm_start", false);
+    return new ParameterScan(&r, &options);
+}
+
+/**
+ * the result of the scan points one after the other with setValue and
+ * simulate or steadyState on the template solver, each point from the
+ * state the scan started with.
+ */
+static vector<double> serialScan(SBMLSolver& r, ParameterScan& scan)
+{
+    const vector<string> ids = scan.getParameterIds();
+    const vector<string> selections = scan.getSelections();
+    const ls::DoubleMatrix points = scan.getPoints();
+    const bool timeCourse = scan.getScanType() == ParameterScan::TIME_COURSE;
+
+    std::stringstream ss;
+    r.getModel()->saveState(ss);
+    const string initialState = ss.str();
+
+    vector<double> result;
+    for (unsigned i = 0; i < points.numRows(); ++i)
+    {
+        std::stringstream state(initialState);
+        r.getModel()->loadState(state);
+
+        for (unsigned j = 0; j < ids.size(); ++j)
+        {
+            r.setValue(ids[j], points(i, j));
+        }
+
+        if (timeCourse)
+        {
+            const ls::DoubleMatrix& m = *r.simulate();
+            for (unsigned k = 0; k < m.numRows(); ++k)
+            {
+                for (unsigned j = 0; j < m.numCols(); ++j)
+                {
+                    result.push_back(m(k, j));
+                }
+            }
+        }
+        else
+        {
+            r.steadyState();
+            for (unsigned j = 0; j < selections.size(); ++j)
+            {
+                result.push_back(r.getValue(selections[j]));
+            }
+        }
+    }
+
+    std::stringstream state(initialState);
+    r.getModel()->loadState(state);
+
+    return result;
+}
+
+static void addScanAxes(ParameterScan& scan)
+{
+    vector<double> k1, k2;
+    k1.push_back(0.5);
+    k1.push_back(1);
+    k1.push_back(2);
+    k1.push_back(4);
+    k2.push_back(0.25);
+    k2.push_back(0.5);
+    k2.push_back(1);
+
+    scan.addAxis("k1", k1);
+    scan.addAxis("k2", k2);
+}
+
+SUITE(ParameterScan)
+{
+    TEST(TIME_COURSE_MATCHES_SERIAL)
+    {
+        SBMLSolver r(scanSBML);
+        setScanOptions(r);
+        r.setSelections(scanSelections(true));
+
+        std::auto_ptr<ParameterScan> scan(newScan(r, "time_course", 4));
+        addScanAxes(*scan);
+
+        CHECK_EQUAL(12, scan->getNumPoints());
+        CHECK_EQUAL(51, scan->getNumTimePoints());
+        CHECK_EQUAL(0, scan->run());
+
+        const vector<double>& result = scan->getResult();
+        vector<double> serial = serialScan(r, *scan);
+
+        CHECK_EQUAL(scan->getResultSize(), result.size());
+        CHECK_EQUAL(result.size(), serial.size());
+
+        // the workers run the same code on clones of the same state, so the
+        // results must be identical, not just close
+        if (result.size() == serial.size() && result.size())
+        {
+            CHECK(memcmp(&result[0], &serial[0],
+                    result.size() * sizeof(double)) == 0);
+        }
+    }
+
+    TEST(TIME_COURSE_IGNORES_THINNING)
+    {
+        SBMLSolver r(scanSBML);
+        setScanOptions(r);
+        r.setSelections(scanSelections(true));
+
+        std::auto_ptr<ParameterScan> scan(newScan(r, "time_course", 2));
+        addScanAxes(*scan);
+        CHECK_EQUAL(0, scan->run());
+        vector<double> result = scan->getResult();
+
+        // the thinning of the template would drop most of the smooth time
+        // points, but every scan point keeps all of them
+        r.getSimulateOptions().thinning = SimulateOptions::THINNING_INTERPOLATION;
+        r.getSimulateOptions().thinningRelative = 1.e-2;
+
+        std::auto_ptr<ParameterScan> thinned(newScan(r, "time_course", 2));
+        addScanAxes(*thinned);
+        CHECK_EQUAL(0, thinned->run());
+
+        const vector<double>& thinnedResult = thinned->getResult();
+
+        CHECK_EQUAL(12 * 51 * 3, (int)thinnedResult.size());
+        CHECK_EQUAL(result.size(), thinnedResult.size());
+
+        if (result.size() == thinnedResult.size() && result.size())
+        {
+            CHECK(memcmp(&result[0], &thinnedResult[0],
+                    result.size() * sizeof(double)) == 0);
+        }
+
+        // and the template still thins
+        CHECK_EQUAL(SimulateOptions::THINNING_INTERPOLATION, r.getSimulateOptions().thinning);
+    }
+
+    TEST(STEADY_STATE_MATCHES_SERIAL)
+    {
+        SBMLSolver r(scanSBML);
+        r.setSteadyStateSelections(scanSelections(false));
+
+        std::auto_ptr<ParameterScan> scan(newScan(r, "steady_state", 4));
+        addScanAxes(*scan);
+
+        CHECK_EQUAL(1, scan->getNumTimePoints());
+        CHECK_EQUAL(0, scan->run());
+
+        const vector<double>& result = scan->getResult();
+        const ls::DoubleMatrix points = scan->getPoints();
+        vector<double> serial = serialScan(r, *scan);
+
+        CHECK_EQUAL(2 * points.numRows(), result.size());
+        CHECK_EQUAL(result.size(), serial.size());
+
+        for (unsigned i = 0; i < points.numRows() && 2 * i + 1 < serial.size(); ++i)
+        {
+            CHECK_CLOSE(serial[2 * i], result[2 * i], 1.e-10);
+            CHECK_CLOSE(serial[2 * i + 1], result[2 * i + 1], 1.e-10);
+
+            // v0 = 1
+            CHECK_CLOSE(1. / points(i, 0), result[2 * i], 1.e-6);
+            CHECK_CLOSE(1. / points(i, 1), result[2 * i + 1], 1.e-6);
+        }
+    }
+
+    TEST(FAILED_POINT)
+    {
+        SBMLSolver r(scanSBML);
+        setScanOptions(r);
+        r.setSelections(scanSelections(true));
+
+        // the rates of the middle point are NaN, so the integrator fails
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const double values[5][2] = {{0.5, 0.25}, {1, 0.5}, {nan, 0.5},
+                {2, 1}, {4, 1}};
+
+        ls::DoubleMatrix points(5, 2);
+        for (int i = 0; i < 5; ++i)
+        {
+            points(i, 0) = values[i][0];
+            points(i, 1) = values[i][1];
+        }
+
+        std::auto_ptr<ParameterScan> scan(newScan(r, "time_course", 2));
+        scan->setPoints(scanIds(), points);
+
+        CHECK_EQUAL(1, scan->run());
+
+        const vector<string>& errors = scan->getErrors();
+        const vector<double>& result = scan->getResult();
+        const size_t pointSize = scan->getNumTimePoints() * scan->getNumSelections();
+
+        CHECK_EQUAL(5, (int)errors.size());
+        CHECK_EQUAL(5 * pointSize, result.size());
+
+        for (int i = 0; i < 5 && errors.size() == 5
+                && result.size() == 5 * pointSize; ++i)
+        {
+            const double* out = &result[i * pointSize];
+
+            if (i == 2)
+            {
+                CHECK(!errors[i].empty());
+                CHECK(isnan(out[0]) && isnan(out[pointSize - 1]));
+                continue;
+            }
+
+            // the other points ran to the end
+            CHECK(errors[i].empty());
+            CHECK_CLOSE(10, out[(scan->getNumTimePoints() - 1) * scan->getNumSelections()], 1.e-10);
+            CHECK(!isnan(out[pointSize - 1]));
+        }
+    }
+}
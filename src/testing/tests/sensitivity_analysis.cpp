@@ -0,0 +1,163 @@
+#include "unit_test/UnitTest++.h"
+#include "SBMLSolver.h"
+#include "SBMLSolverOptions.h"
+#include "SensitivityAnalysis.h"
+
+#include <math.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+/**
+ * the Ishigami function y = sin(x1) + 7 sin(x2)^2 + 0.1 x3^4 sin(x1), and
+ * the linear function z = x1 + 2 x2 + 3 x3, as assignment rules.
+ */
+static const char* ishigamiSBML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">\n"
+    "  <model id=\"ishigami\">\n"
+    "    <listOfParameters>\n"
+    "      <parameter id=\"x1\" value=\"0\" constant=\"true\"/>\n"
+    "      <parameter id=\"x2\" value=\"0\" constant=\"true\"/>\n"
+    "      <parameter id=\"x3\" value=\"0\" constant=\"true\"/>\n"
+    "      <parameter id=\"y\" constant=\"false\"/>\n"
+    "      <parameter id=\"z\" constant=\"false\"/>\n"
+    "    </listOfParameters>\n"
+    "    <listOfRules>\n"
+    "      <assignmentRule variable=\"y\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "        <apply><plus/>\n"
+    "          <apply><sin/><ci> x1 </ci></apply>\n"
+    "          <apply><times/><cn> 7 </cn><apply><power/><apply><sin/><ci> x2 </ci></apply><cn> 2 </cn></apply></apply>\n"
+    "          <apply><times/><cn> 0.1 </cn><apply><power/><ci> x3 </ci><cn> 4 </cn></apply><apply><sin/><ci> x1 </ci></apply></apply>\n"
+    "        </apply>\n"
+    "      </math></assignmentRule>\n"
+    "      <assignmentRule variable=\"z\"><math xmlns=\"http://www.w3.org/1998/Math/MathML\">\n"
+    "        <apply><plus/>\n"
+    "          <ci> x1 </ci>\n"
+    "          <apply><times/><cn> 2 </cn><ci> x2 </ci></apply>\n"
+    "          <apply><times/><cn> 3 </cn><ci> x3 </ci></apply>\n"
+    "        </apply>\n"
+    "      </math></assignmentRule>\n"
+    "    </listOfRules>\n"
+    "  </model>\n"
+    "</sbml>\n";
+
+static void addIshigamiParameters(SensitivityAnalysis& sa)
+{
+    sa.addParameter("x1", -M_PI, M_PI);
+    sa.addParameter("x2", -M_PI, M_PI);
+    sa.addParameter("x3", -M_PI, M_PI);
+    sa.addOutput("y");
+    sa.addOutput("z");
+}
+
+static void setIshigamiOptions(SBMLSolver& r)
+{
+    SimulateOptions& o = r.getSimulateOptions();
+    o.start = 0;
+    o.duration = 1;
+    o.steps = 1;
+}
+
+SUITE(SensitivityAnalysis)
+{
+    TEST(SOBOL_INDICES)
+    {
+        SBMLSolver r(ishigamiSBML);
+        setIshigamiOptions(r);
+
+        BasicDictionary options;
+        options.setItem("method", "sobol");
+        options.setItem("samples", 1024);
+
+        SensitivityAnalysis sa(&r, &options);
+        addIshigamiParameters(sa);
+
+        CHECK_EQUAL(1024 * 5, sa.getNumEvaluations());
+
+        sa.run();
+
+        CHECK_EQUAL(0, sa.getNumFailedEvaluations());
+
+        // the analytic variances of the Ishigami function with a = 7,
+        // b = 0.1
+        const double a = 7, b = 0.1;
+        const double pi4 = pow(M_PI, 4), pi8 = pi4 * pi4;
+        const double V = a * a / 8 + b * pi4 / 5 + b * b * pi8 / 18 + 0.5;
+        const double V1 = 0.5 * (1 + b * pi4 / 5) * (1 + b * pi4 / 5);
+        const double V2 = a * a / 8;
+        const double V13 = b * b * pi8 * (1. / 18 - 1. / 50);
+
+        const double first[2][3] = {
+                {V1 / V, V2 / V, 0},
+                {1. / 14, 4. / 14, 9. / 14}};
+        const double total[2][3] = {
+                {(V1 + V13) / V, V2 / V, V13 / V},
+                {1. / 14, 4. / 14, 9. / 14}};
+
+        for (int o = 0; o < 2; ++o)
+        {
+            ls::DoubleMatrix m = sa.getSobolIndices(o);
+
+            CHECK_EQUAL(3, m.numRows());
+            CHECK_EQUAL(SensitivityAnalysis::SOBOL_COLUMNS, m.numCols());
+
+            for (int i = 0; i < 3 && m.numRows() == 3; ++i)
+            {
+                // the exact indices are within the bootstrap intervals
+                CHECK(m(i, SensitivityAnalysis::FIRST_ORDER_LOWER) <= first[o][i]);
+                CHECK(m(i, SensitivityAnalysis::FIRST_ORDER_UPPER) >= first[o][i]);
+                CHECK(m(i, SensitivityAnalysis::TOTAL_LOWER) <= total[o][i]);
+                CHECK(m(i, SensitivityAnalysis::TOTAL_UPPER) >= total[o][i]);
+
+                CHECK_CLOSE(first[o][i], m(i, SensitivityAnalysis::FIRST_ORDER), 0.05);
+                CHECK_CLOSE(total[o][i], m(i, SensitivityAnalysis::TOTAL), 0.05);
+            }
+        }
+    }
+
+    TEST(MORRIS_STATISTICS)
+    {
+        SBMLSolver r(ishigamiSBML);
+        setIshigamiOptions(r);
+
+        BasicDictionary options;
+        options.setItem("method", "morris");
+        options.setItem("trajectories", 20);
+        options.setItem("levels", 4);
+
+        SensitivityAnalysis sa(&r, &options);
+        addIshigamiParameters(sa);
+
+        CHECK_EQUAL(20 * 4, sa.getNumEvaluations());
+
+        sa.run();
+
+        CHECK_EQUAL(0, sa.getNumFailedEvaluations());
+
+        // the elementary effects of the linear function are its
+        // coefficients times the width of the range
+        ls::DoubleMatrix m = sa.getMorrisStatistics(1);
+
+        CHECK_EQUAL(3, m.numRows());
+        for (int i = 0; i < 3 && m.numRows() == 3; ++i)
+        {
+            CHECK_CLOSE((i + 1) * 2 * M_PI, m(i, SensitivityAnalysis::MU), 1.e-6);
+            CHECK_CLOSE((i + 1) * 2 * M_PI, m(i, SensitivityAnalysis::MU_STAR), 1.e-6);
+            CHECK_CLOSE(0, m(i, SensitivityAnalysis::SIGMA), 1.e-4);
+        }
+
+        CHECK(m(0, SensitivityAnalysis::MU_STAR) < m(1, SensitivityAnalysis::MU_STAR));
+        CHECK(m(1, SensitivityAnalysis::MU_STAR) < m(2, SensitivityAnalysis::MU_STAR));
+
+        // the Ishigami function is non linear in every factor, so the
+        // effects vary along the trajectories
+        m = sa.getMorrisStatistics(0);
+        for (int i = 0; i < 3 && m.numRows() == 3; ++i)
+        {
+            CHECK(m(i, SensitivityAnalysis::MU_STAR) > 1);
+            CHECK(m(i, SensitivityAnalysis::SIGMA) > 1);
+        }
+    }
+}
@@ -0,0 +1,216 @@
+#include "unit_test/UnitTest++.h"
+#include "TrajectoryFile.h"
+#include "rrUtils.h"
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace UnitTest;
+using namespace rr;
+using namespace std;
+
+extern string             gTempFolder;
+
+static string trajectoryPath(const string& name)
+{
+    return joinPath(gTempFolder, name);
+}
+
+static vector<string> trajectoryColumns()
+{
+    vector<string> columns;
+    columns.push_back("time");
+    columns.push_back("smooth");
+    columns.push_back("constant");
+    columns.push_back("step");
+    columns.push_back("special");
+    return columns;
+}
+
+/**
+ * a time column, a smooth, a constant and a step column, and a column of
+ * the values that must survive bit for bit, NaN, both zeros, infinities
+ * and denormals.
+ */
+static ls::DoubleMatrix trajectoryData(int rows)
+{
+    const double special[] = {
+            std::numeric_limits<double>::quiet_NaN(),
+            0.,
+            -0.,
+            std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::denorm_min(),
+            -1.e-300,
+            1.e300,
+            1.
+    };
+    const int numSpecial = sizeof(special) / sizeof(double);
+
+    ls::DoubleMatrix m(rows, 5);
+    for (int i = 0; i < rows; ++i)
+    {
+        double t = 0.01 * i;
+        m(i, 0) = t;
+        m(i, 1) = exp(-0.05 * t) + 0.3 * sin(t);
+        m(i, 2) = 3.7;
+        m(i, 3) = t < 0.01 * rows / 2 ? 1 : 2;
+        m(i, 4) = special[i % numSpecial];
+    }
+    return m;
+}
+
+static bool sameBits(const double* a, const double* b, size_t n)
+{
+    return n == 0 || memcmp(a, b, n * sizeof(double)) == 0;
+}
+
+static vector<char> readBytes(const string& fileName)
+{
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    return vector<char>((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+}
+
+static void writeBytes(const string& fileName, const vector<char>& bytes, size_t n)
+{
+    std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    if (n)
+    {
+        out.write(&bytes[0], n);
+    }
+}
+
+SUITE(TrajectoryFile)
+{
+    TEST(ROUND_TRIP)
+    {
+        // row counts around and between chunk sizes, which are not
+        // multiples of the default of 4096 rows
+        const int rowCounts[] = {0, 1, 2, 4095, 4097, 10001};
+        const int chunkRows[] = {0, 3, 1000};
+
+        string fileName = trajectoryPath("round_trip.rrt");
+
+        for (unsigned r = 0; r < sizeof(rowCounts) / sizeof(int); ++r)
+        {
+            for (unsigned c = 0; c < sizeof(chunkRows) / sizeof(int); ++c)
+            {
+                const int rows = rowCounts[r];
+                ls::DoubleMatrix m = trajectoryData(rows);
+
+                {
+                    // the first half row by row, the rest as a matrix
+                    TrajectoryWriter writer(fileName, trajectoryColumns(), chunkRows[c]);
+                    int half = rows / 2;
+                    for (int i = 0; i < half; ++i)
+                    {
+                        writer.write(m[i]);
+                    }
+
+                    ls::DoubleMatrix rest(rows - half, m.numCols());
+                    for (int i = half; i < rows; ++i)
+                    {
+                        for (unsigned j = 0; j < m.numCols(); ++j)
+                        {
+                            rest(i - half, j) = m(i, j);
+                        }
+                    }
+                    writer.write(rest);
+
+                    CHECK_EQUAL(rows, writer.getNumRows());
+                    writer.close();
+                }
+
+                TrajectoryReader reader(fileName);
+
+                CHECK_EQUAL(rows, reader.getNumRows());
+                CHECK_EQUAL(5, reader.getNumColumns());
+                CHECK(reader.getColumnNames() == trajectoryColumns());
+                CHECK_EQUAL(3, reader.getColumnIndex("step"));
+
+                for (int j = 0; j < reader.getNumColumns(); ++j)
+                {
+                    vector<double> expected(rows);
+                    for (int i = 0; i < rows; ++i)
+                    {
+                        expected[i] = m(i, j);
+                    }
+
+                    vector<double> column = reader.getColumn(j);
+                    CHECK_EQUAL(rows, (int)column.size());
+                    CHECK(sameBits(&expected[0], &column[0], rows));
+                }
+
+                ls::DoubleMatrix read = reader.getMatrix();
+                CHECK_EQUAL(rows, (int)read.numRows());
+                CHECK(sameBits(m.getArray(), read.getArray(), rows * m.numCols()));
+            }
+        }
+
+        remove(fileName.c_str());
+    }
+
+    TEST(COMPRESSION)
+    {
+        // the constant and the step columns predict exactly, and cost a
+        // few bits per value
+        const int rows = 10001;
+        ls::DoubleMatrix m = trajectoryData(rows);
+
+        string fileName = trajectoryPath("compression.rrt");
+
+        for (int j = 2; j <= 3; ++j)
+        {
+            {
+                TrajectoryWriter writer(fileName, vector<string>(1, "x"));
+                for (int i = 0; i < rows; ++i)
+                {
+                    writer.write(&m(i, j));
+                }
+                writer.close();
+            }
+
+            size_t bytes = readBytes(fileName).size();
+            CHECK(bytes * 8 < 2 * rows);
+        }
+
+        remove(fileName.c_str());
+    }
+
+    TEST(TRUNCATED_FILES)
+    {
+        string fileName = trajectoryPath("complete.rrt");
+        string truncated = trajectoryPath("truncated.rrt");
+
+        {
+            TrajectoryWriter writer(fileName, trajectoryColumns(), 3);
+            writer.write(trajectoryData(10));
+            writer.close();
+        }
+
+        vector<char> bytes = readBytes(fileName);
+        CHECK(bytes.size() > 0);
+
+        // every proper prefix of the file is rejected
+        for (size_t n = 0; n < bytes.size(); ++n)
+        {
+            writeBytes(truncated, bytes, n);
+            CHECK_THROW(TrajectoryReader reader(truncated), std::runtime_error);
+        }
+
+        // and the complete file is read
+        writeBytes(truncated, bytes, bytes.size());
+        {
+            TrajectoryReader reader(truncated);
+            CHECK_EQUAL(10, reader.getNumRows());
+        }
+
+        remove(fileName.c_str());
+        remove(truncated.c_str());
+    }
+}
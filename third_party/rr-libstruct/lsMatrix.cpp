@@ -9,6 +9,12 @@
 #include "lsMatrix.h"
 #include "lsUtils.h"
 
+extern "C"
+{
+#include "f2c.h"
+#include "clapack.h"
+}
+
 //---------------------------------------------------------------------------
 namespace ls
 {
@@ -128,16 +134,49 @@ template<typename T> T** Matrix<T>::get2DMatrix(int &nRows, int &nCols)
 }
 
 
+// ******************************************************************** }
+// Row major products through the BLAS gemm routines. A row major matrix
+// is the column major transpose, so C = A B is computed as C' = B' A'.
+// ******************************************************************** }
+static void gemm(const double* a, const double* b, double* c,
+        integer m, integer n, integer k)
+{
+    char trans = 'N';
+    doublereal alpha = 1.0;
+    doublereal beta = 0.0;
+    integer ldb = n;
+    integer lda = k;
+    integer ldc = n;
+
+    dgemm_(&trans, &trans, &n, &m, &k, &alpha, const_cast<doublereal*>(b), &ldb,
+            const_cast<doublereal*>(a), &lda, &beta, c, &ldc);
+}
+
+static void gemm(const Complex* a, const Complex* b, Complex* c,
+        integer m, integer n, integer k)
+{
+    char trans = 'N';
+    doublecomplex alpha = {1.0, 0.0};
+    doublecomplex beta = {0.0, 0.0};
+    integer ldb = n;
+    integer lda = k;
+    integer ldc = n;
+
+    // std::complex<double> has the layout of doublecomplex
+    zgemm_(&trans, &trans, &n, &m, &k, &alpha,
+            reinterpret_cast<doublecomplex*>(const_cast<Complex*>(b)), &ldb,
+            reinterpret_cast<doublecomplex*>(const_cast<Complex*>(a)), &lda,
+            &beta, reinterpret_cast<doublecomplex*>(c), &ldc);
+}
+
 // ******************************************************************** }
 // Multiply matrix 'm1' by 'm2' - returns a DoubleMatrix
 //                                                                      }
 // Usage:  A = mult (A1, A2); multiply A1 by A2 giving A                  }
 //                                                                      }
 // ******************************************************************** }
-ls::DoubleMatrix mult(ls::DoubleMatrix& m1, ls::DoubleMatrix& m2)
+ls::DoubleMatrix mult(const ls::DoubleMatrix& m1, const ls::DoubleMatrix& m2)
 {
-    ls::DoubleMatrix result(0,0);
-
     //  Check dimensions
     unsigned int m1_nRows = m1.numRows();
     unsigned int m2_nRows = m2.numRows();
@@ -156,19 +195,8 @@ ls::DoubleMatrix mult(ls::DoubleMatrix& m1, ls::DoubleMatrix& m2)
 
     if (m1_nColumns == m2_nRows)
     {
-        result.resize(m1_nRows, m2_nColumns);
-        for (unsigned int row = 0; row < result.numRows(); row++)
-        {
-            for (unsigned int col = 0; col < m2_nColumns; col++)
-            {
-                double sum = 0.0;
-                for (unsigned int k = 0; k < m1_nColumns; k++)
-                {
-                    sum = sum + (m1[row][k] * m2[k][col]);
-                }
-                result[row][col] = sum;
-            }
-        }
+        ls::DoubleMatrix result(m1_nRows, m2_nColumns);
+        gemm(m1[0], m2[0], result[0], m1_nRows, m2_nColumns, m1_nColumns);
         return result;
     }
 
@@ -182,7 +210,7 @@ ls::DoubleMatrix mult(ls::DoubleMatrix& m1, ls::DoubleMatrix& m2)
 
 //Double matrix is a special case of a complex matrix for which the imag part is all zero..
 //so it makes sense that return value is a Double matrix..
-DoubleMatrix mult(ComplexMatrix& m1, DoubleMatrix& m2)
+DoubleMatrix mult(const ComplexMatrix& m1, const DoubleMatrix& m2)
 {
     //  Check dimensions
     unsigned int m1_nRows = m1.numRows();
@@ -200,21 +228,11 @@ DoubleMatrix mult(ComplexMatrix& m1, DoubleMatrix& m2)
         return m2;
     }
 
-    DoubleMatrix result(m1_nRows, m2_nColumns);
     if (m1_nColumns == m2_nRows)
     {
-        for (unsigned int row = 0; row < result.numRows(); row++)
-        {
-            for (unsigned int col = 0; col < m2_nColumns; col++)
-            {
-                double sum = 0.0;
-                for (unsigned int k = 0; k < m1_nColumns; k++)
-                {
-                    sum = sum + (real(m1[row][k]) * m2[k][col]);
-                }
-                result[row][col] = sum;
-            }
-        }
+        DoubleMatrix result(m1_nRows, m2_nColumns);
+        DoubleMatrix re = real(m1);
+        gemm(re[0], m2[0], result[0], m1_nRows, m2_nColumns, m1_nColumns);
         return result;
     }
 
@@ -226,7 +244,7 @@ DoubleMatrix mult(ComplexMatrix& m1, DoubleMatrix& m2)
     throw ("Incompatible matrix operands to multiply");
 }
 
-DoubleMatrix mult(DoubleMatrix& m2, ComplexMatrix& m1)
+DoubleMatrix mult(const DoubleMatrix& m2, const ComplexMatrix& m1)
 {
     //  Check dimensions
     unsigned int m1_nRows = m1.numRows();
@@ -244,21 +262,11 @@ DoubleMatrix mult(DoubleMatrix& m2, ComplexMatrix& m1)
         return m2;
     }
 
-    DoubleMatrix result(m1_nRows, m2_nColumns);
     if (m1_nColumns == m2_nRows)
     {
-        for (unsigned int row = 0; row < result.numRows(); row++)
-        {
-            for (unsigned int col = 0; col < m2_nColumns; col++)
-            {
-                double sum = 0.0;
-                for (unsigned int k = 0; k < m1_nColumns; k++)
-                {
-                    sum = sum + (real(m1[row][k]) * m2[k][col]);
-                }
-                result[row][col] = sum;
-            }
-        }
+        DoubleMatrix result(m1_nRows, m2_nColumns);
+        DoubleMatrix re = real(m1);
+        gemm(re[0], m2[0], result[0], m1_nRows, m2_nColumns, m1_nColumns);
         return result;
     }
 
@@ -311,31 +319,19 @@ bool sameDimensions(ComplexMatrix& x, ComplexMatrix& y)
     return ((x.RSize() == y.RSize()) && (x.CSize() == y.CSize())) ? true : false;
 }
 
-ls::ComplexMatrix mult(ls::ComplexMatrix& m1, ls::ComplexMatrix& m2)
+ls::ComplexMatrix mult(const ls::ComplexMatrix& m1, const ls::ComplexMatrix& m2)
 {
     if(m1.CSize() != m2.RSize())
     {
         throw("Matrix product not defined, incompatible sizes..\n");
-      }
+    }
 
-      ComplexMatrix temp(m1.RSize(), m2.CSize());
-      Complex tempVal(0,0);
-      for(int row1 = 0; row1 < m1.RSize(); row1++)
+    ComplexMatrix temp(m1.RSize(), m2.CSize());
+    if (temp.size() && m1.CSize())
     {
-        for(int rescol = 0; rescol < m2.CSize(); rescol++)
-        {
-              for(int col1 = 0; col1 < m1.CSize(); col1++)
-            {
-                Complex val1 = m1(row1,col1);
-                Complex val2 = m2(col1,rescol);
-                Complex test = val1*val2;
-                tempVal = test + tempVal;
-              }
-              temp(row1,rescol) = tempVal;
-              tempVal = Complex(0,0);
-        }
-      }
-      return temp;
+        gemm(m1[0], m2[0], temp[0], m1.RSize(), m2.CSize(), m1.CSize());
+    }
+    return temp;
 }
 
 
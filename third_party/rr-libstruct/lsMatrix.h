@@ -12,8 +12,16 @@
 #include <ostream>
 #include <complex>
 #include <vector>
+#include <algorithm>
 #include "lsExporter.h"
 
+/**
+ * rvalue references are available, matrices returned by value are moved
+ * instead of copied.
+ */
+#if !defined(SWIG) && ((__cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1600))
+#define LS_HAS_MOVE
+#endif
 
 namespace ls
 {
@@ -48,6 +56,17 @@ public:
      */
     Matrix(const Matrix<Complex>& src, bool real = true);
 
+#ifdef LS_HAS_MOVE
+    /**
+     * move constructor, takes the data of src, which is left empty.
+     */
+    Matrix(Matrix<T>&& src) :
+        _Rows(0), _Cols(0), _Array(NULL)
+    {
+        swap(src);
+    }
+#endif
+
     /**
      * Constructor taking a matrix mapped to a vector and reconstructing the 2D form
      */
@@ -114,6 +133,19 @@ public:
      */
     void swapCols(unsigned int col1, unsigned int col2);
 
+    /**
+     * exchange the contents (data, dimensions and names) of this matrix
+     * with another, without copying the data.
+     */
+    void swap(Matrix<T>& other)
+    {
+        std::swap(_Rows, other._Rows);
+        std::swap(_Cols, other._Cols);
+        std::swap(_Array, other._Array);
+        colNames.swap(other.colNames);
+        rowNames.swap(other.rowNames);
+    }
+
     /**
      * resizes the matrix to the given number of rows and columns
      */
@@ -131,6 +163,22 @@ public:
      */
     Matrix<T>& operator =(const Matrix<T>& rhs);
 
+#ifdef LS_HAS_MOVE
+    /**
+     * move assignment, takes the data of rhs, which is left empty.
+     */
+    Matrix<T>& operator =(Matrix<T>&& rhs)
+    {
+        if (this != &rhs)
+        {
+            Matrix<T> tmp;
+            tmp.swap(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+#endif
+
     /**
      * scalar assignment operator
      */
@@ -267,12 +315,12 @@ typedef Matrix< Complex >           ComplexMatrix;
 LIB_EXTERN DoubleMatrix             real(const ComplexMatrix& m2);               //Return real part of complex matrix
 LIB_EXTERN DoubleMatrix             imag(const ComplexMatrix& m2);               //Return imag part of complex matrix
 
-LIB_EXTERN DoubleMatrix             mult(DoubleMatrix& m1, DoubleMatrix& m2);
-LIB_EXTERN DoubleMatrix             mult(ComplexMatrix& m1, DoubleMatrix& m2);
-LIB_EXTERN DoubleMatrix             mult(DoubleMatrix& m1, ComplexMatrix& m2);
+LIB_EXTERN DoubleMatrix             mult(const DoubleMatrix& m1, const DoubleMatrix& m2);
+LIB_EXTERN DoubleMatrix             mult(const ComplexMatrix& m1, const DoubleMatrix& m2);
+LIB_EXTERN DoubleMatrix             mult(const DoubleMatrix& m1, const ComplexMatrix& m2);
 
 LIB_EXTERN ComplexMatrix             subtract(ComplexMatrix& x, ComplexMatrix& y);
-LIB_EXTERN ComplexMatrix               mult(ComplexMatrix& m1, ComplexMatrix& m2);
+LIB_EXTERN ComplexMatrix               mult(const ComplexMatrix& m1, const ComplexMatrix& m2);
 LIB_EXTERN bool                     sameDimensions(ComplexMatrix& x, ComplexMatrix& y);
 
 
@@ -697,7 +745,7 @@ const T& Matrix<T>::Element(const unsigned int & row, const unsigned int & col)
 }
 
 template<class T>
-const Matrix<T> operator*(Matrix<T>& lhs, const double& rhs)
+Matrix<T> operator*(const Matrix<T>& lhs, const double& rhs)
 {
     Matrix<T> result(lhs.RSize(), lhs.CSize());
     for(unsigned int i = 0; i < lhs.RSize(); i++)
@@ -44,6 +44,7 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <stdexcept>
 #include "SBMLSolver.h"
 #include <SBMLSolverOptions.h>
 #include "rrExecutableModel.h"
@@ -624,6 +625,34 @@ RRCDataPtr rrcCallConv getSimulationResult(RRHandle handle)
     catch_ptr_macro
 }
 
+bool rrcCallConv getSimulateResultSize(RRHandle handle, int* rows, int* cols)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        const SimulateOptions& opt = rri->getSimulateOptions();
+
+        *rows = (opt.integratorFlags & Integrator::VARIABLE_STEP) ? -1 : opt.steps + 1;
+        *cols = rri->getSelections().size();
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv simulateInto(RRHandle handle, double* buffer, int size, int* rows, int* cols)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        return copyMatrix(*rri->simulate(), buffer, size, rows, cols);
+    catch_bool_macro
+}
+
+bool rrcCallConv getSimulationResultInto(RRHandle handle, double* buffer, int size, int* rows, int* cols)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        return copyMatrix(*rri->getSimulationData(), buffer, size, rows, cols);
+    catch_bool_macro
+}
+
 
 RRStringArrayPtr rrcCallConv getReactionIds(RRHandle handle)
 {
@@ -707,6 +736,231 @@ bool rrcCallConv setValue(RRHandle handle, const char* symbolId, const double va
     catch_bool_macro
 }
 
+/**
+ * the model of a roadrunner instance, throws if no model is loaded.
+ */
+static ExecutableModel* getModelOrThrow(SBMLSolver* rri)
+{
+    ExecutableModel* model = rri->getModel();
+    if(!model)
+    {
+        throw CoreException(gEmptyModelMessage);
+    }
+    return model;
+}
+
+/**
+ * the model getters return NaN for an invalid index, so check the
+ * indices before calling them.
+ */
+static void checkIndices(int len, const int* indices, int count, const char* what)
+{
+    for(int i = 0; i < len; ++i)
+    {
+        int j = indices ? indices[i] : i;
+        if(j < 0 || j >= count)
+        {
+            stringstream msg;
+            msg << what << " index " << j << " out of range, the model has "
+                << count << " " << what << "s";
+            throw std::out_of_range(msg.str());
+        }
+    }
+}
+
+bool rrcCallConv getValuesInto(RRHandle handle, int count, const char** symbolIds, double* values)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        for(int i = 0; i < count; ++i)
+        {
+            values[i] = rri->getValue(symbolIds[i]);
+        }
+        return true;
+    catch_bool_macro
+}
+
+int rrcCallConv getSelectedValuesInto(RRHandle handle, double* values, int size)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        const vector<SelectionRecord>& selections = rri->getSelections();
+        int n = selections.size();
+
+        if(values && size >= n)
+        {
+            for(int i = 0; i < n; ++i)
+            {
+                values[i] = rri->getValue(selections[i]);
+            }
+        }
+        return n;
+    catch_int_macro
+}
+
+int rrcCallConv getFloatingSpeciesConcentrationsInto(RRHandle handle, double* values, int size)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        int n = model->getNumFloatingSpecies();
+
+        if(values && size >= n)
+        {
+            model->getFloatingSpeciesConcentrations(n, 0, values);
+        }
+        return n;
+    catch_int_macro
+}
+
+int rrcCallConv getBoundarySpeciesConcentrationsInto(RRHandle handle, double* values, int size)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        int n = model->getNumBoundarySpecies();
+
+        if(values && size >= n)
+        {
+            model->getBoundarySpeciesConcentrations(n, 0, values);
+        }
+        return n;
+    catch_int_macro
+}
+
+int rrcCallConv getGlobalParameterValuesInto(RRHandle handle, double* values, int size)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        int n = model->getNumGlobalParameters();
+
+        if(values && size >= n)
+        {
+            model->getGlobalParameterValues(n, 0, values);
+        }
+        return n;
+    catch_int_macro
+}
+
+int rrcCallConv getReactionRatesInto(RRHandle handle, double* values, int size)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        int n = model->getNumReactions();
+
+        if(values && size >= n)
+        {
+            model->getReactionRates(n, 0, values);
+        }
+        return n;
+    catch_int_macro
+}
+
+bool rrcCallConv getFloatingSpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumFloatingSpecies(), "floating species");
+        model->getFloatingSpeciesConcentrations(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv setFloatingSpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, const double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumFloatingSpecies(), "floating species");
+        model->setFloatingSpeciesConcentrations(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv getBoundarySpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumBoundarySpecies(), "boundary species");
+        model->getBoundarySpeciesConcentrations(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv setBoundarySpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, const double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumBoundarySpecies(), "boundary species");
+        model->setBoundarySpeciesConcentrations(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv getGlobalParameterValuesByIndices(RRHandle handle, int len, const int* indices, double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumGlobalParameters(), "global parameter");
+        model->getGlobalParameterValues(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv setGlobalParameterValuesByIndices(RRHandle handle, int len, const int* indices, const double* values)
+{
+    start_try
+        ExecutableModel* model = getModelOrThrow(castToRoadRunner(handle));
+        checkIndices(len, indices, model->getNumGlobalParameters(), "global parameter");
+        model->setGlobalParameterValues(len, indices, values);
+        return true;
+    catch_bool_macro
+}
+
+RRSelectionHandle rrcCallConv resolveSelection(RRHandle handle, const char* symbolId)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        return new SelectionRecord(rri->createSelection(symbolId));
+    catch_ptr_macro
+}
+
+bool rrcCallConv freeSelection(RRSelectionHandle selection)
+{
+    start_try
+        delete static_cast<SelectionRecord*>(selection);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv getSelectionValues(RRHandle handle, int n, const RRSelectionHandle* selections, double* values)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        for(int i = 0; i < n; ++i)
+        {
+            values[i] = rri->getValue(*static_cast<const SelectionRecord*>(selections[i]));
+        }
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv setSelectionValues(RRHandle handle, int n, const RRSelectionHandle* selections, const double* values)
+{
+    start_try
+        SBMLSolver* rri = castToRoadRunner(handle);
+        vector<SelectionRecord> records;
+        for(int i = 0; i < n; ++i)
+        {
+            records.push_back(*static_cast<const SelectionRecord*>(selections[i]));
+        }
+
+        // resets the model at most once
+        if(n > 0)
+        {
+            rri->setValues(&records[0], n, values);
+        }
+        return true;
+    catch_bool_macro
+}
+
 RRDoubleMatrixPtr rrcCallConv getStoichiometryMatrix(RRHandle handle)
 {
     start_try
@@ -574,6 +574,69 @@ C_DECL_SPEC RRCDataPtr rrcCallConv getSimulationResult(RRHandle handle);
 */
 C_DECL_SPEC RRCDataPtr rrcCallConv simulateEx(RRHandle handle, const double timeStart, const double timeEnd, const int numberOfPoints);
 
+/*!
+ \brief Get the size of the result the next simulate call will produce with
+ the current settings, use it to allocate the buffer passed to simulateInto.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] rows The number of points. Variable step simulations produce an
+ unknown number of points, rows is then set to -1. If output thinning is on
+ (see the thinning simulate option), rows is the upper bound steps + 1, and
+ simulateInto sets its rows to the number of rows that were kept.
+ \param[out] cols The number of columns, i.e. the size of the time course selection list
+ \return Returns true if successful
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv getSimulateResultSize(RRHandle handle, int* rows, int* cols);
+
+/*!
+ \brief Carry out a time-course simulation, and copy the result into a caller
+ owned buffer.
+
+ Unlike simulate, this does not allocate anything, so it is suitable for
+ calling repeatedly in a loop with the same buffer.
+
+ Example:
+ \code
+    int rows, cols;
+    getSimulateResultSize (rrHandle, &rows, &cols);
+    int size = rows * cols;
+    double* data = (double*) malloc (size * sizeof (double));
+
+    for (i = 0; i < n; ++i)
+    {
+        reset (rrHandle);
+        setValue (rrHandle, "k1", k1[i]);
+        simulateInto (rrHandle, data, size, &rows, &cols);
+    }
+ \endcode
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] buffer The result is written in row major order, one row per time point
+ \param[in] size The number of doubles the buffer can hold
+ \param[out] rows The number of rows of the result, may be NULL
+ \param[out] cols The number of columns of the result, may be NULL
+ \return Returns true if successful. If the buffer is too small, false is
+ returned and rows and cols are set to the required size, the result can then
+ be retrieved with getSimulationResultInto.
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv simulateInto(RRHandle handle, double* buffer, int size, int* rows, int* cols);
+
+/*!
+ \brief Copy the result of the last simulation into a caller owned buffer.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] buffer The result is written in row major order, one row per time point
+ \param[in] size The number of doubles the buffer can hold
+ \param[out] rows The number of rows of the result, may be NULL
+ \param[out] cols The number of columns of the result, may be NULL
+ \return Returns true if successful. If the buffer is too small, false is
+ returned and rows and cols are set to the required size.
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv getSimulationResultInto(RRHandle handle, double* buffer, int size, int* rows, int* cols);
+
 /*!
  \brief Carry out a one step integration of the model
 
@@ -715,6 +778,237 @@ C_DECL_SPEC bool rrcCallConv getValue(RRHandle handle, const char* symbolId, dou
 */
 C_DECL_SPEC bool rrcCallConv setValue(RRHandle handle, const char* symbolId, const double value);
 
+/*!
+ \brief Get the values of several symbols with one call
+
+ Example:
+ \code
+    const char* ids[] = {"S1", "S2", "J1"};
+    double values[3];
+    status = getValuesInto (rrHandle, 3, ids, values);
+ \endcode
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] count The number of symbols
+ \param[in] symbolIds The symbols, any symbol accepted by getValue
+ \param[out] values Receives the count values
+ \return Returns true if successful
+ \ingroup state
+*/
+C_DECL_SPEC bool rrcCallConv getValuesInto(RRHandle handle, int count, const char** symbolIds, double* values);
+
+/*!
+ \brief Get the current values of the time course selection list into a caller
+ owned buffer. The selections are resolved when the selection list is set, so
+ this does no string lookups.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] values Receives the values, may be NULL to query the size
+ \param[in] size The number of doubles the values buffer can hold
+ \return Returns the number of selections, -1 if an error occurred. If this is
+ larger than size, nothing is written.
+ \ingroup state
+*/
+C_DECL_SPEC int rrcCallConv getSelectedValuesInto(RRHandle handle, double* values, int size);
+
+/*!
+ \brief Get the concentrations of all floating species into a caller owned buffer
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] values Receives the concentrations in the order of getFloatingSpeciesIds,
+ may be NULL to query the size
+ \param[in] size The number of doubles the values buffer can hold
+ \return Returns the number of floating species, -1 if an error occurred. If this is
+ larger than size, nothing is written.
+ \ingroup floating
+*/
+C_DECL_SPEC int rrcCallConv getFloatingSpeciesConcentrationsInto(RRHandle handle, double* values, int size);
+
+/*!
+ \brief Get the concentrations of all boundary species into a caller owned buffer
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] values Receives the concentrations in the order of getBoundarySpeciesIds,
+ may be NULL to query the size
+ \param[in] size The number of doubles the values buffer can hold
+ \return Returns the number of boundary species, -1 if an error occurred. If this is
+ larger than size, nothing is written.
+ \ingroup boundary
+*/
+C_DECL_SPEC int rrcCallConv getBoundarySpeciesConcentrationsInto(RRHandle handle, double* values, int size);
+
+/*!
+ \brief Get the values of all global parameters into a caller owned buffer
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] values Receives the values in the order of getGlobalParameterIds,
+ may be NULL to query the size
+ \param[in] size The number of doubles the values buffer can hold
+ \return Returns the number of global parameters, -1 if an error occurred. If this is
+ larger than size, nothing is written.
+ \ingroup parameters
+*/
+C_DECL_SPEC int rrcCallConv getGlobalParameterValuesInto(RRHandle handle, double* values, int size);
+
+/*!
+ \brief Get the rates of all reactions into a caller owned buffer
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[out] values Receives the rates in the order of getReactionIds,
+ may be NULL to query the size
+ \param[in] size The number of doubles the values buffer can hold
+ \return Returns the number of reactions, -1 if an error occurred. If this is
+ larger than size, nothing is written.
+ \ingroup reaction
+*/
+C_DECL_SPEC int rrcCallConv getReactionRatesInto(RRHandle handle, double* values, int size);
+
+/*!
+ \brief Get the concentrations of a set of floating species by index
+
+ The indices are positions in getFloatingSpeciesIds, they can be looked up once
+ and reused, so no string lookups are done per call.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The species indices, if NULL, the first len species are used
+ \param[out] values Receives the len concentrations
+ \return Returns true if successful, false if an index is out of range
+ \ingroup floating
+*/
+C_DECL_SPEC bool rrcCallConv getFloatingSpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, double* values);
+
+/*!
+ \brief Set the concentrations of a set of floating species by index
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The species indices, if NULL, the first len species are used
+ \param[in] values The len concentrations
+ \return Returns true if successful, false if an index is out of range
+ \ingroup floating
+*/
+C_DECL_SPEC bool rrcCallConv setFloatingSpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, const double* values);
+
+/*!
+ \brief Get the concentrations of a set of boundary species by index
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The species indices, if NULL, the first len species are used
+ \param[out] values Receives the len concentrations
+ \return Returns true if successful, false if an index is out of range
+ \ingroup boundary
+*/
+C_DECL_SPEC bool rrcCallConv getBoundarySpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, double* values);
+
+/*!
+ \brief Set the concentrations of a set of boundary species by index
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The species indices, if NULL, the first len species are used
+ \param[in] values The len concentrations
+ \return Returns true if successful, false if an index is out of range
+ \ingroup boundary
+*/
+C_DECL_SPEC bool rrcCallConv setBoundarySpeciesConcentrationsByIndices(RRHandle handle, int len, const int* indices, const double* values);
+
+/*!
+ \brief Get the values of a set of global parameters by index
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The parameter indices, if NULL, the first len parameters are used
+ \param[out] values Receives the len values
+ \return Returns true if successful, false if an index is out of range
+ \ingroup parameters
+*/
+C_DECL_SPEC bool rrcCallConv getGlobalParameterValuesByIndices(RRHandle handle, int len, const int* indices, double* values);
+
+/*!
+ \brief Set the values of a set of global parameters by index
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] len The number of indices
+ \param[in] indices The parameter indices, if NULL, the first len parameters are used
+ \param[in] values The len values
+ \return Returns true if successful, false if an index is out of range
+ \ingroup parameters
+*/
+C_DECL_SPEC bool rrcCallConv setGlobalParameterValuesByIndices(RRHandle handle, int len, const int* indices, const double* values);
+
+/*!
+ \brief Resolve a symbol to a selection handle
+
+ The handle holds the element type and model index of the symbol, so
+ getting or setting values through it does no string lookups. Resolve the
+ symbols once, and use getSelectionValues and setSelectionValues in loops.
+ Handles are bound to the currently loaded model, they must be resolved
+ again after a new model is loaded.
+
+ Example:
+ \code
+    RRSelectionHandle sels[2];
+    double values[2];
+    sels[0] = resolveSelection (rrHandle, "[S1]");
+    sels[1] = resolveSelection (rrHandle, "k1");
+
+    for (i = 0; i < n; ++i)
+    {
+        oneStep (rrHandle, t, h, &t);
+        getSelectionValues (rrHandle, 2, sels, values);
+        values[1] = controller (values[0]);
+        setSelectionValues (rrHandle, 1, &sels[1], &values[1]);
+    }
+
+    freeSelection (sels[0]);
+    freeSelection (sels[1]);
+ \endcode
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] symbolId Any symbol accepted by getValue
+ \return Returns a selection handle, or NULL if the symbol is not valid. It
+ must be freed with freeSelection.
+ \ingroup state
+*/
+C_DECL_SPEC RRSelectionHandle rrcCallConv resolveSelection(RRHandle handle, const char* symbolId);
+
+/*!
+ \brief Free a selection handle created with resolveSelection
+
+ \param[in] selection The selection handle
+ \return Returns true if successful
+ \ingroup freeRoutines
+*/
+C_DECL_SPEC bool rrcCallConv freeSelection(RRSelectionHandle selection);
+
+/*!
+ \brief Get the values of a set of resolved selections
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] n The number of selections
+ \param[in] selections n selection handles created with resolveSelection
+ \param[out] values Receives the n values
+ \return Returns true if successful
+ \ingroup state
+*/
+C_DECL_SPEC bool rrcCallConv getSelectionValues(RRHandle handle, int n, const RRSelectionHandle* selections, double* values);
+
+/*!
+ \brief Set the values of a set of resolved selections
+
+ Setting an initial amount or concentration resets the model, same as setValue.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] n The number of selections
+ \param[in] selections n selection handles created with resolveSelection
+ \param[in] values The n values
+ \return Returns true if successful
+ \ingroup state
+*/
+C_DECL_SPEC bool rrcCallConv setSelectionValues(RRHandle handle, int n, const RRSelectionHandle* selections, const double* values);
+
 
 /*!
  \brief Retrieve in a vector the concentrations for all the floating species
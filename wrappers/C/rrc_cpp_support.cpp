@@ -3,6 +3,7 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <cstring>
 #include "rrException.h"
 #include "rrc_cpp_support.h"
 #include "rrc_types.h"
@@ -340,15 +341,43 @@ RRCDataPtr createRRCData(const SBMLSolver& tmp)
     int size = rrCData->RSize*rrCData->CSize;
     rrCData->Data = new double[size];
 
-    int index = 0;
-    for(int row = 0; row < rrCData->RSize; row++)
+    copyMatrix(result, rrCData->Data, size, 0, 0);
+    return rrCData;
+}
+
+bool copyMatrix(const ls::DoubleMatrix& tmp, double* buffer, int size,
+        int* rows, int* cols)
+{
+    // TODO make ls::Matrix const correct
+    ls::DoubleMatrix& mat = const_cast<ls::DoubleMatrix&>(tmp);
+
+    const int nRows = mat.RSize();
+    const int nCols = mat.CSize();
+
+    if(rows)
     {
-        for(int col = 0; col < rrCData->CSize; col++)
-        {
-            rrCData->Data[index++] = result(row, col);
-        }
+        *rows = nRows;
     }
-    return rrCData;
+
+    if(cols)
+    {
+        *cols = nCols;
+    }
+
+    if(size < nRows * nCols || (nRows * nCols && !buffer))
+    {
+        std::stringstream msg;
+        msg << "buffer of size " << size << " is too small for a " << nRows
+            << " x " << nCols << " matrix";
+        throw Exception(msg.str());
+    }
+
+    // ls::Matrix is stored in row major order, same as the C API.
+    if(nRows * nCols)
+    {
+        memcpy(buffer, mat.GetPointer(), nRows * nCols * sizeof(double));
+    }
+    return true;
 }
 
 }
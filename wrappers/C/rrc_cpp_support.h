@@ -163,6 +163,20 @@ C_DECL_SPEC RRListPtr                      createArrayList(const ArrayList& list
  */
 C_DECL_SPEC RRCDataPtr    createRRCData(const rr::SBMLSolver&);
 
+/*!
+ \brief Copy a ls::DoubleMatrix in row major order into a caller owned buffer
+ \param[in] mat  Input DoubleMatrix
+ \param[out] buffer Destination buffer
+ \param[in] size Number of doubles the buffer can hold
+ \param[out] rows Number of rows of the matrix, may be NULL
+ \param[out] cols Number of columns of the matrix, may be NULL
+ \return True if the matrix was copied, throws if the buffer is too small.
+ The dimensions are always stored, so they can be used to size the buffer.
+ \ingroup cpp_support
+*/
+C_DECL_SPEC bool          copyMatrix(const ls::DoubleMatrix& mat, double* buffer, int size,
+                                     int* rows, int* cols);
+
 }
 #endif
 
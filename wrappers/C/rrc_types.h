@@ -48,6 +48,7 @@ namespace rrc { extern "C" {
 
 /*!@brief Void pointer to a RoadRunner instance */
 typedef void* RRHandle; /*! Void pointer to a RoadRunner instance */
+typedef void* RRSelectionHandle; /*! Void pointer to a resolved selection */
 
 
 // ===================================== C TYPES =====================================
@@ -360,6 +360,16 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, uint32_t flags)
         Py_CLEAR(list);
         npy_intp dims[] = {rows};
 
+        if (!(flags & SimulateOptions::COPY_RESULT) && mData) {
+            // a row major matrix has the same layout as an array of records
+            // with one f8 field per column, so the data can be wrapped.
+            // steals a reference to descr
+            PyObject *pyres = PyArray_NewFromDescr(&PyArray_Type, descr, 1, dims,
+                    NULL, mData, NPY_CARRAY, NULL);
+            VERIFY_PYARRAY(pyres);
+            return pyres;
+        }
+
         // steals a reference to descr
         PyObject *pyres = PyArray_SimpleNewFromDescr(1, dims,  descr);
         VERIFY_PYARRAY(pyres);
@@ -437,6 +447,46 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, uint32_t flags)
 }
 
 
+static const char* doubleMatrixCapsuleName = "rr.DoubleMatrix";
+
+static void doublematrix_capsule_destructor(PyObject* capsule)
+{
+    delete static_cast<ls::DoubleMatrix*>(
+            PyCapsule_GetPointer(capsule, doubleMatrixCapsuleName));
+}
+
+PyObject* doublematrix_to_py_steal(ls::DoubleMatrix* mat, uint32_t flags)
+{
+    // move the buffer into a heap matrix that lives as long as the array
+    ls::DoubleMatrix *owned = new ls::DoubleMatrix();
+    owned->swap(*mat);
+
+    PyObject *pArray = doublematrix_to_py(owned, flags & ~SimulateOptions::COPY_RESULT);
+
+    if (pArray == NULL || pArray == Py_None) {
+        delete owned;
+        return pArray;
+    }
+
+    PyObject *capsule = PyCapsule_New(owned, doubleMatrixCapsuleName,
+            doublematrix_capsule_destructor);
+
+    if (capsule == NULL) {
+        Py_DECREF(pArray);
+        delete owned;
+        return NULL;
+    }
+
+    // steals the capsule reference, also on failure.
+    if (PyArray_SetBaseObject((PyArrayObject*)pArray, capsule) < 0) {
+        Py_DECREF(pArray);
+        return NULL;
+    }
+
+    return pArray;
+}
+
+
 struct NamedArrayObject {
     PyArrayObject array;
     PyObject *rowNames;
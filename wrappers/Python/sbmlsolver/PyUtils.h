@@ -38,6 +38,15 @@ PyObject *dictionary_contains(const Dictionary* dict, const char* key);
 
 PyObject *doublematrix_to_py(const ls::DoubleMatrix* mat, uint32_t flags);
 
+/**
+ * Create a numpy array from a matrix without copying the data.
+ *
+ * The data buffer is moved out of mat into a heap allocated matrix that is
+ * owned by the numpy array (through its base object) and freed with it,
+ * mat is left empty.
+ */
+PyObject *doublematrix_to_py_steal(ls::DoubleMatrix* mat, uint32_t flags);
+
 PyObject *stringvector_to_py(const std::vector<std::string>& vec);
 
 std::vector<std::string> py_to_stringvector(PyObject *obj);
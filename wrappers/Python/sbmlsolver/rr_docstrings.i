@@ -973,7 +973,9 @@ simulate accepts the following list of keyword arguments:
 integrator
   A text string specifying which integrator to use. Currently supports \"cvode\"
   for deterministic simulation (default) and \"gillespie\" for stochastic
-  simulation.
+  simulation. \"rosenbrock\" is a linearly implicit Rosenbrock integrator
+  for stiff models, it factors the dense Jacobian, and \"dopri5\" is an
+  explicit Runge-Kutta integrator for non stiff models.
 
 sel or selections
   A list of strings specifying what values to display in the output.
@@ -1048,6 +1050,18 @@ maximumNumSteps
   Specify the maximum number of steps the internal integrator will use before
   reaching the user specified time span. Uses the integrator default value if <= 0.
 
+thinning
+  "none", "change" or "interpolation", drop the output rows which can be
+  reproduced within the thinning tolerance, see SimulateOptions.thinning.
+
+thinningAbsolute, thinningRelative
+  The thinning tolerance.
+
+output
+  A file name or a TrajectoryWriter the result rows are written to, in the
+  compressed trajectory format, instead of returned. A file name is closed
+  when the simulation is done.
+
 
 :returns: a numpy array with each selected output time series being a
           column vector, and the 0'th column is the simulation time.
@@ -1936,6 +1950,34 @@ default value if <= 0.
 
 
 
+%feature("docstring") rr::SimulateOptions::thinning "
+:annotation: str
+
+Which output rows are kept, \"none\" keeps all of them, \"change\" keeps a
+row when a selected value moved by more than the thinning tolerance since
+the last kept row, and \"interpolation\" keeps a row when linear
+interpolation between the kept rows would miss a dropped row by more than
+the tolerance. The first, the last and the rows around events are always
+kept.
+";
+
+
+
+%feature("docstring") rr::SimulateOptions::thinningAbsolute "
+
+The absolute thinning tolerance, a value is within the tolerance if it
+differs by no more than thinningAbsolute + thinningRelative * abs(value).
+";
+
+
+
+%feature("docstring") rr::SimulateOptions::thinningRelative "
+
+The relative thinning tolerance, see thinningAbsolute.
+";
+
+
+
 %feature("docstring") rr::LoadSBMLOptions::conservedMoieties "
 :annotation: bool
 
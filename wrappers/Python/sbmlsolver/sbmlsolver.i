@@ -4,8 +4,11 @@
         "threads"=1 /*, directors="1"*/) sbmlsolver
 
 // most methods should leave the GIL locked, no point to extra overhead
-// for fast methods. Only SBMLSolver with long methods like simulate
-// and load release the GIL.
+// for fast methods. All of the SBMLSolver methods (simulate, steadyState,
+// load, the MCA and Jacobian matrices, ...) release the GIL, so several
+// SBMLSolver objects can be used concurrently from Python threads.
+// Extension methods that run long computations release it explicitly
+// with SWIG_PYTHON_THREAD_BEGIN_ALLOW.
 %nothread;
 
 //%feature("director") PyEventListener;
@@ -37,6 +40,12 @@
     #include <SBMLSolverOptions.h>
     #include <SBMLSolver.h>
     #include <rrLogger.h>
+    #include <Tracer.h>
+    #include <ParameterScan.h>
+    #include <SensitivityAnalysis.h>
+    #include <ParameterEstimation.h>
+    #include <FrequencyResponse.h>
+    #include <TrajectoryFile.h>
     #include <rrConfig.h>
     #include <conservation/ConservationExtension.h>
     #include "conservation/ConservedMoietyConverter.h"
@@ -164,12 +173,13 @@
 
 /**
  *  Convert from C --> Python
- *  copy data
+ *  the result is a temporary, so the numpy array takes over its buffer
+ *  instead of copying it.
  */
 %typemap(out) ls::DoubleMatrix {
     // %typemap(out) ls::DoubleMatrix
-    const ls::DoubleMatrix* mat = &($1);
-    $result = doublematrix_to_py(mat, SimulateOptions::COPY_RESULT);
+    ls::DoubleMatrix* mat = &($1);
+    $result = doublematrix_to_py_steal(mat, 0);
 }
 
 
@@ -617,6 +627,9 @@ PyObject *Integrator_NewPythonObj(rr::Integrator* i) {
 //%ignore rr::SBMLSolver::getValue;
 //%ignore rr::SBMLSolver::steadyState;
 %ignore rr::SBMLSolver::getValue(const SelectionRecord&);
+%ignore rr::SBMLSolver::setValue(const SelectionRecord&, double);
+%ignore rr::SBMLSolver::getValues(const SelectionRecord*, int, double*);
+%ignore rr::SBMLSolver::setValues(const SelectionRecord*, int, const double*);
 //%ignore rr::SBMLSolver::this;
 %ignore rr::SBMLSolver::getFloatingSpeciesByIndex;
 %ignore rr::SBMLSolver::getParameterValue;
@@ -807,6 +820,10 @@ PyObject *Integrator_NewPythonObj(rr::Integrator* i) {
 %ignore rr::Integrator::setListener(rr::IntegratorListenerPtr);
 %ignore rr::Integrator::getListener();
 
+// the sample listener is only used by simulate
+%ignore rr::IntegratorSampleListener;
+%ignore rr::Integrator::sample;
+
 //%ignore rr::Integrator::addIntegratorListener;
 //%ignore rr::Integrator::removeIntegratorListener;
 
@@ -846,8 +863,20 @@ namespace std { class ostream{}; }
 
 
 %include <Dictionary.h>
+
+// thinning is a string attribute in python, added by the extension below
+%ignore rr::SimulateOptions::thinning;
+
 %include <SBMLSolverOptions.h>
 %include <rrLogger.h>
+
+// spans are recorded from C++ only, python can enable the tracer and
+// get or write the trace.
+%ignore rr::TraceScope;
+%ignore rr::Tracer::record;
+%ignore rr::Tracer::write;
+%include <Tracer.h>
+
 %include <rrCompiler.h>
 %include <rrExecutableModel.h>
 %include <ExecutableModelFactory.h>
@@ -861,6 +890,421 @@ namespace std { class ostream{}; }
 %include <conservation/ConservedMoietyConverter.h>
 %include <Integrator.h>
 
+// the vector and matrix arguments and the result block are numpy arrays,
+// see the extension methods below.
+%ignore rr::ParameterScan::addAxis(const std::string&, const std::vector<double>&);
+%ignore rr::ParameterScan::setPoints(const std::vector<std::string>&, const ls::DoubleMatrix&);
+%ignore rr::ParameterScan::run();
+%ignore rr::ParameterScan::run(double*);
+%ignore rr::ParameterScan::getResult;
+%ignore rr::ParameterScan::write(const std::string&, const double*) const;
+
+// the scan borrows the solver, keep it alive as long as the scan
+%pythonappend rr::ParameterScan::ParameterScan %{
+    self._solver = args[0]
+%}
+
+%include <ParameterScan.h>
+
+%extend rr::ParameterScan
+{
+    /**
+     * add a grid axis, values is any sequence of numbers.
+     */
+    PyObject* addAxis(const std::string& id, PyObject* values) {
+        PyObject* array = PyArray_FROMANY(values, NPY_DOUBLE, 1, 1, NPY_IN_ARRAY);
+        if (!array) {
+            return NULL;
+        }
+
+        double* data = (double*)PyArray_DATA((PyArrayObject*)array);
+        std::vector<double> v(data, data + PyArray_DIM((PyArrayObject*)array, 0));
+        Py_DECREF(array);
+
+        $self->addAxis(id, v);
+        Py_RETURN_NONE;
+    }
+
+    /**
+     * set explicit scan points, points is a 2d array with one row per
+     * point and one column per id.
+     */
+    PyObject* setPoints(const std::vector<std::string>& ids, PyObject* points) {
+        PyObject* array = PyArray_FROMANY(points, NPY_DOUBLE, 2, 2, NPY_IN_ARRAY);
+        if (!array) {
+            return NULL;
+        }
+
+        int rows = PyArray_DIM((PyArrayObject*)array, 0);
+        int cols = PyArray_DIM((PyArrayObject*)array, 1);
+        ls::DoubleMatrix m(rows, cols);
+        memcpy(m.getArray(), PyArray_DATA((PyArrayObject*)array),
+                rows * cols * sizeof(double));
+        Py_DECREF(array);
+
+        $self->setPoints(ids, m);
+        Py_RETURN_NONE;
+    }
+
+    /**
+     * run the scan into a new points x time points x selections array.
+     */
+    PyObject* _run() {
+        npy_intp dims[] = {$self->getNumPoints(), $self->getNumTimePoints(),
+                $self->getNumSelections()};
+        PyObject *array = PyArray_SimpleNew(3, dims, NPY_DOUBLE);
+        if (!array) {
+            return NULL;
+        }
+
+        double *data = (double*)PyArray_DATA((PyArrayObject*)array);
+
+        try {
+            SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+            $self->run(data);
+            SWIG_PYTHON_THREAD_END_ALLOW;
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        return array;
+    }
+
+    %pythoncode %{
+        def run(self):
+            """
+            run the scan, returns a points x time points x selections array,
+            failed points are NaN, see getErrors.
+            """
+            return self._run()
+    %}
+
+    /**
+     * write the result array returned by run to a trajectory file.
+     */
+    PyObject* write(const std::string& fileName, PyObject* result) {
+        PyObject* array = PyArray_FROMANY(result, NPY_DOUBLE, 3, 3, NPY_IN_ARRAY);
+        if (!array) {
+            return NULL;
+        }
+
+        if ((size_t)PyArray_SIZE((PyArrayObject*)array) != $self->getResultSize()) {
+            Py_DECREF(array);
+            PyErr_SetString(PyExc_ValueError, "result is not the result of the last run");
+            return NULL;
+        }
+
+        try {
+            $self->write(fileName, (const double*)PyArray_DATA((PyArrayObject*)array));
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        Py_DECREF(array);
+        Py_RETURN_NONE;
+    }
+}
+
+// run releases the GIL, and the output values are returned as a copy,
+// the std::vector<double> out typemap only handles values. The extensions
+// have the signatures of the methods they replace, so they are named
+// with an underscore, and called by python methods of the original name.
+%ignore rr::SensitivityAnalysis::run();
+%ignore rr::SensitivityAnalysis::getOutputValues(int) const;
+
+%pythonappend rr::SensitivityAnalysis::SensitivityAnalysis %{
+    self._solver = args[0]
+%}
+
+%include <SensitivityAnalysis.h>
+
+%extend rr::SensitivityAnalysis
+{
+    void _run() {
+        SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+        $self->run();
+        SWIG_PYTHON_THREAD_END_ALLOW;
+    }
+
+    std::vector<double> _getOutputValues(int output) {
+        return $self->getOutputValues(output);
+    }
+
+    %pythoncode %{
+        def run(self):
+            """
+            run the evaluations and compute the indices.
+            """
+            self._run()
+
+        def getOutputValues(self, output):
+            """
+            the scalar output values of the last run, one per evaluation.
+            """
+            return self._getOutputValues(output)
+    %}
+}
+
+// the data and standard deviations are numpy arrays, and run releases
+// the GIL. Only the C++ signatures are ignored, an unqualified ignore
+// would also hide the extensions.
+%ignore rr::ParameterEstimation::addExperiment(const ls::DoubleMatrix&, const std::vector<std::string>&);
+%ignore rr::ParameterEstimation::setStandardDeviations(int, const ls::DoubleMatrix&);
+%ignore rr::ParameterEstimation::run();
+
+%pythonappend rr::ParameterEstimation::ParameterEstimation %{
+    self._solver = args[0]
+%}
+
+%include <ParameterEstimation.h>
+
+%{
+static bool toDoubleMatrix(PyObject* obj, ls::DoubleMatrix& m) {
+    PyObject* array = PyArray_FROMANY(obj, NPY_DOUBLE, 2, 2, NPY_IN_ARRAY);
+    if (!array) {
+        return false;
+    }
+
+    int rows = PyArray_DIM((PyArrayObject*)array, 0);
+    int cols = PyArray_DIM((PyArrayObject*)array, 1);
+    m.resize(rows, cols);
+    if (rows * cols) {
+        memcpy(m.getArray(), PyArray_DATA((PyArrayObject*)array),
+                rows * cols * sizeof(double));
+    }
+    Py_DECREF(array);
+    return true;
+}
+%}
+
+%extend rr::ParameterEstimation
+{
+    /**
+     * add an experiment, data is a 2d array of times and measured values
+     * of the selections, NaN for missing values.
+     */
+    PyObject* addExperiment(PyObject* data, const std::vector<std::string>& selections) {
+        ls::DoubleMatrix m;
+        if (!toDoubleMatrix(data, m)) {
+            return NULL;
+        }
+        return PyInt_FromLong($self->addExperiment(m, selections));
+    }
+
+    PyObject* setStandardDeviations(int experiment, PyObject* sigma) {
+        ls::DoubleMatrix m;
+        if (!toDoubleMatrix(sigma, m)) {
+            return NULL;
+        }
+        $self->setStandardDeviations(experiment, m);
+        Py_RETURN_NONE;
+    }
+
+    double _run() {
+        double ssr;
+        SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+        ssr = $self->run();
+        SWIG_PYTHON_THREAD_END_ALLOW;
+        return ssr;
+    }
+
+    %pythoncode %{
+        def run(self):
+            """
+            fit the parameters to the experiments, returns the weighted sum
+            of squared residuals at the estimate.
+            """
+            return self._run()
+    %}
+}
+
+// run releases the GIL, and the results are returned as copies, the out
+// typemaps only handle values. Only the C++ signatures are ignored, the
+// non const getters extend them.
+%ignore rr::FrequencyResponse::run(double, int, int);
+%ignore rr::FrequencyResponse::getParameters() const;
+%ignore rr::FrequencyResponse::getVariables() const;
+%ignore rr::FrequencyResponse::getFrequencies() const;
+%ignore rr::FrequencyResponse::getGain() const;
+%ignore rr::FrequencyResponse::getPhase() const;
+
+%pythonappend rr::FrequencyResponse::FrequencyResponse %{
+    self._solver = args[0]
+%}
+
+%include <FrequencyResponse.h>
+
+%extend rr::FrequencyResponse
+{
+    void _run(double startFrequency, int numberOfDecades, int numberOfPoints) {
+        SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+        $self->run(startFrequency, numberOfDecades, numberOfPoints);
+        SWIG_PYTHON_THREAD_END_ALLOW;
+    }
+
+    std::vector<std::string> getParameters() {
+        return $self->getParameters();
+    }
+
+    std::vector<std::string> getVariables() {
+        return $self->getVariables();
+    }
+
+    std::vector<double> getFrequencies() {
+        return $self->getFrequencies();
+    }
+
+    ls::DoubleMatrix getGain() {
+        return $self->getGain();
+    }
+
+    ls::DoubleMatrix getPhase() {
+        return $self->getPhase();
+    }
+
+    %pythoncode %{
+        def run(self, startFrequency, numberOfDecades, numberOfPoints):
+            """
+            compute the responses of all variables to all parameters at
+            numberOfPoints logarithmically spaced frequencies, from
+            startFrequency to startFrequency * 10**numberOfDecades.
+            """
+            self._run(startFrequency, numberOfDecades, numberOfPoints)
+    %}
+}
+
+// rows are written and columns read as numpy arrays, and the columns
+// are decoded straight into the array. Only the C++ signatures are
+// ignored, an unqualified ignore would also hide the extensions.
+%ignore rr::TrajectoryWriter::write(const double*);
+%ignore rr::TrajectoryWriter::write(const ls::DoubleMatrix&);
+%ignore rr::TrajectoryReader::getColumn(int, double*) const;
+%ignore rr::TrajectoryReader::getColumn(int) const;
+%ignore rr::TrajectoryReader::getMatrix() const;
+
+%include <TrajectoryFile.h>
+
+%extend rr::TrajectoryWriter
+{
+    /**
+     * write a row, or a 2d array of rows.
+     */
+    PyObject* write(PyObject* rows) {
+        PyObject* array = PyArray_FROMANY(rows, NPY_DOUBLE, 1, 2, NPY_IN_ARRAY);
+        if (!array) {
+            return NULL;
+        }
+
+        PyArrayObject* a = (PyArrayObject*)array;
+        int nrows = PyArray_NDIM(a) == 1 ? 1 : PyArray_DIM(a, 0);
+        int ncols = PyArray_DIM(a, PyArray_NDIM(a) - 1);
+
+        if (ncols != $self->getNumColumns()) {
+            Py_DECREF(array);
+            PyErr_Format(PyExc_ValueError, "expected %d columns, got %d",
+                    $self->getNumColumns(), ncols);
+            return NULL;
+        }
+
+        const double* data = (const double*)PyArray_DATA(a);
+        try {
+            for (int i = 0; i < nrows; ++i) {
+                $self->write(data + i * ncols);
+            }
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        Py_DECREF(array);
+        Py_RETURN_NONE;
+    }
+
+    %pythoncode %{
+        def __enter__(self):
+            return self
+
+        def __exit__(self, *args):
+            self.close()
+    %}
+}
+
+%extend rr::TrajectoryReader
+{
+    /**
+     * a column as a 1d array, by index or name.
+     */
+    PyObject* getColumn(PyObject* column) {
+        int index;
+        if (PyInt_Check(column) || PyLong_Check(column)) {
+            index = PyInt_AsLong(column);
+        } else if (PyString_Check(column)) {
+            index = $self->getColumnIndex(PyString_AsString(column));
+        } else {
+            PyErr_SetString(PyExc_TypeError, "column must be an index or a name");
+            return NULL;
+        }
+
+        if (index < 0 || index >= $self->getNumColumns()) {
+            PyErr_Format(PyExc_IndexError, "no column %d", index);
+            return NULL;
+        }
+
+        npy_intp dims[] = {(npy_intp)$self->getNumRows()};
+        PyObject *array = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+        if (!array) {
+            return NULL;
+        }
+
+        double *data = (double*)PyArray_DATA((PyArrayObject*)array);
+
+        try {
+            SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+            $self->getColumn(index, data);
+            SWIG_PYTHON_THREAD_END_ALLOW;
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        return array;
+    }
+
+    /**
+     * all the rows as a 2d array.
+     */
+    PyObject* read() {
+        npy_intp dims[] = {(npy_intp)$self->getNumRows(), $self->getNumColumns()};
+        PyObject *array = PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+        if (!array) {
+            return NULL;
+        }
+
+        double *data = (double*)PyArray_DATA((PyArrayObject*)array);
+
+        try {
+            SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+            std::vector<double> column(dims[0]);
+            for (int j = 0; j < dims[1]; ++j) {
+                if (dims[0]) {
+                    $self->getColumn(j, &column[0]);
+                }
+                for (npy_intp i = 0; i < dims[0]; ++i) {
+                    data[i * dims[1] + j] = column[i];
+                }
+            }
+            SWIG_PYTHON_THREAD_END_ALLOW;
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        return array;
+    }
+}
+
 %include "PyEventListener.h"
 %include "PyIntegratorListener.h"
 %include <rrConfig.h>
@@ -889,9 +1333,18 @@ namespace std { class ostream{}; }
         return $self->getInfo();
     }
 
-    PyObject* _simulate(const rr::SimulateOptions* opt) {
-        // its not const correct...
-        ls::DoubleMatrix *result = const_cast<ls::DoubleMatrix*>($self->simulate(opt));
+    PyObject* _simulate(const rr::SimulateOptions* opt,
+            rr::TrajectoryWriter* output = 0) {
+        ls::DoubleMatrix *result = 0;
+
+        // the GIL is released while integrating, it is re-acquired
+        // at the end of the block, even if simulate throws.
+        {
+            SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+            // its not const correct...
+            result = const_cast<ls::DoubleMatrix*>($self->simulate(opt, output));
+            SWIG_PYTHON_THREAD_END_ALLOW;
+        }
 
         return doublematrix_to_py(result, opt->flags);
     }
@@ -900,6 +1353,108 @@ namespace std { class ostream{}; }
         return $self->getValue(*pRecord);
     }
 
+    void setValue(const rr::SelectionRecord* pRecord, double value) {
+        $self->setValue(*pRecord, value);
+    }
+
+    /**
+     * get the values of a sequence of SelectionRecords (created with
+     * createSelection or resolve) as a numpy array.
+     */
+    PyObject* getValues(PyObject* selections) {
+        PyObject* seq = PySequence_Fast(selections, "selections must be a sequence of SelectionRecords");
+        if (!seq) {
+            return NULL;
+        }
+
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        npy_intp dims[] = {n};
+        PyObject *array = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+        if (!array) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+
+        double *data = (double*)PyArray_DATA((PyArrayObject*)array);
+
+        try {
+            for (Py_ssize_t i = 0; i < n; ++i) {
+                void *p = 0;
+                int res = SWIG_ConvertPtr(PySequence_Fast_GET_ITEM(seq, i), &p,
+                        SWIGTYPE_p_rr__SelectionRecord, 0);
+                if (!SWIG_IsOK(res)) {
+                    PyErr_SetString(PyExc_TypeError, "selections must be a sequence of SelectionRecords");
+                    Py_DECREF(seq);
+                    Py_DECREF(array);
+                    return NULL;
+                }
+                data[i] = $self->getValue(*static_cast<rr::SelectionRecord*>(p));
+            }
+        } catch (...) {
+            Py_DECREF(seq);
+            Py_DECREF(array);
+            throw;
+        }
+
+        Py_DECREF(seq);
+        return array;
+    }
+
+    /**
+     * set the values of a sequence of SelectionRecords, values is any
+     * sequence of numbers of the same length.
+     */
+    PyObject* setValues(PyObject* selections, PyObject* values) {
+        PyObject* seq = PySequence_Fast(selections, "selections must be a sequence of SelectionRecords");
+        if (!seq) {
+            return NULL;
+        }
+
+        PyObject* vals = PySequence_Fast(values, "values must be a sequence of numbers");
+        if (!vals) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+        if (PySequence_Fast_GET_SIZE(vals) != n) {
+            PyErr_SetString(PyExc_ValueError, "selections and values must have the same length");
+            Py_DECREF(seq);
+            Py_DECREF(vals);
+            return NULL;
+        }
+
+        std::vector<rr::SelectionRecord> records(n);
+        std::vector<double> v(n);
+
+        for (Py_ssize_t i = 0; i < n; ++i) {
+            void *p = 0;
+            int res = SWIG_ConvertPtr(PySequence_Fast_GET_ITEM(seq, i), &p,
+                    SWIGTYPE_p_rr__SelectionRecord, 0);
+            v[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(vals, i));
+
+            if (!SWIG_IsOK(res) || PyErr_Occurred()) {
+                if (!PyErr_Occurred()) {
+                    PyErr_SetString(PyExc_TypeError, "selections must be a sequence of SelectionRecords");
+                }
+                Py_DECREF(seq);
+                Py_DECREF(vals);
+                return NULL;
+            }
+            records[i] = *static_cast<rr::SelectionRecord*>(p);
+        }
+
+        Py_DECREF(seq);
+        Py_DECREF(vals);
+
+        // resets the model at most once
+        if (n) {
+            $self->setValues(&records[0], n, &v[0]);
+        }
+
+        Py_RETURN_NONE;
+    }
+
     double __getitem__(const std::string& id) {
         return ($self)->getValue(id);
     }
@@ -1070,6 +1625,35 @@ namespace std { class ostream{}; }
             SBMLSolver._makeProperties(self)
 
 
+        def performanceCounters(self):
+            """
+            the performance counters and timers (seconds) of the simulations,
+            the integrator, the model and the last steady state as a dict,
+            see getPerformanceCounters.
+
+            >>> r.simulate(0, 10, 100)
+            >>> r.performanceCounters()['integrator.NumRhsEvals']
+            153
+            """
+            d = self.getPerformanceCounters()
+            return dict((k, d.getItem(k)) for k in d.getKeys())
+
+        def resolve(self, ids):
+            """
+            resolve a list of selection strings to SelectionRecords.
+
+            The records hold the type and model index of each element, use them
+            with getValues / setValues to get and set values without any id
+            lookups, e.g. in a control loop. They must be resolved again after
+            a new model is loaded.
+
+            >>> sels = r.resolve(['[S1]', 'k1'])
+            >>> r.getValues(sels)
+            array([ 10. ,   0.1])
+            >>> r.setValues(sels, [5, 0.2])
+            """
+            return [self.createSelection(i) for i in ids]
+
         def keys(self, types=_sbmlsolver.SelectionRecord_ALL):
             return self.getIds(types)
 
@@ -1176,7 +1760,9 @@ namespace std { class ostream{}; }
             integrator
                 A text string specifying which integrator to use. Currently supports "cvode"
                 for deterministic simulation (default) and "gillespie" for stochastic
-                simulation.
+                simulation. "rosenbrock" is a linearly implicit Rosenbrock integrator
+                for stiff models, it factors the dense Jacobian, and "dopri5" is an
+                explicit Runge-Kutta integrator for non stiff models.
 
             sel or selections
                 A list of strings specifying what values to display in the output.
@@ -1250,6 +1836,27 @@ namespace std { class ostream{}; }
                 Specify the maximum number of steps the internal integrator will use before
                 reaching the user specified time span. Uses the integrator default value if <= 0.
 
+            thinning
+                "none", "change" or "interpolation", drop the output rows which are not needed.
+                With "change", a row is kept when a selected value moved by more than the
+                thinning tolerance since the last kept row, with "interpolation", when a straight
+                line between the kept rows would miss the dropped values by more than the
+                tolerance. The first, the last and the rows around events are always kept, the
+                "simulate.compressionRatio" performance counter is the number of output rows
+                per kept row.
+
+            thinningAbsolute, thinningRelative
+                The thinning tolerance, a value is within the tolerance if it differs by no more
+                than thinningAbsolute + thinningRelative * abs(value).
+
+            output
+                A file name or a TrajectoryWriter. The result rows are written to the compressed
+                trajectory file as they are produced, instead of returned, which keeps long or
+                many simulations out of memory. A file name creates a new file with a column per
+                selection, which is closed when the simulation is done, a TrajectoryWriter is left
+                open, so several simulations can be written to it. Read the file with
+                TrajectoryReader.
+
             seed
                 Specify a seed to use for the random number generator for stochastic simulations.
                 The seed is used whenever the integrator is reset, i.e. `r.reset()`.
@@ -1264,6 +1871,9 @@ namespace std { class ostream{}; }
             doPlot = False
             showPlot = True
 
+            # a trajectory file the result is written to
+            output = None
+
             # user specified number of steps via 3rd arg or steps=xxx
             haveSteps = False
 
@@ -1363,6 +1973,10 @@ namespace std { class ostream{}; }
                     showPlot = v
                     continue
 
+                if k == "output":
+                    output = v
+                    continue
+
                 # if its not one of these, just set the item on the dict, and
                 # if the inegrator cares about it, it will use it.
                 # if its one of these, set it.
@@ -1378,8 +1992,17 @@ namespace std { class ostream{}; }
                 Integrator.STOCHASTIC and not haveVariableStep:
                 o.variableStep = not haveSteps
 
+            # a file name is written to a new file, which is closed when done
+            closeOutput = output is not None and not isinstance(output, TrajectoryWriter)
+            if closeOutput:
+                output = TrajectoryWriter(output, self.selections)
+
             # the options are set up, now actually run the simuation...
-            result = self._simulate(o)
+            try:
+                result = self._simulate(o, output)
+            finally:
+                if closeOutput:
+                    output.close()
 
             if not hadSeed:
                 del o["seed"]
@@ -1491,6 +2114,7 @@ namespace std { class ostream{}; }
     bool structuredResult;
     bool variableStep;
     bool copyResult;
+    std::string thinning;
 
     std::string __repr__() {
         return ($self)->toRepr();
@@ -1608,6 +2232,14 @@ namespace std { class ostream{}; }
     void rr_SimulateOptions_variableStep_set(SimulateOptions* opt, bool value) {
         opt->setItem("variableStep", value);
     }
+
+    std::string rr_SimulateOptions_thinning_get(SimulateOptions* opt) {
+        return opt->getItem("thinning");
+    }
+
+    void rr_SimulateOptions_thinning_set(SimulateOptions* opt, const std::string& value) {
+        opt->setItem("thinning", value);
+    }
 %}
 
 
@@ -2,7 +2,7 @@ import time
 import random
 
 
-from sbmlsolver import SBMLSolver, Logger
+from sbmlsolver import SBMLSolver, Logger, TrajectoryWriter
 import numpy as n
 import os
 import sys
@@ -34,7 +34,11 @@ def ensemble(src, ensembles, seeds=None, *sim_args, **sim_kwargs):
 
         *args: the arguments that are passed to SBMLSolver.simulate
     
-        **kwargs: the keyword arguments that are passed to SBMLSolver.simulate
+        **kwargs: the keyword arguments that are passed to SBMLSolver.simulate,
+               except output: an optional file name, the results of all the
+               simulations are written to a compressed trajectory file, with
+               a leading ensemble column, the number of the simulation in the
+               order they finished.
 
     Returns:
         A tuple containing the mean and std matricies. 
@@ -45,6 +49,10 @@ def ensemble(src, ensembles, seeds=None, *sim_args, **sim_kwargs):
 
     start = time.time()
 
+    # the parent writes the results, the workers return them
+    output = sim_kwargs.pop('output', None)
+    writer = None
+
     # parent process will run statistics, but stats are
     # very minimal, so better perf using all processors.
     CPU_COUNT = cpu_count() 
@@ -92,7 +100,12 @@ def ensemble(src, ensembles, seeds=None, *sim_args, **sim_kwargs):
     print 'Unordered results:'
     for i in range(ensembles):
 
-        res = results.get()
+        columns, res = results.get()
+
+        if output is not None:
+            if writer is None:
+                writer = TrajectoryWriter(output, ['ensemble'] + columns)
+            writer.write(n.column_stack((i * n.ones(res.shape[0]), res)))
 
         if stdev is None or mean is None:
             mean = n.zeros(res.shape)
@@ -110,6 +123,9 @@ def ensemble(src, ensembles, seeds=None, *sim_args, **sim_kwargs):
         stdev[:,1:] += (res[:,1:])**2
 
 
+    if writer is not None:
+        writer.close()
+
     # divide by num processes to get expectation of x
     # and expectation of X^2
     mean[:,1:] = mean[:,1:] / ensembles
@@ -172,7 +188,7 @@ def _worker(src, seeds, results, sim_args, sim_kwargs):
     for seed in iter(seeds.get, None):
         sim_kwargs['seed'] = seed
         result = r.simulate(*sim_args, **sim_kwargs)
-        results.put(result)
+        results.put((r.selections, result))
         n += 1
 
     print("process {} finished with {} simulations".format(os.getpid(), n))